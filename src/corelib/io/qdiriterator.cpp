@@ -51,6 +51,22 @@
     enables iterating through all subdirectories of the assigned path,
     following all symbolic links. Symbolic link loops (e.g., "link" => "." or
     "link" => "..") are automatically detected and ignored.
+
+    \value [since 6.8] ParallelTraversal When combined with Subdirectories,
+    subdirectories are listed concurrently by a pool of worker threads while
+    the iterator is being advanced. The workers also retrieve the file
+    information needed to apply the filters, so that this I/O does not block
+    the thread using the iterator; this speeds up the traversal of large trees
+    on storage with high latency, such as network file systems. Entries are
+    returned in the same order as without this flag, unless UnorderedResults
+    is also set. This flag is ignored for directories that are not in the
+    native file system, such as resources, and in builds without thread
+    support.
+
+    \value [since 6.8] UnorderedResults When combined with ParallelTraversal,
+    the entries of each directory are returned as soon as it has been listed,
+    rather than in depth-first order. Entries of the same directory are still
+    returned in the order in which they were listed.
 */
 
 #include "qdiriterator.h"
@@ -63,6 +79,12 @@
 #if QT_CONFIG(regularexpression)
 #include <QtCore/qregularexpression.h>
 #endif
+#if QT_CONFIG(thread)
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+#endif
 
 #include <QtCore/private/qfilesystemiterator_p.h>
 #include <QtCore/private/qfilesystementry_p.h>
@@ -71,7 +93,14 @@
 #include <QtCore/private/qfileinfo_p.h>
 #include <QtCore/private/qduplicatetracker_p.h>
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <vector>
+
+#if QT_CONFIG(thread) && !defined(QT_NO_FILESYSTEMITERATOR)
+#  define QT_DIRITERATOR_PARALLEL
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -87,19 +116,85 @@ public:
     }
 };
 
+#ifdef QT_DIRITERATOR_PARALLEL
+// The state shared by a QDirIterator using ParallelTraversal and its workers.
+// Every directory to list is a Node; a worker lists it, applying the filters,
+// and queues the subdirectories it finds as new nodes. The iterator consumes
+// the nodes either depth-first, waiting for (or listing itself) the node it
+// needs next, or in the order in which they were listed.
+struct QDirIteratorParallelTraversal
+{
+    struct Node;
+    struct Entry
+    {
+        QFileInfo fileInfo;
+        std::shared_ptr<Node> subdirectory; // to descend into after this entry
+        bool matches = false;
+    };
+    struct Node
+    {
+        enum State { Queued, Listing, Listed };
+
+        explicit Node(const QFileInfo &directory) : directory(directory) {}
+
+        QFileInfo directory;
+        std::vector<Entry> entries;
+        State state = Queued;
+    };
+
+    // Directories listed, or being listed, that the iterator has not
+    // consumed yet. This bounds the memory used by a traversal that runs
+    // ahead of the iterator.
+    static constexpr int MaximumPendingNodes = 64;
+
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition nodeListed;
+    std::deque<std::shared_ptr<Node>> queue;    // Queued, or claimed by the iterator
+    std::deque<std::shared_ptr<Node>> listed;   // for UnorderedResults
+    int pendingNodes = 0;
+    int listingNodes = 0;
+    std::atomic<bool> canceled = false;
+
+    // the iterator's position, used by the iterator's thread only
+    struct Position
+    {
+        std::shared_ptr<Node> node;
+        size_t index = 0;
+        bool isListed = false;
+    };
+    QStack<Position> stack;
+    bool atEnd = false;
+};
+#endif
+
 class QDirIteratorPrivate
 {
 public:
     QDirIteratorPrivate(const QFileSystemEntry &entry, const QStringList &nameFilters,
                         QDir::Filters _filters, QDirIterator::IteratorFlags flags, bool resolveEngine = true);
+#ifdef QT_DIRITERATOR_PARALLEL
+    ~QDirIteratorPrivate();
+#endif
 
     void advance();
 
     bool entryMatches(const QString & fileName, const QFileInfo &fileInfo);
     void pushDirectory(const QFileInfo &fileInfo);
     void checkAndPushDirectory(const QFileInfo &);
+    bool shouldDescend(const QFileInfo &fileInfo) const;
     bool matchesFilters(const QString &fileName, const QFileInfo &fi) const;
 
+#ifdef QT_DIRITERATOR_PARALLEL
+    void startParallelTraversal(const QFileInfo &fileInfo);
+    void scheduleNodes();
+    void listNode(const std::shared_ptr<QDirIteratorParallelTraversal::Node> &node);
+    void waitUntilListed(const std::shared_ptr<QDirIteratorParallelTraversal::Node> &node);
+    bool nextParallelEntry(QFileInfo *fileInfo);
+
+    std::unique_ptr<QDirIteratorParallelTraversal> parallel;
+#endif
+
     std::unique_ptr<QAbstractFileEngine> engine;
 
     QFileSystemEntry dirEntry;
@@ -146,11 +241,226 @@ QDirIteratorPrivate::QDirIteratorPrivate(const QFileSystemEntry &entry, const QS
         engine.reset(QFileSystemEngine::resolveEntryAndCreateLegacyEngine(dirEntry, metaData));
     QFileInfo fileInfo(new QFileInfoPrivate(dirEntry, metaData));
 
+#ifdef QT_DIRITERATOR_PARALLEL
+    if (!engine && iteratorFlags.testFlags(QDirIterator::ParallelTraversal
+                                           | QDirIterator::Subdirectories)) {
+        startParallelTraversal(fileInfo);
+        advance();
+        return;
+    }
+#endif
+
     // Populate fields for hasNext() and next()
     pushDirectory(fileInfo);
     advance();
 }
 
+#ifdef QT_DIRITERATOR_PARALLEL
+QDirIteratorPrivate::~QDirIteratorPrivate()
+{
+    if (!parallel)
+        return;
+    {
+        QMutexLocker locker(&parallel->mutex);
+        parallel->canceled = true;
+    }
+    parallel->pool.waitForDone();
+}
+
+/*!
+    \internal
+
+    Queues the root directory described by \a fileInfo for listing.
+*/
+void QDirIteratorPrivate::startParallelTraversal(const QFileInfo &fileInfo)
+{
+    parallel = std::make_unique<QDirIteratorParallelTraversal>();
+    // listing a directory mostly waits for I/O, so use more threads than cores
+    parallel->pool.setMaxThreadCount(qMax(4, 2 * QThread::idealThreadCount()));
+    parallel->pool.setObjectName("QDirIterator"_L1);
+
+    if ((iteratorFlags & QDirIterator::FollowSymlinks)
+            && visitedLinks.hasSeen(fileInfo.canonicalFilePath())) {
+        parallel->atEnd = true;
+        return;
+    }
+    auto root = std::make_shared<QDirIteratorParallelTraversal::Node>(fileInfo);
+    if (!(iteratorFlags & QDirIterator::UnorderedResults))
+        parallel->stack.push({ root });
+    QMutexLocker locker(&parallel->mutex);
+    parallel->queue.push_back(std::move(root));
+    scheduleNodes();
+}
+
+/*!
+    \internal
+
+    Starts workers for queued nodes, as long as fewer than
+    MaximumPendingNodes are pending. Must be called with the mutex locked.
+*/
+void QDirIteratorPrivate::scheduleNodes()
+{
+    using Node = QDirIteratorParallelTraversal::Node;
+    QDirIteratorParallelTraversal &state = *parallel;
+    while (!state.canceled && !state.queue.empty()
+           && state.pendingNodes < QDirIteratorParallelTraversal::MaximumPendingNodes) {
+        std::shared_ptr<Node> node = std::move(state.queue.front());
+        state.queue.pop_front();
+        if (node->state != Node::Queued)
+            continue; // claimed by the iterator
+        node->state = Node::Listing;
+        ++state.pendingNodes;
+        ++state.listingNodes;
+        state.pool.start([this, node = std::move(node)] { listNode(node); });
+    }
+}
+
+/*!
+    \internal
+
+    Lists the directory of \a node, which must be in the Listing state, and
+    queues its subdirectories. This runs in a worker thread, or in the
+    iterator's thread if it needs the node before a worker got to it.
+*/
+void QDirIteratorPrivate::listNode(const std::shared_ptr<QDirIteratorParallelTraversal::Node> &node)
+{
+    using Node = QDirIteratorParallelTraversal::Node;
+    QDirIteratorParallelTraversal &state = *parallel;
+    std::vector<QDirIteratorParallelTraversal::Entry> entries;
+    std::vector<std::shared_ptr<Node>> subdirectories;
+
+    QFileSystemIterator it(node->directory.d_ptr->fileEntry, filters, nameFilters,
+                           iteratorFlags);
+    QFileSystemEntry entry;
+    QFileSystemMetaData metaData;
+    while (!state.canceled.load(std::memory_order_relaxed) && it.advance(entry, metaData)) {
+        QFileInfo info(new QFileInfoPrivate(entry, metaData));
+        metaData = QFileSystemMetaData();
+
+        std::shared_ptr<Node> subdirectory;
+        if (shouldDescend(info)) {
+            bool seen = false;
+            if (iteratorFlags & QDirIterator::FollowSymlinks) {
+                const QString canonicalPath = info.canonicalFilePath();
+                QMutexLocker locker(&state.mutex);
+                seen = visitedLinks.hasSeen(canonicalPath);
+            }
+            if (!seen) {
+                subdirectory = std::make_shared<Node>(info);
+                subdirectories.push_back(subdirectory);
+            }
+        }
+        const bool matches = matchesFilters(entry.fileName(), info);
+        if (matches || subdirectory)
+            entries.push_back({ std::move(info), std::move(subdirectory), matches });
+    }
+
+    QMutexLocker locker(&state.mutex);
+    node->entries = std::move(entries);
+    node->state = Node::Listed;
+    --state.listingNodes;
+    if (iteratorFlags & QDirIterator::UnorderedResults)
+        state.listed.push_back(node);
+    for (auto &subdirectory : subdirectories)
+        state.queue.push_back(std::move(subdirectory));
+    state.nodeListed.wakeAll();
+    scheduleNodes();
+}
+
+/*!
+    \internal
+
+    Waits until \a node is listed. If no worker has started listing it yet,
+    the node is listed in the calling thread.
+*/
+void QDirIteratorPrivate::waitUntilListed(
+        const std::shared_ptr<QDirIteratorParallelTraversal::Node> &node)
+{
+    using Node = QDirIteratorParallelTraversal::Node;
+    QDirIteratorParallelTraversal &state = *parallel;
+    QMutexLocker locker(&state.mutex);
+    if (node->state == Node::Queued) {
+        node->state = Node::Listing;
+        ++state.pendingNodes;
+        ++state.listingNodes;
+        locker.unlock();
+        listNode(node);
+        return;
+    }
+    while (node->state != Node::Listed)
+        state.nodeListed.wait(&state.mutex);
+}
+
+/*!
+    \internal
+
+    Retrieves the next matching entry of a parallel traversal into
+    \a fileInfo. Returns \c false if there are none left.
+*/
+bool QDirIteratorPrivate::nextParallelEntry(QFileInfo *fileInfo)
+{
+    QDirIteratorParallelTraversal &state = *parallel;
+    const bool unordered = iteratorFlags.testFlag(QDirIterator::UnorderedResults);
+
+    while (!state.atEnd) {
+        if (state.stack.isEmpty()) {
+            if (!unordered) {
+                state.atEnd = true;
+                break;
+            }
+            // continue with whichever directory was listed first
+            QMutexLocker locker(&state.mutex);
+            while (state.listed.empty() && (state.listingNodes || !state.queue.empty())) {
+                if (!state.listingNodes) {
+                    // all workers are done, but the queue was not scheduled
+                    scheduleNodes();
+                    if (!state.listingNodes)
+                        break;
+                }
+                state.nodeListed.wait(&state.mutex);
+            }
+            if (state.listed.empty()) {
+                state.atEnd = true;
+                break;
+            }
+            state.stack.push({ std::move(state.listed.front()), 0, true });
+            state.listed.pop_front();
+        }
+
+        QDirIteratorParallelTraversal::Position &position = state.stack.top();
+        if (!position.isListed) {
+            waitUntilListed(position.node);
+            position.isListed = true;
+        }
+        std::vector<QDirIteratorParallelTraversal::Entry> &entries = position.node->entries;
+        while (position.index < entries.size()) {
+            QDirIteratorParallelTraversal::Entry &entry = entries[position.index++];
+            const bool matches = entry.matches;
+            if (matches)
+                *fileInfo = std::move(entry.fileInfo);
+            if (entry.subdirectory && !unordered) {
+                // its entries follow this one, as in a sequential traversal
+                // (this invalidates position)
+                state.stack.push({ std::move(entry.subdirectory) });
+                if (matches)
+                    return true;
+                break;
+            }
+            if (matches)
+                return true;
+        }
+        const QDirIteratorParallelTraversal::Position &top = state.stack.top();
+        if (top.isListed && top.index == top.node->entries.size()) {
+            state.stack.pop();
+            QMutexLocker locker(&state.mutex);
+            --state.pendingNodes;
+            scheduleNodes();
+        }
+    }
+    return false;
+}
+#endif
+
 /*!
     \internal
 */
@@ -209,6 +519,17 @@ inline bool QDirIteratorPrivate::entryMatches(const QString & fileName, const QF
 */
 void QDirIteratorPrivate::advance()
 {
+#ifdef QT_DIRITERATOR_PARALLEL
+    if (parallel) {
+        QFileInfo fileInfo;
+        currentFileInfo = nextFileInfo;
+        if (nextParallelEntry(&fileInfo))
+            nextFileInfo = std::move(fileInfo);
+        else
+            nextFileInfo = QFileInfo();
+        return;
+    }
+#endif
     if (engine) {
         while (!fileEngineIterators.isEmpty()) {
             // Find the next valid iterator that matches the filters.
@@ -252,29 +573,41 @@ void QDirIteratorPrivate::advance()
     \internal
  */
 void QDirIteratorPrivate::checkAndPushDirectory(const QFileInfo &fileInfo)
+{
+    if (shouldDescend(fileInfo))
+        pushDirectory(fileInfo);
+}
+
+/*!
+    \internal
+
+    Returns \c true if the iteration should continue into the directory
+    described by \a fileInfo.
+ */
+bool QDirIteratorPrivate::shouldDescend(const QFileInfo &fileInfo) const
 {
     // If we're doing flat iteration, we're done.
     if (!(iteratorFlags & QDirIterator::Subdirectories))
-        return;
+        return false;
 
     // Never follow non-directory entries
     if (!fileInfo.isDir())
-        return;
+        return false;
 
     // Follow symlinks only when asked
     if (!(iteratorFlags & QDirIterator::FollowSymlinks) && fileInfo.isSymLink())
-        return;
+        return false;
 
     // Never follow . and ..
     QString fileName = fileInfo.fileName();
     if ("."_L1 == fileName || ".."_L1 == fileName)
-        return;
+        return false;
 
     // No hidden directories unless requested
     if (!(filters & QDir::AllDirs) && !(filters & QDir::Hidden) && fileInfo.isHidden())
-        return;
+        return false;
 
-    pushDirectory(fileInfo);
+    return true;
 }
 
 /*!
@@ -497,6 +830,10 @@ QFileInfo QDirIterator::nextFileInfo()
 */
 bool QDirIterator::hasNext() const
 {
+#ifdef QT_DIRITERATOR_PARALLEL
+    if (d->parallel)
+        return !d->parallel->atEnd;
+#endif
     if (d->engine)
         return !d->fileEngineIterators.isEmpty();
     else
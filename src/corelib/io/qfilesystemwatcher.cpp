@@ -32,6 +32,10 @@
 QT_BEGIN_NAMESPACE
 
 using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+// how long the changes in recursively watched trees are collected
+static constexpr auto BatchInterval = 50ms;
 
 Q_LOGGING_CATEGORY(lcWatcher, "qt.core.filesystemwatcher")
 
@@ -71,6 +75,8 @@ void QFileSystemWatcherPrivate::init()
                          SIGNAL(directoryChanged(QString,bool)),
                          q,
                          SLOT(_q_directoryChanged(QString,bool)));
+        QObject::connect(native, &QFileSystemWatcherEngine::directoriesChanged,
+                         q, [this] (const QStringList &p) { _q_directoriesChanged(p); });
 #if defined(Q_OS_WIN)
         QObject::connect(static_cast<QWindowsFileSystemWatcherEngine *>(native),
                          &QWindowsFileSystemWatcherEngine::driveLockForRemoval,
@@ -119,15 +125,61 @@ void QFileSystemWatcherPrivate::_q_directoryChanged(const QString &path, bool re
 {
     Q_Q(QFileSystemWatcher);
     qCDebug(lcWatcher) << "directory changed" << path << "removed?" << removed << "watching?" << directories.contains(path);
-    if (!directories.contains(path)) {
+    if (!directories.contains(path) && !recursiveDirectories.contains(path)) {
         // perhaps the path was removed after a change was detected, but before we delivered the signal
         return;
     }
-    if (removed)
+    if (removed) {
         directories.removeAll(path);
+        recursiveDirectories.removeAll(path);
+    }
     emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
 }
 
+bool QFileSystemWatcherPrivate::isInRecursiveDirectory(const QString &path) const
+{
+    return std::any_of(recursiveDirectories.cbegin(), recursiveDirectories.cend(),
+                       [&path](const QString &root) {
+        return path.startsWith(root)
+                && (path.size() == root.size() || root.endsWith(u'/')
+                    || path.at(root.size()) == u'/');
+    });
+}
+
+void QFileSystemWatcherPrivate::_q_directoriesChanged(const QStringList &paths)
+{
+    Q_Q(QFileSystemWatcher);
+    qCDebug(lcWatcher) << "directories changed" << paths;
+    for (const QString &path : paths) {
+        // the tree might have been removed after the change was detected
+        if (!isInRecursiveDirectory(path) || changedDirectorySet.contains(path))
+            continue;
+        changedDirectorySet.insert(path);
+        changedDirectories.append(path);
+    }
+    if (changedDirectories.isEmpty())
+        return;
+
+    if (!batchTimer) {
+        batchTimer = new QTimer(q);
+        batchTimer->setSingleShot(true);
+        batchTimer->setInterval(BatchInterval);
+        QObject::connect(batchTimer, &QTimer::timeout, q, [this] { emitChangedDirectories(); });
+    }
+    if (!batchTimer->isActive())
+        batchTimer->start();
+}
+
+void QFileSystemWatcherPrivate::emitChangedDirectories()
+{
+    Q_Q(QFileSystemWatcher);
+    const QStringList paths = std::exchange(changedDirectories, {});
+    changedDirectorySet.clear();
+    for (const QString &path : paths)
+        emit q->directoryChanged(path, QFileSystemWatcher::QPrivateSignal());
+    emit q->directoriesChanged(paths, QFileSystemWatcher::QPrivateSignal());
+}
+
 #if defined(Q_OS_WIN)
 
 void QFileSystemWatcherPrivate::_q_winDriveLockForRemoval(const QString &path)
@@ -217,6 +269,16 @@ void  QFileSystemWatcherPrivate::_q_winDriveRemoved(const QString &path)
     \endlist
     \endlist
 
+    To watch a whole directory tree, call addPathRecursive() instead of
+    adding each subdirectory. The directories created in the tree later
+    are watched as well, and the directories in which entries changed
+    are reported with directoriesChanged(), one batch at a time, in
+    addition to directoryChanged(). Such trees are listed by
+    recursiveDirectories() rather than directories(). On Linux, this uses
+    fanotify if the process has the privileges to watch a whole file
+    system, and one inotify watch per directory otherwise; other platforms
+    do not support it yet.
+
     \sa QFile, QDir
 */
 
@@ -407,10 +469,59 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
         p = d->native->removePaths(p, &d->files, &d->directories);
     if (d->poller)
         p = d->poller->removePaths(p, &d->files, &d->directories);
+    if (d->native && !p.isEmpty())
+        p = d->native->removeRecursivePaths(p, &d->recursiveDirectories);
 
     return p;
 }
 
+/*!
+    \since 6.8
+
+    Adds the directory \a directory and all its subdirectories to the file
+    system watcher, including the subdirectories that are created later.
+    Returns \c true if the tree is being watched.
+
+    The directoryChanged() and directoriesChanged() signals are emitted
+    for each directory of the tree in which an entry was added, removed,
+    renamed or had its attributes changed. The changes are collected for a
+    short while before they are reported, so that a burst of changes
+    results in one directoriesChanged() signal, and in one
+    directoryChanged() signal per directory. When \a directory itself is
+    removed, directoryChanged() is emitted for it and the tree is no
+    longer watched.
+
+    Symbolic links to directories in the tree are not followed.
+    Call removePath() with \a directory to stop watching the tree.
+
+    Unlike with addPath(), the subdirectories do not count individually
+    against the system's limit of watched paths when the process is
+    allowed to use fanotify on Linux, that is, when it has the
+    \c CAP_SYS_ADMIN and \c CAP_DAC_READ_SEARCH capabilities. In that
+    case, file systems mounted inside of the tree are not watched.
+    Setting the \c QT_NO_FANOTIFY environment variable makes the watcher
+    use inotify nonetheless.
+
+    \note This function is currently only supported on Linux, and returns
+    \c false on other platforms.
+
+    \sa recursiveDirectories(), removePath(), addPath()
+*/
+bool QFileSystemWatcher::addPathRecursive(const QString &directory)
+{
+    Q_D(QFileSystemWatcher);
+
+    if (directory.isEmpty()) {
+        qWarning("QFileSystemWatcher::addPathRecursive: path is empty");
+        return false;
+    }
+    qCDebug(lcWatcher) << "adding recursively" << directory;
+
+    if (!d->native)
+        return false;
+    return d->native->addRecursivePaths(QStringList(directory), &d->recursiveDirectories).isEmpty();
+}
+
 /*!
     \fn void QFileSystemWatcher::fileChanged(const QString &path)
 
@@ -439,6 +550,19 @@ QStringList QFileSystemWatcher::removePaths(const QStringList &paths)
     \sa fileChanged()
 */
 
+/*!
+    \fn void QFileSystemWatcher::directoriesChanged(const QStringList &paths)
+    \since 6.8
+
+    This signal is emitted with the \a paths of the directories, in trees
+    watched with addPathRecursive(), in which entries were added, removed,
+    renamed or changed their attributes during a short period of time.
+    The directoryChanged() signal has been emitted for each of the \a
+    paths right before.
+
+    \sa addPathRecursive()
+*/
+
 /*!
     \fn QStringList QFileSystemWatcher::directories() const
 
@@ -467,6 +591,20 @@ QStringList QFileSystemWatcher::files() const
     return d->files;
 }
 
+/*!
+    \since 6.8
+
+    Returns a list of paths to the directory trees that are being watched
+    with addPathRecursive().
+
+    \sa directories()
+*/
+QStringList QFileSystemWatcher::recursiveDirectories() const
+{
+    Q_D(const QFileSystemWatcher);
+    return d->recursiveDirectories;
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qfilesystemwatcher.cpp"
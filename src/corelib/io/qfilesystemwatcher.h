@@ -27,13 +27,16 @@ public:
     QStringList addPaths(const QStringList &files);
     bool removePath(const QString &file);
     QStringList removePaths(const QStringList &files);
+    bool addPathRecursive(const QString &directory);
 
     QStringList files() const;
     QStringList directories() const;
+    QStringList recursiveDirectories() const;
 
 Q_SIGNALS:
     void fileChanged(const QString &path, QPrivateSignal);
     void directoryChanged(const QString &path, QPrivateSignal);
+    void directoriesChanged(const QStringList &paths, QPrivateSignal);
 
 private:
     Q_PRIVATE_SLOT(d_func(), void _q_fileChanged(const QString &path, bool removed))
@@ -15,6 +15,8 @@
 #include <qvarlengtharray.h>
 
 #if defined(Q_OS_LINUX)
+#include "qfilesystemwatcher_linux_p.h"
+
 #include <sys/syscall.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -388,6 +390,53 @@ void QInotifyFileSystemWatcherEngine::readFromInotify()
     }
 }
 
+#ifdef Q_OS_LINUX
+QStringList QInotifyFileSystemWatcherEngine::addRecursivePaths(const QStringList &paths,
+                                                               QStringList *directories)
+{
+    QStringList unhandled;
+    for (const QString &path : paths) {
+        if (directories->contains(path) || !QFileInfo(path).isDir()) {
+            unhandled.push_back(path);
+            continue;
+        }
+
+        // each tree has its own file descriptor, so that trees can overlap
+        QFileSystemTreeWatcher *tree = QFileSystemTreeWatcher::create(path, this);
+        if (!tree) {
+            unhandled.push_back(path);
+            continue;
+        }
+        connect(tree, &QFileSystemTreeWatcher::directoriesChanged,
+                this, &QInotifyFileSystemWatcherEngine::directoriesChanged);
+        connect(tree, &QFileSystemTreeWatcher::rootRemoved, this, [this, path] {
+            if (QFileSystemTreeWatcher *tree = trees.take(path))
+                tree->deleteLater();
+            emit directoryChanged(path, true);
+        });
+        trees.insert(path, tree);
+        directories->append(path);
+    }
+    return unhandled;
+}
+
+QStringList QInotifyFileSystemWatcherEngine::removeRecursivePaths(const QStringList &paths,
+                                                                  QStringList *directories)
+{
+    QStringList unhandled;
+    for (const QString &path : paths) {
+        QFileSystemTreeWatcher *tree = trees.take(path);
+        if (!tree) {
+            unhandled.push_back(path);
+            continue;
+        }
+        delete tree;
+        directories->removeAll(path);
+    }
+    return unhandled;
+}
+#endif // Q_OS_LINUX
+
 template <typename Hash, typename Key>
 typename Hash::const_iterator
 find_last_in_equal_range(const Hash &c, const Key &key)
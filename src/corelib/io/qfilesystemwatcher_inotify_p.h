@@ -25,6 +25,8 @@ QT_REQUIRE_CONFIG(filesystemwatcher);
 
 QT_BEGIN_NAMESPACE
 
+class QFileSystemTreeWatcher;
+
 class QInotifyFileSystemWatcherEngine : public QFileSystemWatcherEngine
 {
     Q_OBJECT
@@ -36,6 +38,10 @@ public:
 
     QStringList addPaths(const QStringList &paths, QStringList *files, QStringList *directories) override;
     QStringList removePaths(const QStringList &paths, QStringList *files, QStringList *directories) override;
+#ifdef Q_OS_LINUX
+    QStringList addRecursivePaths(const QStringList &paths, QStringList *directories) override;
+    QStringList removeRecursivePaths(const QStringList &paths, QStringList *directories) override;
+#endif
 
 private Q_SLOTS:
     void readFromInotify();
@@ -49,6 +55,9 @@ private:
     QHash<QString, int> pathToID;
     QMultiHash<int, QString> idToPath;
     QSocketNotifier notifier;
+#ifdef Q_OS_LINUX
+    QHash<QString, QFileSystemTreeWatcher *> trees;
+#endif
 };
 
 
@@ -0,0 +1,502 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qfilesystemwatcher_linux_p.h"
+
+#include "private/qcore_unix_p.h"
+
+#include <qfile.h>
+#include <qloggingcategory.h>
+#include <qscopeguard.h>
+#include <qset.h>
+#include <qvarlengtharray.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __has_include(<sys/fanotify.h>)
+#  include <sys/fanotify.h>
+#endif
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+Q_DECLARE_LOGGING_CATEGORY(lcWatcher)
+
+QFileSystemTreeWatcher::QFileSystemTreeWatcher(int fd, const QString &root, QObject *parent)
+    : QObject(parent),
+      fd(fd),
+      rootPath(root),
+      notifier(fd, QSocketNotifier::Read, this)
+{
+}
+
+QFileSystemTreeWatcher::~QFileSystemTreeWatcher()
+{
+    notifier.setEnabled(false);
+    qt_safe_close(fd);
+}
+
+QFileSystemTreeWatcher *QFileSystemTreeWatcher::create(const QString &root, QObject *parent)
+{
+    if (!qEnvironmentVariableIsSet("QT_NO_FANOTIFY")) {
+        if (QFileSystemTreeWatcher *watcher = QFanotifyTreeWatcher::create(root, parent)) {
+            qCDebug(lcWatcher) << "watching" << root << "with fanotify";
+            return watcher;
+        }
+    }
+    if (QFileSystemTreeWatcher *watcher = QInotifyTreeWatcher::create(root, parent)) {
+        qCDebug(lcWatcher) << "watching" << root << "with inotify";
+        return watcher;
+    }
+    return nullptr;
+}
+
+//
+// fanotify
+//
+
+#ifdef FAN_REPORT_DFID_NAME
+static constexpr uint64_t FanotifyMask = FAN_ATTRIB | FAN_CREATE | FAN_DELETE | FAN_MOVE
+        | FAN_DELETE_SELF | FAN_MOVE_SELF | FAN_ONDIR;
+
+// a file handle can be stored in a QByteArray, but must be copied to be used
+union FileHandleBuffer
+{
+    file_handle handle;
+    char data[sizeof(file_handle) + MAX_HANDLE_SZ];
+};
+
+static QString pathOfFileDescriptor(int fd)
+{
+    char link[PATH_MAX];
+    const QByteArray proc = "/proc/self/fd/" + QByteArray::number(fd);
+    const ssize_t len = ::readlink(proc.constData(), link, sizeof(link));
+    if (len <= 0 || size_t(len) == sizeof(link))
+        return QString();
+    return QFile::decodeName(QByteArray(link, len));
+}
+#endif
+
+QFanotifyTreeWatcher *QFanotifyTreeWatcher::create(const QString &root, QObject *parent)
+{
+#ifdef FAN_REPORT_DFID_NAME
+    // fails on kernels before 5.9, and without CAP_SYS_ADMIN before 5.13
+    const int fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK
+                                 | FAN_REPORT_DFID_NAME, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    auto fdGuard = qScopeGuard([fd] { qt_safe_close(fd); });
+
+    // also used to resolve the handles, for which O_PATH does not suffice
+    const QByteArray encodedRoot = QFile::encodeName(root);
+    const int rootFd = qt_safe_open(encodedRoot.constData(), O_RDONLY | O_DIRECTORY);
+    if (rootFd < 0)
+        return nullptr;
+    auto rootFdGuard = qScopeGuard([rootFd] { qt_safe_close(rootFd); });
+
+    FileHandleBuffer buffer;
+    buffer.handle.handle_bytes = MAX_HANDLE_SZ;
+    int mountId;
+    if (name_to_handle_at(rootFd, "", &buffer.handle, &mountId, AT_EMPTY_PATH) != 0)
+        return nullptr;
+    const QByteArray rootHandle(buffer.data, sizeof(file_handle) + buffer.handle.handle_bytes);
+    buffer.handle.handle_bytes = MAX_HANDLE_SZ;
+    if (name_to_handle_at(rootFd, "..", &buffer.handle, &mountId, 0) != 0)
+        return nullptr;
+    const QByteArray parentHandle(buffer.data, sizeof(file_handle) + buffer.handle.handle_bytes);
+
+    // resolving the handles of the events needs CAP_DAC_READ_SEARCH, and
+    // marking a whole file system needs CAP_SYS_ADMIN
+    const int handleFd = open_by_handle_at(rootFd, &buffer.handle, O_PATH | O_CLOEXEC);
+    if (handleFd < 0)
+        return nullptr;
+    qt_safe_close(handleFd);
+    if (fanotify_mark(fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FanotifyMask, AT_FDCWD,
+                      encodedRoot.constData()) != 0) {
+        return nullptr;
+    }
+
+    const QString canonicalRoot = pathOfFileDescriptor(rootFd);
+    if (canonicalRoot.isEmpty())
+        return nullptr;
+
+    fdGuard.dismiss();
+    rootFdGuard.dismiss();
+    return new QFanotifyTreeWatcher(fd, rootFd, root, canonicalRoot, rootHandle, parentHandle,
+                                    parent);
+#else
+    Q_UNUSED(root);
+    Q_UNUSED(parent);
+    return nullptr;
+#endif
+}
+
+QFanotifyTreeWatcher::QFanotifyTreeWatcher(int fd, int rootFd, const QString &root,
+                                           const QString &canonicalRoot,
+                                           const QByteArray &rootHandle,
+                                           const QByteArray &parentHandle, QObject *parent)
+    : QFileSystemTreeWatcher(fd, root, parent),
+      rootFd(rootFd),
+      canonicalRoot(canonicalRoot),
+      rootName(QFile::encodeName(canonicalRoot.mid(canonicalRoot.lastIndexOf(u'/') + 1))),
+      rootHandle(rootHandle),
+      parentHandle(parentHandle)
+{
+    connect(&notifier, &QSocketNotifier::activated, this, &QFanotifyTreeWatcher::readFromFanotify);
+}
+
+QFanotifyTreeWatcher::~QFanotifyTreeWatcher()
+{
+    qt_safe_close(rootFd);
+}
+
+QString QFanotifyTreeWatcher::pathFromHandle(const QByteArray &handle) const
+{
+#ifdef FAN_REPORT_DFID_NAME
+    FileHandleBuffer buffer;
+    if (size_t(handle.size()) > sizeof(buffer))
+        return QString();
+    memcpy(buffer.data, handle.constData(), handle.size());
+    const int handleFd = open_by_handle_at(rootFd, &buffer.handle, O_PATH | O_CLOEXEC);
+    if (handleFd < 0)
+        return QString();   // deleted in the meantime
+    const QString path = pathOfFileDescriptor(handleFd);
+    qt_safe_close(handleFd);
+    return path;
+#else
+    Q_UNUSED(handle);
+    return QString();
+#endif
+}
+
+void QFanotifyTreeWatcher::readFromFanotify()
+{
+#ifdef FAN_REPORT_DFID_NAME
+    // the handles of the directories whose entries (or which themselves)
+    // changed, in the order they were first reported
+    QList<QByteArray> handles;
+    QSet<QByteArray> seenHandles;
+    bool overflow = false;
+    bool removed = false;
+
+    alignas(fanotify_event_metadata) char buffer[16384];
+    for (;;) {
+        ssize_t len = qt_safe_read(fd, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
+        const auto *event = reinterpret_cast<const fanotify_event_metadata *>(buffer);
+        for (; FAN_EVENT_OK(event, len); event = FAN_EVENT_NEXT(event, len)) {
+            if (event->vers != FANOTIFY_METADATA_VERSION)
+                return;
+            if (event->mask & FAN_Q_OVERFLOW) {
+                overflow = true;
+                continue;
+            }
+
+            const char *info = reinterpret_cast<const char *>(event) + event->metadata_len;
+            const char *end = reinterpret_cast<const char *>(event) + event->event_len;
+            while (info + sizeof(fanotify_event_info_header) <= end) {
+                const auto *header = reinterpret_cast<const fanotify_event_info_header *>(info);
+                if (header->len == 0)
+                    break;
+                if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME
+                        || header->info_type == FAN_EVENT_INFO_TYPE_DFID) {
+                    const auto *fid = reinterpret_cast<const fanotify_event_info_fid *>(info);
+                    const auto *handle = reinterpret_cast<const file_handle *>(fid->handle);
+                    const QByteArray key(reinterpret_cast<const char *>(handle),
+                                         sizeof(file_handle) + handle->handle_bytes);
+                    if (key == rootHandle && (event->mask & (FAN_DELETE_SELF | FAN_MOVE_SELF))) {
+                        removed = true;
+                    } else if (key == parentHandle && (event->mask & FAN_DELETE)
+                               && header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) {
+                        // FAN_DELETE_SELF only comes once the root is no longer
+                        // open, but it is open as rootFd
+                        const char *name = reinterpret_cast<const char *>(handle->f_handle)
+                                + handle->handle_bytes;
+                        QT_STATBUF statBuffer;
+                        if (rootName == name && QT_FSTAT(rootFd, &statBuffer) == 0
+                                && statBuffer.st_nlink == 0) {
+                            removed = true;
+                        }
+                    } else if (!seenHandles.contains(key)) {
+                        handles.append(*seenHandles.insert(key));
+                    }
+                    break;
+                }
+                info += header->len;
+            }
+        }
+    }
+
+    if (removed) {
+        notifier.setEnabled(false);
+        emit rootRemoved();
+        return;
+    }
+
+    // the file system mark reports changes anywhere on the file system
+    const bool rootIsFileSystemRoot = canonicalRoot == u'/';
+    QStringList paths;
+    if (overflow)
+        paths.append(rootPath);
+    for (const QByteArray &handle : std::as_const(handles)) {
+        const QString path = pathFromHandle(handle);
+        if (path == canonicalRoot) {
+            if (!overflow)
+                paths.append(rootPath);
+            continue;
+        }
+        if (!path.startsWith(canonicalRoot))
+            continue;
+        QStringView relative = QStringView(path).mid(canonicalRoot.size());
+        if (!rootIsFileSystemRoot) {
+            if (!relative.startsWith(u'/'))
+                continue;
+            if (rootPath.endsWith(u'/'))
+                relative = relative.mid(1);
+        }
+        paths.append(rootPath + relative);
+    }
+    if (!paths.isEmpty())
+        emit directoriesChanged(paths);
+#endif
+}
+
+//
+// inotify
+//
+
+static constexpr uint32_t InotifyMask = IN_ATTRIB | IN_MOVE | IN_CREATE | IN_DELETE
+        | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+static QByteArray appendPath(const QByteArray &directory, const QByteArray &name)
+{
+    if (directory.endsWith('/'))
+        return directory + name;
+    return directory + '/' + name;
+}
+
+QInotifyTreeWatcher *QInotifyTreeWatcher::create(const QString &root, QObject *parent)
+{
+    const int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (fd < 0)
+        return nullptr;
+
+    auto watcher = new QInotifyTreeWatcher(fd, root, parent);
+    if (!watcher->addTree(-1, QFile::encodeName(root))) {
+        delete watcher;
+        return nullptr;
+    }
+    return watcher;
+}
+
+QInotifyTreeWatcher::QInotifyTreeWatcher(int fd, const QString &root, QObject *parent)
+    : QFileSystemTreeWatcher(fd, root, parent)
+{
+    connect(&notifier, &QSocketNotifier::activated, this, &QInotifyTreeWatcher::readFromInotify);
+}
+
+/*
+    Watches the directory \a name in the directory \a parent (or the root,
+    if \a parent is -1) and everything below it. Directories that are
+    already watched in the same place are rescanned for new subdirectories.
+    Returns false if the root could not be watched or the user's limit of
+    inotify watches was reached.
+*/
+bool QInotifyTreeWatcher::addTree(int parent, const QByteArray &name)
+{
+    struct Directory
+    {
+        int parent;
+        QByteArray name;
+        QByteArray path;
+    };
+    std::vector<Directory> stack;
+    stack.push_back({ parent, name, parent < 0 ? name : appendPath(pathOf(parent), name) });
+
+    while (!stack.empty()) {
+        const Directory directory = std::move(stack.back());
+        stack.pop_back();
+
+        // don't follow symbolic links below the root
+        const uint32_t mask = directory.parent < 0 ? InotifyMask : InotifyMask | IN_DONT_FOLLOW;
+        const int wd = inotify_add_watch(fd, directory.path.constData(), mask);
+        if (wd < 0) {
+            if (errno != ENOENT && errno != ENOTDIR)
+                qErrnoWarning("inotify_add_watch(%s) failed:", directory.path.constData());
+            if (errno == ENOSPC || directory.parent < 0)
+                return false;
+            continue;   // removed in the meantime
+        }
+
+        const auto it = nodes.constFind(wd);
+        if (it != nodes.cend()) {
+            // already watched; skip it if it was reached through another
+            // path, such as a bind mount
+            if (it->parent != directory.parent || it->name != directory.name)
+                continue;
+        } else {
+            nodes.insert(wd, Node{ directory.parent, directory.name, {} });
+            if (directory.parent < 0)
+                rootWd = wd;
+            else
+                nodes[directory.parent].children.insert(directory.name, wd);
+        }
+
+        // list the subdirectories only now that the directory is watched, so
+        // that none created in the meantime are missed
+        DIR *dir = ::opendir(directory.path.constData());
+        if (!dir)
+            continue;
+        while (const dirent *entry = ::readdir(dir)) {
+            const char *entryName = entry->d_name;
+            if (entryName[0] == '.' && (entryName[1] == '\0'
+                                        || (entryName[1] == '.' && entryName[2] == '\0'))) {
+                continue;
+            }
+            bool isDirectory = entry->d_type == DT_DIR;
+            if (entry->d_type == DT_UNKNOWN) {
+                struct stat statBuffer;
+                isDirectory = ::fstatat(dirfd(dir), entryName, &statBuffer, AT_SYMLINK_NOFOLLOW) == 0
+                        && S_ISDIR(statBuffer.st_mode);
+            }
+            if (isDirectory) {
+                const QByteArray childName(entryName);
+                stack.push_back({ wd, childName, appendPath(directory.path, childName) });
+            }
+        }
+        ::closedir(dir);
+    }
+    return true;
+}
+
+// stops watching the directory \a wd and everything below it
+void QInotifyTreeWatcher::removeTree(int wd)
+{
+    QVarLengthArray<int, 64> stack;
+    stack.append(wd);
+    while (!stack.isEmpty()) {
+        const int current = stack.last();
+        stack.removeLast();
+        const auto it = nodes.constFind(current);
+        if (it == nodes.cend())
+            continue;
+        for (int child : it->children)
+            stack.append(child);
+        inotify_rm_watch(fd, current);
+        nodes.erase(it);
+    }
+}
+
+QByteArray QInotifyTreeWatcher::pathOf(int wd) const
+{
+    QVarLengthArray<const QByteArray *, 32> names;
+    for (auto it = nodes.constFind(wd); it != nodes.cend(); it = nodes.constFind(it->parent))
+        names.append(&it->name);
+
+    QByteArray path;
+    for (qsizetype i = names.size() - 1; i >= 0; --i)
+        path = path.isEmpty() ? *names.at(i) : appendPath(path, *names.at(i));
+    return path;
+}
+
+void QInotifyTreeWatcher::readFromInotify()
+{
+    QStringList paths;
+    QSet<int> changed;
+    const auto markChanged = [&](int wd) {
+        if (!changed.contains(wd)) {
+            changed.insert(wd);
+            paths.append(QFile::decodeName(pathOf(wd)));
+        }
+    };
+    QHash<uint32_t, int> movedFrom;     // cookie -> directory
+    bool removed = false;
+
+    alignas(inotify_event) char buffer[16384];
+    while (!removed) {
+        const qint64 len = qt_safe_read(fd, buffer, sizeof(buffer));
+        if (len <= 0)
+            break;
+        for (const char *at = buffer; at < buffer + len; ) {
+            const auto *event = reinterpret_cast<const inotify_event *>(at);
+            at += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events were lost: look for new subdirectories, and let the
+                // user rescan the whole tree
+                addTree(-1, nodes.value(rootWd).name);
+                markChanged(rootWd);
+                continue;
+            }
+            if (!nodes.contains(event->wd))
+                continue;   // no longer watched
+
+            if (event->wd == rootWd
+                    && (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT | IN_IGNORED))) {
+                removed = true;
+                break;
+            }
+            if (event->mask & IN_IGNORED) {
+                // the directory was deleted or its file system unmounted
+                const Node node = nodes.value(event->wd);
+                auto parent = nodes.find(node.parent);
+                if (parent != nodes.end() && parent->children.value(node.name) == event->wd)
+                    parent->children.remove(node.name);
+                removeTree(event->wd);
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                continue;   // reported as a change of the parent
+
+            markChanged(event->wd);
+            if (event->len == 0 || !(event->mask & IN_ISDIR))
+                continue;
+
+            const QByteArray name(event->name);
+            if (event->mask & IN_MOVED_FROM) {
+                const int child = nodes[event->wd].children.take(name);
+                if (child > 0)
+                    movedFrom.insert(event->cookie, child);
+            } else if (event->mask & IN_MOVED_TO) {
+                const int child = movedFrom.take(event->cookie);
+                if (child > 0) {
+                    // moved within the tree: the watches below it stay valid
+                    Node &node = nodes[child];
+                    node.parent = event->wd;
+                    node.name = name;
+                    nodes[event->wd].children.insert(name, child);
+                } else {
+                    addTree(event->wd, name);
+                }
+            } else if (event->mask & IN_CREATE) {
+                addTree(event->wd, name);
+            } else if (event->mask & IN_DELETE) {
+                // the watch itself goes away with IN_IGNORED
+                nodes[event->wd].children.remove(name);
+            }
+        }
+    }
+
+    // directories moved out of the tree
+    for (int child : std::as_const(movedFrom))
+        removeTree(child);
+
+    if (removed) {
+        notifier.setEnabled(false);
+        emit rootRemoved();
+        return;
+    }
+    if (!paths.isEmpty())
+        emit directoriesChanged(paths);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qfilesystemwatcher_linux_p.cpp"
@@ -0,0 +1,123 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFILESYSTEMWATCHER_LINUX_P_H
+#define QFILESYSTEMWATCHER_LINUX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+
+QT_REQUIRE_CONFIG(filesystemwatcher);
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+
+// Watches a whole directory tree, including the directories created in it
+// later. directoriesChanged() reports the directories whose entries
+// changed, collected per batch of kernel events; rootRemoved() is emitted
+// when the root itself is deleted or moved, after which the watcher is
+// inactive.
+class QFileSystemTreeWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    // uses fanotify if the process is allowed to, and an inotify watch
+    // per directory otherwise
+    static QFileSystemTreeWatcher *create(const QString &root, QObject *parent);
+    ~QFileSystemTreeWatcher();
+
+    QString root() const { return rootPath; }
+
+Q_SIGNALS:
+    void directoriesChanged(const QStringList &paths);
+    void rootRemoved();
+
+protected:
+    QFileSystemTreeWatcher(int fd, const QString &root, QObject *parent);
+
+    const int fd;
+    const QString rootPath;
+    QSocketNotifier notifier;
+};
+
+// Marks the whole file system of the root with fanotify, which needs no
+// per-directory state; the changed directories are reported as file
+// handles and resolved to paths, and those outside of the root are
+// ignored. Needs CAP_SYS_ADMIN and CAP_DAC_READ_SEARCH, and does not see
+// the file systems mounted below the root.
+class QFanotifyTreeWatcher : public QFileSystemTreeWatcher
+{
+    Q_OBJECT
+
+public:
+    ~QFanotifyTreeWatcher();
+
+    static QFanotifyTreeWatcher *create(const QString &root, QObject *parent);
+
+private Q_SLOTS:
+    void readFromFanotify();
+
+private:
+    QFanotifyTreeWatcher(int fd, int rootFd, const QString &root, const QString &canonicalRoot,
+                         const QByteArray &rootHandle, const QByteArray &parentHandle,
+                         QObject *parent);
+    QString pathFromHandle(const QByteArray &handle) const;
+
+    const int rootFd;
+    const QString canonicalRoot;
+    const QByteArray rootName;
+    // the file handles of the root and of the directory containing it
+    const QByteArray rootHandle;
+    const QByteArray parentHandle;
+};
+
+// Keeps an inotify watch on every directory of the tree, adding and
+// removing watches as directories are created, deleted or moved. The
+// directories are stored as a tree of names, so that renaming a directory
+// only updates one node.
+class QInotifyTreeWatcher : public QFileSystemTreeWatcher
+{
+    Q_OBJECT
+
+public:
+    static QInotifyTreeWatcher *create(const QString &root, QObject *parent);
+
+private Q_SLOTS:
+    void readFromInotify();
+
+private:
+    struct Node
+    {
+        int parent;                         // -1 for the root
+        QByteArray name;                    // the encoded root path for the root
+        QHash<QByteArray, int> children;    // name -> watch descriptor
+    };
+
+    QInotifyTreeWatcher(int fd, const QString &root, QObject *parent);
+    bool addTree(int parent, const QByteArray &name);
+    void removeTree(int wd);
+    QByteArray pathOf(int wd) const;
+
+    int rootWd = -1;
+    QHash<int, Node> nodes;     // watch descriptor -> directory
+};
+
+QT_END_NAMESPACE
+
+#endif // QFILESYSTEMWATCHER_LINUX_P_H
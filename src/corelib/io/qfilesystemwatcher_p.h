@@ -23,9 +23,12 @@ QT_REQUIRE_CONFIG(filesystemwatcher);
 
 #include <QtCore/qstringlist.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qset.h>
 
 QT_BEGIN_NAMESPACE
 
+class QTimer;
+
 class QFileSystemWatcherEngine : public QObject
 {
     Q_OBJECT
@@ -48,10 +51,28 @@ public:
     virtual QStringList removePaths(const QStringList &paths,
                                     QStringList *files,
                                     QStringList *directories) = 0;
+    // watches the directory trees at \a paths, including subdirectories
+    // created later, fills \a directories with the roots it could watch,
+    // and returns the others; engines that cannot watch trees watch none
+    virtual QStringList addRecursivePaths(const QStringList &paths, QStringList *directories)
+    {
+        Q_UNUSED(directories);
+        return paths;
+    }
+    // stops watching the trees at \a paths, removes them from \a
+    // directories, and returns the paths that were not watched as trees
+    virtual QStringList removeRecursivePaths(const QStringList &paths, QStringList *directories)
+    {
+        Q_UNUSED(directories);
+        return paths;
+    }
 
 Q_SIGNALS:
     void fileChanged(const QString &path, bool removed);
     void directoryChanged(const QString &path, bool removed);
+    // the directories in a watched tree whose entries changed; the removal
+    // of a tree's root is reported with directoryChanged()
+    void directoriesChanged(const QStringList &paths);
 };
 
 class QFileSystemWatcherPrivate : public QObjectPrivate
@@ -66,11 +87,20 @@ public:
     void initPollerEngine();
 
     QFileSystemWatcherEngine *native, *poller;
-    QStringList files, directories;
+    QStringList files, directories, recursiveDirectories;
+
+    // the changes in recursively watched trees are collected for a while
+    // and emitted as one batch
+    QStringList changedDirectories;
+    QSet<QString> changedDirectorySet;
+    QTimer *batchTimer = nullptr;
+    bool isInRecursiveDirectory(const QString &path) const;
+    void emitChangedDirectories();
 
     // private slots
     void _q_fileChanged(const QString &path, bool removed);
     void _q_directoryChanged(const QString &path, bool removed);
+    void _q_directoriesChanged(const QStringList &paths);
 
 #if defined(Q_OS_WIN)
     void _q_winDriveLockForRemoval(const QString &);
@@ -1698,6 +1698,11 @@ std::function<void(void)> QProcess::childProcessModifier() const
     only make use of low-level system calls, such as \c{read()},
     \c{write()}, \c{setsid()}, \c{nice()}, and similar.
 
+    \note Without the UnixProcessParameters::UseVFork flag, QProcess starts
+    the child process with \c{fork()} whenever a modifier is set. Unlike
+    \c{vfork()}, whose cost does not depend on the memory used by the
+    parent process, \c{fork()} gets slower as the parent process grows.
+
     \sa childProcessModifier(), failChildProcessModifier(), setUnixProcessParameters()
 */
 void QProcess::setChildProcessModifier(const std::function<void(void)> &modifier)
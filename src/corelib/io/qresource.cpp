@@ -15,6 +15,8 @@
 #include "qbytearray.h"
 #include "qstringlist.h"
 #include "qendian.h"
+#include "qcache.h"
+#include "qmutex.h"
 #include <qshareddata.h>
 #include <qplatformdefs.h>
 #include <qendian.h>
@@ -107,17 +109,26 @@ public:
 
 private:
     const uchar *tree, *names, *payloads;
+    const uchar *pathIndex; // version 4 and up
+    const uchar *dictionary; // the zstd dictionary, version 4 and up
     int version;
     inline int findOffset(int node) const { return node * (14 + (version >= 0x02 ? 8 : 0)); } //sizeof each tree element
     uint hash(int node) const;
     QString name(int node) const;
+    bool nameEquals(int node, QStringView name) const;
     short flags(int node) const;
+    int findIndexedNode(QStringView path, const QLocale &locale) const;
+#if QT_CONFIG(zstd)
+    mutable QAtomicPointer<ZSTD_DDict> zstdDDict = nullptr;
+#endif
 public:
     mutable QAtomicInt ref;
 
-    inline QResourceRoot(): tree(nullptr), names(nullptr), payloads(nullptr), version(0) {}
+    inline QResourceRoot()
+        : tree(nullptr), names(nullptr), payloads(nullptr), pathIndex(nullptr),
+          dictionary(nullptr), version(0) {}
     inline QResourceRoot(int version, const uchar *t, const uchar *n, const uchar *d) { setSource(version, t, n, d); }
-    virtual ~QResourceRoot() { }
+    virtual ~QResourceRoot();
     int findNode(const QString &path, const QLocale &locale=QLocale()) const;
     inline bool isContainer(int node) const { return flags(node) & Directory; }
     QResource::Compression compressionAlgo(int node)
@@ -132,6 +143,9 @@ public:
     const uchar *data(int node, qint64 *size) const;
     quint64 lastModified(int node) const;
     QStringList children(int node) const;
+#if QT_CONFIG(zstd)
+    const ZSTD_DDict *zstdDictionary() const;
+#endif
     virtual QString mappingRoot() const { return QString(); }
     bool mappingRootSubdir(const QString &path, QString *match = nullptr) const;
     inline bool operator==(const QResourceRoot &other) const
@@ -143,6 +157,19 @@ public:
 
 protected:
     inline void setSource(int v, const uchar *t, const uchar *n, const uchar *d) {
+        pathIndex = nullptr;
+        dictionary = nullptr;
+        if (v >= 0x04) {
+            // the lookup index precedes the nodes, see rcc.cpp
+            pathIndex = t;
+            const quint32 nodeCount = qFromBigEndian<quint32>(t);
+            const quint32 bucketCount = qFromBigEndian<quint32>(t + 4);
+            const quint32 slotCount = qFromBigEndian<quint32>(t + 8);
+            const quint32 dictionaryOffset = qFromBigEndian<quint32>(t + 12);
+            if (dictionaryOffset != 0xffffffffu)
+                dictionary = d + dictionaryOffset;
+            t += 4 * (4 + qsizetype(bucketCount) + slotCount + nodeCount);
+        }
         tree = t;
         names = n;
         payloads = d;
@@ -170,6 +197,32 @@ struct QResourceGlobalData
 };
 Q_GLOBAL_STATIC(QResourceGlobalData, resourceGlobalData)
 
+// The decompressed contents of the resources, shared by all QResource and
+// QFile objects using them. The cost is in KiB.
+struct QResourceDecompressedCache
+{
+    using Key = std::pair<const QResourceRoot *, const uchar *>;
+    QMutex mutex;
+    QCache<Key, QByteArray> cache{16 * 1024};
+};
+Q_GLOBAL_STATIC(QResourceDecompressedCache, decompressedCache)
+
+QResourceRoot::~QResourceRoot()
+{
+#if QT_CONFIG(zstd)
+    ZSTD_freeDDict(zstdDDict.loadRelaxed());
+#endif
+    if (!decompressedCache.exists())
+        return;
+    QResourceDecompressedCache *d = decompressedCache();
+    const auto locker = qt_scoped_lock(d->mutex);
+    const QList<QResourceDecompressedCache::Key> keys = d->cache.keys();
+    for (const QResourceDecompressedCache::Key &key : keys) {
+        if (key.first == this)
+            d->cache.remove(key);
+    }
+}
+
 static inline QRecursiveMutex &resourceMutex()
 { return resourceGlobalData->resourceMutex; }
 
@@ -423,6 +476,21 @@ qint64 QResourcePrivate::uncompressedSize() const
     return -1;
 }
 
+#if QT_CONFIG(zstd)
+// one decompression context per thread, instead of allocating one for each
+// resource
+static ZSTD_DCtx *zstdDecompressionContext()
+{
+    struct Context
+    {
+        ZSTD_DCtx *context = ZSTD_createDCtx();
+        ~Context() { ZSTD_freeDCtx(context); }
+    };
+    static thread_local Context context;
+    return context.context;
+}
+#endif
+
 qsizetype QResourcePrivate::decompress(char *buffer, qsizetype bufferSize) const
 {
     Q_ASSERT(data);
@@ -453,7 +521,15 @@ qsizetype QResourcePrivate::decompress(char *buffer, qsizetype bufferSize) const
 
     case QResource::ZstdCompression: {
 #if QT_CONFIG(zstd)
-        size_t usize = ZSTD_decompress(buffer, bufferSize, data, size);
+        // frames with a dictionary ID were compressed with the one of the
+        // resource file
+        const ZSTD_DDict *dictionary = nullptr;
+        if (ZSTD_getDictID_fromFrame(data, size) != 0 && !related.isEmpty())
+            dictionary = related.constFirst()->zstdDictionary();
+        ZSTD_DCtx *context = zstdDecompressionContext();
+        size_t usize = dictionary
+                ? ZSTD_decompress_usingDDict(context, buffer, bufferSize, data, size, dictionary)
+                : ZSTD_decompressDCtx(context, buffer, bufferSize, data, size);
         if (ZSTD_isError(usize)) {
             qWarning("QResource: error decompressing zstd content: %s", ZSTD_getErrorName(usize));
             return -1;
@@ -660,8 +736,10 @@ const uchar *QResource::data() const
     compressed. If the resource is a directory or an error occurs while
     decompressing, a null QByteArray is returned.
 
-    \note If the data was compressed, this function will decompress every time
-    it is called. The result is not cached between calls.
+    \note If the data was compressed, the result is kept in a cache shared by
+    the whole application (of at most 16 MB), so that calling this function
+    again, or reading the resource with QFile, does not need to decompress
+    it again while it is in the cache.
 
     \sa uncompressedSize(), size(), compressionAlgorithm(), isFile()
 */
@@ -679,13 +757,23 @@ QByteArray QResource::uncompressedData() const
     if (d->compressionAlgo == NoCompression)
         return QByteArray::fromRawData(reinterpret_cast<const char *>(d->data), n);
 
-    // decompress
+    QResourceDecompressedCache *cache = decompressedCache();
+    const QResourceDecompressedCache::Key key(d->related.constFirst(), d->data);
+    {
+        const auto locker = qt_scoped_lock(cache->mutex);
+        if (const QByteArray *cached = cache->cache.object(key))
+            return *cached;
+    }
+
+    // decompress, without holding the lock
     QByteArray result(n, Qt::Uninitialized);
     n = d->decompress(result.data(), n);
     if (n < 0)
-        result.clear();
-    else
-        result.truncate(n);
+        return QByteArray();
+    result.truncate(n);
+
+    const auto locker = qt_scoped_lock(cache->mutex);
+    cache->cache.insert(key, new QByteArray(result), qMax(qsizetype(1), result.size() / 1024));
     return result;
 }
 
@@ -757,6 +845,121 @@ inline QString QResourceRoot::name(int node) const
     return ret;
 }
 
+inline bool QResourceRoot::nameEquals(int node, QStringView name) const
+{
+    if (!node) // root
+        return name.isEmpty();
+    const int offset = findOffset(node);
+
+    qint32 name_offset = qFromBigEndian<qint32>(tree + offset);
+    const quint16 name_length = qFromBigEndian<qint16>(names + name_offset);
+    if (name_length != name.size())
+        return false;
+    name_offset += 2;
+    name_offset += 4; // jump past hash
+
+    const uchar *unicode = names + name_offset;
+    for (qsizetype i = 0; i < name.size(); ++i) {
+        if (qFromBigEndian<char16_t>(unicode + 2 * i) != name[i].unicode())
+            return false;
+    }
+    return true;
+}
+
+// Must match rcc.cpp
+static quint64 resourcePathHash(QStringView path)
+{
+    quint64 h = Q_UINT64_C(14695981039346656037);
+    for (QChar c : path) {
+        h ^= c.unicode();
+        h *= Q_UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+static quint32 resourcePathSlot(quint64 hash, quint32 displacement, quint32 slotCount)
+{
+    quint64 h = hash ^ (displacement * Q_UINT64_C(0x9e3779b97f4a7c15));
+    h = (h ^ (h >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    h = (h ^ (h >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    h ^= h >> 31;
+    return quint32(h % slotCount);
+}
+
+/*
+    Looks \a path up in the perfect hash index of format version 4, which
+    finds the only candidate node in constant time. The candidate is then
+    verified by comparing its name and the names of its parents with the
+    segments of \a path, and the localized variants that follow it are
+    considered like in the tree walk of findNode().
+*/
+int QResourceRoot::findIndexedNode(QStringView path, const QLocale &locale) const
+{
+    const quint32 nodeCount = qFromBigEndian<quint32>(pathIndex);
+    const quint32 bucketCount = qFromBigEndian<quint32>(pathIndex + 4);
+    const quint32 slotCount = qFromBigEndian<quint32>(pathIndex + 8);
+    const uchar *displacements = pathIndex + 16;
+    const uchar *slotNodes = displacements + 4 * qsizetype(bucketCount);
+    const uchar *parents = slotNodes + 4 * qsizetype(slotCount);
+
+    const quint64 h = resourcePathHash(path);
+    const quint32 displacement = qFromBigEndian<quint32>(displacements + 4 * (h % bucketCount));
+    const quint32 slot = resourcePathSlot(h, displacement, slotCount);
+    const quint32 candidate = qFromBigEndian<quint32>(slotNodes + 4 * qsizetype(slot));
+    if (candidate == 0 || candidate >= nodeCount)
+        return -1;
+
+    // compare the path from its end, up to the root
+    qsizetype end = path.size();
+    quint32 parent = 0;
+    for (quint32 node = candidate; node != 0;) {
+        const quint32 up = qFromBigEndian<quint32>(parents + 4 * qsizetype(node));
+        if (node == candidate)
+            parent = up;
+        if (end == 0)
+            return -1;
+        const qsizetype start = path.lastIndexOf(u'/', end - 1) + 1;
+        if (start == 0 || up >= node || !nameEquals(node, path.sliced(start, end - start)))
+            return -1;
+        end = start - 1;
+        node = up;
+    }
+    if (end != 0)
+        return -1;
+
+    if (isContainer(candidate))
+        return candidate;
+
+    // the localized variants of a file are its siblings of the same name
+    int offset = findOffset(parent) + 6; // jump past name and flags
+    const qint32 child_count = qFromBigEndian<qint32>(tree + offset);
+    const qint32 child = qFromBigEndian<qint32>(tree + offset + 4);
+    const QStringView fileName = path.sliced(path.lastIndexOf(u'/') + 1);
+    const uint nameHash = hash(candidate);
+    int node = -1;
+    for (int sub_node = candidate; sub_node < child + child_count && hash(sub_node) == nameHash;
+         ++sub_node) {
+        if (!nameEquals(sub_node, fileName))
+            continue;
+        offset = findOffset(sub_node) + 4; // jump past name
+        if (qFromBigEndian<qint16>(tree + offset) & Directory)
+            return sub_node;
+        offset += 2;
+
+        const qint16 territory = qFromBigEndian<qint16>(tree + offset);
+        offset += 2;
+
+        const qint16 language = qFromBigEndian<qint16>(tree + offset);
+        if (territory == locale.territory() && language == locale.language())
+            return sub_node;
+        if ((territory == QLocale::AnyTerritory && language == locale.language())
+            || (territory == QLocale::AnyTerritory && language == QLocale::C && node == -1)) {
+            node = sub_node;
+        }
+    }
+    return node;
+}
+
 int QResourceRoot::findNode(const QString &_path, const QLocale &locale) const
 {
     QString path = _path;
@@ -782,6 +985,15 @@ int QResourceRoot::findNode(const QString &_path, const QLocale &locale) const
     if (path == "/"_L1)
         return 0;
 
+    if (pathIndex) {
+        QStringView view = path;
+        if (view.endsWith(u'/'))
+            view.chop(1);
+        // the index only knows the canonical form of the paths
+        if (view.startsWith(u'/') && !view.contains(u"//"))
+            return findIndexedNode(view, locale);
+    }
+
     // the root node is always first
     qint32 child_count = qFromBigEndian<qint32>(tree + 6);
     qint32 child       = qFromBigEndian<qint32>(tree + 10);
@@ -945,6 +1157,25 @@ QStringList QResourceRoot::children(int node) const
     }
     return ret;
 }
+#if QT_CONFIG(zstd)
+// The dictionary is only loaded when a file compressed with it is read.
+const ZSTD_DDict *QResourceRoot::zstdDictionary() const
+{
+    if (!dictionary)
+        return nullptr;
+    ZSTD_DDict *ddict = zstdDDict.loadAcquire();
+    if (!ddict) {
+        const quint32 size = qFromBigEndian<quint32>(dictionary);
+        ZSTD_DDict *created = ZSTD_createDDict(dictionary + 4, size);
+        if (zstdDDict.testAndSetOrdered(nullptr, created, ddict))
+            ddict = created;
+        else
+            ZSTD_freeDDict(created);
+    }
+    return ddict;
+}
+#endif
+
 bool QResourceRoot::mappingRootSubdir(const QString &path, QString *match) const
 {
     const QString root = mappingRoot();
@@ -975,7 +1206,7 @@ Q_CORE_EXPORT bool qRegisterResourceData(int version, const unsigned char *tree,
         return false;
     const auto locker = qt_scoped_lock(resourceMutex());
     ResourceList *list = resourceList();
-    if (version >= 0x01 && version <= 0x3) {
+    if (version >= 0x01 && version <= 0x4) {
         bool found = false;
         QResourceRoot res(version, tree, name, data);
         for (int i = 0; i < list->size(); ++i) {
@@ -1001,7 +1232,7 @@ Q_CORE_EXPORT bool qUnregisterResourceData(int version, const unsigned char *tre
         return false;
 
     const auto locker = qt_scoped_lock(resourceMutex());
-    if (version >= 0x01 && version <= 0x3) {
+    if (version >= 0x01 && version <= 0x4) {
         QResourceRoot res(version, tree, name, data);
         ResourceList *list = resourceList();
         for (int i = 0; i < list->size();) {
@@ -1081,7 +1312,7 @@ public:
         if (file_flags & ~acceptableFlags)
             return false;
 
-        if (version >= 0x01 && version <= 0x03) {
+        if (version >= 0x01 && version <= 0x04) {
             buffer = b;
             setSource(version, b + tree_offset, b + name_offset, b + data_offset);
             return true;
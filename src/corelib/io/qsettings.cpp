@@ -847,6 +847,31 @@ end:
     return isStringList;
 }
 
+void QSettingsPrivate::iniEscapedValue(const QVariant &value, QByteArray &result)
+{
+    /*
+        The size() != 1 trick is necessary because
+        QVariant(QString("foo")).toList() returns an empty
+        list, not a list containing "foo".
+    */
+    if (value.metaType().id() == QMetaType::QStringList
+            || (value.metaType().id() == QMetaType::QVariantList && value.toList().size() != 1)) {
+        iniEscapedStringList(variantListToStringList(value.toList()), result);
+    } else {
+        iniEscapedString(variantToString(value), result);
+    }
+}
+
+QVariant QSettingsPrivate::iniUnescapedValue(QByteArrayView value)
+{
+    QString stringResult;
+    QStringList stringListResult;
+    stringResult.reserve(value.size());
+    return iniUnescapedStringList(value, stringResult, stringListResult)
+            ? stringListToVariantList(stringListResult)
+            : stringToVariant(stringResult);
+}
+
 QStringList QSettingsPrivate::splitArgs(const QString &s, qsizetype idx)
 {
     qsizetype l = s.size();
@@ -1226,7 +1251,12 @@ std::optional<QVariant> QConfFileSettingsPrivate::get(const QString &key) const
             j = confFile->addedKeys.constFind(theKey);
             found = (j != confFile->addedKeys.constEnd());
         }
-        if (!found) {
+        if (!found && confFile->iniIndex) {
+            // removing keys drops the index
+            Q_ASSERT(confFile->removedKeys.isEmpty());
+            if (const auto value = confFile->iniIndex->value(theKey))
+                return iniUnescapedValue(*value);
+        } else if (!found) {
             ensureSectionParsed(confFile, theKey);
             j = confFile->originalKeys.constFind(theKey);
             found = (j != confFile->originalKeys.constEnd()
@@ -1391,6 +1421,7 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
     if (mustReadFile) {
         confFile->unparsedIniSections.clear();
         confFile->originalKeys.clear();
+        confFile->iniIndex.reset();
 
         QFile file(confFile->name);
         if (!createFile && !file.open(QFile::ReadOnly)) {
@@ -1418,8 +1449,29 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
             } else
 #endif
             if (format <= QSettings::IniFormat) {
-                QByteArray data = file.readAll();
-                ok = readIniFile(data, &confFile->unparsedIniSections);
+                // only reading benefits from the index, writing needs all keys
+                const bool useIndex = readOnly && usesIniIndex();
+                // the state of the file we opened, which a writer may have
+                // replaced since
+                const auto source = useIndex ? QSettingsIniIndex::sourceKey(file)
+                                             : QSettingsIniIndex::SourceKey();
+                if (source.isValid()) {
+                    auto index = std::make_unique<QSettingsIniIndex>();
+                    if (index->open(confFile->name, source))
+                        confFile->iniIndex = std::move(index);
+                }
+                if (confFile->iniIndex) {
+                    ok = true;
+                } else {
+                    QByteArray data = file.readAll();
+                    ok = readIniFile(data, &confFile->unparsedIniSections);
+                    // Don't index what we read if the file changed while we
+                    // read it, e.g. by a writer that doesn't replace it.
+                    if (ok && source.isValid() && source == QSettingsIniIndex::sourceKey(file)) {
+                        ensureAllSectionsParsed(confFile);
+                        writeIniIndex(confFile, source, confFile->originalKeys);
+                    }
+                }
             } else if (readFunc) {
                 QSettings::SettingsMap tempNewKeys;
                 ok = readFunc(file, tempNewKeys);
@@ -1450,6 +1502,8 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
         bool ok = false;
         ensureAllSectionsParsed(confFile);
         ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
+        const auto indexedSource = usesIniIndex() ? QSettingsIniIndex::sourceKey(confFile->name)
+                                                  : QSettingsIniIndex::SourceKey();
 
 #if !defined(QT_BOOTSTRAPPED) && QT_CONFIG(temporaryfile)
         QSaveFile sf(confFile->name);
@@ -1495,6 +1549,24 @@ void QConfFileSettingsPrivate::syncConfFile(QConfFile *confFile)
             ok = sf.commit();
 #endif
 
+        if (ok && usesIniIndex()) {
+            // the changes are appended to the index, unless it has to be rewritten
+            const auto source = QSettingsIniIndex::sourceKey(confFile->name);
+            QSettingsIniIndex::Changes changes;
+            changes.reserve(confFile->addedKeys.size() + confFile->removedKeys.size());
+            for (auto i = confFile->addedKeys.cbegin(); i != confFile->addedKeys.cend(); ++i) {
+                QByteArray value;
+                iniEscapedValue(i.value(), value);
+                changes.emplace_back(i.key(), std::move(value));
+            }
+            for (auto i = confFile->removedKeys.cbegin(); i != confFile->removedKeys.cend(); ++i)
+                changes.emplace_back(i.key(), std::nullopt);
+            if (!indexedSource.isValid()
+                    || !QSettingsIniIndex::append(confFile->name, indexedSource, source, changes)) {
+                writeIniIndex(confFile, source, mergedKeys);
+            }
+        }
+
         if (ok) {
             confFile->unparsedIniSections.clear();
             confFile->originalKeys = mergedKeys;
@@ -1686,7 +1758,6 @@ bool QConfFileSettingsPrivate::readIniFile(QByteArrayView data,
 bool QConfFileSettingsPrivate::readIniSection(const QSettingsKey &section, QByteArrayView data,
                                               ParsedSettingsMap *settingsMap)
 {
-    QStringList strListValue;
     bool sectionIsLowercase = (section == section.originalCaseKey());
     qsizetype equalsPos;
 
@@ -1718,11 +1789,7 @@ bool QConfFileSettingsPrivate::readIniSection(const QSettingsKey &section, QByte
                                            ? Qt::CaseSensitive
                                            : IniCaseSensitivity;
 
-        QString strValue;
-        strValue.reserve(value.size());
-        QVariant variant = iniUnescapedStringList(value, strValue, strListValue)
-                           ? stringListToVariantList(strListValue)
-                           : stringToVariant(strValue);
+        QVariant variant = iniUnescapedValue(value);
 
         /*
             We try to avoid the expensive toLower() call in
@@ -1835,20 +1902,7 @@ bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSetti
             QByteArray block;
             iniEscapedKey(j.key(), block);
             block += '=';
-
-            const QVariant &value = j.value();
-
-            /*
-                The size() != 1 trick is necessary because
-                QVariant(QString("foo")).toList() returns an empty
-                list, not a list containing "foo".
-            */
-            if (value.metaType().id() == QMetaType::QStringList
-                    || (value.metaType().id() == QMetaType::QVariantList && value.toList().size() != 1)) {
-                iniEscapedStringList(variantListToStringList(value.toList()), block);
-            } else {
-                iniEscapedString(variantToString(value), block);
-            }
+            iniEscapedValue(j.value(), block);
             block += eol;
             if (device.write(block) == -1) {
                 writeError = true;
@@ -1861,6 +1915,9 @@ bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSetti
 
 void QConfFileSettingsPrivate::ensureAllSectionsParsed(QConfFile *confFile) const
 {
+    if (confFile->iniIndex)
+        dropIniIndex(confFile);
+
     auto i = confFile->unparsedIniSections.constBegin();
     const auto end = confFile->unparsedIniSections.constEnd();
 
@@ -1874,6 +1931,8 @@ void QConfFileSettingsPrivate::ensureAllSectionsParsed(QConfFile *confFile) cons
 void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
                                                    const QSettingsKey &key) const
 {
+    if (confFile->iniIndex)
+        dropIniIndex(confFile);
     if (confFile->unparsedIniSections.isEmpty())
         return;
 
@@ -1898,6 +1957,47 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
     confFile->unparsedIniSections.erase(i);
 }
 
+bool QConfFileSettingsPrivate::usesIniIndex() const
+{
+#ifdef Q_OS_DARWIN
+    if (format == QSettings::NativeFormat)
+        return false;
+#endif
+    return format <= QSettings::IniFormat && QSettingsIniIndex::isEnabled();
+}
+
+/*
+    Replaces the index of the INI file by the file's sections, for the
+    operations that need more than looking keys up, like listing or
+    removing them.
+*/
+void QConfFileSettingsPrivate::dropIniIndex(QConfFile *confFile) const
+{
+    confFile->iniIndex.reset();
+
+    QFile file(confFile->name);
+    if (!file.open(QFile::ReadOnly)) {
+        setStatus(QSettings::AccessError);
+        return;
+    }
+    if (!readIniFile(file.readAll(), &confFile->unparsedIniSections))
+        setStatus(QSettings::FormatError);
+}
+
+void QConfFileSettingsPrivate::writeIniIndex(QConfFile *confFile,
+                                             const QSettingsIniIndex::SourceKey &source,
+                                             const ParsedSettingsMap &map) const
+{
+    QSettingsIniIndex::Entries entries;
+    entries.reserve(map.size());
+    for (auto i = map.cbegin(); i != map.cend(); ++i) {
+        QByteArray value;
+        iniEscapedValue(i.value(), value);
+        entries.emplace_back(i.key(), std::move(value));
+    }
+    QSettingsIniIndex::write(confFile->name, source, entries);
+}
+
 /*!
     \class QSettings
     \inmodule QtCore
@@ -2175,6 +2275,14 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
     Note that sync() imports changes made by other processes (in addition to
     writing the changes from this QSettings).
 
+    When many processes read a large INI file, setting the \c QT_SETTINGS_INDEX
+    environment variable to \c 1 lets them share a binary index of the file,
+    stored next to it with an \c .index suffix. A process that finds an
+    up-to-date index looks values up in it instead of parsing the file;
+    listing, removing or writing keys still parses the file. The INI file
+    remains authoritative: the changes written by QSettings are appended to
+    the index, and an index that does not match the file is rebuilt.
+
     \section1 Platform-Specific Notes
 
     \section2 Locations Where Application Settings Are Stored
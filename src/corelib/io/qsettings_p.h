@@ -24,6 +24,9 @@
 
 #include <QtCore/qvariant.h>
 #include "qsettings.h"
+#include "qsettingsindex_p.h"
+
+#include <memory>
 
 #ifndef QT_NO_QOBJECT
 #include "private/qobject_p.h"
@@ -130,6 +133,8 @@ public:
     ParsedSettingsMap originalKeys;
     ParsedSettingsMap addedKeys;
     ParsedSettingsMap removedKeys;
+    // answers get() instead of originalKeys until other operations need them
+    std::unique_ptr<QSettingsIniIndex> iniIndex;
     QAtomicInt ref;
     QMutex mutex;
     bool userPerms;
@@ -200,6 +205,8 @@ public:
     static void iniEscapedStringList(const QStringList &strs, QByteArray &result);
     static bool iniUnescapedStringList(QByteArrayView str, QString &stringResult,
                                        QStringList &stringListResult);
+    static void iniEscapedValue(const QVariant &value, QByteArray &result);
+    static QVariant iniUnescapedValue(QByteArrayView value);
     static QStringList splitArgs(const QString &s, qsizetype idx);
 
     QSettings::Format format;
@@ -236,7 +243,7 @@ public:
     bool isWritable() const override;
     QString fileName() const override;
 
-    bool readIniFile(QByteArrayView data, UnparsedSettingsMap *unparsedIniSections);
+    static bool readIniFile(QByteArrayView data, UnparsedSettingsMap *unparsedIniSections);
     static bool readIniSection(const QSettingsKey &section, QByteArrayView data,
                                ParsedSettingsMap *settingsMap);
     static bool readIniLine(QByteArrayView data, qsizetype &dataPos,
@@ -257,6 +264,10 @@ private:
 #endif
     void ensureAllSectionsParsed(QConfFile *confFile) const;
     void ensureSectionParsed(QConfFile *confFile, const QSettingsKey &key) const;
+    bool usesIniIndex() const;
+    void dropIniIndex(QConfFile *confFile) const;
+    void writeIniIndex(QConfFile *confFile, const QSettingsIniIndex::SourceKey &source,
+                       const ParsedSettingsMap &map) const;
 
     QList<QConfFile *> confFiles;
     QSettings::ReadFunc readFunc;
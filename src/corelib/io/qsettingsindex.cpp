@@ -0,0 +1,416 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsettingsindex_p.h"
+
+#include <qbytearrayalgorithms.h>
+#include <qendian.h>
+#include <qfileinfo.h>
+#if QT_CONFIG(temporaryfile)
+#include <qsavefile.h>
+#endif
+#include <qtimezone.h>
+
+#include "private/qfilesystemengine_p.h"
+#include "private/qfilesystementry_p.h"
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*
+    The index of an INI file is stored next to it, with an ".index" suffix,
+    in the native byte order:
+
+        Header:
+            quint32 magic, which also tells the byte order
+            quint32 version
+            quint32 entry count
+            quint32 size of the string area
+            source key (the state of the INI file that was indexed)
+        Entries, sorted by key:
+            quint32 key offset, quint32 key length (in UTF-16 code units)
+            quint32 value offset, quint32 value length (in bytes)
+        String area, relative to which the offsets are:
+            the keys in UTF-16, then the values as escaped in the INI file,
+            padded to 4 bytes
+        Journal, a sequence of batches:
+            quint32 batch size (in bytes, not counting this word)
+            quint32 record count
+            source key (the state of the INI file the batch applies to)
+            records:
+                quint32 key length, qint32 value length (-1 if removed),
+                the key, the value, padded to 4 bytes
+            source key (the state of the INI file after the batch)
+            quint32 checksum of the batch, without this word
+
+    A source key is the size and the modification time of the INI file as
+    qint64, followed by the length of its file ID as quint32 and the ID,
+    padded to 4 bytes.
+
+    The index is only ever appended to, by the process holding the lock of
+    the INI file, or replaced. A batch that was cut short or that does not
+    apply to the state before it ends the journal, so that a reader never
+    uses a partial update.
+*/
+enum : quint32 {
+    IndexMagic = 0x58495351,    // "QSIX" in little endian
+    IndexVersion = 1,
+    HeaderSize = 4 * sizeof(quint32),
+    EntrySize = 4 * sizeof(quint32),
+    // the journal may grow to this size, or to half the size of the
+    // entries and strings if it is larger, before the index is rewritten
+    MinimumJournalLimit = 16 * 1024,
+};
+
+static constexpr qsizetype padded(qsizetype size)
+{
+    return (size + 3) & ~qsizetype(3);
+}
+
+template <typename T>
+static void appendInt(QByteArray &data, T value)
+{
+    data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void appendPadding(QByteArray &data)
+{
+    data.append(padded(data.size()) - data.size(), '\0');
+}
+
+static void appendSourceKey(QByteArray &data, const QSettingsIniIndex::SourceKey &key)
+{
+    appendInt<qint64>(data, key.size);
+    appendInt<qint64>(data, key.modificationTime);
+    appendInt<quint32>(data, quint32(key.id.size()));
+    data += key.id;
+    appendPadding(data);
+}
+
+static bool readSourceKey(const uchar *data, qsizetype size, qsizetype *offset,
+                          QSettingsIniIndex::SourceKey *key)
+{
+    qsizetype pos = *offset;
+    if (size - pos < qsizetype(2 * sizeof(qint64) + sizeof(quint32)))
+        return false;
+    key->size = qFromUnaligned<qint64>(data + pos);
+    key->modificationTime = qFromUnaligned<qint64>(data + pos + sizeof(qint64));
+    const quint32 idSize = qFromUnaligned<quint32>(data + pos + 2 * sizeof(qint64));
+    pos += 2 * sizeof(qint64) + sizeof(quint32);
+    if (size - pos < qsizetype(idSize))
+        return false;
+    key->id = QByteArray(reinterpret_cast<const char *>(data + pos), idSize);
+    pos = padded(pos + idSize);
+    if (pos > size)
+        return false;
+    *offset = pos;
+    return true;
+}
+
+/*
+    The index is optional, and enabled by setting the QT_SETTINGS_INDEX
+    environment variable to a positive number.
+*/
+bool QSettingsIniIndex::isEnabled()
+{
+    return qEnvironmentVariableIntValue("QT_SETTINGS_INDEX") > 0;
+}
+
+QString QSettingsIniIndex::indexFileName(const QString &iniFileName)
+{
+    return iniFileName + ".index"_L1;
+}
+
+/*
+    Returns the current state of \a iniFileName, or an invalid key if the
+    file cannot be indexed, as it does not exist or is not a native file.
+*/
+QSettingsIniIndex::SourceKey QSettingsIniIndex::sourceKey(const QString &iniFileName)
+{
+    SourceKey key;
+    const QFileInfo info(iniFileName);
+    if (!info.exists())
+        return key;
+    key.id = QFileSystemEngine::id(QFileSystemEntry(iniFileName));
+    if (key.id.isEmpty())
+        return key;
+    key.size = info.size();
+    key.modificationTime = info.lastModified(QTimeZone::UTC).toMSecsSinceEpoch();
+    return key;
+}
+
+/*
+    Returns the state of the open \a iniFile. Unlike the state of its file
+    name, this is the state of the contents read from it, even if another
+    process has replaced the file since it was opened.
+*/
+QSettingsIniIndex::SourceKey QSettingsIniIndex::sourceKey(const QFile &iniFile)
+{
+#ifdef Q_OS_UNIX
+    SourceKey key;
+    const int fd = iniFile.handle();
+    QFileSystemMetaData metaData;
+    if (fd < 0 || !QFileSystemEngine::fillMetaData(fd, metaData))
+        return key;
+    key.id = QFileSystemEngine::id(fd);
+    if (key.id.isEmpty())
+        return key;
+    key.size = metaData.size();
+    key.modificationTime = metaData.modificationTime().toMSecsSinceEpoch();
+    return key;
+#else
+    return sourceKey(iniFile.fileName());
+#endif
+}
+
+/*
+    Maps the index of \a iniFileName, and returns \c true if it is
+    up to date with the INI file's \a source state.
+*/
+bool QSettingsIniIndex::open(const QString &iniFileName, const SourceKey &source)
+{
+    SourceKey indexed;
+    if (source.isValid() && map(iniFileName, &indexed)) {
+        readJournal(&indexed);
+        if (indexed == source)
+            return true;
+    }
+    journal.clear();
+    data = nullptr;
+    size = 0;
+    file.close();
+    return false;
+}
+
+bool QSettingsIniIndex::map(const QString &iniFileName, SourceKey *source)
+{
+    file.setFileName(indexFileName(iniFileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    size = file.size();
+    if (size < HeaderSize || !(data = file.map(0, size)))
+        return false;
+
+    if (qFromUnaligned<quint32>(data) != IndexMagic
+            || qFromUnaligned<quint32>(data + 4) != IndexVersion) {
+        return false;
+    }
+    entryCount = qFromUnaligned<quint32>(data + 8);
+    const quint32 stringsSize = qFromUnaligned<quint32>(data + 12);
+    qsizetype offset = HeaderSize;
+    if (!readSourceKey(data, size, &offset, source))
+        return false;
+    if ((size - offset) / EntrySize < entryCount)
+        return false;
+    entries = data + offset;
+    offset += qsizetype(entryCount) * EntrySize;
+    if (size - offset < qsizetype(stringsSize))
+        return false;
+    strings = data + offset;
+    snapshotSize = offset + stringsSize;
+    journalEnd = snapshotSize;
+
+    // check the entries once, so that lookups can trust them
+    for (quint32 i = 0; i < entryCount; ++i) {
+        const uchar *entry = entries + i * EntrySize;
+        const quint32 keyOffset = qFromUnaligned<quint32>(entry);
+        const quint32 keyLength = qFromUnaligned<quint32>(entry + 4);
+        const quint32 valueOffset = qFromUnaligned<quint32>(entry + 8);
+        const quint32 valueLength = qFromUnaligned<quint32>(entry + 12);
+        if (keyOffset % 2 || keyOffset > stringsSize || (stringsSize - keyOffset) / 2 < keyLength
+                || valueOffset > stringsSize || stringsSize - valueOffset < valueLength) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    Applies the journal to the entries, and updates \a source to the state
+    of the INI file after the last complete batch.
+*/
+void QSettingsIniIndex::readJournal(SourceKey *source)
+{
+    qsizetype offset = snapshotSize;
+    while (size - offset >= qsizetype(sizeof(quint32))) {
+        const quint32 batchSize = qFromUnaligned<quint32>(data + offset);
+        const qsizetype begin = offset + sizeof(quint32);
+        if (batchSize % 4 || batchSize < 2 * sizeof(quint32) || size - begin < batchSize)
+            break;
+        const qsizetype end = begin + batchSize - sizeof(quint32);
+        const QByteArrayView batch(data + begin, end - begin);
+        if (qChecksum(batch) != qFromUnaligned<quint32>(data + end))
+            break;
+
+        const quint32 recordCount = qFromUnaligned<quint32>(data + begin);
+        qsizetype pos = begin + sizeof(quint32);
+        SourceKey from;
+        if (!readSourceKey(data, end, &pos, &from) || from != *source)
+            break;
+
+        QHash<QString, std::optional<QByteArrayView>> records;
+        quint32 i = 0;
+        for (; i < recordCount; ++i) {
+            if (end - pos < qsizetype(2 * sizeof(quint32)))
+                break;
+            const quint32 keyLength = qFromUnaligned<quint32>(data + pos);
+            const qint32 valueLength = qFromUnaligned<qint32>(data + pos + 4);
+            pos += 2 * sizeof(quint32);
+            if ((end - pos) / 2 < keyLength || valueLength < -1
+                    || end - pos - 2 * keyLength < qMax(valueLength, 0)) {
+                break;
+            }
+            QString key(reinterpret_cast<const QChar *>(data + pos), keyLength);
+            pos += 2 * keyLength;
+            std::optional<QByteArrayView> value;
+            if (valueLength >= 0) {
+                value = QByteArrayView(data + pos, valueLength);
+                pos += valueLength;
+            }
+            pos = padded(pos);
+            records.insert(std::move(key), value);
+        }
+        SourceKey to;
+        if (i != recordCount || pos > end || !readSourceKey(data, end, &pos, &to) || pos != end)
+            break;
+
+        journal.insert(records);
+        *source = std::move(to);
+        offset = end + sizeof(quint32);
+        journalEnd = offset;
+    }
+}
+
+/*
+    Returns the value of \a key as escaped in the INI file, or no value if
+    the INI file does not have \a key.
+*/
+std::optional<QByteArrayView> QSettingsIniIndex::value(const QString &key) const
+{
+    if (!journal.isEmpty()) {
+        const auto it = journal.constFind(key);
+        if (it != journal.cend())
+            return *it;
+    }
+
+    const auto keyAt = [this](quint32 i) {
+        const uchar *entry = entries + i * EntrySize;
+        return QStringView(reinterpret_cast<const QChar *>(strings + qFromUnaligned<quint32>(entry)),
+                           qFromUnaligned<quint32>(entry + 4));
+    };
+    quint32 first = 0;
+    quint32 last = entryCount;
+    while (first < last) {
+        const quint32 middle = first + (last - first) / 2;
+        const int cmp = keyAt(middle).compare(key);
+        if (cmp == 0) {
+            const uchar *entry = entries + middle * EntrySize;
+            return QByteArrayView(strings + qFromUnaligned<quint32>(entry + 8),
+                                  qFromUnaligned<quint32>(entry + 12));
+        }
+        if (cmp < 0)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+    return std::nullopt;
+}
+
+/*
+    Replaces the index of \a iniFileName by one of \a entries, for the
+    \a source state of the INI file.
+*/
+bool QSettingsIniIndex::write(const QString &iniFileName, const SourceKey &source,
+                              const Entries &entries)
+{
+#if QT_CONFIG(temporaryfile)
+    if (!source.isValid())
+        return false;
+
+    QByteArray table;
+    QByteArray keys;
+    QByteArray values;
+    table.reserve(entries.size() * EntrySize);
+    for (const auto &[key, value] : entries) {
+        appendInt<quint32>(table, quint32(keys.size()));
+        appendInt<quint32>(table, quint32(key.size()));
+        appendInt<quint32>(table, quint32(values.size()));
+        appendInt<quint32>(table, quint32(value.size()));
+        keys.append(reinterpret_cast<const char *>(key.constData()), key.size() * 2);
+        values += value;
+    }
+    appendPadding(values);
+    if (keys.size() + values.size() > std::numeric_limits<quint32>::max())
+        return false;
+
+    // the values follow the keys
+    for (qsizetype i = 0; i < entries.size(); ++i) {
+        char *valueOffset = table.data() + i * EntrySize + 8;
+        qToUnaligned<quint32>(qFromUnaligned<quint32>(valueOffset) + quint32(keys.size()),
+                              valueOffset);
+    }
+
+    QByteArray index;
+    appendInt<quint32>(index, IndexMagic);
+    appendInt<quint32>(index, IndexVersion);
+    appendInt<quint32>(index, quint32(entries.size()));
+    appendInt<quint32>(index, quint32(keys.size() + values.size()));
+    appendSourceKey(index, source);
+    index += table;
+    index += keys;
+    index += values;
+
+    QSaveFile file(indexFileName(iniFileName));
+    return file.open(QIODevice::WriteOnly) && file.write(index) == index.size() && file.commit();
+#else
+    Q_UNUSED(iniFileName);
+    Q_UNUSED(source);
+    Q_UNUSED(entries);
+    return false;
+#endif
+}
+
+/*
+    Appends \a changes to the journal of the index of \a iniFileName, which
+    takes the INI file from the \a from state to the \a to state. Returns
+    \c false if the index is not up to date with \a from, or if the journal
+    is too large, in which case the index has to be rewritten.
+*/
+bool QSettingsIniIndex::append(const QString &iniFileName, const SourceKey &from,
+                               const SourceKey &to, const Changes &changes)
+{
+    if (!to.isValid())
+        return false;
+    QSettingsIniIndex index;
+    if (!index.open(iniFileName, from) || index.journalEnd != index.size)
+        return false;
+
+    QByteArray batch;
+    appendInt<quint32>(batch, 0);   // the batch size
+    appendInt<quint32>(batch, quint32(changes.size()));
+    appendSourceKey(batch, from);
+    for (const auto &[key, value] : changes) {
+        appendInt<quint32>(batch, quint32(key.size()));
+        appendInt<qint32>(batch, value ? qint32(value->size()) : -1);
+        batch.append(reinterpret_cast<const char *>(key.constData()), key.size() * 2);
+        if (value)
+            batch += *value;
+        appendPadding(batch);
+    }
+    appendSourceKey(batch, to);
+    const QByteArrayView checksummed = QByteArrayView(batch).sliced(sizeof(quint32));
+    appendInt<quint32>(batch, qChecksum(checksummed));
+    qToUnaligned<quint32>(quint32(batch.size() - sizeof(quint32)), batch.data());
+
+    const qsizetype journalSize = index.size - index.snapshotSize + batch.size();
+    if (journalSize > qMax(qsizetype(MinimumJournalLimit), index.snapshotSize / 2))
+        return false;
+
+    // a single write, so that a reader sees either none or all of the batch
+    QFile file(indexFileName(iniFileName));
+    return file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)
+            && file.write(batch) == batch.size();
+}
+
+QT_END_NAMESPACE
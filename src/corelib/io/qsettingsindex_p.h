@@ -0,0 +1,96 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSETTINGSINDEX_P_H
+#define QSETTINGSINDEX_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QSettings class.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+
+#include <optional>
+#include <utility>
+
+QT_REQUIRE_CONFIG(settings);
+
+QT_BEGIN_NAMESPACE
+
+// A binary index of the keys and values of an INI file, stored next to it,
+// that is mapped into memory and answers lookups without parsing the INI
+// file. The index is tied to the state of the INI file it was built from,
+// and is ignored once the INI file changes. Changes written by QSettings
+// are appended to the index as a journal, until the journal grows too
+// large and the index is rewritten.
+class Q_AUTOTEST_EXPORT QSettingsIniIndex
+{
+    Q_DISABLE_COPY_MOVE(QSettingsIniIndex)
+public:
+    struct SourceKey
+    {
+        qint64 size = -1;
+        qint64 modificationTime = 0;    // milliseconds since the epoch
+        QByteArray id;
+
+        bool isValid() const { return size >= 0; }
+        friend bool operator==(const SourceKey &lhs, const SourceKey &rhs) noexcept
+        {
+            return lhs.size == rhs.size && lhs.modificationTime == rhs.modificationTime
+                    && lhs.id == rhs.id;
+        }
+        friend bool operator!=(const SourceKey &lhs, const SourceKey &rhs) noexcept
+        { return !(lhs == rhs); }
+    };
+
+    // the keys with their values as escaped in the INI file, sorted by key
+    using Entries = QList<std::pair<QString, QByteArray>>;
+    // the changed keys, with no value for the removed ones
+    using Changes = QList<std::pair<QString, std::optional<QByteArray>>>;
+
+    QSettingsIniIndex() = default;
+
+    static bool isEnabled();
+    static QString indexFileName(const QString &iniFileName);
+    static SourceKey sourceKey(const QString &iniFileName);
+    static SourceKey sourceKey(const QFile &iniFile);
+
+    bool open(const QString &iniFileName, const SourceKey &source);
+    bool isOpen() const { return data != nullptr; }
+    std::optional<QByteArrayView> value(const QString &key) const;
+
+    static bool write(const QString &iniFileName, const SourceKey &source,
+                      const Entries &entries);
+    static bool append(const QString &iniFileName, const SourceKey &from, const SourceKey &to,
+                       const Changes &changes);
+
+private:
+    bool map(const QString &iniFileName, SourceKey *source);
+    void readJournal(SourceKey *source);
+
+    QFile file;
+    const uchar *data = nullptr;
+    qsizetype size = 0;
+    quint32 entryCount = 0;
+    const uchar *entries = nullptr;
+    const uchar *strings = nullptr;
+    qsizetype snapshotSize = 0;     // the offset of the journal
+    qsizetype journalEnd = 0;       // the end of the last complete batch
+    QHash<QString, std::optional<QByteArrayView>> journal;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSETTINGSINDEX_P_H
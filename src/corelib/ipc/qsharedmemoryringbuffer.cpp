@@ -0,0 +1,494 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsharedmemoryringbuffer_p.h"
+
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qnumeric.h>
+
+#include <atomic>
+#include <new>
+#include <thread>
+
+#ifdef Q_OS_UNIX
+#  include <QtCore/qfile.h>
+#  include <private/qcore_unix_p.h>
+#endif
+#if QT_CONFIG(posix_shm)
+#  include <sys/mman.h>
+#endif
+#ifdef Q_OS_LINUX
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <limits.h>
+#  include <unistd.h>
+#endif
+#if __has_include(<sys/eventfd.h>)
+#  include <sys/eventfd.h>
+#  define QT_RINGBUFFER_HAS_EVENTFD
+#endif
+
+using namespace std::chrono_literals;
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QSharedMemoryRingBuffer
+    \internal
+    \inmodule QtCore
+
+    \brief Passes messages between processes through a lock-free queue in a
+    QSharedMemory segment.
+
+    The consumer create()s the ring buffer with room for capacity() messages
+    of up to maximumMessageSize() bytes each, and producers attach() to it
+    with the same key. In SingleProducer mode there may be only one producer
+    at a time; in MultiProducer mode any number of them may write
+    concurrently. There is always a single consumer.
+
+    Each slot of the queue carries a sequence number that tells whether it
+    is free or holds a message for the current pass over the ring, so
+    writing and reading a message take no lock and no system call as long
+    as the consumer keeps up.
+
+    When the consumer finds the queue empty, it flags itself as sleeping,
+    and the next producer to write wakes it up: through a futex on Linux,
+    which waitForReadyRead() waits on, and through the eventDescriptor(),
+    which can be watched with a QSocketNotifier. Likewise, write() waits
+    for the consumer to make room when the queue is full. Without
+    process-shared futexes, those waits poll instead.
+
+    The event descriptor belongs to the consumer's process. Producers in
+    other processes need a copy of it, which the application can pass them
+    with QLocalSocket::sendDescriptors(), to notify the consumer through it;
+    see setEventDescriptor().
+*/
+
+namespace {
+constexpr quint32 RingBufferMagic = 0x51524231; // "QRB1"
+constexpr qsizetype MaximumCapacity = qsizetype(1) << 30;
+constexpr size_t CacheLineSize = 64;
+
+static_assert(std::atomic<quint32>::is_always_lock_free);
+static_assert(std::atomic<quint64>::is_always_lock_free);
+
+#ifdef Q_OS_LINUX
+// Not FUTEX_PRIVATE_FLAG: the words live in memory shared with other
+// processes.
+void futexWait(std::atomic<quint32> &futex, quint32 expected, QDeadlineTimer deadline)
+{
+    struct timespec ts;
+    struct timespec *timeout = nullptr;
+    if (!deadline.isForever()) {
+        ts = durationToTimespec(deadline.deadline<std::chrono::steady_clock>().time_since_epoch());
+        timeout = &ts;
+    }
+    syscall(__NR_futex, reinterpret_cast<int *>(&futex), FUTEX_WAIT_BITSET, int(expected),
+            timeout, nullptr, FUTEX_BITSET_MATCH_ANY);
+}
+
+void futexWakeAll(std::atomic<quint32> &futex)
+{
+    syscall(__NR_futex, reinterpret_cast<int *>(&futex), FUTEX_WAKE, INT_MAX);
+}
+#else
+void futexWait(std::atomic<quint32> &futex, quint32 expected, QDeadlineTimer deadline)
+{
+    auto delay = 10us;
+    while (futex.load(std::memory_order_acquire) == expected && !deadline.hasExpired()) {
+        std::this_thread::sleep_for(delay);
+        delay = qMin(delay * 2, std::chrono::microseconds(1ms));
+    }
+}
+
+void futexWakeAll(std::atomic<quint32> &)
+{
+}
+#endif
+} // unnamed namespace
+
+struct QSharedMemoryRingBuffer::Header
+{
+    std::atomic<quint32> magic;
+    Mode mode;
+    quint32 capacity;           // a power of two
+    quint32 reserved;
+    quint64 slotSize;
+    quint64 maximumMessageSize;
+
+    alignas(CacheLineSize) std::atomic<quint64> enqueuePosition;
+    alignas(CacheLineSize) std::atomic<quint64> dequeuePosition;
+    alignas(CacheLineSize) std::atomic<quint32> consumerSleeping;
+    std::atomic<quint32> consumerWakeUps;
+    alignas(CacheLineSize) std::atomic<quint32> producersWaiting;
+    std::atomic<quint32> spaceWakeUps;
+};
+
+// A slot is free for the write at position p when its sequence is p, and
+// holds that message when its sequence is p + 1.
+struct QSharedMemoryRingBuffer::Slot
+{
+    std::atomic<quint64> sequence;
+    quint64 size;
+
+    uchar *data() { return reinterpret_cast<uchar *>(this + 1); }
+};
+
+QSharedMemoryRingBuffer::QSharedMemoryRingBuffer() = default;
+
+QSharedMemoryRingBuffer::~QSharedMemoryRingBuffer()
+{
+    detach();
+}
+
+/*!
+    Creates the shared memory segment for \a key and sets up the ring buffer
+    in it, for \a capacity messages (rounded up to a power of two, and at
+    least two) of up to \a maximumMessageSize bytes each. The caller becomes
+    the consumer.
+
+    Returns \c false and sets errorString() on failure.
+*/
+bool QSharedMemoryRingBuffer::create(const QNativeIpcKey &key, qsizetype maximumMessageSize,
+                                     qsizetype capacity, Mode mode)
+{
+    detach();
+    if (maximumMessageSize <= 0 || capacity <= 0 || capacity > MaximumCapacity) {
+        m_errorString = QCoreApplication::translate("QSharedMemoryRingBuffer",
+                                                    "Invalid size or capacity");
+        return false;
+    }
+
+    // with a single slot, a full slot would look free for the next pass
+    capacity = qMax(qsizetype(2), qsizetype(qNextPowerOfTwo(quint32(capacity - 1))));
+    const qsizetype slotSize = (sizeof(Slot) + maximumMessageSize + alignof(Slot) - 1)
+            & ~qsizetype(alignof(Slot) - 1);
+    qsizetype size;
+    if (qMulOverflow(slotSize, capacity, &size)
+            || qAddOverflow(size, qsizetype(sizeof(Header)), &size)) {
+        m_errorString = QCoreApplication::translate("QSharedMemoryRingBuffer",
+                                                    "Invalid size or capacity");
+        return false;
+    }
+
+    m_memory.setNativeKey(key);
+    if (!m_memory.create(size)) {
+        m_errorString = m_memory.errorString();
+        return false;
+    }
+
+    m_header = new (m_memory.data()) Header{ {}, mode, quint32(capacity), 0, quint64(slotSize),
+                                             quint64(maximumMessageSize), {}, {}, {}, {}, {}, {} };
+    m_slots = static_cast<uchar *>(m_memory.data()) + sizeof(Header);
+    for (qsizetype i = 0; i < capacity; ++i)
+        new (m_slots + i * slotSize) Slot{ { quint64(i) }, 0 };
+
+#ifdef QT_RINGBUFFER_HAS_EVENTFD
+    m_eventDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+    // producers that attach check this last
+    m_header->magic.store(RingBufferMagic, std::memory_order_release);
+    m_isConsumer = true;
+    m_errorString.clear();
+    return true;
+}
+
+/*!
+    Attaches to the ring buffer created for \a key, to write to it.
+
+    Returns \c false and sets errorString() on failure.
+*/
+bool QSharedMemoryRingBuffer::attach(const QNativeIpcKey &key)
+{
+    detach();
+    m_memory.setNativeKey(key);
+    if (!m_memory.attach()) {
+        m_errorString = m_memory.errorString();
+        return false;
+    }
+
+    auto header = static_cast<Header *>(m_memory.data());
+    bool valid = m_memory.size() >= qsizetype(sizeof(Header))
+            && header->magic.load(std::memory_order_acquire) == RingBufferMagic;
+    if (valid) {
+        const quint64 capacity = header->capacity;
+        valid = capacity >= 2 && (capacity & (capacity - 1)) == 0
+                && header->slotSize >= sizeof(Slot) + header->maximumMessageSize
+                && (quint64(m_memory.size()) - sizeof(Header)) / header->slotSize >= capacity;
+    }
+    if (!valid) {
+        m_memory.detach();
+        m_errorString = QCoreApplication::translate("QSharedMemoryRingBuffer",
+                                                    "The shared memory segment is not a ring buffer");
+        return false;
+    }
+
+    m_header = header;
+    m_slots = static_cast<uchar *>(m_memory.data()) + sizeof(Header);
+    m_errorString.clear();
+    return true;
+}
+
+/*!
+    Detaches from the ring buffer. Once the consumer has detached, no
+    producer can attach to it anymore, and it is destroyed when the last
+    producer detaches.
+*/
+void QSharedMemoryRingBuffer::detach()
+{
+    closeEventDescriptor();
+    m_header = nullptr;
+    m_slots = nullptr;
+    if (!m_memory.isAttached())
+        return;
+#if QT_CONFIG(posix_shm)
+    // QSharedMemory cannot tell when the last process detaches from a POSIX
+    // segment on most systems, so the consumer removes it.
+    const QNativeIpcKey key = m_memory.nativeIpcKey();
+    m_memory.detach();
+    if (std::exchange(m_isConsumer, false) && key.type() == QNativeIpcKey::Type::PosixRealtime)
+        ::shm_unlink(QFile::encodeName(key.nativeKey()).constData());
+#else
+    m_isConsumer = false;
+    m_memory.detach();
+#endif
+}
+
+QSharedMemoryRingBuffer::Mode QSharedMemoryRingBuffer::mode() const
+{
+    return m_header ? m_header->mode : Mode::SingleProducer;
+}
+
+qsizetype QSharedMemoryRingBuffer::maximumMessageSize() const
+{
+    return m_header ? qsizetype(m_header->maximumMessageSize) : 0;
+}
+
+qsizetype QSharedMemoryRingBuffer::capacity() const
+{
+    return m_header ? qsizetype(m_header->capacity) : 0;
+}
+
+QSharedMemoryRingBuffer::Slot *QSharedMemoryRingBuffer::slotAt(quint64 position) const
+{
+    const quint64 index = position & (m_header->capacity - 1);
+    return reinterpret_cast<Slot *>(m_slots + index * m_header->slotSize);
+}
+
+/*!
+    Queues \a message, unless the ring buffer is full or the message is
+    larger than maximumMessageSize(). Never blocks.
+*/
+bool QSharedMemoryRingBuffer::tryWrite(QByteArrayView message)
+{
+    if (!m_header || quint64(message.size()) > m_header->maximumMessageSize)
+        return false;
+
+    quint64 position = m_header->enqueuePosition.load(std::memory_order_relaxed);
+    Slot *slot;
+    for (;;) {
+        slot = slotAt(position);
+        const quint64 sequence = slot->sequence.load(std::memory_order_acquire);
+        const qint64 difference = qint64(sequence - position);
+        if (difference == 0) {
+            if (m_header->mode == Mode::SingleProducer) {
+                m_header->enqueuePosition.store(position + 1, std::memory_order_relaxed);
+                break;
+            }
+            if (m_header->enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                                std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            return false; // full: the consumer has not read this slot's last message
+        } else {
+            position = m_header->enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->size = quint64(message.size());
+    memcpy(slot->data(), message.data(), message.size());
+    slot->sequence.store(position + 1, std::memory_order_release);
+    wakeConsumer();
+    return true;
+}
+
+/*!
+    Queues \a message, waiting until \a deadline for the consumer to make
+    room for it if the ring buffer is full.
+*/
+bool QSharedMemoryRingBuffer::write(QByteArrayView message, QDeadlineTimer deadline)
+{
+    for (;;) {
+        if (tryWrite(message))
+            return true;
+        if (!m_header || quint64(message.size()) > m_header->maximumMessageSize)
+            return false;
+
+        const quint32 wakeUps = m_header->spaceWakeUps.load(std::memory_order_acquire);
+        m_header->producersWaiting.fetch_add(1);
+        const bool written = tryWrite(message);
+        if (!written && !deadline.hasExpired())
+            futexWait(m_header->spaceWakeUps, wakeUps, deadline);
+        m_header->producersWaiting.fetch_sub(1, std::memory_order_relaxed);
+        if (written)
+            return true;
+        if (deadline.hasExpired())
+            return false;
+    }
+}
+
+template <typename Copy> bool QSharedMemoryRingBuffer::dequeue(Copy copy)
+{
+    const quint64 position = m_header->dequeuePosition.load(std::memory_order_relaxed);
+    Slot *slot = slotAt(position);
+    if (slot->sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+
+    copy(slot->data(), qsizetype(qMin(slot->size, m_header->maximumMessageSize)));
+    m_header->dequeuePosition.store(position + 1, std::memory_order_relaxed);
+    slot->sequence.store(position + m_header->capacity, std::memory_order_release);
+    wakeProducers();
+    return true;
+}
+
+bool QSharedMemoryRingBuffer::isEmpty() const
+{
+    const quint64 position = m_header->dequeuePosition.load(std::memory_order_relaxed);
+    return slotAt(position)->sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+/*!
+    Dequeues the oldest message into \a data and returns its size, or -1 if
+    there is none. A message larger than \a maxSize is truncated.
+*/
+qsizetype QSharedMemoryRingBuffer::tryRead(char *data, qsizetype maxSize)
+{
+    if (!m_header)
+        return -1;
+    qsizetype result = -1;
+    const auto copy = [&](const uchar *message, qsizetype size) {
+        result = qMin(size, maxSize);
+        memcpy(data, message, result);
+    };
+    if (dequeue(copy) || (armWakeUp() && dequeue(copy)))
+        return result;
+    return -1;
+}
+
+/*!
+    \overload
+
+    Dequeues the oldest message into \a message. Returns \c false if there
+    is none.
+*/
+bool QSharedMemoryRingBuffer::tryRead(QByteArray *message)
+{
+    if (!m_header)
+        return false;
+    const auto copy = [&](const uchar *data, qsizetype size) {
+        message->assign(QByteArrayView(data, size));
+    };
+    return dequeue(copy) || (armWakeUp() && dequeue(copy));
+}
+
+/*!
+    Waits until there is a message to read or \a deadline expires. Returns
+    \c true if there is one.
+*/
+bool QSharedMemoryRingBuffer::waitForReadyRead(QDeadlineTimer deadline)
+{
+    if (!m_header)
+        return false;
+    for (;;) {
+        if (!isEmpty())
+            return true;
+        const quint32 wakeUps = m_header->consumerWakeUps.load(std::memory_order_acquire);
+        if (armWakeUp())
+            return true;
+        if (deadline.hasExpired())
+            return false;
+        futexWait(m_header->consumerWakeUps, wakeUps, deadline);
+    }
+}
+
+// The consumer found the queue empty: flag it as sleeping, so that the
+// next write wakes it up. Returns true if a message arrived meanwhile.
+bool QSharedMemoryRingBuffer::armWakeUp()
+{
+#ifdef QT_RINGBUFFER_HAS_EVENTFD
+    if (m_eventDescriptor != -1) {
+        eventfd_t value;
+        eventfd_read(m_eventDescriptor, &value);
+    }
+#endif
+    m_header->consumerSleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return !isEmpty();
+}
+
+void QSharedMemoryRingBuffer::wakeConsumer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_header->consumerSleeping.load(std::memory_order_relaxed)
+            || !m_header->consumerSleeping.exchange(0)) {
+        return;
+    }
+    m_header->consumerWakeUps.fetch_add(1, std::memory_order_release);
+    futexWakeAll(m_header->consumerWakeUps);
+#ifdef QT_RINGBUFFER_HAS_EVENTFD
+    if (m_eventDescriptor != -1)
+        eventfd_write(m_eventDescriptor, 1);
+#endif
+}
+
+void QSharedMemoryRingBuffer::wakeProducers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_header->producersWaiting.load(std::memory_order_relaxed))
+        return;
+    m_header->spaceWakeUps.fetch_add(1, std::memory_order_release);
+    futexWakeAll(m_header->spaceWakeUps);
+}
+
+/*!
+    \fn int QSharedMemoryRingBuffer::eventDescriptor() const
+
+    Returns the descriptor that becomes readable when a message arrives
+    while the consumer is idle, or -1 if there is none. On the consumer's
+    side, it is meant for a QSocketNotifier, whose activation should be
+    answered by reading messages until tryRead() fails.
+*/
+
+/*!
+    Makes this producer notify the consumer through \a fd as well, which is
+    a copy of the consumer's eventDescriptor(). This object keeps its own
+    duplicate of \a fd.
+
+    Returns \c false if event descriptors are not supported.
+*/
+bool QSharedMemoryRingBuffer::setEventDescriptor(int fd)
+{
+#ifdef QT_RINGBUFFER_HAS_EVENTFD
+    closeEventDescriptor();
+    if (fd != -1)
+        m_eventDescriptor = qt_safe_dup(fd);
+    return fd == -1 || m_eventDescriptor != -1;
+#else
+    Q_UNUSED(fd);
+    return false;
+#endif
+}
+
+void QSharedMemoryRingBuffer::closeEventDescriptor()
+{
+#ifdef QT_RINGBUFFER_HAS_EVENTFD
+    if (m_eventDescriptor != -1)
+        qt_safe_close(m_eventDescriptor);
+#endif
+    m_eventDescriptor = -1;
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,87 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSHAREDMEMORYRINGBUFFER_P_H
+#define QSHAREDMEMORYRINGBUFFER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qsharedmemory.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qstring.h>
+
+QT_REQUIRE_CONFIG(sharedmemory);
+
+QT_BEGIN_NAMESPACE
+
+class Q_CORE_EXPORT QSharedMemoryRingBuffer
+{
+    Q_DISABLE_COPY_MOVE(QSharedMemoryRingBuffer)
+public:
+    enum class Mode : quint32 {
+        SingleProducer,
+        MultiProducer,
+    };
+
+    QSharedMemoryRingBuffer();
+    ~QSharedMemoryRingBuffer();
+
+    bool create(const QNativeIpcKey &key, qsizetype maximumMessageSize, qsizetype capacity,
+                Mode mode = Mode::SingleProducer);
+    bool attach(const QNativeIpcKey &key);
+    void detach();
+
+    bool isValid() const { return m_header != nullptr; }
+    QString errorString() const { return m_errorString; }
+
+    Mode mode() const;
+    qsizetype maximumMessageSize() const;
+    qsizetype capacity() const;
+
+    // producers
+    bool tryWrite(QByteArrayView message);
+    bool write(QByteArrayView message, QDeadlineTimer deadline = QDeadlineTimer::Forever);
+
+    // the consumer
+    qsizetype tryRead(char *data, qsizetype maxSize);
+    bool tryRead(QByteArray *message);
+    bool waitForReadyRead(QDeadlineTimer deadline = QDeadlineTimer::Forever);
+
+    int eventDescriptor() const { return m_eventDescriptor; }
+    bool setEventDescriptor(int fd);
+
+private:
+    struct Header;
+    struct Slot;
+
+    Slot *slotAt(quint64 position) const;
+    template <typename Copy> bool dequeue(Copy copy);
+    bool isEmpty() const;
+    bool armWakeUp();
+    void wakeConsumer();
+    void wakeProducers();
+    void closeEventDescriptor();
+
+    QSharedMemory m_memory;
+    Header *m_header = nullptr;
+    uchar *m_slots = nullptr;
+    int m_eventDescriptor = -1;
+    bool m_isConsumer = false;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSHAREDMEMORYRINGBUFFER_P_H
@@ -26,6 +26,7 @@
 
 #if QT_CONFIG(library)
 #  include "qlibrary_p.h"
+#  include "qpluginmetadatacache_p.h"
 #endif
 
 #include <qtcore_tracepoints_p.h>
@@ -303,6 +304,8 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
 
     qCDebug(lcFactoryLoader) << "checking directory path" << path << "...";
 
+    QPluginMetaDataCache cache(path);
+
     QDirIterator plugins(path,
 #if defined(Q_OS_WIN)
                 QStringList(QStringLiteral("*.dll")),
@@ -338,7 +341,10 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
 
         QLibraryPrivate::UniquePtr library;
         library.reset(QLibraryPrivate::findOrCreate(QFileInfo(fileName).canonicalFilePath()));
-        if (!library->isPlugin()) {
+        // A library classified by an earlier scan doesn't look at the cache,
+        // but its entry must survive the save below all the same.
+        cache.markSeen(library->fileName);
+        if (!library->isPlugin(&cache)) {
             qCDebug(lcFactoryLoader) << library->errorString << Qt::endl
                                      << "         not a plugin";
             continue;
@@ -384,6 +390,8 @@ inline void QFactoryLoaderPrivate::updateSinglePath(const QString &path)
             libraries.push_back(std::move(library));
         }
     };
+
+    cache.save();
 }
 
 void QFactoryLoader::update()
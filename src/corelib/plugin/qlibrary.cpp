@@ -27,6 +27,7 @@
 #include "qelfparser_p.h"
 #include "qfactoryloader_p.h"
 #include "qmachparser_p.h"
+#include "qpluginmetadatacache_p.h"
 
 #include <qtcore_tracepoints_p.h>
 
@@ -209,13 +210,19 @@ static QLibraryScanResult qt_find_pattern(const char *s, qsizetype s_len, QStrin
   Returns \c false if version information is not present, or if the
                 information could not be read.
   Returns  true if version information is present and successfully read.
+
+  If \a cacheEntry is not null, the raw metadata is copied to it. Its key is
+  invalidated if the file could not be read, so that no result is cached.
 */
-static QLibraryScanResult findPatternUnloaded(const QString &library, QLibraryPrivate *lib)
+static QLibraryScanResult findPatternUnloaded(const QString &library, QLibraryPrivate *lib,
+                                              QPluginMetaDataCache::Entry *cacheEntry = nullptr)
 {
     QFile file(library);
     if (!file.open(QIODevice::ReadOnly)) {
         if (lib)
             lib->errorString = file.errorString();
+        if (cacheEntry)
+            cacheEntry->key = {};
         qCWarning(qt_lcDebugPlugins, "%ls: cannot open: %ls", qUtf16Printable(library),
                   qUtf16Printable(file.errorString()));
         return {};
@@ -233,6 +240,8 @@ static QLibraryScanResult findPatternUnloaded(const QString &library, QLibraryPr
     if (filedata == nullptr) {
         // If we can't mmap(), then the dynamic loader won't be able to either.
         // This can't be used as a plugin.
+        if (cacheEntry)
+            cacheEntry->key = {};
         qCWarning(qt_lcDebugPlugins, "%ls: failed to map to memory: %ls",
                   qUtf16Printable(library), qUtf16Printable(file.errorString()));
         return {};
@@ -264,6 +273,8 @@ static QLibraryScanResult findPatternUnloaded(const QString &library, QLibraryPr
             qCDebug(qt_lcDebugPlugins, "Found metadata in lib %ls, metadata=\n%s\n",
                     qUtf16Printable(library),
                     QJsonDocument(lib->metaData.toJson()).toJson().constData());
+            if (cacheEntry)
+                cacheEntry->metaData = QByteArray(filedata + r.pos, r.length);
             return r;
         }
     } else {
@@ -702,15 +713,15 @@ static bool qt_get_metadata(QLibraryPrivate *priv, QString *errMsg)
     return false;
 }
 
-bool QLibraryPrivate::isPlugin()
+bool QLibraryPrivate::isPlugin(QPluginMetaDataCache *cache)
 {
     if (pluginState == MightBeAPlugin)
-        updatePluginState();
+        updatePluginState(cache);
 
     return pluginState == IsAPlugin;
 }
 
-void QLibraryPrivate::updatePluginState()
+void QLibraryPrivate::updatePluginState(QPluginMetaDataCache *cache)
 {
     QMutexLocker locker(&mutex);
     errorString.clear();
@@ -733,9 +744,27 @@ void QLibraryPrivate::updatePluginState()
     }
 #endif
 
-    if (!pHnd.loadRelaxed()) {
+    QPluginMetaDataCache::Entry cacheEntry;
+    const QPluginMetaDataCache::Entry *cached = nullptr;
+    if (cache && !pHnd.loadRelaxed()) {
+        // take the key before scanning, a change made meanwhile invalidates the entry
+        cacheEntry.key = QPluginMetaDataCache::fileKey(fileName);
+        cached = cache->find(fileName, cacheEntry.key);
+    }
+
+    if (cached) {
+        // scanned before and unchanged since
+        qCDebug(qt_lcDebugPlugins, "Using cached metadata of %ls", qUtf16Printable(fileName));
+        if (cached->metaData.isEmpty())
+            errorString = cached->errorString;
+        else if (metaData.parse(cached->metaData))
+            success = true;
+        else
+            errorString = metaData.errorString();
+    } else if (!pHnd.loadRelaxed()) {
         // scan for the plugin metadata without loading
-        QLibraryScanResult result = findPatternUnloaded(fileName, this);
+        QLibraryScanResult result = findPatternUnloaded(fileName, this,
+                                                        cache ? &cacheEntry : nullptr);
 #if defined(Q_OF_MACH_O)
         if (result.length && result.isEncrypted) {
             // We found the .qtmetadata section, but since the library is encrypted
@@ -750,6 +779,10 @@ void QLibraryPrivate::updatePluginState()
 #endif
         {
             success = result.length != 0;
+            if (cache) {
+                cacheEntry.errorString = errorString;
+                cache->insert(fileName, std::move(cacheEntry));
+            }
         }
     } else {
         // library is already loaded (probably via QLibrary)
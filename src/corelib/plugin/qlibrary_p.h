@@ -46,6 +46,7 @@ struct QLibraryScanResult
 };
 
 class QLibraryStore;
+class QPluginMetaDataCache;
 class QLibraryPrivate
 {
 public:
@@ -91,8 +92,8 @@ public:
     QString errorString;
     QString qualifiedFileName;
 
-    void updatePluginState();
-    bool isPlugin();
+    void updatePluginState(QPluginMetaDataCache *cache = nullptr);
+    bool isPlugin(QPluginMetaDataCache *cache = nullptr);
 
 private:
     explicit QLibraryPrivate(const QString &canonicalFileName, const QString &version, QLibrary::LoadHints loadHints);
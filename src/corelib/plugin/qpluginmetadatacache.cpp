@@ -0,0 +1,232 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qpluginmetadatacache_p.h"
+#include "qlibrary_p.h"
+
+#include <qcborarray.h>
+#include <qcbormap.h>
+#include <qcborvalue.h>
+#include <qcryptographichash.h>
+#include <qdatetime.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qsavefile.h>
+#include <qstandardpaths.h>
+
+#include "qplatformdefs.h"
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+
+/*
+    The cache of a plugin directory is a file in cacheDirectory(), named
+    after a hash of the directory's path, holding a CBOR map:
+
+        {
+            "version": CacheVersion,
+            "directory": <path of the plugin directory>,
+            "entries": [
+                [ <file name>, <mtime>, <size>, <device>, <inode>,
+                  <raw metadata (byte string)> or <error (text string)> ],
+                ...
+            ]
+        }
+
+    Several processes can share a cache: it is replaced atomically when
+    saved, and the last process to save wins.
+*/
+static constexpr int CacheVersion = 1;
+
+#ifdef Q_OS_UNIX
+template <typename T>
+[[maybe_unused]] static auto modificationTime(const T &statBuffer, int)
+        -> decltype(statBuffer.st_mtim, qint64())
+{
+    return statBuffer.st_mtim.tv_sec * Q_INT64_C(1000000000) + statBuffer.st_mtim.tv_nsec;
+}
+
+template <typename T>
+[[maybe_unused]] static auto modificationTime(const T &statBuffer, long)
+        -> decltype(statBuffer.st_mtimespec, qint64())
+{
+    return statBuffer.st_mtimespec.tv_sec * Q_INT64_C(1000000000)
+            + statBuffer.st_mtimespec.tv_nsec;
+}
+
+template <typename T>
+[[maybe_unused]] static qint64 modificationTime(const T &statBuffer, ...)
+{
+    return statBuffer.st_mtime * Q_INT64_C(1000000000);
+}
+#endif
+
+QPluginMetaDataCache::QPluginMetaDataCache(const QString &directory)
+{
+    const QString cacheDir = cacheDirectory();
+    if (cacheDir.isEmpty())
+        return;
+
+    const QByteArray hash = QCryptographicHash::hash(QFile::encodeName(directory),
+                                                     QCryptographicHash::Sha1);
+    cacheFile = cacheDir + u'/' + QLatin1StringView(hash.toHex()) + ".cbor"_L1;
+    this->directory = directory;
+    load();
+}
+
+/*
+    Returns the directory holding the caches, or an empty string if caching
+    is disabled by the QT_NO_PLUGIN_METADATA_CACHE environment variable.
+    QT_PLUGIN_METADATA_CACHE_DIR overrides the default location, which is
+    shared by all applications of the user.
+*/
+QString QPluginMetaDataCache::cacheDirectory()
+{
+    if (qEnvironmentVariableIsSet("QT_NO_PLUGIN_METADATA_CACHE"))
+        return QString();
+    QString dir = qEnvironmentVariable("QT_PLUGIN_METADATA_CACHE_DIR");
+    if (!dir.isEmpty())
+        return dir;
+    dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (dir.isEmpty())
+        return dir;
+    return dir + "/QtProject/plugin-metadata"_L1;
+}
+
+QPluginMetaDataCache::FileKey QPluginMetaDataCache::fileKey(const QString &fileName)
+{
+    FileKey key;
+#ifdef Q_OS_UNIX
+    QT_STATBUF statBuffer;
+    if (QT_STAT(QFile::encodeName(fileName).constData(), &statBuffer) != 0)
+        return key;
+    key.modificationTime = modificationTime(statBuffer, 0);
+    key.size = statBuffer.st_size;
+    key.device = quint64(statBuffer.st_dev);
+    key.inode = quint64(statBuffer.st_ino);
+#else
+    const QFileInfo info(fileName);
+    if (!info.exists())
+        return key;
+    key.modificationTime = info.lastModified().toMSecsSinceEpoch() * 1000000;
+    key.size = info.size();
+#endif
+    return key;
+}
+
+void QPluginMetaDataCache::load()
+{
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QCborMap map = QCborValue::fromCbor(file.readAll()).toMap();
+    if (map.value("version"_L1).toInteger() != CacheVersion
+            || map.value("directory"_L1).toString() != directory) {
+        qCDebug(qt_lcDebugPlugins, "Ignoring invalid plugin metadata cache %ls",
+                qUtf16Printable(cacheFile));
+        dirty = true;
+        return;
+    }
+
+    const QCborArray array = map.value("entries"_L1).toArray();
+    entries.reserve(array.size());
+    for (const QCborValue &item : array) {
+        const QCborArray fields = item.toArray();
+        if (fields.size() != 6 || !fields.at(0).isString())
+            continue;
+        Entry entry;
+        entry.key.modificationTime = fields.at(1).toInteger();
+        entry.key.size = fields.at(2).toInteger(-1);
+        entry.key.device = quint64(fields.at(3).toInteger());
+        entry.key.inode = quint64(fields.at(4).toInteger());
+        const QCborValue result = fields.at(5);
+        if (result.isByteArray())
+            entry.metaData = result.toByteArray();
+        else
+            entry.errorString = result.toString();
+        entries.insert(fields.at(0).toString(), std::move(entry));
+    }
+}
+
+/*
+    Returns the cached entry of \a fileName if it is still valid for the
+    file's current \a key, or nullptr if the file has to be scanned.
+*/
+const QPluginMetaDataCache::Entry *
+QPluginMetaDataCache::find(const QString &fileName, const FileKey &key)
+{
+    if (!isEnabled() || !key.isValid())
+        return nullptr;
+    auto it = entries.constFind(fileName);
+    if (it == entries.cend())
+        return nullptr;
+    if (it->key != key) {
+        qCDebug(qt_lcDebugPlugins, "Cached metadata of %ls is out of date",
+                qUtf16Printable(fileName));
+        return nullptr;
+    }
+    usedFiles.insert(fileName);
+    return &*it;
+}
+
+/*
+    Stores the result of scanning \a fileName. The entry's key must have
+    been taken before the file was scanned, so that a change made during the
+    scan invalidates the entry.
+*/
+void QPluginMetaDataCache::insert(const QString &fileName, Entry entry)
+{
+    if (!isEnabled() || !entry.key.isValid())
+        return;
+    entries.insert(fileName, std::move(entry));
+    usedFiles.insert(fileName);
+    dirty = true;
+}
+
+/*
+    Writes the cache back if it changed. Entries of files that were not seen
+    since the cache was loaded are dropped.
+*/
+bool QPluginMetaDataCache::save()
+{
+    if (!isEnabled() || (!dirty && usedFiles.size() == entries.size()))
+        return true;
+
+#if QT_CONFIG(temporaryfile) && QT_CONFIG(cborstreamwriter)
+    QCborArray array;
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it) {
+        if (!usedFiles.contains(it.key()))
+            continue;
+        const Entry &entry = it.value();
+        array.append(QCborArray{
+            it.key(),
+            entry.key.modificationTime,
+            entry.key.size,
+            qint64(entry.key.device),
+            qint64(entry.key.inode),
+            entry.metaData.isEmpty() ? QCborValue(entry.errorString) : QCborValue(entry.metaData)
+        });
+    }
+    const QCborMap map{
+        { "version"_L1, CacheVersion },
+        { "directory"_L1, directory },
+        { "entries"_L1, array },
+    };
+
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile file(cacheFile);
+    if (file.open(QIODevice::WriteOnly) && file.write(map.toCborValue().toCbor()) >= 0
+            && file.commit()) {
+        dirty = false;
+        return true;
+    }
+    qCDebug(qt_lcDebugPlugins, "Could not write plugin metadata cache %ls: %ls",
+            qUtf16Printable(cacheFile), qUtf16Printable(file.errorString()));
+#endif
+    return false;
+}
+
+QT_END_NAMESPACE
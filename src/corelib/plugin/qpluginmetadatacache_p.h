@@ -0,0 +1,89 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QPLUGINMETADATACACHE_P_H
+#define QPLUGINMETADATACACHE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QLibrary and QFactoryLoader classes.  This header file may change
+// from version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/private/qglobal_p.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstring.h>
+
+QT_REQUIRE_CONFIG(library);
+
+QT_BEGIN_NAMESPACE
+
+// Caches the raw plugin metadata of the files in one plugin directory, so
+// that a later scan of the directory (possibly by another process) does not
+// have to open and parse the files again. An entry is valid as long as the
+// file's modification time, size and inode (device and file ID) match.
+class Q_AUTOTEST_EXPORT QPluginMetaDataCache
+{
+    Q_DISABLE_COPY_MOVE(QPluginMetaDataCache)
+public:
+    struct FileKey
+    {
+        qint64 modificationTime = 0;    // nanoseconds since the epoch
+        qint64 size = -1;
+        quint64 device = 0;
+        quint64 inode = 0;
+
+        bool isValid() const { return size >= 0; }
+        friend bool operator==(const FileKey &lhs, const FileKey &rhs) noexcept
+        {
+            return lhs.modificationTime == rhs.modificationTime && lhs.size == rhs.size
+                    && lhs.device == rhs.device && lhs.inode == rhs.inode;
+        }
+        friend bool operator!=(const FileKey &lhs, const FileKey &rhs) noexcept
+        { return !(lhs == rhs); }
+    };
+
+    struct Entry
+    {
+        FileKey key;
+        // the raw metadata found in the file, or empty if it is not a plugin
+        QByteArray metaData;
+        QString errorString;
+    };
+
+    explicit QPluginMetaDataCache(const QString &directory);
+
+    bool isEnabled() const { return !cacheFile.isEmpty(); }
+    QString cacheFileName() const { return cacheFile; }
+
+    static FileKey fileKey(const QString &fileName);
+    // keeps the entry of fileName when saving, whether it was looked up or not
+    void markSeen(const QString &fileName) { usedFiles.insert(fileName); }
+    const Entry *find(const QString &fileName, const FileKey &key);
+    void insert(const QString &fileName, Entry entry);
+    bool save();
+
+    static QString cacheDirectory();
+
+private:
+    void load();
+
+    QString directory;
+    QString cacheFile;
+    QHash<QString, Entry> entries;
+    // the files seen by the scan since the cache was loaded; the other
+    // entries are for files that are gone and are dropped when saving
+    QSet<QString> usedFiles;
+    bool dirty = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QPLUGINMETADATACACHE_P_H
@@ -20,6 +20,7 @@
 #include <qdatetime.h>
 #include <qtimezone.h>
 #include <private/qbytearray_p.h>
+#include <private/qdatetime_p.h>
 #include <private/qnumeric_p.h>
 #include <private/qsimd_p.h>
 
@@ -781,7 +782,7 @@ static QCborValue::Type convertToExtendedType(QCborContainerPrivate *d)
             e.type == QCborValue::String && (e.flags & Element::StringIsUtf16) == 0) {
             // The data is supposed to be US-ASCII. If it isn't (contains UTF-8),
             // QDateTime::fromString will fail anyway.
-            dt = QDateTime::fromString(b->asLatin1(), Qt::ISODateWithMs);
+            dt = QDateTimePrivate::fromIsoString(b->asLatin1(), Qt::ISODateWithMs);
         } else if (tag == qint64(QCborKnownTags::UnixTime_t)) {
             qint64 msecs;
             bool ok = false;
@@ -803,9 +804,10 @@ static QCborValue::Type convertToExtendedType(QCborContainerPrivate *d)
                 dt = QDateTime::fromMSecsSinceEpoch(msecs, QTimeZone::UTC);
         }
         if (dt.isValid()) {
-            QByteArray text = dt.toString(Qt::ISODateWithMs).toLatin1();
-            if (!text.isEmpty()) {
-                replaceByteData(text, text.size(), Element::StringIsAscii);
+            char text[QDateTimePrivate::IsoDateTimeMaxSize];
+            const qsizetype size = QDateTimePrivate::toIsoString(dt, Qt::ISODateWithMs, text);
+            if (size) {
+                replaceByteData(text, size, Element::StringIsAscii);
                 e.type = QCborValue::String;
                 d->elements[0].value = qint64(QCborKnownTags::DateTimeString);
                 return QCborValue::DateTime;
@@ -2000,7 +2002,7 @@ QDateTime QCborValue::toDateTime(const QDateTime &defaultValue) const
 
     // Our data must be US-ASCII.
     Q_ASSERT((container->elements.at(1).flags & Element::StringIsUtf16) == 0);
-    return QDateTime::fromString(byteData->asLatin1(), Qt::ISODateWithMs);
+    return QDateTimePrivate::fromIsoString(byteData->asLatin1(), Qt::ISODateWithMs);
 }
 
 #ifndef QT_BOOTSTRAPPED
@@ -3670,6 +3670,10 @@ QString QLocaleData::doubleToString(double d, int precision, DoubleForm form,
     if (width < 0)
         width = 0;
 
+    // The C locale's default form is the one QString::number() produces:
+    if (this == c() && width == 0 && (flags & ~CapitalEorX) == ZeroPadExponent)
+        return qdtoBasicLatin(d, form, precision, flags & CapitalEorX);
+
     int decpt;
     qsizetype bufSize = 1;
     if (precision == QLocale::FloatingPointShortest)
@@ -4412,14 +4416,45 @@ QLocaleData::validateChars(QStringView str, NumberMode numMode, int decDigits,
     return result;
 }
 
+/*
+    Copies a number written with only the ASCII digits, signs, decimal point and
+    exponent that the C locale uses, which numberToCLocale() would pass through
+    unchanged, to *result. Returns false, having written part of it, if s has
+    any other character.
+*/
+static bool asciiNumberToCLocale(QStringView s, CharBuff *result)
+{
+    result->resize(s.size() + 1);
+    char *out = result->data();
+    for (QChar ch : s) {
+        const char16_t c = ch.unicode();
+        if (isAsciiDigit(c) || c == '.' || c == '-' || c == '+' || c == 'e')
+            *out++ = char(c);
+        else if (c == 'E')
+            *out++ = 'e';
+        else
+            return false;
+    }
+    *out = '\0';
+    return true;
+}
+
 double QLocaleData::stringToDouble(QStringView str, bool *ok,
                                    QLocale::NumberOptions number_options) const
 {
     CharBuff buff;
-    if (!numberToCLocale(str, number_options, DoubleScientificMode, &buff)) {
-        if (ok != nullptr)
-            *ok = false;
-        return 0.0;
+    // The C locale's numbers mostly need no conversion, unless checking for
+    // zeros only numberToCLocale() knows to reject:
+    constexpr QLocale::NumberOptions zeroChecks =
+            QLocale::RejectLeadingZeroInExponent | QLocale::RejectTrailingZeroesAfterDot;
+    if (this != c() || (number_options & zeroChecks)
+        || !asciiNumberToCLocale(str.trimmed(), &buff)) {
+        buff.clear();
+        if (!numberToCLocale(str, number_options, DoubleScientificMode, &buff)) {
+            if (ok != nullptr)
+                *ok = false;
+            return 0.0;
+        }
     }
     auto r = qt_asciiToDouble(buff.constData(), buff.size() - 1);
     if (ok != nullptr)
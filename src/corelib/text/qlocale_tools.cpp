@@ -18,6 +18,8 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
 #include <charconv>
 
@@ -42,6 +44,42 @@ using namespace QtMiscUtils;
 
 QT_CLOCALE_HOLDER
 
+// The standard library's conversions of double are much faster than
+// double-conversion's, and give the same results where we use them.
+#if defined(__cpp_lib_to_chars) && !defined(QT_BOOTSTRAPPED)
+#  define QT_HAS_DOUBLE_CHARCONV
+#endif
+
+#ifdef QT_HAS_DOUBLE_CHARCONV
+// Writes the shortest digits of |d| that read back as d, without any leading
+// or trailing zeros (just "0" for zero), like double-conversion's SHORTEST
+// mode. Returns false, leaving the work to the caller, if they don't fit.
+static bool shortestDigits(double d, char *buf, qsizetype bufSize, int &length, int &decpt)
+{
+    // d.dddddddddddddddde-ddd
+    char text[std::numeric_limits<double>::max_digits10 + 7];
+    const auto [end, ec] = std::to_chars(std::begin(text), std::end(text), std::abs(d),
+                                         std::chars_format::scientific);
+    if (ec != std::errc{})
+        return false;
+    const char *const exponent = std::find(text, end, 'e');
+    Q_ASSERT(exponent != end);
+    length = 0;
+    for (const char *p = text; p != exponent; ++p) {
+        if (*p == '.')
+            continue;
+        if (length == bufSize)
+            return false;
+        buf[length++] = *p;
+    }
+    int power = 0;
+    const char *const powerStart = exponent[1] == '+' ? exponent + 2 : exponent + 1;
+    std::from_chars(powerStart, end, power);
+    decpt = power + 1;
+    return true;
+}
+#endif // QT_HAS_DOUBLE_CHARCONV
+
 void qt_doubleToAscii(double d, QLocaleData::DoubleForm form, int precision,
                       char *buf, qsizetype bufSize,
                       bool &sign, int &length, int &decpt)
@@ -84,6 +122,17 @@ void qt_doubleToAscii(double d, QLocaleData::DoubleForm form, int precision,
     if (form == QLocaleData::DFSignificantDigits && precision == 0)
         precision = 1; // 0 significant digits is silently converted to 1
 
+#ifdef QT_HAS_DOUBLE_CHARCONV
+    // In the other modes, double-conversion rounds ties away from zero, where
+    // std::to_chars() rounds them to even, so only the shortest mode, in which
+    // both give the digits closest to d, gets the fast path.
+    if (precision == QLocale::FloatingPointShortest
+        && shortestDigits(d, buf, bufSize, length, decpt)) {
+        sign = std::signbit(d);
+        return;
+    }
+#endif
+
 #if !defined(QT_NO_DOUBLECONVERSION) && !defined(QT_BOOTSTRAPPED)
     // one digit before the decimal dot, counts as significant digit for DoubleToStringConverter
     if (form == QLocaleData::DFExponent && precision >= 0)
@@ -293,6 +342,17 @@ QSimpleParsedNumber<double> qt_asciiToDouble(const char *num, qsizetype numLen,
     }
 
     double d = 0.0;
+#ifdef QT_HAS_DOUBLE_CHARCONV
+    // A number with nothing around it is read, correctly rounded, by
+    // std::from_chars(). Whatever it doesn't consume entirely (a leading '+',
+    // spaces, junk, an out-of-range value) and zero, which may have underflowed,
+    // are left to the code below.
+    if (double value; int(numLen) == numLen) {
+        const auto [end, ec] = std::from_chars(num, num + numLen, value);
+        if (ec == std::errc{} && end == num + numLen && !isZero(value))
+            return { value, numLen };
+    }
+#endif
     int processed;
 #if !defined(QT_NO_DOUBLECONVERSION) && !defined(QT_BOOTSTRAPPED)
     int conv_flags = double_conversion::StringToDoubleConverter::NO_FLAGS;
@@ -703,76 +763,73 @@ static T dtoString(double d, QLocaleData::DoubleForm form, int precision, bool u
     constexpr bool IsQString = std::is_same_v<T, QString>;
     using Char = std::conditional_t<IsQString, char16_t, char>;
 
-    T result;
-    result.reserve(total);
+    // Write straight into the result, which is then cut down to what we used:
+    T result(total, Qt::Uninitialized);
+    Char *const begin = reinterpret_cast<Char *>(result.data());
+    Char *out = begin;
+    // Only ever ASCII, so copying converts to char16_t correctly:
+    const auto append = [&out](QLatin1StringView text) {
+        out = std::copy(text.begin(), text.end(), out);
+    };
+    const auto appendZeros = [&out](qsizetype count) {
+        if (count > 0)
+            out = std::fill_n(out, count, Char('0'));
+    };
 
     if (negative && !isZero(d)) // We don't return "-0"
-        result.append(Char('-'));
+        *out++ = Char('-');
     if (!qIsFinite(d)) {
-        result.append(view);
-        if (uppercase)
-            result = std::move(result).toUpper();
+        append(view);
     } else {
         switch (form) {
         case QLocaleData::DFExponent: {
-            result.append(view.first(1));
+            append(view.first(1));
             view = view.sliced(1);
             if (!view.isEmpty() || (!succinct && precision > 0)) {
-                result.append(Char('.'));
-                result.append(view);
-                if (qsizetype pad = precision - view.size(); !succinct && pad > 0) {
-                    for (int i = 0; i < pad; ++i)
-                        result.append(Char('0'));
-                }
+                *out++ = Char('.');
+                append(view);
+                if (!succinct)
+                    appendZeros(precision - view.size());
             }
             int exponent = decpt - 1;
-            result.append(Char(uppercase ? 'E' : 'e'));
-            result.append(Char(exponent < 0 ? '-' : '+'));
+            *out++ = Char(uppercase ? 'E' : 'e');
+            *out++ = Char(exponent < 0 ? '-' : '+');
             exponent = std::abs(exponent);
             Q_ASSERT(exponent <= D::max_exponent10 + D::max_digits10);
             int exponentDigits = digits(exponent);
             // C's printf guarantees a two-digit exponent, and so do we:
             if (exponentDigits == 1)
-                result.append(Char('0'));
-            result.resize(result.size() + exponentDigits);
-            auto location = reinterpret_cast<Char *>(result.end());
+                *out++ = Char('0');
+            out += exponentDigits;
+            Char *location = out;
             qulltoString_helper<Char>(exponent, 10, location);
             break;
         }
         case QLocaleData::DFDecimal:
             if (decpt < 0) {
-                if constexpr (IsQString)
-                    result.append(u"0.0");
-                else
-                    result.append("0.0");
-                while (++decpt < 0)
-                    result.append(Char('0'));
-                result.append(view);
+                append(QLatin1StringView("0.0"));
+                appendZeros(-1 - decpt);
+                append(view);
                 if (!succinct) {
-                    auto numDecimals = result.size() - 2 - (negative ? 1 : 0);
-                    for (qsizetype i = numDecimals; i < precision; ++i)
-                        result.append(Char('0'));
+                    auto numDecimals = (out - begin) - 2 - (negative ? 1 : 0);
+                    appendZeros(precision - numDecimals);
                 }
             } else {
                 if (decpt > view.size()) {
-                    result.append(view);
-                    const int sign = negative ? 1 : 0;
-                    while (result.size() - sign < decpt)
-                        result.append(Char('0'));
+                    append(view);
+                    appendZeros(decpt - view.size());
                     view = {};
                 } else if (decpt) {
-                    result.append(view.first(decpt));
+                    append(view.first(decpt));
                     view = view.sliced(decpt);
                 } else {
-                    result.append(Char('0'));
+                    *out++ = Char('0');
                 }
                 if (!view.isEmpty() || (!succinct && view.size() < precision)) {
-                    result.append(Char('.'));
-                    result.append(view);
-                    if (!succinct) {
-                        for (qsizetype i = view.size(); i < precision; ++i)
-                            result.append(Char('0'));
-                    }
+                    *out++ = Char('.');
+                    append(view);
+                    if (!succinct)
+                        appendZeros(precision - view.size());
                 }
             }
             break;
@@ -781,7 +838,10 @@ static T dtoString(double d, QLocaleData::DoubleForm form, int precision, bool u
             break;
         }
     }
-    Q_ASSERT(total >= result.size()); // No reallocations are needed
+    Q_ASSERT(total >= out - begin); // No reallocations are needed
+    result.truncate(out - begin);
+    if (uppercase && !qIsFinite(d))
+        result = std::move(result).toUpper();
     return result;
 }
 
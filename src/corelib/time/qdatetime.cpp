@@ -29,6 +29,7 @@
 #endif
 
 #include <cmath>
+#include <optional>
 #ifdef Q_OS_WIN
 #  include <qt_windows.h>
 #endif
@@ -125,6 +126,73 @@ ParsedInt readInt(QStringView text)
     return readInt(QLatin1StringView{latin1.data(), latin1.size()});
 }
 
+/*
+    Reads exactly count ASCII digits at pos in text, which must have them.
+*/
+template <typename View>
+bool readDigits(View text, qsizetype pos, qsizetype count, int *value)
+{
+    int result = 0;
+    for (qsizetype i = pos; i < pos + count; ++i) {
+        const char16_t ch = text[i].unicode();
+        if (ch < u'0' || ch > u'9')
+            return false;
+        result = result * 10 + (ch - u'0');
+    }
+    *value = result;
+    return true;
+}
+
+/*
+    Writes a non-negative value that has at most width digits, zero-padded to
+    width digits like "%0*d"; returns the end of what it wrote.
+*/
+char *writeDigits(char *out, int value, int width)
+{
+    Q_ASSERT(value >= 0);
+    for (int i = width - 1; i >= 0; --i, value /= 10)
+        out[i] = char('0' + value % 10);
+    Q_ASSERT(value == 0);
+    return out + width;
+}
+
+// "yyyy-MM-dd", for years 0 to 9999:
+char *writeIsoDate(char *out, const QCalendar::YearMonthDay &parts)
+{
+    Q_ASSERT(parts.year >= 0 && parts.year <= 9999);
+    out = writeDigits(out, parts.year, 4);
+    *out++ = '-';
+    out = writeDigits(out, parts.month, 2);
+    *out++ = '-';
+    return writeDigits(out, parts.day, 2);
+}
+
+// "HH:mm:ss", with ".zzz" for Qt::ISODateWithMs:
+char *writeIsoTime(char *out, QTime time, Qt::DateFormat format)
+{
+    out = writeDigits(out, time.hour(), 2);
+    *out++ = ':';
+    out = writeDigits(out, time.minute(), 2);
+    *out++ = ':';
+    out = writeDigits(out, time.second(), 2);
+    if (format == Qt::ISODateWithMs) {
+        *out++ = '.';
+        out = writeDigits(out, time.msec(), 3);
+    }
+    return out;
+}
+
+// "±HH:mm" for Qt::ISODate, "±HHmm" for Qt::TextDate, like toOffsetString():
+char *writeOffset(char *out, Qt::DateFormat format, int offset)
+{
+    Q_ASSERT(offset >= QTimeZone::MinUtcOffsetSecs && offset <= QTimeZone::MaxUtcOffsetSecs);
+    *out++ = offset >= 0 ? '+' : '-';
+    out = writeDigits(out, qAbs(offset) / int(SECS_PER_HOUR), 2);
+    if (format != Qt::TextDate)
+        *out++ = ':';
+    return writeDigits(out, (qAbs(offset) / 60) % 60, 2);
+}
+
 } // namespace
 
 struct ParsedRfcDateTime {
@@ -1181,8 +1249,10 @@ static QString toStringTextDate(QDate date)
 static QString toStringIsoDate(QDate date)
 {
     const auto parts = QCalendar().partsFromDate(date);
-    if (parts.isValid() && parts.year >= 0 && parts.year <= 9999)
-        return QString::asprintf("%04d-%02d-%02d", parts.year, parts.month, parts.day);
+    if (parts.isValid() && parts.year >= 0 && parts.year <= 9999) {
+        char buffer[10];
+        return QString::fromLatin1(buffer, writeIsoDate(buffer, parts) - buffer);
+    }
     return QString();
 }
 
@@ -2004,15 +2074,10 @@ QString QTime::toString(Qt::DateFormat format) const
     if (!isValid())
         return QString();
 
-    switch (format) {
-    case Qt::ISODateWithMs:
-        return QString::asprintf("%02d:%02d:%02d.%03d", hour(), minute(), second(), msec());
-    case Qt::RFC2822Date:
-    case Qt::ISODate:
-    case Qt::TextDate:
-    default:
-        return QString::asprintf("%02d:%02d:%02d", hour(), minute(), second());
-    }
+    char buffer[12];
+    const char *end = writeIsoTime(buffer, *this,
+                                   format == Qt::ISODateWithMs ? format : Qt::ISODate);
+    return QString::fromLatin1(buffer, end - buffer);
 }
 
 /*!
@@ -4484,10 +4549,27 @@ QString QDateTime::toString(Qt::DateFormat format) const
         return buf;
 
     switch (format) {
-    case Qt::RFC2822Date:
-        buf = QLocale::c().toString(*this, u"dd MMM yyyy hh:mm:ss ");
-        buf += toOffsetString(Qt::TextDate, offsetFromUtc());
-        return buf;
+    case Qt::RFC2822Date: {
+        const QPair<QDate, QTime> p = getDateTime(d);
+        const auto parts = QGregorianCalendar::partsFromJulian(p.first.toJulianDay());
+        if (parts.year < 1 || parts.year > 9999) {
+            buf = QLocale::c().toString(*this, u"dd MMM yyyy hh:mm:ss ");
+            buf += toOffsetString(Qt::TextDate, offsetFromUtc());
+            return buf;
+        }
+        // "dd MMM yyyy hh:mm:ss ±HHmm", as the C locale formats it:
+        char buffer[QDateTimePrivate::IsoDateTimeMaxSize];
+        char *out = writeDigits(buffer, parts.day, 2);
+        *out++ = ' ';
+        out = std::copy_n(qt_shortMonthNames[parts.month - 1], 3, out);
+        *out++ = ' ';
+        out = writeDigits(out, parts.year, 4);
+        *out++ = ' ';
+        out = writeIsoTime(out, p.second, Qt::ISODate);
+        *out++ = ' ';
+        out = writeOffset(out, Qt::TextDate, offsetFromUtc());
+        return QString::fromLatin1(buffer, out - buffer);
+    }
     default:
     case Qt::TextDate: {
         const QPair<QDate, QTime> p = getDateTime(d);
@@ -4518,27 +4600,52 @@ QString QDateTime::toString(Qt::DateFormat format) const
     }
     case Qt::ISODate:
     case Qt::ISODateWithMs: {
-        const QPair<QDate, QTime> p = getDateTime(d);
-        buf = toStringIsoDate(p.first);
-        if (buf.isEmpty())
-            return QString();   // failed to convert
-        buf += u'T' + p.second.toString(format);
-        switch (getSpec(d)) {
-        case Qt::UTC:
-            buf += u'Z';
-            break;
-        case Qt::OffsetFromUTC:
-        case Qt::TimeZone:
-            buf += toOffsetString(Qt::ISODate, offsetFromUtc());
-            break;
-        default:
-            break;
-        }
-        return buf;
+        char buffer[QDateTimePrivate::IsoDateTimeMaxSize];
+        const qsizetype size = QDateTimePrivate::toIsoString(*this, format, buffer);
+        return size ? QString::fromLatin1(buffer, size) : QString(); // empty if failed to convert
     }
     }
 }
 
+/*!
+    \internal
+
+    Writes \a dateTime into \a buffer, which must have room for
+    IsoDateTimeMaxSize characters, in the ISO 8601 form that
+    QDateTime::toString() gives for \a format, Qt::ISODate or
+    Qt::ISODateWithMs. Returns the number of characters written, or zero if
+    the date is outside the years 0 to 9999. Unlike toString(), this does not
+    allocate.
+*/
+qsizetype QDateTimePrivate::toIsoString(const QDateTime &dateTime, Qt::DateFormat format,
+                                        char *buffer)
+{
+    Q_ASSERT(format == Qt::ISODate || format == Qt::ISODateWithMs);
+    if (!dateTime.isValid())
+        return 0;
+    const QPair<QDate, QTime> p = getDateTime(dateTime.d);
+    const auto parts = QGregorianCalendar::partsFromJulian(p.first.toJulianDay());
+    if (!parts.isValid() || parts.year < 0 || parts.year > 9999)
+        return 0;
+
+    char *out = writeIsoDate(buffer, parts);
+    *out++ = 'T';
+    out = writeIsoTime(out, p.second, format);
+    switch (getSpec(dateTime.d)) {
+    case Qt::UTC:
+        *out++ = 'Z';
+        break;
+    case Qt::OffsetFromUTC:
+    case Qt::TimeZone:
+        out = writeOffset(out, Qt::ISODate, dateTime.offsetFromUtc());
+        break;
+    default:
+        break;
+    }
+    Q_ASSERT(out - buffer <= IsoDateTimeMaxSize);
+    return out - buffer;
+}
+
 /*!
     \fn QString QDateTime::toString(const QString &format, QCalendar cal) const
     \fn QString QDateTime::toString(QStringView format, QCalendar cal) const
@@ -5493,6 +5600,85 @@ QDateTime QDateTime::fromSecsSinceEpoch(qint64 secs)
     \sa toString(), QLocale::toDateTime()
 */
 
+/*
+    Parses the fully specified ISO 8601 form, yyyy-MM-ddTHH:mm:ss[.zzz] with an
+    optional Z or ±HH:mm suffix, that Qt::ISODateWithMs and RFC 3339 use,
+    reading the characters in place. Returns nullopt for any other string,
+    including invalid dates and times, leaving the rest of what Qt::ISODate
+    accepts to the general parser in fromString().
+*/
+template <typename View>
+static std::optional<QDateTime> fromIsoStringFast(View string)
+{
+    const qsizetype size = string.size();
+    if (size < 19)
+        return std::nullopt;
+    int year, month, day, hour, minute, second;
+    const auto charAt = [string](qsizetype i) -> char16_t { return string[i].unicode(); };
+    if (!readDigits(string, 0, 4, &year) || charAt(4) != u'-'
+        || !readDigits(string, 5, 2, &month) || charAt(7) != u'-'
+        || !readDigits(string, 8, 2, &day)
+        || (charAt(10) != u'T' && charAt(10) != u't' && charAt(10) != u' ')
+        || !readDigits(string, 11, 2, &hour) || charAt(13) != u':'
+        || !readDigits(string, 14, 2, &minute) || charAt(16) != u':'
+        || !readDigits(string, 17, 2, &second)) {
+        return std::nullopt;
+    }
+    if (year < 1 || hour > 23 || minute >= MINS_PER_HOUR || second >= SECS_PER_MIN)
+        return std::nullopt;
+
+    // Up to three digits of fraction are exact milliseconds:
+    qsizetype pos = 19;
+    int msec = 0;
+    if (pos < size && (charAt(pos) == u'.' || charAt(pos) == u',')) {
+        const qsizetype first = ++pos;
+        while (pos < size && isAsciiDigit(charAt(pos)))
+            ++pos;
+        const qsizetype digits = pos - first;
+        if (digits < 1 || digits > 3 || !readDigits(string, first, digits, &msec))
+            return std::nullopt;
+        for (qsizetype i = digits; i < 3; ++i)
+            msec *= 10;
+    }
+
+    QTimeZone zone = QTimeZone::LocalTime;
+    if (pos < size) {
+        const char16_t sign = charAt(pos);
+        int offsetHour, offsetMinute;
+        if ((sign == u'Z' || sign == u'z') && pos + 1 == size) {
+            zone = QTimeZone::UTC;
+        } else if ((sign == u'+' || sign == u'-') && pos + 6 == size
+                   && readDigits(string, pos + 1, 2, &offsetHour) && charAt(pos + 3) == u':'
+                   && readDigits(string, pos + 4, 2, &offsetMinute)
+                   && offsetHour <= 23 && offsetMinute < MINS_PER_HOUR) {
+            const int offset = (offsetHour * MINS_PER_HOUR + offsetMinute) * SECS_PER_MIN;
+            zone = QTimeZone::fromSecondsAheadOfUtc(sign == u'-' ? -offset : offset);
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    const QDate date(year, month, day);
+    if (!date.isValid())
+        return std::nullopt;
+    return QDateTime(date, QTime(hour, minute, second, msec), zone);
+}
+
+/*!
+    \internal
+
+    Returns the QDateTime that QDateTime::fromString() gives for \a string in
+    the ISO 8601 \a format, Qt::ISODate or Qt::ISODateWithMs. The fully
+    specified forms are parsed without converting \a string to UTF-16.
+*/
+QDateTime QDateTimePrivate::fromIsoString(QLatin1StringView string, Qt::DateFormat format)
+{
+    Q_ASSERT(format == Qt::ISODate || format == Qt::ISODateWithMs);
+    if (std::optional<QDateTime> result = fromIsoStringFast(string))
+        return *std::move(result);
+    return QDateTime::fromString(QString(string), format);
+}
+
 /*!
     \overload
     \since 6.0
@@ -5515,6 +5701,9 @@ QDateTime QDateTime::fromString(QStringView string, Qt::DateFormat format)
     }
     case Qt::ISODate:
     case Qt::ISODateWithMs: {
+        if (std::optional<QDateTime> result = fromIsoStringFast(string))
+            return *std::move(result);
+
         const int size = string.size();
         if (size < 10)
             return QDateTime();
@@ -117,6 +117,13 @@ public:
     static ZoneState localStateAtMillis(qint64 millis, TransitionOptions resolve);
     static QString localNameAtMillis(qint64 millis, DaylightStatus dst); // empty if unknown
 
+#if QT_CONFIG(datestring)
+    // Allocation-free ISO 8601 (RFC 3339) conversions, for Qt::ISODate(WithMs):
+    static constexpr qsizetype IsoDateTimeMaxSize = 32;
+    static qsizetype toIsoString(const QDateTime &dateTime, Qt::DateFormat format, char *buffer);
+    static QDateTime fromIsoString(QLatin1StringView string, Qt::DateFormat format);
+#endif
+
     StatusFlags m_status = StatusFlag(Qt::LocalTime << TimeSpecShift);
     qint64 m_msecs = 0;
     int m_offsetFromUtc = 0;
@@ -22,6 +22,8 @@
 #include "private/qlocale_p.h"
 #include "private/qdatetime_p.h"
 
+#include <optional>
+
 #if QT_CONFIG(icu)
 #include <unicode/ucal.h>
 #endif
@@ -269,8 +271,12 @@ struct QTzTimeZoneCacheEntry
 {
     QList<QTzTransitionTime> m_tranTimes;
     QList<QTzTransitionRule> m_tranRules;
-    QList<QByteArray> m_abbreviations;
+    QList<QString> m_abbreviations;
     QByteArray m_posixRule;
+    // The POSIX rule's transitions, precomputed for the years after
+    // m_tranTimes, or its rule if it has no transitions:
+    QList<QTzTransitionTime> m_posixTimes;
+    std::optional<QTzTransitionRule> m_posixFixedRule;
     QTzTransitionRule m_preZoneRule;
     bool m_hasDst;
 };
@@ -759,6 +759,69 @@ static QList<QTimeZonePrivate::Data> calculatePosixTransitions(const QByteArray
     return result;
 }
 
+// The number of years past the last transition of a zone file (or, lacking
+// any, past 1970) for which the transitions of its POSIX rule are computed
+// when the zone is loaded; lookups outside them evaluate the rule each time.
+static int posixPrecomputedYears()
+{
+    bool ok;
+    const int years = qEnvironmentVariableIntValue("QT_TIMEZONE_PRECOMPUTED_YEARS", &ok);
+    return ok && years >= 0 ? years : 100;
+}
+
+static void precomputePosixTransitions(QTzTimeZoneCacheEntry &entry)
+{
+    if (entry.m_posixRule.isEmpty())
+        return;
+
+    // Start a year before the last transition, as getPosixTransitions() does
+    // for instants just after it:
+    const qint64 lastTranMSecs = entry.m_tranTimes.isEmpty()
+            ? QTimeZonePrivate::invalidMSecs() : entry.m_tranTimes.last().atMSecsSinceEpoch;
+    const int lastYear = entry.m_tranTimes.isEmpty() ? 1970
+            : QDateTime::fromMSecsSinceEpoch(lastTranMSecs, QTimeZone::UTC).date().year();
+    const int years = qMin(posixPrecomputedYears(), int(QDateTime::YearRange::Last) - lastYear);
+    const QList<QTimeZonePrivate::Data> transitions
+            = calculatePosixTransitions(entry.m_posixRule, lastYear - 1, lastYear + years,
+                                        lastTranMSecs);
+
+    const auto ruleIndex = [&entry](const QTimeZonePrivate::Data &data) {
+        qsizetype abbreviationIndex = entry.m_abbreviations.indexOf(data.abbreviation);
+        if (abbreviationIndex < 0) {
+            abbreviationIndex = entry.m_abbreviations.size();
+            entry.m_abbreviations.append(data.abbreviation);
+        }
+        if (abbreviationIndex > std::numeric_limits<quint8>::max())
+            return qsizetype(-1);
+        const QTzTransitionRule rule = { data.standardTimeOffset, data.daylightTimeOffset,
+                                         quint8(abbreviationIndex) };
+        qsizetype index = entry.m_tranRules.indexOf(rule);
+        if (index < 0) {
+            index = entry.m_tranRules.size();
+            entry.m_tranRules.append(rule);
+        }
+        return index > std::numeric_limits<quint8>::max() ? qsizetype(-1) : index;
+    };
+
+    // A rule without DST gives one entry, at the time we passed:
+    if (transitions.size() == 1 && transitions.first().atMSecsSinceEpoch == lastTranMSecs) {
+        const qsizetype index = ruleIndex(transitions.first());
+        if (index >= 0)
+            entry.m_posixFixedRule = entry.m_tranRules.at(index);
+        return;
+    }
+
+    QList<QTzTransitionTime> times;
+    times.reserve(transitions.size());
+    for (const QTimeZonePrivate::Data &data : transitions) {
+        const qsizetype index = ruleIndex(data);
+        if (index < 0)
+            return; // Too many rules to index; evaluate the POSIX rule instead.
+        times.append({ data.atMSecsSinceEpoch, quint8(index) });
+    }
+    entry.m_posixTimes = std::move(times);
+}
+
 // Create the system default time zone
 QTzTimeZonePrivate::QTzTimeZonePrivate()
     : QTzTimeZonePrivate(staticSystemTimeZoneId())
@@ -803,6 +866,7 @@ QTzTimeZoneCacheEntry QTzTimeZoneCache::findEntry(const QByteArray &ianaId)
         if (check.isValid) {
             ret.m_hasDst = check.hasDst;
             ret.m_posixRule = ianaId;
+            precomputePosixTransitions(ret);
         }
         return ret;
     }
@@ -873,7 +937,7 @@ QTzTimeZoneCacheEntry QTzTimeZoneCache::findEntry(const QByteArray &ianaId)
     QList<int> abbrindList;
     abbrindList.reserve(size);
     for (auto it = abbrevMap.cbegin(), end = abbrevMap.cend(); it != end; ++it) {
-        ret.m_abbreviations.append(it.value());
+        ret.m_abbreviations.append(QString::fromUtf8(it.value()));
         abbrindList.append(it.key());
     }
     // Map tz_abbrind from map's keys (as initially read) to abbrindList's
@@ -967,6 +1031,7 @@ QTzTimeZoneCacheEntry QTzTimeZoneCache::findEntry(const QByteArray &ianaId)
         ret.m_tranTimes.append(tran);
     }
 
+    precomputePosixTransitions(ret);
     return ret;
 }
 
@@ -1131,7 +1196,7 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::dataForTzTransition(QTzTransitionTime
 QTimeZonePrivate::Data QTzTimeZonePrivate::dataFromRule(QTzTransitionRule rule,
                                                         qint64 msecsSinceEpoch) const
 {
-    return { QString::fromUtf8(cached_data.m_abbreviations.at(rule.abbreviationIndex)),
+    return { cached_data.m_abbreviations.at(rule.abbreviationIndex),
              msecsSinceEpoch, rule.stdOffset + rule.dstOffset, rule.stdOffset, rule.dstOffset };
 }
 
@@ -1149,6 +1214,18 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::data(qint64 forMSecsSinceEpoch) const
     // and we have a POSIX rule, then use it:
     if (!cached_data.m_posixRule.isEmpty()
         && (tranCache().isEmpty() || tranCache().last().atMSecsSinceEpoch < forMSecsSinceEpoch)) {
+        if (cached_data.m_posixFixedRule)
+            return dataFromRule(*cached_data.m_posixFixedRule, forMSecsSinceEpoch);
+        const auto &posixTimes = cached_data.m_posixTimes;
+        if (!posixTimes.isEmpty() && posixTimes.first().atMSecsSinceEpoch <= forMSecsSinceEpoch
+            && forMSecsSinceEpoch < posixTimes.last().atMSecsSinceEpoch) {
+            auto it = std::partition_point(posixTimes.cbegin(), posixTimes.cend(),
+                                           [forMSecsSinceEpoch] (const QTzTransitionTime &at) {
+                                               return at.atMSecsSinceEpoch <= forMSecsSinceEpoch;
+                                           });
+            --it;
+            return dataFromRule(cached_data.m_tranRules.at(it->ruleIndex), forMSecsSinceEpoch);
+        }
         QList<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(forMSecsSinceEpoch);
         auto it = std::partition_point(posixTrans.cbegin(), posixTrans.cend(),
                                        [forMSecsSinceEpoch] (const QTimeZonePrivate::Data &at) {
@@ -1187,6 +1264,15 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::nextTransition(qint64 afterMSecsSince
     // and we have a POSIX rule, then use it:
     if (!cached_data.m_posixRule.isEmpty()
         && (tranCache().isEmpty() || tranCache().last().atMSecsSinceEpoch < afterMSecsSinceEpoch)) {
+        const auto &posixTimes = cached_data.m_posixTimes;
+        if (!posixTimes.isEmpty() && posixTimes.first().atMSecsSinceEpoch <= afterMSecsSinceEpoch
+            && afterMSecsSinceEpoch < posixTimes.last().atMSecsSinceEpoch) {
+            auto it = std::partition_point(posixTimes.cbegin(), posixTimes.cend(),
+                                           [afterMSecsSinceEpoch] (const QTzTransitionTime &at) {
+                                               return at.atMSecsSinceEpoch <= afterMSecsSinceEpoch;
+                                           });
+            return dataForTzTransition(*it);
+        }
         QList<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(afterMSecsSinceEpoch);
         auto it = std::partition_point(posixTrans.cbegin(), posixTrans.cend(),
                                        [afterMSecsSinceEpoch] (const QTimeZonePrivate::Data &at) {
@@ -1210,6 +1296,15 @@ QTimeZonePrivate::Data QTzTimeZonePrivate::previousTransition(qint64 beforeMSecs
     // and we have a POSIX rule, then use it:
     if (!cached_data.m_posixRule.isEmpty()
         && (tranCache().isEmpty() || tranCache().last().atMSecsSinceEpoch < beforeMSecsSinceEpoch)) {
+        const auto &posixTimes = cached_data.m_posixTimes;
+        if (!posixTimes.isEmpty() && posixTimes.first().atMSecsSinceEpoch < beforeMSecsSinceEpoch
+            && beforeMSecsSinceEpoch <= posixTimes.last().atMSecsSinceEpoch) {
+            auto it = std::partition_point(posixTimes.cbegin(), posixTimes.cend(),
+                                           [beforeMSecsSinceEpoch] (const QTzTransitionTime &at) {
+                                               return at.atMSecsSinceEpoch < beforeMSecsSinceEpoch;
+                                           });
+            return dataForTzTransition(*--it);
+        }
         QList<QTimeZonePrivate::Data> posixTrans = getPosixTransitions(beforeMSecsSinceEpoch);
         auto it = std::partition_point(posixTrans.cbegin(), posixTrans.cend(),
                                        [beforeMSecsSinceEpoch] (const QTimeZonePrivate::Data &at) {
@@ -69,7 +69,13 @@ void BitOStream::write(QByteArrayView src, bool compressed)
     if (compressed && byteLen) {
         const auto bitLen = huffman_encoded_bit_length(src);
         Q_ASSERT(bitLen && std::numeric_limits<quint32>::max() >= (bitLen + 7) / 8);
-        byteLen = (bitLen + 7) / 8;
+        // Strings of unusual characters grow with Huffman coding (codes are
+        // up to 30 bits long), send those as they are:
+        compressed = (bitLen + 7) / 8 < byteLen;
+        if (compressed)
+            byteLen = (bitLen + 7) / 8;
+    }
+    if (compressed) {
         writeBits(uchar(1), 1); // bit set - compressed
     } else {
         writeBits(uchar(0), 1); // no compression.
@@ -269,7 +275,7 @@ bool BitIStream::read(QByteArray *dstPtr)
                 return true;
             }
 
-            BitIStream slice(first + offset / 8, first + offset / 8 + len);
+            const QByteArrayView slice(first + offset / 8, len);
             if (huffman_decode_string(slice, &dst)) {
                 offset += quint64(len) * 8;
                 return true;
@@ -55,6 +55,8 @@ public:
 private:
     Q_DISABLE_COPY_MOVE(BitOStream);
 
+    friend void huffman_encode_string(QByteArrayView inputData, BitOStream &outputStream);
+
     std::vector<uchar> &buffer;
     quint64 bitsSet;
 };
@@ -6,8 +6,10 @@
 
 #include <QtCore/qbytearray.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qhashfunctions.h>
 
 #include <limits>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
@@ -97,6 +99,24 @@ bool is_request_pseudo_header(QByteArrayView name)
            name == ":authority" || name == ":path";
 }
 
+// Fields whose value typically changes with every request: adding each
+// value to the dynamic table would only evict entries worth keeping.
+bool is_volatile_field(QByteArrayView name)
+{
+    return name == ":path" || name == "content-length";
+}
+
+// HPACK, 7.1.3: values that could be guessed by probing the compression
+// state are not indexed, neither by us nor by intermediaries. Credentials
+// never are, since a long value can still have little entropy (like Basic
+// credentials); as in nghttp2, only short cookies are treated the same.
+bool is_sensitive_field(const HeaderField &field)
+{
+    if (field.name == "authorization" || field.name == "proxy-authorization")
+        return true;
+    return field.name == "cookie" && field.value.size() < 20;
+}
+
 } // unnamed namespace
 
 Encoder::Encoder(quint32 size, bool compress)
@@ -250,8 +270,6 @@ bool Encoder::encodeRequestPseudoHeaders(BitOStream &outputStream,
 
 bool Encoder::encodeHeaderField(BitOStream &outputStream, const HeaderField &field)
 {
-    // TODO: at the moment we never use LiteralNo/Never Indexing ...
-
     // Here we try:
     // 1. indexed
     // 2. literal indexed with indexed name/literal value
@@ -259,15 +277,34 @@ bool Encoder::encodeHeaderField(BitOStream &outputStream, const HeaderField &fie
     if (const auto index = lookupTable.indexOf(field.name, field.value))
         return encodeIndexedField(outputStream, index);
 
+    const BitPattern &fieldType = literalFieldType(field);
     if (const auto index = lookupTable.indexOf(field.name)) {
-        return encodeLiteralField(outputStream, LiteralIncrementalIndexing,
+        return encodeLiteralField(outputStream, fieldType,
                                   index, field.value, compressStrings);
     }
 
-    return encodeLiteralField(outputStream, LiteralIncrementalIndexing,
+    return encodeLiteralField(outputStream, fieldType,
                               field.name, field.value, compressStrings);
 }
 
+const BitPattern &Encoder::literalFieldType(const HeaderField &field)
+{
+    if (is_sensitive_field(field))
+        return LiteralNeverIndexing;
+
+    if (is_volatile_field(field.name)) {
+        // Index a volatile field once its value is seen a second time, so
+        // that values that do repeat (like an API's few paths) still end up
+        // in the dynamic table:
+        const size_t hash = qHash(field.value, qHash(field.name));
+        size_t &recent = recentValues[hash % recentValues.size()];
+        if (std::exchange(recent, hash) != hash)
+            return LiteralNoIndexing;
+    }
+
+    return LiteralIncrementalIndexing;
+}
+
 bool Encoder::encodeMethod(BitOStream &outputStream, const HeaderField &field)
 {
     Q_ASSERT(field.name == ":method");
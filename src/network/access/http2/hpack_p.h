@@ -19,6 +19,7 @@
 
 #include <QtCore/qglobal.h>
 
+#include <array>
 #include <vector>
 
 QT_BEGIN_NAMESPACE
@@ -75,8 +76,13 @@ private:
                             const QByteArray &value,
                             bool withCompression);
 
+    const BitPattern &literalFieldType(const HeaderField &field);
+
     FieldLookupTable lookupTable;
     bool compressStrings;
+    // Hashes of recently sent values of fields that are indexed only when
+    // their value repeats:
+    std::array<size_t, 64> recentValues = {};
 };
 
 class Q_AUTOTEST_EXPORT Decoder
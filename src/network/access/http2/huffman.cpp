@@ -6,7 +6,7 @@
 
 #include <QtCore/qbytearray.h>
 
-#include <algorithm>
+#include <vector>
 #include <limits>
 
 QT_BEGIN_NAMESPACE
@@ -24,32 +24,10 @@ namespace HPack
     code length. All codes were left-aligned - for implementation
     convenience.
 
-    Using binary trees to implement decoding would be prohibitively
-    expensive (both memory and time-wise). Instead we use a table-based
-    approach and any given code itself works as an index into such table(s).
-    We have 256 possible byte values and code lengths in
-    a range [5, 26]. This would require a huge table (and most of entries
-    would be 'wasted', since we only have to encode 256 elements).
-    Instead we use multi-level tables. The first level table
-    is using 9-bit length index; some entries in this table are 'terminal',
-    some reference the next level table(s).
-
-    For example, bytes with values 48 and 49 (ASCII codes for '0' and '1')
-    both have code length 5, Huffman codes are: 00000 and 00001. They
-    both are placed in the 'root' table,
-    the 'root' table has index length == 9:
-    [00000 | 4 remaining bits]
-     ...
-    [00001 | 4 remaining bits]
-
-    All entries with indices between these two will 'point' to value 48
-    with bitLength == 5 so that bit stream (for example) 000001010 will be
-    decoded as: 48 + "put 1010 back into bitstream".
-
-    A good description can be found here:
-    http://commandlinefanatic.com/cgi-bin/showarticle.cgi?article=art007
-    or just google "Efficient Huffman Decoding".
-    Also see comments below about 'filling holes'.
+    Encoding appends each symbol's code to a 64-bit accumulator and
+    writes the stream out four bytes at a time. Decoding walks the code's
+    tree four bits at a time, with transitions computed once for every inner
+    node and nibble (see HuffmanDecoder).
 */
 
 namespace
@@ -316,30 +294,6 @@ const CodeEntry staticHuffmanCodeTable[]
     {256, 0xfffffffcul, 30}   // EOS 11111111|11111111|11111111|111111
 };
 
-void write_huffman_code(BitOStream &outputStream, const CodeEntry &code)
-{
-    // Append octet by octet.
-    auto bitLength = code.bitLength;
-    const auto hc = code.huffmanCode >> (32 - bitLength);
-
-    if (bitLength > 24) {
-        outputStream.writeBits(uchar(hc >> 24), bitLength - 24);
-        bitLength = 24;
-    }
-
-    if (bitLength > 16) {
-        outputStream.writeBits(uchar(hc >> 16), bitLength - 16);
-        bitLength = 16;
-    }
-
-    if (bitLength > 8) {
-        outputStream.writeBits(uchar(hc >> 8), bitLength - 8);
-        bitLength = 8;
-    }
-
-    outputStream.writeBits(uchar(hc), bitLength);
-}
-
 }
 
 // That's from HPACK's specs - we deal with octets.
@@ -348,191 +302,161 @@ static_assert(std::numeric_limits<uchar>::digits == 8, "octets expected");
 quint64 huffman_encoded_bit_length(QByteArrayView inputData)
 {
     quint64 bitLength = 0;
-    for (int i = 0, e = inputData.size(); i < e; ++i)
-        bitLength += staticHuffmanCodeTable[int(inputData[i])].bitLength;
+    for (const char c : inputData)
+        bitLength += staticHuffmanCodeTable[uchar(c)].bitLength;
 
     return bitLength;
 }
 
 void huffman_encode_string(QByteArrayView inputData, BitOStream &outputStream)
 {
-    for (int i = 0, e = inputData.size(); i < e; ++i) {
-        const auto value = uchar(inputData[i]);
-        write_huffman_code(outputStream, staticHuffmanCodeTable[value]);
+    std::vector<uchar> &buffer = outputStream.buffer;
+    // The accumulator is filled from its most significant bit, starting
+    // with the bits already in the last, partially used byte:
+    quint64 bits = 0;
+    quint32 bitCount = quint32(outputStream.bitsSet % 8);
+    if (bitCount) {
+        bits = quint64(buffer.back()) << 56;
+        buffer.pop_back();
     }
 
-    // Pad bits ...
-    if (outputStream.bitLength() % 8)
-        outputStream.writeBits(0xff, 8 - outputStream.bitLength() % 8);
-}
+    const auto flush = [&buffer, &bits, &bitCount](quint32 byteCount) {
+        for (quint32 i = 0; i < byteCount; ++i)
+            buffer.push_back(uchar(bits >> (56 - 8 * i)));
+        bits <<= 8 * byteCount;
+        bitCount -= 8 * byteCount;
+    };
+
+    for (const char c : inputData) {
+        // Codes are left-aligned and at most 30 bits long, and less than 32
+        // bits are pending, so they fit:
+        const CodeEntry &code = staticHuffmanCodeTable[uchar(c)];
+        bits |= quint64(code.huffmanCode) << (32 - bitCount);
+        bitCount += code.bitLength;
+        if (bitCount >= 32)
+            flush(4);
+    }
 
-static constexpr
-bool padding_is_valid(quint32 chunk, quint32 nBits)
-{
-    Q_ASSERT(nBits);
+    // Pad bits with the most significant bits of EOS, that is with ones:
+    if (const quint32 padding = (8 - bitCount % 8) % 8) {
+        bits |= ((quint64(1) << padding) - 1) << (64 - bitCount - padding);
+        bitCount += padding;
+    }
+    flush(bitCount / 8);
 
-    // HPACK, 5.2: "A padding strictly longer than 7 bits MUST be
-    // treated as a decoding error."
-    if (nBits > 7)
-        return false;
-    // HPACK, 5.2:
-    // "A padding not corresponding to the most significant bits
-    // of the code for the EOS symbol MUST be treated as a decoding error."
-    return (chunk >> (32 - nBits)) == quint32((1 << nBits) - 1);
+    outputStream.bitsSet = 8 * quint64(buffer.size());
 }
 
 HuffmanDecoder::HuffmanDecoder()
-    : minCodeLength()
 {
-    const auto nCodes = sizeof staticHuffmanCodeTable / sizeof staticHuffmanCodeTable[0];
-
-    std::vector<CodeEntry> symbols(staticHuffmanCodeTable, staticHuffmanCodeTable + nCodes);
-    // Now we sort: by bit length first (in the descending order) and by the symbol
-    // value (descending). Descending order: to make sure we do not create prefix tables with
-    // short 'indexLength' first and having longer codes that do not fit into such tables later.
-    std::sort(symbols.begin(), symbols.end(), [](const CodeEntry &code1, const CodeEntry &code2) {
-        if (code1.bitLength == code2.bitLength)
-            return code1.byteValue > code2.byteValue;
-        return code1.bitLength > code2.bitLength;
-    });
-
-    minCodeLength = symbols.back().bitLength; // The shortest one, currently it's 5.
-
-    // TODO: add a verification - Huffman codes
-    // within a given bit length range also
-    // should be in descending order.
-
-    // Initialize 'prefixTables' and 'tableData'.
-    addTable(0, quint32(BitConstants::rootPrefix)); // 'root' table.
-
-    for (const auto &s : symbols) {
-        quint32 tableIndex = 0;
-        while (true) {
-            Q_ASSERT(tableIndex < prefixTables.size());
-            // Note, by value - since prefixTables will be updated in between.
-            const auto table = prefixTables[tableIndex];
-            // We skip prefixed bits (if any) and use indexed bits only:
-            const auto entryIndex = s.huffmanCode << table.prefixLength >> (32 - table.indexLength);
-            // Again, by value.
-            PrefixTableEntry entry = tableEntry(table, entryIndex);
-            // How many bits were coded by previous tables and this table:
-            const auto codedLength = table.prefixLength + table.indexLength;
-            if (codedLength < s.bitLength) {
-                // We have to add a new prefix table ... (if it's not done yet).
-                if (!entry.bitLength) {
-                    entry.nextTable = addTable(codedLength, std::min<quint32>(quint32(BitConstants::childPrefix),
-                                                                              s.bitLength - codedLength));
-                    entry.bitLength = s.bitLength;
-                    entry.byteValue = s.byteValue;
-                    setTableEntry(table, entryIndex, entry);
-                }
-                tableIndex = entry.nextTable;
-            } else {
-                // We found the slot for our code (terminal entry):
-                entry.byteValue = s.byteValue;
-                entry.bitLength = s.bitLength;
-                // Refer to our own table as 'nextTable':
-                entry.nextTable = tableIndex;
-                setTableEntry(table, entryIndex, entry);
-                break;
+    // Build the code's tree, with the inner nodes first numbered in the
+    // order they are created, so that the root is 0:
+    struct Node
+    {
+        int children[2] = { -1, -1 };
+        int symbol = -1;
+        int innerIndex = -1;
+        quint32 depth = 0;
+        bool allOnes = true;
+    };
+    std::vector<Node> nodes(1);
+    nodes[0].innerIndex = 0;
+    int innerCount = 1;
+
+    for (const CodeEntry &code : staticHuffmanCodeTable) {
+        int node = 0;
+        for (quint32 i = 0; i < code.bitLength; ++i) {
+            const int bit = (code.huffmanCode >> (31 - i)) & 1;
+            if (nodes[node].children[bit] == -1) {
+                Node child;
+                child.depth = nodes[node].depth + 1;
+                child.allOnes = nodes[node].allOnes && bit;
+                if (i + 1 < code.bitLength)
+                    child.innerIndex = innerCount++;
+                else
+                    child.symbol = int(code.byteValue);
+                nodes[node].children[bit] = int(nodes.size());
+                nodes.push_back(child);
             }
+            node = nodes[node].children[bit];
         }
     }
+    Q_ASSERT(innerCount == 256);
 
-    // Now, we have a table(s) and have to fill 'holes' to
-    // 'fix' terminal entries.
-    for (const auto &table : prefixTables) {
-        const quint32 codedLength = table.prefixLength + table.indexLength;
-        for (quint32 j = 0; j < table.size();) {
-            const PrefixTableEntry &entry = tableEntry(table, j);
-            if (entry.bitLength && entry.bitLength < codedLength) {
-                const quint32 range = 1 << (codedLength - entry.bitLength);
-                for (quint32 k = 1; k < range; ++k)
-                    setTableEntry(table, j + k, entry);
-                j += range;
-            } else {
-                ++j;
+    std::vector<int> innerNodes(innerCount);
+    for (int i = 0, e = int(nodes.size()); i < e; ++i) {
+        if (nodes[i].innerIndex != -1)
+            innerNodes[nodes[i].innerIndex] = i;
+    }
+
+    for (int state = 0; state < innerCount; ++state) {
+        for (quint32 nibble = 0; nibble < 16; ++nibble) {
+            HuffmanTransition &transition = transitions[state][nibble];
+            transition = {};
+            int node = innerNodes[state];
+            for (int i = 3; i >= 0; --i) {
+                node = nodes[node].children[(nibble >> i) & 1];
+                Q_ASSERT(node != -1); // The code is complete.
+                if (nodes[node].symbol == 256) {
+                    // EOS (256) == compression error (HPACK).
+                    transition.flags = HuffmanTransition::Fail;
+                    break;
+                }
+                if (nodes[node].symbol != -1) {
+                    transition.flags |= HuffmanTransition::Emit;
+                    transition.symbol = quint16(nodes[node].symbol);
+                    node = 0;
+                }
             }
+            if (transition.flags & HuffmanTransition::Fail)
+                continue;
+            transition.state = quint8(nodes[node].innerIndex);
+            // HPACK, 5.2: "A padding strictly longer than 7 bits MUST be
+            // treated as a decoding error. A padding not corresponding to
+            // the most significant bits of the code for the EOS symbol MUST
+            // be treated as a decoding error."
+            if (nodes[node].allOnes && nodes[node].depth <= 7)
+                transition.flags |= HuffmanTransition::Accept;
         }
     }
 }
 
-bool HuffmanDecoder::decodeStream(BitIStream &inputStream, QByteArray &outputBuffer)
+bool HuffmanDecoder::decode(QByteArrayView input, QByteArray *outputBuffer) const
 {
-    while (true) {
-        quint32 chunk = 0;
-        const quint32 readBits = inputStream.peekBits(inputStream.streamOffset(), 32, &chunk);
-        if (!readBits)
-            return !inputStream.hasMoreBits();
-
-        if (readBits < minCodeLength) {
-            inputStream.skipBits(readBits);
-            return padding_is_valid(chunk, readBits);
-        }
-
-        quint32 tableIndex = 0;
-        const PrefixTable *table = &prefixTables[tableIndex];
-        quint32 entryIndex = chunk >> (32 - table->indexLength);
-        PrefixTableEntry entry = tableEntry(*table, entryIndex);
-
-        while (true) {
-            if (entry.nextTable == tableIndex)
-                break;
-
-            tableIndex = entry.nextTable;
-            table = &prefixTables[tableIndex];
-            entryIndex = chunk << table->prefixLength >> (32 - table->indexLength);
-            entry = tableEntry(*table, entryIndex);
-        }
-
-        if (entry.bitLength > readBits) {
-            inputStream.skipBits(readBits);
-            return padding_is_valid(chunk, readBits);
-        }
-
-        if (!entry.bitLength || entry.byteValue == 256) {
-            //EOS (256) == compression error (HPACK).
-            inputStream.skipBits(readBits);
+    // At most one symbol per 5 bits:
+    const qsizetype oldSize = outputBuffer->size();
+    outputBuffer->resize(oldSize + input.size() * 8 / 5);
+    char *out = outputBuffer->data() + oldSize;
+
+    quint32 state = 0;
+    quint8 flags = HuffmanTransition::Accept;
+    const auto step = [this, &state, &flags, &out](quint32 nibble) {
+        const HuffmanTransition &transition = transitions[state][nibble];
+        if (transition.flags & HuffmanTransition::Emit)
+            *out++ = char(transition.symbol);
+        state = transition.state;
+        flags = transition.flags;
+        return !(flags & HuffmanTransition::Fail);
+    };
+
+    for (const char c : input) {
+        const auto byte = uchar(c);
+        if (!step(byte >> 4) || !step(byte & 0xf)) {
+            outputBuffer->resize(oldSize);
             return false;
         }
-
-        outputBuffer.append(entry.byteValue);
-        inputStream.skipBits(entry.bitLength);
     }
 
-    return false;
-}
-
-quint32 HuffmanDecoder::addTable(quint32 prefix, quint32 index)
-{
-    PrefixTable newTable{prefix, index};
-    newTable.offset = quint32(tableData.size());
-    prefixTables.push_back(newTable);
-    // Add entries for this table:
-    tableData.resize(tableData.size() + newTable.size());
-
-    return quint32(prefixTables.size() - 1);
-}
-
-PrefixTableEntry HuffmanDecoder::tableEntry(const PrefixTable &table, quint32 index)
-{
-    Q_ASSERT(index < table.size());
-    return tableData[table.offset + index];
-}
-
-void HuffmanDecoder::setTableEntry(const PrefixTable &table, quint32 index,
-                                   const PrefixTableEntry &entry)
-{
-    Q_ASSERT(index < table.size());
-    tableData[table.offset + index] = entry;
+    outputBuffer->resize(out - outputBuffer->constData());
+    return flags & HuffmanTransition::Accept;
 }
 
-bool huffman_decode_string(BitIStream &inputStream, QByteArray *outputBuffer)
+bool huffman_decode_string(QByteArrayView inputData, QByteArray *outputBuffer)
 {
     Q_ASSERT(outputBuffer);
 
-    static HuffmanDecoder decoder;
-    return decoder.decodeStream(inputStream, *outputBuffer);
+    static const HuffmanDecoder decoder;
+    return decoder.decode(inputData, outputBuffer);
 }
 
 }
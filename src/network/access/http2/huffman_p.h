@@ -36,94 +36,38 @@ class BitOStream;
 quint64 huffman_encoded_bit_length(QByteArrayView inputData);
 void huffman_encode_string(QByteArrayView inputData, BitOStream &outputStream);
 
-// PrefixTable:
-// Huffman codes with a small bit length
-// fit into a table (these are 'terminal' symbols),
-// codes with longer codes require additional
-// tables, so several symbols will have the same index
-// in a table - pointing into the next table.
-// Every table has an 'indexLength' - that's
-// how many bits can fit in table's indices +
-// 'prefixLength' - how many bits were addressed
-// by its 'parent' table(s).
-// All PrefixTables are kept in 'prefixTables' array.
-// PrefixTable itself does not have any entries,
-// it just holds table's prefix/index + 'offset' -
-// there table's data starts in an array of all
-// possible entries ('tableData').
-
-struct PrefixTable
+// The decoder is a finite state machine over the Huffman code's tree: its
+// 256 states are the tree's inner nodes (the root being state 0), and it
+// consumes the input four bits at a time. Since codes are at least five
+// bits long, a nibble completes at most one symbol, so a transition moves
+// to the next state and emits zero or one symbol - it never needs to look
+// at single bits or peek ahead.
+
+struct HuffmanTransition
 {
-    PrefixTable()
-        : prefixLength(),
-          indexLength(),
-          offset()
-    {
-    }
-
-    PrefixTable(quint32 prefix, quint32 index)
-        : prefixLength(prefix),
-          indexLength(index),
-          offset()
-    {
-    }
-
-    quint32 size()const
-    {
-        // Number of entries table contains:
-        return 1 << indexLength;
-    }
-
-    quint32 prefixLength;
-    quint32 indexLength;
-    quint32 offset;
-};
-
-// Table entry is either a terminal entry (thus probably the code found)
-// or points into another table ('nextTable' - index into
-// 'prefixTables' array). If it's a terminal, 'nextTable' index
-// refers to the same table.
-
-struct PrefixTableEntry
-{
-    PrefixTableEntry()
-        : bitLength(),
-          nextTable(),
-          byteValue()
-    {
-    }
+    enum Flag : quint8 {
+        Emit = 0x1,     // 'symbol' was completed
+        Fail = 0x2,     // the EOS symbol was decoded
+        Accept = 0x4    // the string may end in the new state
+    };
 
-    quint32 bitLength;
-    quint32 nextTable;
-    quint32 byteValue;
+    quint8 state;
+    quint8 flags;
+    quint16 symbol;
 };
 
-class BitIStream;
-
 class HuffmanDecoder
 {
 public:
-    enum class BitConstants
-    {
-        rootPrefix = 9,
-        childPrefix = 6
-    };
-
     HuffmanDecoder();
 
-    bool decodeStream(BitIStream &inputStream, QByteArray &outputBuffer);
+    bool decode(QByteArrayView input, QByteArray *outputBuffer) const;
 
 private:
-    quint32 addTable(quint32 prefixLength, quint32 indexLength);
-    PrefixTableEntry tableEntry(const PrefixTable &table, quint32 index);
-    void setTableEntry(const PrefixTable &table, quint32 index, const PrefixTableEntry &entry);
-
-    std::vector<PrefixTable> prefixTables;
-    std::vector<PrefixTableEntry> tableData;
-    quint32 minCodeLength;
+    HuffmanTransition transitions[256][16];
 };
 
-bool huffman_decode_string(BitIStream &inputStream, QByteArray *outputBuffer);
+bool huffman_decode_string(QByteArrayView inputData, QByteArray *outputBuffer);
 
 } // namespace HPack
 
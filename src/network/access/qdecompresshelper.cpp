@@ -6,6 +6,7 @@
 #include <QtCore/private/qbytearray_p.h>
 #include <QtCore/qiodevice.h>
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
 
 #include <limits>
 #include <zlib.h>
@@ -381,6 +382,9 @@ qsizetype QDecompressHelper::readInternal(char *data, qsizetype maxSize)
     if (!hasDataInternal())
         return 0;
 
+    // timed once per chunk handed to the decoder
+    QElapsedTimer timer;
+    timer.start();
     qsizetype bytesRead = -1;
     switch (contentEncoding) {
     case None:
@@ -397,6 +401,7 @@ qsizetype QDecompressHelper::readInternal(char *data, qsizetype maxSize)
         bytesRead = readZstandard(data, maxSize);
         break;
     }
+    decoderNSecs += timer.nsecsElapsed();
     if (bytesRead == -1)
         clear();
 
@@ -553,6 +558,7 @@ void QDecompressHelper::clear()
     totalBytesRead = 0;
     totalUncompressedBytes = 0;
     totalCompressedBytes = 0;
+    decoderNSecs = 0;
 
     errorStr.clear();
 }
@@ -57,6 +57,12 @@ public:
 
     void setDecompressedSafetyCheckThreshold(qint64 threshold);
 
+    // Throughput counters since setEncoding(); the time is that spent in the
+    // decoder, in nanoseconds
+    qint64 compressedBytes() const { return totalCompressedBytes; }
+    qint64 decompressedBytes() const { return totalUncompressedBytes; }
+    qint64 decompressionTime() const { return decoderNSecs; }
+
     static bool isSupportedEncoding(QByteArrayView encoding);
     static QByteArrayList acceptedEncoding();
 
@@ -93,6 +99,7 @@ private:
     qint64 totalUncompressedBytes = 0;
     qint64 totalCompressedBytes = 0;
     qint64 totalBytesRead = 0;
+    qint64 decoderNSecs = 0;
 
     ContentEncoding contentEncoding = None;
 
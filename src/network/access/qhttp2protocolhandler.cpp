@@ -183,6 +183,22 @@ void QHttp2ProtocolHandler::ensureClientPrefaceSent()
         sendClientPreface();
 }
 
+bool QHttp2ProtocolHandler::checkIdleConnection()
+{
+    // Streams in flight keep the connection busy enough for us to notice
+    // if it's gone, so we only ping an idle connection:
+    if (goingAway || !prefaceSent || !activeStreams.isEmpty())
+        return true;
+
+    if (waitingForPingACK)
+        return false;
+
+    frameWriter.start(FrameType::PING, FrameFlag::EMPTY, connectionStreamID);
+    frameWriter.append(quint64(0));
+    waitingForPingACK = frameWriter.write(*m_socket);
+    return waitingForPingACK;
+}
+
 void QHttp2ProtocolHandler::_q_uploadDataReadyRead()
 {
     if (!sender()) // QueuedConnection, firing after sender (byte device) was deleted.
@@ -313,11 +329,13 @@ bool QHttp2ProtocolHandler::sendRequest()
             m_connection->preConnectFinished();
             emit pair.second->finished();
             it = requests.erase(it);
-            if (!requests.size()) {
+            if (!requests.size() && !m_connection->d_func()->warmChannelCount) {
                 // Normally, after a connection was established and H2
                 // was negotiated, we send a client preface. connectToHostEncrypted
                 // though is not meant to send any data, it's just a 'preconnect'.
-                // Thus we return early:
+                // Thus we return early. A connection that is kept warm (see
+                // QNetworkAccessManager::warmUpConnections()) instead exchanges
+                // SETTINGS now, so the first real request does not wait for it.
                 return true;
             }
         } else {
@@ -778,16 +796,20 @@ void QHttp2ProtocolHandler::handlePUSH_PROMISE()
 
 void QHttp2ProtocolHandler::handlePING()
 {
-    // Since we're implementing a client and not
-    // a server, we only reply to a PING, ACKing it.
+    // Other than the PINGs of checkIdleConnection(), we
+    // only reply to a PING, ACKing it.
     Q_ASSERT(inboundFrame.type() == FrameType::PING);
     Q_ASSERT(m_socket);
 
     if (inboundFrame.streamID() != connectionStreamID)
         return connectionError(PROTOCOL_ERROR, "PING on invalid stream");
 
-    if (inboundFrame.flags() & FrameFlag::ACK)
-        return connectionError(PROTOCOL_ERROR, "unexpected PING ACK");
+    if (inboundFrame.flags() & FrameFlag::ACK) {
+        if (!waitingForPingACK)
+            return connectionError(PROTOCOL_ERROR, "unexpected PING ACK");
+        waitingForPingACK = false;
+        return;
+    }
 
     Q_ASSERT(inboundFrame.dataSize() == 8);
 
@@ -1335,6 +1357,8 @@ quint32 QHttp2ProtocolHandler::createNewStream(const HttpMessagePair &message, b
     replyPrivate->connection = m_connection;
     replyPrivate->connectionChannel = m_channel;
     reply->setHttp2WasUsed(true);
+    // Stream 1 is the first one on this connection
+    replyPrivate->statisticsDispatched(newStreamID > 1, true);
     streamIDs.insert(reply, newStreamID);
     connect(reply, SIGNAL(destroyed(QObject*)),
             this, SLOT(_q_replyDestroyed(QObject*)));
@@ -1432,6 +1456,7 @@ void QHttp2ProtocolHandler::deleteActiveStream(quint32 streamID)
     if (const auto it = activeStreams.constFind(streamID); it != activeStreams.cend()) {
         const Stream &stream = it.value();
         if (stream.reply()) {
+            stream.reply()->d_func()->statisticsDone();
             stream.reply()->disconnect(this);
             streamIDs.remove(stream.reply());
         }
@@ -58,6 +58,9 @@ public:
 
     Q_INVOKABLE void handleConnectionClosure();
     Q_INVOKABLE void ensureClientPrefaceSent();
+    // Health check for an idle connection kept warm by QHttpNetworkConnection:
+    // sends a PING, returns false if the previous one was never acknowledged.
+    bool checkIdleConnection();
 
 private slots:
     void _q_uploadDataReadyRead();
@@ -120,6 +123,8 @@ private:
     // SETTINGS only once, immediately after
     // the client's preface 24-byte message.
     bool waitingForSettingsACK = false;
+    // We only have one PING of our own in flight, see checkIdleConnection():
+    bool waitingForPingACK = false;
 
     inline static const quint32 maxAcceptableTableSize = 16 * HPack::FieldLookupTable::DefaultSize;
     // HTTP/2 4.3: Header compression is stateful. One compression context and
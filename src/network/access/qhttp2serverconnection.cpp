@@ -0,0 +1,1147 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qhttp2serverconnection_p.h"
+
+#include "http2/bitstreams_p.h"
+
+#include <QtNetwork/qabstractsocket.h>
+#include <QtCore/qloggingcategory.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qdebug.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Http2;
+
+namespace
+{
+
+// We stop handing DATA frames to the socket once this much is waiting to be
+// written, so that the order in which streams are served is decided by
+// their priorities, not by the order in which the application queued data:
+constexpr qint64 socketHighWaterMark = 256 * 1024;
+// Deficit round robin: per round, a stream is credited with its weight
+// multiplied by this many bytes:
+constexpr qint64 bytesPerWeight = 1024;
+
+std::vector<uchar> assemble_hpack_block(const std::vector<Http2::Frame> &frames)
+{
+    std::vector<uchar> hpackBlock;
+
+    size_t total = 0;
+    for (const auto &frame : frames)
+        total += frame.hpackBlockSize();
+
+    if (!total)
+        return hpackBlock;
+
+    hpackBlock.resize(total);
+    auto dst = hpackBlock.begin();
+    for (const auto &frame : frames) {
+        if (const auto hpackBlockSize = frame.hpackBlockSize()) {
+            const uchar *src = frame.hpackBlockBegin();
+            std::copy(src, src + hpackBlockSize, dst);
+            dst += hpackBlockSize;
+        }
+    }
+
+    return hpackBlock;
+}
+
+// HTTP/2 8.1.2.3: a request must contain exactly one :method and, unless it
+// is a CONNECT request, non-empty :scheme and :path. Pseudo-header fields
+// must precede regular fields and response pseudo-headers are not allowed.
+bool is_valid_request(const HPack::HttpHeader &header)
+{
+    QByteArray method;
+    bool hasScheme = false;
+    bool hasPath = false;
+    bool regularFieldSeen = false;
+    for (const auto &field : header) {
+        if (!field.name.startsWith(':')) {
+            regularFieldSeen = true;
+            continue;
+        }
+        if (regularFieldSeen)
+            return false;
+        if (field.name == ":method") {
+            if (!method.isEmpty() || field.value.isEmpty())
+                return false;
+            method = field.value;
+        } else if (field.name == ":scheme") {
+            if (hasScheme || field.value.isEmpty())
+                return false;
+            hasScheme = true;
+        } else if (field.name == ":path") {
+            if (hasPath || field.value.isEmpty())
+                return false;
+            hasPath = true;
+        } else if (field.name != ":authority") {
+            return false;
+        }
+    }
+
+    if (method.isEmpty())
+        return false;
+    return method == "CONNECT" || (hasScheme && hasPath);
+}
+
+bool is_valid_response(const HPack::HttpHeader &header)
+{
+    int statusCount = 0;
+    for (const auto &field : header) {
+        if (field.name == ":status")
+            ++statusCount;
+        else if (field.name.startsWith(':'))
+            return false;
+    }
+    return statusCount == 1;
+}
+
+} // unnamed namespace
+
+QHttp2ServerStream::QHttp2ServerStream(QHttp2ServerConnection *connection, quint32 streamID,
+                                       qint32 sendWindow, qint32 recvWindow)
+    : QObject(connection),
+      m_streamID(streamID),
+      m_sendWindow(sendWindow),
+      m_recvWindow(recvWindow)
+{
+}
+
+QHttp2ServerStream::~QHttp2ServerStream() = default;
+
+QHttp2ServerConnection *QHttp2ServerStream::connection() const
+{
+    return static_cast<QHttp2ServerConnection *>(parent());
+}
+
+QByteArray QHttp2ServerStream::requestHeader(QByteArrayView name) const
+{
+    for (const auto &field : m_requestHeaders) {
+        if (field.name == name)
+            return field.value;
+    }
+    return QByteArray();
+}
+
+bool QHttp2ServerStream::isRequestFinished() const
+{
+    return m_state == State::HalfClosedRemote || m_state == State::Closed;
+}
+
+QByteArray QHttp2ServerStream::read(qint64 maxSize)
+{
+    const QByteArray data = m_incoming.read(std::min(maxSize, m_incoming.byteAmount()));
+    consumeReceived(qint32(data.size()));
+    return data;
+}
+
+QByteArray QHttp2ServerStream::readAll()
+{
+    const QByteArray data = m_incoming.readAll();
+    consumeReceived(qint32(data.size()));
+    return data;
+}
+
+bool QHttp2ServerStream::sendHeaders(const HPack::HttpHeader &headers, bool endStream)
+{
+    if (m_state == State::HalfClosedLocal || m_state == State::Closed)
+        return false;
+    return connection()->sendHeaders(this, headers, endStream);
+}
+
+bool QHttp2ServerStream::sendData(const QByteArray &data, bool endStream)
+{
+    if (m_state == State::HalfClosedLocal || m_state == State::Closed || m_endStreamPending)
+        return false;
+
+    if (!data.isEmpty())
+        m_outgoing.append(data);
+    m_endStreamPending = endStream;
+    connection()->schedulePendingData();
+    return true;
+}
+
+void QHttp2ServerStream::reset(quint32 errorCode)
+{
+    if (m_state != State::Closed)
+        connection()->resetStream(this, errorCode);
+}
+
+void QHttp2ServerStream::consumeReceived(qint32 size)
+{
+    // The application has consumed 'size' bytes, we can let our peer send
+    // more, unless we do not expect any more DATA on this stream:
+    m_unacknowledged += size;
+    if (isRequestFinished() || !m_unacknowledged)
+        return;
+
+    QHttp2ServerConnection *c = connection();
+    if (m_unacknowledged >= c->m_streamInitialReceiveWindowSize / 2) {
+        c->sendWINDOW_UPDATE(m_streamID, quint32(m_unacknowledged));
+        m_recvWindow += m_unacknowledged;
+        m_unacknowledged = 0;
+    }
+}
+
+QHttp2ServerConnection::QHttp2ServerConnection(QAbstractSocket *socket,
+                                               const QHttp2Configuration &configuration,
+                                               QObject *parent)
+    : QObject(parent),
+      m_socket(socket),
+      m_configuration(configuration)
+{
+    Q_ASSERT(socket);
+
+    m_sessionReceiveWindowSize = qint32(configuration.sessionReceiveWindowSize());
+    m_sessionRecvWindow = Http2::defaultSessionWindowSize;
+    m_streamInitialReceiveWindowSize = qint32(configuration.streamReceiveWindowSize());
+    m_encoder.setCompressStrings(configuration.huffmanCompressionEnabled());
+
+    connect(socket, &QAbstractSocket::readyRead, this, &QHttp2ServerConnection::_q_readyRead);
+    connect(socket, &QAbstractSocket::disconnected,
+            this, &QHttp2ServerConnection::_q_disconnected);
+    connect(socket, &QAbstractSocket::bytesWritten,
+            this, &QHttp2ServerConnection::schedulePendingData);
+
+    // We send our SETTINGS (the server connection preface) from the event
+    // loop, so that setMaxConcurrentStreams() can still be called; this also
+    // handles any data already buffered in the socket:
+    QMetaObject::invokeMethod(this, &QHttp2ServerConnection::_q_readyRead, Qt::QueuedConnection);
+}
+
+QHttp2ServerConnection::~QHttp2ServerConnection() = default;
+
+void QHttp2ServerConnection::setMaxConcurrentStreams(quint32 count)
+{
+    if (m_maxConcurrentStreams == count)
+        return;
+
+    m_maxConcurrentStreams = count;
+    if (m_prefaceSent && !m_connectionError)
+        sendSETTINGS();
+}
+
+void QHttp2ServerConnection::setMaxHeaderListSize(quint32 size)
+{
+    if (m_maxHeaderListSize == size)
+        return;
+
+    m_maxHeaderListSize = size;
+    if (m_prefaceSent && !m_connectionError)
+        sendSETTINGS();
+}
+
+void QHttp2ServerConnection::shutdown()
+{
+    if (m_goingAway || m_connectionError)
+        return;
+
+    m_goingAway = true;
+    sendGOAWAY(HTTP2_NO_ERROR);
+    finishIfIdle();
+}
+
+void QHttp2ServerConnection::_q_readyRead()
+{
+    if (!m_socket || m_connectionError)
+        return;
+
+    if (!m_prefaceSent && !sendServerPreface())
+        return connectionError(INTERNAL_ERROR, "failed to send SETTINGS");
+
+    if (!m_prefaceReceived) {
+        // 3.5 HTTP/2 Connection Preface
+        if (m_socket->bytesAvailable() < clientPrefaceLength)
+            return;
+
+        char preface[clientPrefaceLength] = {};
+        m_socket->read(preface, clientPrefaceLength);
+        if (std::memcmp(preface, Http2clientPreface, clientPrefaceLength))
+            return connectionError(PROTOCOL_ERROR, "invalid client preface");
+        m_prefaceReceived = true;
+    }
+
+    while (!m_connectionError) {
+        const auto result = m_frameReader.read(*m_socket);
+        switch (result) {
+        case FrameStatus::incompleteFrame:
+            return;
+        case FrameStatus::protocolError:
+            return connectionError(PROTOCOL_ERROR, "invalid frame");
+        case FrameStatus::sizeError:
+            return connectionError(FRAME_SIZE_ERROR, "invalid frame size");
+        default:
+            break;
+        }
+
+        Q_ASSERT(result == FrameStatus::goodFrame);
+
+        m_inboundFrame = std::move(m_frameReader.inboundFrame());
+        handleIncomingFrame();
+    }
+}
+
+void QHttp2ServerConnection::_q_disconnected()
+{
+    // Whatever is still active, will never complete:
+    const auto streams = m_streams.values();
+    for (QHttp2ServerStream *stream : streams) {
+        emit stream->errorOccurred(CANCEL);
+        closeStream(stream);
+    }
+
+    m_connectionError = true;
+    emit finished();
+}
+
+void QHttp2ServerConnection::_q_sendPendingData()
+{
+    m_sendScheduled = false;
+    if (!m_socket || m_connectionError)
+        return;
+
+    // Streams are served by deficit round robin: in every round each stream
+    // that has something to send, and is not waiting for a stream it depends
+    // on, gets a credit proportional to its weight and sends DATA frames
+    // while it has credit left. Higher weights go first within a round.
+    QVarLengthArray<QHttp2ServerStream *, 32> ready;
+    QVarLengthArray<std::pair<QPointer<QHttp2ServerStream>, qint64>, 32> written;
+    const auto canSend = [this](const QHttp2ServerStream *stream) {
+        if (!stream->m_headersSent || stream->m_state == QHttp2ServerStream::State::Closed
+            || stream->m_state == QHttp2ServerStream::State::HalfClosedLocal) {
+            return false;
+        }
+        if (!stream->bytesToWrite())
+            return stream->m_endStreamPending;
+        return std::min(m_sessionSendWindow, stream->m_sendWindow) > 0;
+    };
+
+    while (m_socket->bytesToWrite() < socketHighWaterMark) {
+        ready.clear();
+        for (QHttp2ServerStream *stream : std::as_const(m_streams)) {
+            if (canSend(stream) && !isBlockedByDependency(stream))
+                ready.append(stream);
+            else if (!stream->bytesToWrite())
+                stream->m_deficit = 0;
+        }
+        if (ready.isEmpty())
+            break;
+
+        std::sort(ready.begin(), ready.end(),
+                  [](const QHttp2ServerStream *a, const QHttp2ServerStream *b) {
+            return a->m_weight > b->m_weight
+                   || (a->m_weight == b->m_weight && a->m_streamID < b->m_streamID);
+        });
+
+        for (QHttp2ServerStream *stream : std::as_const(ready)) {
+            stream->m_deficit += stream->m_weight * bytesPerWeight;
+            qint64 total = 0;
+            while (stream->m_deficit > 0 && canSend(stream)) {
+                const qint64 sent = sendDATA(stream);
+                if (sent < 0)
+                    return connectionError(INTERNAL_ERROR, "failed to write DATA");
+                stream->m_deficit -= std::max(sent, qint64(1));
+                total += sent;
+            }
+            if (!stream->bytesToWrite())
+                stream->m_deficit = 0;
+            if (total)
+                written.append({ stream, total });
+        }
+    }
+
+    // Only now that we are done with our bookkeeping, notify the streams
+    // (and close the ones that are done) - slots may queue more data:
+    for (const auto &[stream, bytes] : std::as_const(written)) {
+        if (stream)
+            emit stream->bytesWritten(bytes);
+    }
+    QVarLengthArray<QPointer<QHttp2ServerStream>, 32> done;
+    for (QHttp2ServerStream *stream : std::as_const(m_streams)) {
+        if (stream->m_state == QHttp2ServerStream::State::Closed)
+            done.append(stream);
+    }
+    for (const auto &stream : std::as_const(done)) {
+        if (stream)
+            closeStream(stream);
+    }
+}
+
+bool QHttp2ServerConnection::sendServerPreface()
+{
+    // 3.5 HTTP/2 Connection Preface: "The server connection preface consists
+    // of a potentially empty SETTINGS frame that MUST be the first frame the
+    // server sends in the HTTP/2 connection."
+    Q_ASSERT(m_socket);
+
+    if (!sendSETTINGS())
+        return false;
+
+    m_sessionRecvWindow = m_sessionReceiveWindowSize;
+    const auto delta = m_sessionReceiveWindowSize - Http2::defaultSessionWindowSize;
+    if (delta > 0 && !sendWINDOW_UPDATE(connectionStreamID, delta))
+        return false;
+
+    m_prefaceSent = true;
+    return true;
+}
+
+bool QHttp2ServerConnection::sendSETTINGS()
+{
+    // 6.5 SETTINGS
+    Q_ASSERT(m_socket);
+
+    m_frameWriter.start(FrameType::SETTINGS, FrameFlag::EMPTY, connectionStreamID);
+    // 8.2: we never push, so we tell our peer it must not expect it:
+    m_frameWriter.append(Settings::ENABLE_PUSH_ID);
+    m_frameWriter.append(quint32(0));
+    m_frameWriter.append(Settings::MAX_CONCURRENT_STREAMS_ID);
+    m_frameWriter.append(m_maxConcurrentStreams);
+    m_frameWriter.append(Settings::MAX_HEADER_LIST_SIZE_ID);
+    m_frameWriter.append(m_maxHeaderListSize);
+    if (m_streamInitialReceiveWindowSize != Http2::defaultSessionWindowSize) {
+        m_frameWriter.append(Settings::INITIAL_WINDOW_SIZE_ID);
+        m_frameWriter.append(quint32(m_streamInitialReceiveWindowSize));
+    }
+    if (m_configuration.maxFrameSize() != Http2::minPayloadLimit) {
+        m_frameWriter.append(Settings::MAX_FRAME_SIZE_ID);
+        m_frameWriter.append(m_configuration.maxFrameSize());
+    }
+
+    ++m_pendingSettingsACKs;
+    return m_frameWriter.write(*m_socket);
+}
+
+bool QHttp2ServerConnection::sendWINDOW_UPDATE(quint32 streamID, quint32 delta)
+{
+    Q_ASSERT(m_socket);
+
+    m_frameWriter.start(FrameType::WINDOW_UPDATE, FrameFlag::EMPTY, streamID);
+    m_frameWriter.append(delta);
+    return m_frameWriter.write(*m_socket);
+}
+
+bool QHttp2ServerConnection::sendRST_STREAM(quint32 streamID, quint32 errorCode)
+{
+    Q_ASSERT(m_socket);
+
+    m_frameWriter.start(FrameType::RST_STREAM, FrameFlag::EMPTY, streamID);
+    m_frameWriter.append(errorCode);
+    return m_frameWriter.write(*m_socket);
+}
+
+bool QHttp2ServerConnection::sendGOAWAY(quint32 errorCode)
+{
+    Q_ASSERT(m_socket);
+
+    m_frameWriter.start(FrameType::GOAWAY, FrameFlag::EMPTY, connectionStreamID);
+    m_frameWriter.append(m_lastStreamID);
+    m_frameWriter.append(errorCode);
+    return m_frameWriter.write(*m_socket);
+}
+
+void QHttp2ServerConnection::handleIncomingFrame()
+{
+    const auto frameType = m_inboundFrame.type();
+
+    if (m_waitingForClientSettings) {
+        // 3.5: "... the client connection preface starts with a sequence of 24
+        // octets ... This sequence MUST be followed by a SETTINGS frame".
+        if (frameType != FrameType::SETTINGS
+            || m_inboundFrame.flags().testFlag(FrameFlag::ACK)) {
+            return connectionError(PROTOCOL_ERROR, "SETTINGS expected");
+        }
+        m_waitingForClientSettings = false;
+    }
+
+    if (m_continuationExpected && frameType != FrameType::CONTINUATION)
+        return connectionError(PROTOCOL_ERROR, "CONTINUATION expected");
+
+    switch (frameType) {
+    case FrameType::DATA:
+        handleDATA();
+        break;
+    case FrameType::HEADERS:
+        handleHEADERS();
+        break;
+    case FrameType::PRIORITY:
+        handlePRIORITY();
+        break;
+    case FrameType::RST_STREAM:
+        handleRST_STREAM();
+        break;
+    case FrameType::SETTINGS:
+        handleSETTINGS();
+        break;
+    case FrameType::PUSH_PROMISE:
+        // 8.2: "A client cannot push."
+        connectionError(PROTOCOL_ERROR, "PUSH_PROMISE from a client");
+        break;
+    case FrameType::PING:
+        handlePING();
+        break;
+    case FrameType::GOAWAY:
+        handleGOAWAY();
+        break;
+    case FrameType::WINDOW_UPDATE:
+        handleWINDOW_UPDATE();
+        break;
+    case FrameType::CONTINUATION:
+        handleCONTINUATION();
+        break;
+    case FrameType::LAST_FRAME_TYPE:
+        // 5.1 - ignore unknown frames.
+        break;
+    }
+}
+
+void QHttp2ServerConnection::handleDATA()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::DATA);
+
+    const auto streamID = m_inboundFrame.streamID();
+    if (streamID == connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "DATA on stream 0x0");
+
+    if (streamID > m_lastStreamID)
+        return connectionError(PROTOCOL_ERROR, "DATA on idle stream");
+
+    const qint32 payloadSize = qint32(m_inboundFrame.payloadSize());
+    if (payloadSize > m_sessionRecvWindow)
+        return connectionError(FLOW_CONTROL_ERROR, "Flow control error");
+
+    m_sessionRecvWindow -= payloadSize;
+
+    // DATA on streams that were closed (or reset) is still accounted for
+    // in the session's window (below), but otherwise ignored.
+    QHttp2ServerStream *stream = m_streams.value(streamID);
+    if (stream && stream->isRequestFinished()) {
+        emit stream->errorOccurred(STREAM_CLOSED);
+        resetStream(stream, STREAM_CLOSED);
+    } else if (stream && payloadSize > stream->m_recvWindow) {
+        emit stream->errorOccurred(FLOW_CONTROL_ERROR);
+        resetStream(stream, FLOW_CONTROL_ERROR);
+    } else if (stream) {
+        stream->m_recvWindow -= payloadSize;
+        const qint32 dataSize = qint32(m_inboundFrame.dataSize());
+        if (dataSize) {
+            stream->m_incoming.append(
+                    QByteArray(reinterpret_cast<const char *>(m_inboundFrame.dataBegin()),
+                               dataSize));
+        }
+
+        const bool endStream = m_inboundFrame.flags().testFlag(FrameFlag::END_STREAM);
+        if (endStream) {
+            stream->m_state = stream->m_state == QHttp2ServerStream::State::HalfClosedLocal
+                    ? QHttp2ServerStream::State::Closed
+                    : QHttp2ServerStream::State::HalfClosedRemote;
+        } else if (payloadSize != dataSize) {
+            // Padding is consumed immediately:
+            stream->consumeReceived(payloadSize - dataSize);
+        }
+
+        QPointer<QHttp2ServerStream> guard(stream);
+        if (dataSize)
+            emit stream->readyRead();
+        if (endStream && guard)
+            emit stream->requestFinished();
+        if (guard && stream->m_state == QHttp2ServerStream::State::Closed)
+            closeStream(stream);
+    }
+
+    if (!m_connectionError && m_sessionRecvWindow < m_sessionReceiveWindowSize / 2) {
+        sendWINDOW_UPDATE(connectionStreamID, m_sessionReceiveWindowSize - m_sessionRecvWindow);
+        m_sessionRecvWindow = m_sessionReceiveWindowSize;
+    }
+}
+
+void QHttp2ServerConnection::handleHEADERS()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::HEADERS);
+
+    const auto streamID = m_inboundFrame.streamID();
+    if (streamID == connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "HEADERS on 0x0 stream");
+
+    // 5.1.1: "Streams initiated by a client MUST use odd-numbered stream
+    // identifiers".
+    if (!(streamID & 0x1))
+        return connectionError(PROTOCOL_ERROR, "HEADERS on even stream");
+
+    const bool endHeaders = m_inboundFrame.flags().testFlag(FrameFlag::END_HEADERS);
+    m_continuedFrames.clear();
+    m_continuedFramesSize = 0;
+    if (!appendHeaderBlockFrame())
+        return;
+    if (!endHeaders) {
+        m_continuationExpected = true;
+        return;
+    }
+
+    handleContinuedHEADERS();
+}
+
+void QHttp2ServerConnection::handlePRIORITY()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::PRIORITY);
+
+    const auto streamID = m_inboundFrame.streamID();
+    if (streamID == connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "PRIORITY on 0x0 stream");
+
+    // PRIORITY can be sent for a stream in any state; we only keep track of
+    // the streams that are active.
+    if (QHttp2ServerStream *stream = m_streams.value(streamID)) {
+        quint32 streamDependency = 0;
+        uchar weight = 0;
+        m_inboundFrame.priority(&streamDependency, &weight);
+        updatePriority(stream, streamDependency, weight);
+    }
+}
+
+void QHttp2ServerConnection::handleRST_STREAM()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::RST_STREAM);
+
+    const auto streamID = m_inboundFrame.streamID();
+    if (streamID == connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "RST_STREAM on 0x0");
+
+    if (streamID > m_lastStreamID)
+        return connectionError(PROTOCOL_ERROR, "RST_STREAM on idle stream");
+
+    QHttp2ServerStream *stream = m_streams.value(streamID);
+    if (!stream) {
+        // 'closed' stream, ignore.
+        return;
+    }
+
+    Q_ASSERT(m_inboundFrame.dataSize() == 4);
+
+    QPointer<QHttp2ServerStream> guard(stream);
+    emit stream->errorOccurred(qFromBigEndian<quint32>(m_inboundFrame.dataBegin()));
+    if (guard)
+        closeStream(stream);
+}
+
+void QHttp2ServerConnection::handleSETTINGS()
+{
+    // 6.5 SETTINGS.
+    Q_ASSERT(m_inboundFrame.type() == FrameType::SETTINGS);
+
+    if (m_inboundFrame.streamID() != connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "SETTINGS on invalid stream");
+
+    if (m_inboundFrame.flags().testFlag(FrameFlag::ACK)) {
+        if (!m_pendingSettingsACKs)
+            return connectionError(PROTOCOL_ERROR, "unexpected SETTINGS ACK");
+        --m_pendingSettingsACKs;
+        return;
+    }
+
+    if (m_inboundFrame.dataSize()) {
+        auto src = m_inboundFrame.dataBegin();
+        for (const uchar *end = src + m_inboundFrame.dataSize(); src != end; src += 6) {
+            const Settings identifier = Settings(qFromBigEndian<quint16>(src));
+            const quint32 intVal = qFromBigEndian<quint32>(src + 2);
+            if (!acceptSetting(identifier, intVal)) {
+                // If not accepted - we finish with connectionError.
+                return;
+            }
+        }
+    }
+
+    m_frameWriter.start(FrameType::SETTINGS, FrameFlag::ACK, connectionStreamID);
+    m_frameWriter.write(*m_socket);
+}
+
+void QHttp2ServerConnection::handlePING()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::PING);
+    Q_ASSERT(m_socket);
+
+    if (m_inboundFrame.streamID() != connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "PING on invalid stream");
+
+    // We never send PING ourselves, so there is nothing to do with an ACK.
+    if (m_inboundFrame.flags() & FrameFlag::ACK)
+        return;
+
+    Q_ASSERT(m_inboundFrame.dataSize() == 8);
+
+    m_frameWriter.start(FrameType::PING, FrameFlag::ACK, connectionStreamID);
+    m_frameWriter.append(m_inboundFrame.dataBegin(), m_inboundFrame.dataBegin() + 8);
+    m_frameWriter.write(*m_socket);
+}
+
+void QHttp2ServerConnection::handleGOAWAY()
+{
+    // 6.8 GOAWAY
+    Q_ASSERT(m_inboundFrame.type() == FrameType::GOAWAY);
+
+    if (m_inboundFrame.streamID() != connectionStreamID)
+        return connectionError(PROTOCOL_ERROR, "GOAWAY on invalid stream");
+
+    // Our peer will not open new streams; since we never initiate streams,
+    // the last stream ID is of no interest to us. The active streams are
+    // allowed to complete.
+    const quint32 errorCode = qFromBigEndian<quint32>(m_inboundFrame.dataBegin() + 4);
+    if (errorCode != HTTP2_NO_ERROR)
+        qCDebug(QT_HTTP2) << "GOAWAY received:" << qt_error_string(errorCode);
+
+    m_goingAway = true;
+    finishIfIdle();
+}
+
+void QHttp2ServerConnection::handleWINDOW_UPDATE()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::WINDOW_UPDATE);
+
+    const quint32 delta = qFromBigEndian<quint32>(m_inboundFrame.dataBegin());
+    const bool valid = delta && delta <= quint32(std::numeric_limits<qint32>::max());
+    const auto streamID = m_inboundFrame.streamID();
+
+    if (streamID == connectionStreamID) {
+        qint32 sum = 0;
+        if (!valid)
+            return connectionError(PROTOCOL_ERROR, "WINDOW_UPDATE invalid delta");
+        if (qAddOverflow(m_sessionSendWindow, qint32(delta), &sum))
+            return connectionError(FLOW_CONTROL_ERROR, "WINDOW_UPDATE window overflow");
+        m_sessionSendWindow = sum;
+    } else {
+        if (streamID > m_lastStreamID)
+            return connectionError(PROTOCOL_ERROR, "WINDOW_UPDATE on idle stream");
+
+        QHttp2ServerStream *stream = m_streams.value(streamID);
+        if (!stream) {
+            // WINDOW_UPDATE on closed streams can be ignored.
+            return;
+        }
+        qint32 sum = 0;
+        if (!valid || qAddOverflow(stream->m_sendWindow, qint32(delta), &sum)) {
+            const quint32 error = valid ? FLOW_CONTROL_ERROR : PROTOCOL_ERROR;
+            QPointer<QHttp2ServerStream> guard(stream);
+            emit stream->errorOccurred(error);
+            if (guard)
+                resetStream(stream, error);
+            return;
+        }
+        stream->m_sendWindow = sum;
+    }
+
+    schedulePendingData();
+}
+
+void QHttp2ServerConnection::handleCONTINUATION()
+{
+    Q_ASSERT(m_inboundFrame.type() == FrameType::CONTINUATION);
+
+    if (!m_continuationExpected)
+        return connectionError(PROTOCOL_ERROR, "unexpected CONTINUATION");
+
+    Q_ASSERT(m_continuedFrames.size()); // HEADERS frame must be already in.
+
+    if (m_inboundFrame.streamID() != m_continuedFrames.front().streamID())
+        return connectionError(PROTOCOL_ERROR, "CONTINUATION on invalid stream");
+
+    const bool endHeaders = m_inboundFrame.flags().testFlag(FrameFlag::END_HEADERS);
+    if (!appendHeaderBlockFrame())
+        return;
+
+    if (!endHeaders)
+        return;
+
+    m_continuationExpected = false;
+    handleContinuedHEADERS();
+}
+
+// Adds the inbound HEADERS or CONTINUATION frame to the header block being
+// assembled, unless that makes the block larger than the header list we
+// accept; a peer that keeps sending CONTINUATION frames could otherwise
+// make us buffer without end.
+bool QHttp2ServerConnection::appendHeaderBlockFrame()
+{
+    const quint32 frameSize = frameHeaderSize + m_inboundFrame.dataSize();
+    if (frameSize > m_maxHeaderListSize - std::min(m_continuedFramesSize, m_maxHeaderListSize)) {
+        m_continuedFrames.clear();
+        m_continuedFramesSize = 0;
+        connectionError(ENHANCE_YOUR_CALM, "header block too large");
+        return false;
+    }
+    m_continuedFramesSize += frameSize;
+    m_continuedFrames.push_back(std::move(m_inboundFrame));
+    return true;
+}
+
+void QHttp2ServerConnection::handleContinuedHEADERS()
+{
+    Q_ASSERT(m_continuedFrames.size());
+
+    const Frame &firstFrame = m_continuedFrames[0];
+    const auto streamID = firstFrame.streamID();
+    const auto flags = firstFrame.flags();
+    const bool endStream = flags.testFlag(FrameFlag::END_STREAM);
+
+    // We have to decode the header block even if we are going to ignore it,
+    // it changes the HPACK context.
+    HPack::HttpHeader header;
+    std::vector<uchar> hpackBlock(assemble_hpack_block(m_continuedFrames));
+    if (!hpackBlock.empty()) {
+        HPack::BitIStream inputStream{&hpackBlock[0], &hpackBlock[0] + hpackBlock.size()};
+        if (!m_decoder.decodeHeaderFields(inputStream))
+            return connectionError(COMPRESSION_ERROR, "HPACK decompression failed");
+        header = m_decoder.decodedHeader();
+    }
+
+    // 6.5.2: we told our peer how large a header list may be
+    const HPack::HeaderSize headerSize = HPack::header_size(header);
+    if (!headerSize.first || headerSize.second > m_maxHeaderListSize)
+        return connectionError(ENHANCE_YOUR_CALM, "header list too large");
+
+    if (QHttp2ServerStream *stream = m_streams.value(streamID)) {
+        // A second HEADERS on an active stream is the request's trailer
+        // section, 8.1: it must end the stream.
+        if (stream->isRequestFinished() || !endStream) {
+            const quint32 error = stream->isRequestFinished() ? STREAM_CLOSED : PROTOCOL_ERROR;
+            QPointer<QHttp2ServerStream> guard(stream);
+            emit stream->errorOccurred(error);
+            if (guard)
+                resetStream(stream, error);
+            return;
+        }
+
+        stream->m_requestHeaders.insert(stream->m_requestHeaders.end(),
+                                        header.begin(), header.end());
+        stream->m_state = stream->m_state == QHttp2ServerStream::State::HalfClosedLocal
+                ? QHttp2ServerStream::State::Closed
+                : QHttp2ServerStream::State::HalfClosedRemote;
+        QPointer<QHttp2ServerStream> guard(stream);
+        emit stream->requestFinished();
+        if (guard && stream->m_state == QHttp2ServerStream::State::Closed)
+            closeStream(stream);
+        return;
+    }
+
+    if (streamID <= m_lastStreamID) {
+        // A stream that was closed or reset; our peer has yet to find out.
+        return;
+    }
+
+    m_lastStreamID = streamID;
+
+    if (m_goingAway) {
+        // 6.8: streams initiated after GOAWAY was sent are ignored.
+        return;
+    }
+
+    if (quint32(m_streams.size()) >= m_maxConcurrentStreams) {
+        // 5.1.2: "An endpoint that receives a HEADERS frame that causes its
+        // advertised concurrent stream limit to be exceeded MUST treat this
+        // as a stream error ... of type PROTOCOL_ERROR or REFUSED_STREAM."
+        sendRST_STREAM(streamID, REFUSE_STREAM);
+        return;
+    }
+
+    if (!is_valid_request(header)) {
+        sendRST_STREAM(streamID, PROTOCOL_ERROR);
+        return;
+    }
+
+    auto *stream = new QHttp2ServerStream(this, streamID, m_streamInitialSendWindowSize,
+                                          streamReceiveWindow());
+    if (flags.testFlag(FrameFlag::PRIORITY)) {
+        quint32 streamDependency = 0;
+        uchar weight = 0;
+        firstFrame.priority(&streamDependency, &weight);
+        updatePriority(stream, streamDependency, weight);
+    }
+    stream->m_requestHeaders = std::move(header);
+    if (endStream)
+        stream->m_state = QHttp2ServerStream::State::HalfClosedRemote;
+    m_streams.insert(streamID, stream);
+
+    emit newRequest(stream);
+}
+
+bool QHttp2ServerConnection::acceptSetting(Http2::Settings identifier, quint32 newValue)
+{
+    if (identifier == Settings::HEADER_TABLE_SIZE_ID) {
+        // Our peer's decoder can hold that much; we never use more than
+        // the default, though.
+        m_encoder.setMaxDynamicTableSize(
+                std::min(newValue, quint32(HPack::FieldLookupTable::DefaultSize)));
+    }
+
+    if (identifier == Settings::ENABLE_PUSH_ID && newValue > 1) {
+        connectionError(PROTOCOL_ERROR, "SETTINGS invalid ENABLE_PUSH");
+        return false;
+    }
+
+    if (identifier == Settings::INITIAL_WINDOW_SIZE_ID) {
+        // For every active stream - adjust its window
+        // (and handle possible overflows as errors).
+        if (newValue > quint32(std::numeric_limits<qint32>::max())) {
+            connectionError(FLOW_CONTROL_ERROR, "SETTINGS invalid initial window size");
+            return false;
+        }
+
+        const qint32 delta = qint32(newValue) - m_streamInitialSendWindowSize;
+        m_streamInitialSendWindowSize = newValue;
+
+        QVarLengthArray<QHttp2ServerStream *, 16> brokenStreams;
+        for (QHttp2ServerStream *stream : std::as_const(m_streams)) {
+            qint32 sum = 0;
+            if (qAddOverflow(stream->m_sendWindow, delta, &sum)) {
+                brokenStreams.append(stream);
+                continue;
+            }
+            stream->m_sendWindow = sum;
+        }
+
+        for (QHttp2ServerStream *stream : std::as_const(brokenStreams)) {
+            emit stream->errorOccurred(FLOW_CONTROL_ERROR);
+            if (stream->m_state != QHttp2ServerStream::State::Closed)
+                resetStream(stream, FLOW_CONTROL_ERROR);
+        }
+
+        schedulePendingData();
+    }
+
+    if (identifier == Settings::MAX_FRAME_SIZE_ID) {
+        if (newValue < Http2::minPayloadLimit || newValue > Http2::maxPayloadSize) {
+            connectionError(PROTOCOL_ERROR, "SETTINGS max frame size is out of range");
+            return false;
+        }
+        m_maxFrameSize = newValue;
+    }
+
+    // MAX_CONCURRENT_STREAMS limits the streams we could initiate (we
+    // don't), MAX_HEADER_LIST_SIZE is advisory.
+    return true;
+}
+
+void QHttp2ServerConnection::updatePriority(QHttp2ServerStream *stream, quint32 dependency,
+                                            uchar weight)
+{
+    // 5.3.1 and 5.3.3
+    const bool exclusive = dependency & 0x80000000;
+    dependency &= ~0x80000000;
+    if (dependency == stream->m_streamID) {
+        // "A stream cannot depend on itself." We ignore the dependency,
+        // rather than reset the stream.
+        dependency = connectionStreamID;
+    }
+
+    if (exclusive) {
+        // The stream becomes the sole dependency of its parent, adopting the
+        // parent's other dependencies.
+        for (QHttp2ServerStream *other : std::as_const(m_streams)) {
+            if (other != stream && other->m_dependency == dependency)
+                other->m_dependency = stream->m_streamID;
+        }
+    }
+
+    stream->m_dependency = dependency;
+    stream->m_exclusive = exclusive;
+    stream->m_weight = int(weight) + 1;
+
+    schedulePendingData();
+}
+
+bool QHttp2ServerConnection::isBlockedByDependency(const QHttp2ServerStream *stream) const
+{
+    // 5.3.1: "... a dependent stream SHOULD only be allocated resources if
+    // all of the streams that it depends on are either closed or it is not
+    // possible to make progress on them." Dependencies can form cycles after
+    // reprioritization, hence the bound on the number of steps.
+    quint32 dependency = stream->m_dependency;
+    for (qsizetype step = 0; dependency && step < m_streams.size(); ++step) {
+        const QHttp2ServerStream *parent = m_streams.value(dependency);
+        if (!parent)
+            return false;
+        if (parent->m_headersSent && parent->bytesToWrite()
+            && std::min(m_sessionSendWindow, parent->m_sendWindow) > 0) {
+            return true;
+        }
+        dependency = parent->m_dependency;
+    }
+    return false;
+}
+
+bool QHttp2ServerConnection::sendHeaders(QHttp2ServerStream *stream,
+                                         const HPack::HttpHeader &headers, bool endStream)
+{
+    using namespace HPack;
+
+    if (!m_socket || m_connectionError)
+        return false;
+
+    if (stream->m_headersSent) {
+        qCWarning(QT_HTTP2) << "response headers already sent on stream" << stream->m_streamID;
+        return false;
+    }
+
+    if (!is_valid_response(headers)) {
+        qCWarning(QT_HTTP2) << "invalid response headers on stream" << stream->m_streamID;
+        return false;
+    }
+
+    if (endStream && (stream->bytesToWrite() || stream->m_endStreamPending))
+        return false;
+
+    m_frameWriter.start(FrameType::HEADERS, endStream ? FrameFlag::END_STREAM : FrameFlag::EMPTY,
+                        stream->m_streamID);
+    BitOStream outputStream(m_frameWriter.outboundFrame().buffer);
+    if (!m_encoder.encodeResponse(outputStream, headers)) {
+        // The HPACK context may be out of sync with our peer's now:
+        connectionError(INTERNAL_ERROR, "HPACK compression failed");
+        return false;
+    }
+
+    if (!m_frameWriter.writeHEADERS(*m_socket, m_maxFrameSize))
+        return false;
+
+    stream->m_headersSent = true;
+    if (endStream)
+        closeLocal(stream);
+    else if (stream->bytesToWrite() || stream->m_endStreamPending)
+        schedulePendingData();
+    return true;
+}
+
+void QHttp2ServerConnection::schedulePendingData()
+{
+    if (m_sendScheduled || m_connectionError)
+        return;
+
+    m_sendScheduled = true;
+    QMetaObject::invokeMethod(this, &QHttp2ServerConnection::_q_sendPendingData,
+                              Qt::QueuedConnection);
+}
+
+qint64 QHttp2ServerConnection::sendDATA(QHttp2ServerStream *stream)
+{
+    // Sends a single DATA frame, as large as the flow control windows and
+    // frame size limit permit, END_STREAM set if it is the last one.
+    Q_ASSERT(m_socket);
+
+    const qint64 pending = stream->m_outgoing.byteAmount();
+    const qint32 window = std::min(m_sessionSendWindow, stream->m_sendWindow);
+    const quint32 chunkSize = quint32(std::min({ pending, qint64(window),
+                                                 qint64(m_maxFrameSize) }));
+    const bool lastFrame = qint64(chunkSize) == pending && stream->m_endStreamPending;
+    if (!chunkSize && !lastFrame)
+        return 0;
+
+    m_frameWriter.start(FrameType::DATA, lastFrame ? FrameFlag::END_STREAM : FrameFlag::EMPTY,
+                        stream->m_streamID);
+    m_frameWriter.setPayloadSize(chunkSize);
+    if (!m_frameWriter.write(*m_socket))
+        return -1;
+
+    for (quint32 remaining = chunkSize; remaining;) {
+        const QByteArrayView data = stream->m_outgoing.readPointer();
+        const qint64 size = std::min(data.size(), qsizetype(remaining));
+        if (m_socket->write(data.data(), size) != size)
+            return -1;
+        stream->m_outgoing.advanceReadPointer(size);
+        remaining -= quint32(size);
+    }
+
+    m_sessionSendWindow -= qint32(chunkSize);
+    stream->m_sendWindow -= qint32(chunkSize);
+
+    if (lastFrame) {
+        stream->m_endStreamPending = false;
+        // We do not close the stream here, _q_sendPendingData() does, once
+        // it has finished iterating over the active streams.
+        stream->m_state = stream->m_state == QHttp2ServerStream::State::HalfClosedRemote
+                ? QHttp2ServerStream::State::Closed
+                : QHttp2ServerStream::State::HalfClosedLocal;
+    }
+
+    return chunkSize;
+}
+
+void QHttp2ServerConnection::resetStream(QHttp2ServerStream *stream, quint32 errorCode)
+{
+    if (m_socket && !m_connectionError)
+        sendRST_STREAM(stream->m_streamID, errorCode);
+    closeStream(stream);
+}
+
+void QHttp2ServerConnection::closeStream(QHttp2ServerStream *stream)
+{
+    stream->m_state = QHttp2ServerStream::State::Closed;
+    if (m_streams.value(stream->m_streamID) != stream)
+        return;
+
+    m_streams.remove(stream->m_streamID);
+    stream->m_outgoing.clear();
+    stream->m_endStreamPending = false;
+    emit stream->closed();
+    stream->deleteLater();
+
+    finishIfIdle();
+}
+
+void QHttp2ServerConnection::closeLocal(QHttp2ServerStream *stream)
+{
+    if (stream->m_state == QHttp2ServerStream::State::HalfClosedRemote)
+        closeStream(stream);
+    else
+        stream->m_state = QHttp2ServerStream::State::HalfClosedLocal;
+}
+
+void QHttp2ServerConnection::connectionError(Http2::Http2Error errorCode, const char *message)
+{
+    Q_ASSERT(message);
+
+    if (m_connectionError)
+        return;
+
+    qCWarning(QT_HTTP2) << "connection error:" << message;
+
+    if (m_socket)
+        sendGOAWAY(errorCode);
+    m_goingAway = true;
+    m_connectionError = true;
+
+    const auto streams = m_streams.values();
+    for (QHttp2ServerStream *stream : streams) {
+        emit stream->errorOccurred(errorCode);
+        closeStream(stream);
+    }
+
+    emit errorOccurred(errorCode, QLatin1StringView(message));
+
+    if (m_socket)
+        m_socket->disconnectFromHost();
+}
+
+void QHttp2ServerConnection::finishIfIdle()
+{
+    if (m_goingAway && m_streams.isEmpty() && m_socket && !m_connectionError)
+        m_socket->disconnectFromHost();
+}
+
+qint32 QHttp2ServerConnection::streamReceiveWindow() const
+{
+    // Until our peer acknowledges our SETTINGS, it may still be using the
+    // default window size:
+    if (m_pendingSettingsACKs)
+        return std::max(m_streamInitialReceiveWindowSize, qint32(Http2::defaultSessionWindowSize));
+    return m_streamInitialReceiveWindowSize;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qhttp2serverconnection_p.cpp"
@@ -0,0 +1,249 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QHTTP2SERVERCONNECTION_P_H
+#define QHTTP2SERVERCONNECTION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+
+#include <QtNetwork/qhttp2configuration.h>
+
+#include <private/http2protocol_p.h>
+#include <private/http2frames_p.h>
+#include <private/hpack_p.h>
+#include <private/qbytedata_p.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+
+#include <vector>
+
+QT_REQUIRE_CONFIG(http);
+
+QT_BEGIN_NAMESPACE
+
+class QAbstractSocket;
+class QHttp2ServerConnection;
+
+class Q_NETWORK_EXPORT QHttp2ServerStream : public QObject
+{
+    Q_OBJECT
+public:
+    enum class State {
+        Open,
+        HalfClosedLocal,
+        HalfClosedRemote,
+        Closed
+    };
+
+    ~QHttp2ServerStream() override;
+
+    QHttp2ServerConnection *connection() const;
+    quint32 streamID() const { return m_streamID; }
+    State state() const { return m_state; }
+
+    // RFC 7540, 5.3: the weight is in the range [1, 256]. The dependency is
+    // the stream this one depends on, 0 if none.
+    int weight() const { return m_weight; }
+    quint32 dependency() const { return m_dependency; }
+    bool isExclusive() const { return m_exclusive; }
+
+    const HPack::HttpHeader &requestHeaders() const { return m_requestHeaders; }
+    QByteArray requestHeader(QByteArrayView name) const;
+    QByteArray method() const { return requestHeader(":method"); }
+    QByteArray path() const { return requestHeader(":path"); }
+    QByteArray authority() const { return requestHeader(":authority"); }
+    QByteArray scheme() const { return requestHeader(":scheme"); }
+
+    // True once the peer has sent END_STREAM, that is, the request body
+    // (if any) is complete:
+    bool isRequestFinished() const;
+    qint64 bytesAvailable() const { return m_incoming.byteAmount(); }
+    QByteArray read(qint64 maxSize);
+    QByteArray readAll();
+
+    bool sendHeaders(const HPack::HttpHeader &headers, bool endStream = false);
+    bool sendData(const QByteArray &data, bool endStream = false);
+    qint64 bytesToWrite() const { return m_outgoing.byteAmount(); }
+    void reset(quint32 errorCode = Http2::CANCEL);
+
+Q_SIGNALS:
+    void readyRead();
+    void requestFinished();
+    void bytesWritten(qint64 bytes);
+    // The stream was reset by the peer, or the connection was lost:
+    void errorOccurred(quint32 errorCode);
+    // Emitted once the stream has reached the Closed state; the stream is
+    // deleted afterwards (via deleteLater()):
+    void closed();
+
+private:
+    friend class QHttp2ServerConnection;
+
+    QHttp2ServerStream(QHttp2ServerConnection *connection, quint32 streamID,
+                       qint32 sendWindow, qint32 recvWindow);
+
+    void consumeReceived(qint32 size);
+
+    quint32 m_streamID = 0;
+    State m_state = State::Open;
+
+    int m_weight = 16;
+    quint32 m_dependency = 0;
+    bool m_exclusive = false;
+
+    HPack::HttpHeader m_requestHeaders;
+    bool m_headersSent = false;
+
+    // Signed as window sizes can become negative:
+    qint32 m_sendWindow = Http2::defaultSessionWindowSize;
+    qint32 m_recvWindow = Http2::defaultSessionWindowSize;
+    // Received bytes the application has consumed, but we have not yet
+    // returned to our peer via WINDOW_UPDATE:
+    qint32 m_unacknowledged = 0;
+    // Deficit round robin credit, see _q_sendPendingData():
+    qint64 m_deficit = 0;
+
+    QByteDataBuffer m_incoming;
+    QByteDataBuffer m_outgoing;
+    bool m_endStreamPending = false;
+};
+
+class Q_NETWORK_EXPORT QHttp2ServerConnection : public QObject
+{
+    Q_OBJECT
+public:
+    // The socket must be connected, and encrypted if TLS is in use (with "h2"
+    // negotiated via ALPN), or a clear text connection on which the client
+    // starts with the HTTP/2 connection preface (prior knowledge). The
+    // connection does not take ownership of the socket.
+    explicit QHttp2ServerConnection(QAbstractSocket *socket,
+                                    const QHttp2Configuration &configuration = {},
+                                    QObject *parent = nullptr);
+    ~QHttp2ServerConnection() override;
+
+    QAbstractSocket *socket() const { return m_socket; }
+    QHttp2Configuration configuration() const { return m_configuration; }
+
+    quint32 maxConcurrentStreams() const { return m_maxConcurrentStreams; }
+    void setMaxConcurrentStreams(quint32 count);
+
+    // The largest header list a request may send, as HPACK counts it; its
+    // header block (HEADERS and CONTINUATION frames) may not be larger
+    // either.
+    quint32 maxHeaderListSize() const { return m_maxHeaderListSize; }
+    void setMaxHeaderListSize(quint32 size);
+
+    qsizetype activeStreamCount() const { return m_streams.size(); }
+    QHttp2ServerStream *stream(quint32 streamID) const { return m_streams.value(streamID); }
+
+    bool isGoingAway() const { return m_goingAway; }
+    // Graceful shutdown: refuse new streams, let the active ones finish, then
+    // disconnect.
+    void shutdown();
+
+Q_SIGNALS:
+    void newRequest(QHttp2ServerStream *stream);
+    void errorOccurred(quint32 errorCode, const QString &message);
+    void finished();
+
+private Q_SLOTS:
+    void _q_readyRead();
+    void _q_disconnected();
+    void _q_sendPendingData();
+
+private:
+    friend class QHttp2ServerStream;
+
+    bool sendServerPreface();
+    bool sendSETTINGS();
+    bool sendWINDOW_UPDATE(quint32 streamID, quint32 delta);
+    bool sendRST_STREAM(quint32 streamID, quint32 errorCode);
+    bool sendGOAWAY(quint32 errorCode);
+
+    void handleIncomingFrame();
+    void handleDATA();
+    void handleHEADERS();
+    void handlePRIORITY();
+    void handleRST_STREAM();
+    void handleSETTINGS();
+    void handlePING();
+    void handleGOAWAY();
+    void handleWINDOW_UPDATE();
+    void handleCONTINUATION();
+    bool appendHeaderBlockFrame();
+    void handleContinuedHEADERS();
+
+    bool acceptSetting(Http2::Settings identifier, quint32 newValue);
+    void updatePriority(QHttp2ServerStream *stream, quint32 dependency, uchar weight);
+    bool isBlockedByDependency(const QHttp2ServerStream *stream) const;
+
+    bool sendHeaders(QHttp2ServerStream *stream, const HPack::HttpHeader &headers,
+                     bool endStream);
+    void schedulePendingData();
+    qint64 sendDATA(QHttp2ServerStream *stream);
+    void resetStream(QHttp2ServerStream *stream, quint32 errorCode);
+    void closeStream(QHttp2ServerStream *stream);
+    void closeLocal(QHttp2ServerStream *stream);
+    void connectionError(Http2::Http2Error errorCode, const char *message);
+    void finishIfIdle();
+    qint32 streamReceiveWindow() const;
+
+    QPointer<QAbstractSocket> m_socket;
+    QHttp2Configuration m_configuration;
+
+    Http2::FrameReader m_frameReader;
+    Http2::Frame m_inboundFrame;
+    Http2::FrameWriter m_frameWriter;
+
+    bool m_prefaceReceived = false;
+    bool m_waitingForClientSettings = true;
+    bool m_prefaceSent = false;
+    bool m_goingAway = false;
+    bool m_connectionError = false;
+    bool m_sendScheduled = false;
+    // We can have several SETTINGS frames in flight:
+    int m_pendingSettingsACKs = 0;
+
+    // HEADERS + CONTINUATION frames of a header block we are assembling:
+    bool m_continuationExpected = false;
+    std::vector<Http2::Frame> m_continuedFrames;
+    // Bytes of these frames, including the frame headers:
+    quint32 m_continuedFramesSize = 0;
+
+    HPack::Decoder m_decoder{HPack::FieldLookupTable::DefaultSize};
+    HPack::Encoder m_encoder{HPack::FieldLookupTable::DefaultSize, true};
+
+    QHash<quint32, QHttp2ServerStream *> m_streams;
+    // The highest client-initiated stream ID we have seen, 5.1.1:
+    quint32 m_lastStreamID = 0;
+
+    // What we advertise to our peer:
+    quint32 m_maxConcurrentStreams = Http2::maxConcurrentStreams;
+    quint32 m_maxHeaderListSize = 64 * 1024;
+    qint32 m_sessionReceiveWindowSize = Http2::defaultSessionWindowSize;
+    qint32 m_sessionRecvWindow = Http2::defaultSessionWindowSize;
+    qint32 m_streamInitialReceiveWindowSize = Http2::defaultSessionWindowSize;
+
+    // Our peer's limits, updated by its SETTINGS and WINDOW_UPDATE frames:
+    qint32 m_sessionSendWindow = Http2::defaultSessionWindowSize;
+    qint32 m_streamInitialSendWindowSize = Http2::defaultSessionWindowSize;
+    quint32 m_maxFrameSize = Http2::minPayloadLimit;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHTTP2SERVERCONNECTION_P_H
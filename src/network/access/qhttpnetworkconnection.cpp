@@ -4,6 +4,7 @@
 #include "qhttpnetworkconnection_p.h"
 #include <private/qabstractsocket_p.h>
 #include "qhttpnetworkconnectionchannel_p.h"
+#include "qhttp2protocolhandler_p.h"
 #include "private/qnoncontiguousbytedevice_p.h"
 #include <private/qnetworkrequest_p.h>
 #include <private/qobject_p.h>
@@ -93,6 +94,9 @@ QHttpNetworkConnectionPrivate::QHttpNetworkConnectionPrivate(quint16 connectionC
 QHttpNetworkConnectionPrivate::~QHttpNetworkConnectionPrivate()
 {
     for (int i = 0; i < channelCount; ++i) {
+        // the channels cannot reach us anymore, and won't see the disconnect
+        if (statistics && channels[i].connectionCounted)
+            statistics->connectionClosed(hostName);
         if (channels[i].socket) {
             QObject::disconnect(channels[i].socket, nullptr, &channels[i], nullptr);
             channels[i].socket->close();
@@ -112,6 +116,7 @@ void QHttpNetworkConnectionPrivate::init()
 
     delayedConnectionTimer.setSingleShot(true);
     QObject::connect(&delayedConnectionTimer, SIGNAL(timeout()), q, SLOT(_q_connectDelayedChannel()));
+    QObject::connect(&warmUpTimer, SIGNAL(timeout()), q, SLOT(_q_checkWarmChannels()));
 }
 
 void QHttpNetworkConnectionPrivate::pauseConnection()
@@ -628,6 +633,10 @@ QHttpNetworkReply* QHttpNetworkConnectionPrivate::queueRequest(const QHttpNetwor
     reply->setRequest(request);
     reply->d_func()->connection = q;
     reply->d_func()->connectionChannel = &channels[0]; // will have the correct one set later
+    if (statistics) {
+        reply->d_func()->statistics = statistics;
+        reply->d_func()->queueTimer.start();
+    }
     HttpMessagePair pair = qMakePair(request, reply);
 
     if (request.isPreConnect())
@@ -694,6 +703,12 @@ void QHttpNetworkConnectionPrivate::requeueRequest(const HttpMessagePair &pair)
 {
     Q_Q(QHttpNetworkConnection);
 
+    QHttpNetworkReplyPrivate *replyPrivate = pair.second->d_func();
+    if (replyPrivate->inFlight) {
+        replyPrivate->statisticsDone();
+        replyPrivate->queueTimer.start();
+    }
+
     QHttpNetworkRequest request = pair.first;
     switch (request.priority()) {
     case QHttpNetworkRequest::HighPriority:
@@ -741,6 +756,9 @@ void QHttpNetworkConnectionPrivate::updateChannel(int i, const HttpMessagePair &
     // Now that reply is assigned a channel, correct reply to channel association
     // previously set in queueRequest.
     channels[i].reply->d_func()->connectionChannel = &channels[i];
+    const bool reused = std::exchange(channels[i].connectionUsed, true)
+            && channels[i].socket && channels[i].socket->state() == QAbstractSocket::ConnectedState;
+    channels[i].reply->d_func()->statisticsDispatched(reused, false);
 }
 
 QHttpNetworkRequest QHttpNetworkConnectionPrivate::predictNextRequest() const
@@ -1042,6 +1060,8 @@ void QHttpNetworkConnectionPrivate::_q_startNextRequest()
     if (state == PausedState)
         return;
 
+    ensureWarmChannels();
+
     //resend the necessary ones.
     for (int i = 0; i < activeChannelCount; ++i) {
         if (channels[i].resendCurrent && (channels[i].state != QHttpNetworkConnectionChannel::ClosingState)) {
@@ -1348,6 +1368,77 @@ void QHttpNetworkConnectionPrivate::_q_connectDelayedChannel()
         channels[1].ensureConnection();
 }
 
+void QHttpNetworkConnectionPrivate::warmUp(int channelsToWarm, qint64 keepAliveSeconds)
+{
+    warmChannelCount = qBound(warmChannelCount, channelsToWarm, channelCount);
+
+    // Check on the channels a few times per keep-alive period (that is, how
+    // long an unused connection stays in QNetworkAccessManager's cache), so
+    // that one the server dropped is back before the next request needs it:
+    using namespace std::chrono_literals;
+    const auto keepAlive = std::chrono::seconds(keepAliveSeconds < 0 ? 120 : keepAliveSeconds);
+    const auto interval = qBound(std::chrono::milliseconds(1s),
+                                 std::chrono::milliseconds(keepAlive) / 4,
+                                 std::chrono::milliseconds(30s));
+    if (!warmUpTimer.isActive() || interval < warmUpTimer.intervalAsDuration())
+        warmUpTimer.start(interval);
+}
+
+// Connect idle channels until warmChannelCount of them are open (or opening).
+// For HTTP/2 this is the one channel we use; the others only come into play if
+// ALPN makes us fall back to HTTP/1.1, which resets activeChannelCount.
+void QHttpNetworkConnectionPrivate::ensureWarmChannels()
+{
+    if (!warmChannelCount || state == PausedState)
+        return;
+    if (networkLayerState != IPv4 && networkLayerState != IPv6)
+        return;
+
+    const auto isOpen = [](const QHttpNetworkConnectionChannel &channel) {
+        return channel.socket && channel.socket->state() != QAbstractSocket::UnconnectedState;
+    };
+    const int target = qMin(warmChannelCount, activeChannelCount);
+    int openChannels = 0;
+    for (int i = 0; i < activeChannelCount; ++i) {
+        if (isOpen(channels[i]))
+            ++openChannels;
+    }
+
+    for (int i = 0; i < activeChannelCount && openChannels < target; ++i) {
+        QHttpNetworkConnectionChannel &channel = channels[i];
+        if (isOpen(channel) || channel.reply || channel.isSocketBusy() || channel.resendCurrent)
+            continue;
+        channel.networkLayerPreference = networkLayerState == IPv4 ? QAbstractSocket::IPv4Protocol
+                                                                   : QAbstractSocket::IPv6Protocol;
+        channel.ensureConnection();
+        ++openChannels;
+    }
+}
+
+void QHttpNetworkConnectionPrivate::_q_checkWarmChannels()
+{
+    if (state == PausedState)
+        return;
+
+    // A server (or something in between) might have dropped an idle HTTP/2
+    // connection without telling us; if it doesn't answer our PING, we
+    // close it and open a new one:
+    QHttpNetworkConnectionChannel &channel = channels[0];
+    if (connectionType != QHttpNetworkConnection::ConnectionTypeHTTP && channel.protocolHandler
+        && (channel.switchedToHttp2
+            || connectionType == QHttpNetworkConnection::ConnectionTypeHTTP2Direct)
+        && channel.socket && channel.socket->state() == QAbstractSocket::ConnectedState
+        && !channel.pendingEncrypt) {
+        auto *h2 = static_cast<QHttp2ProtocolHandler *>(channel.protocolHandler.get());
+        if (!h2->checkIdleConnection()) {
+            channel.abort();
+            return; // _q_disconnected() reconnects us
+        }
+    }
+
+    ensureWarmChannels();
+}
+
 QHttpNetworkConnection::QHttpNetworkConnection(const QString &hostName, quint16 port, bool encrypt,
                                                QHttpNetworkConnection::ConnectionType connectionType, QObject *parent)
     : QObject(*(new QHttpNetworkConnectionPrivate(hostName, port, encrypt , connectionType)), parent)
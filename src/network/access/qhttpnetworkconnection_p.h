@@ -127,6 +127,7 @@ private:
     Q_PRIVATE_SLOT(d_func(), void _q_startNextRequest())
     Q_PRIVATE_SLOT(d_func(), void _q_hostLookupFinished(QHostInfo))
     Q_PRIVATE_SLOT(d_func(), void _q_connectDelayedChannel())
+    Q_PRIVATE_SLOT(d_func(), void _q_checkWarmChannels())
 };
 
 
@@ -197,6 +198,7 @@ public:
 
     void _q_hostLookupFinished(const QHostInfo &info);
     void _q_connectDelayedChannel();
+    void _q_checkWarmChannels();
 
     void createAuthorization(QAbstractSocket *socket, QHttpNetworkRequest &request);
 
@@ -243,6 +245,14 @@ public:
 
     int preConnectRequests;
 
+    // Connection warm-up, see QNetworkAccessManager::warmUpConnections(): the
+    // number of channels we keep connected even while there is nothing to
+    // send, and the timer that checks on them periodically.
+    void warmUp(int channels, qint64 keepAliveSeconds);
+    void ensureWarmChannels();
+    int warmChannelCount = 0;
+    QTimer warmUpTimer;
+
     QHttpNetworkConnection::ConnectionType connectionType;
 
 #ifndef QT_NO_SSL
@@ -261,6 +271,9 @@ public:
     // early).
     QNetworkConnectionMonitor connectionMonitor;
 
+    // shared with the QNetworkAccessManager, may be null
+    std::shared_ptr<QNetworkConnectionStatisticsCollector> statistics;
+
     friend class QHttpNetworkConnectionChannel;
 };
 
@@ -370,6 +370,7 @@ bool QHttpNetworkConnectionChannel::ensureConnection()
                 QSslSocketPrivate::checkSettingSslContext(sslSocket, std::move(ctx));
 
             sslSocket->setPeerVerifyName(connection->d_func()->peerVerifyName);
+            connectTimer.start();
             sslSocket->connectToHostEncrypted(connectHost, connectPort, QIODevice::ReadWrite, networkLayerPreference);
             if (ignoreAllSslErrors)
                 sslSocket->ignoreSslErrors();
@@ -392,11 +393,13 @@ bool QHttpNetworkConnectionChannel::ensureConnection()
                     && connection->cacheProxy().type() == QNetworkProxy::NoProxy
                     && connection->transparentProxy().type() == QNetworkProxy::NoProxy) {
 #endif
+                connectTimer.start();
                 socket->connectToHost(connectHost, connectPort, QIODevice::ReadWrite | QIODevice::Unbuffered, networkLayerPreference);
                 // For an Unbuffered QTcpSocket, the read buffer size has a special meaning.
                 socket->setReadBufferSize(1*1024);
 #ifndef QT_NO_NETWORKPROXY
             } else {
+                connectTimer.start();
                 socket->connectToHost(connectHost, connectPort, QIODevice::ReadWrite, networkLayerPreference);
 
                 // limit the socket read buffer size. we will read everything into
@@ -570,6 +573,19 @@ void QHttpNetworkConnectionChannel::detectPipeliningSupport()
     }
 }
 
+void QHttpNetworkConnectionChannel::connectionClosedForStatistics()
+{
+    connectionUsed = false;
+    if (!connectionCounted)
+        return;
+    connectionCounted = false;
+    connectTimer.invalidate();
+    if (connection) {
+        if (const auto &statistics = connection->d_func()->statistics)
+            statistics->connectionClosed(connection->d_func()->hostName);
+    }
+}
+
 // called when the connection broke and we need to queue some pipelined requests again
 void QHttpNetworkConnectionChannel::requeueCurrentlyPipelinedRequests()
 {
@@ -728,6 +744,7 @@ void QHttpNetworkConnectionChannel::pipelineInto(HttpMessagePair &pair)
     reply->d_func()->connectionChannel = this;
     reply->d_func()->autoDecompress = request.d->autoDecompress;
     reply->d_func()->pipeliningUsed = true;
+    reply->d_func()->statisticsDispatched(true, false);
 
 #ifndef QT_NO_NETWORKPROXY
     pipeline.append(QHttpNetworkRequestPrivate::header(request,
@@ -812,6 +829,8 @@ void QHttpNetworkConnectionChannel::_q_bytesWritten(qint64 bytes)
 
 void QHttpNetworkConnectionChannel::_q_disconnected()
 {
+    connectionClosedForStatistics();
+
     if (state == QHttpNetworkConnectionChannel::ClosingState) {
         state = QHttpNetworkConnectionChannel::IdleState;
         QMetaObject::invokeMethod(connection, "_q_startNextRequest", Qt::QueuedConnection);
@@ -870,6 +889,13 @@ void QHttpNetworkConnectionChannel::_q_connected()
         //The connections networkLayerState had already been decided.
     }
 
+    if (const auto &statistics = connection->d_func()->statistics;
+        statistics && !connectionCounted && connectTimer.isValid()) {
+        statistics->connectionOpened(connection->d_func()->hostName, connectTimer.nsecsElapsed());
+        connectionCounted = true;
+        connectTimer.start(); // for the TLS handshake, if any
+    }
+
     // improve performance since we get the request sent by the kernel ASAP
     //socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
     // We have this commented out now. It did not have the effect we wanted. If we want to
@@ -1165,6 +1191,12 @@ void QHttpNetworkConnectionChannel::_q_encrypted()
     QSslSocket *sslSocket = qobject_cast<QSslSocket *>(socket);
     Q_ASSERT(sslSocket);
 
+    if (const auto &statistics = connection->d_func()->statistics;
+        statistics && connectionCounted && connectTimer.isValid()) {
+        statistics->tlsHandshakeDone(connection->d_func()->hostName, connectTimer.nsecsElapsed());
+        connectTimer.invalidate();
+    }
+
     if (!protocolHandler && connection->connectionType() != QHttpNetworkConnection::ConnectionTypeHTTP2Direct) {
         // ConnectionTypeHTTP2Direct does not rely on ALPN/NPN to negotiate HTTP/2,
         // after establishing a secure connection we immediately start sending
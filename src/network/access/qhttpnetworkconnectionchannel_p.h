@@ -40,6 +40,7 @@
 #   include <QtNetwork/qtcpsocket.h>
 #endif
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qpointer.h>
 #include <QtCore/qscopedpointer.h>
 
@@ -102,6 +103,12 @@ public:
     // to emit the signal for all in-flight replies:
     void emitFinishedWithError(QNetworkReply::NetworkError error, const char *message);
 
+    // for QNetworkConnectionStatistics
+    QElapsedTimer connectTimer; // from connectToHost() to connected(), then to encrypted()
+    bool connectionCounted = false;
+    bool connectionUsed = false; // a request was dispatched on the current connection
+    void connectionClosedForStatistics();
+
     // HTTP pipelining -> http://en.wikipedia.org/wiki/Http_pipelining
     enum PipeliningSupport {
         PipeliningSupportUnknown, // default for a new connection
@@ -24,6 +24,7 @@ QHttpNetworkReply::QHttpNetworkReply(const QUrl &url, QObject *parent)
 QHttpNetworkReply::~QHttpNetworkReply()
 {
     Q_D(QHttpNetworkReply);
+    d->statisticsDone();
     if (d->connection) {
         d->connection->d_func()->removeReply(this);
     }
@@ -325,6 +326,24 @@ QHttpNetworkReplyPrivate::QHttpNetworkReplyPrivate(const QUrl &newUrl)
 
 QHttpNetworkReplyPrivate::~QHttpNetworkReplyPrivate() = default;
 
+void QHttpNetworkReplyPrivate::statisticsDispatched(bool reusedConnection, bool http2)
+{
+    if (!statistics || inFlight || request.isPreConnect())
+        return;
+    inFlight = true;
+    inFlightOnHttp2 = http2;
+    statistics->requestDispatched(request.url().host(), queueTimer.nsecsElapsed(),
+                                  reusedConnection, http2);
+}
+
+void QHttpNetworkReplyPrivate::statisticsDone()
+{
+    if (!inFlight)
+        return;
+    inFlight = false;
+    statistics->requestDone(request.url().host(), inFlightOnHttp2);
+}
+
 void QHttpNetworkReplyPrivate::clearHttpLayerInformation()
 {
     state = NothingDoneState;
@@ -41,9 +41,13 @@ Q_MOC_INCLUDE(<QtNetwork/QNetworkProxy>)
 Q_MOC_INCLUDE(<QtNetwork/QAuthenticator>)
 
 #include <private/qdecompresshelper_p.h>
+#include <private/qnetworkconnectionstatistics_p.h>
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qpointer.h>
 
+#include <memory>
+
 QT_REQUIRE_CONFIG(http);
 
 QT_BEGIN_NAMESPACE
@@ -242,6 +246,15 @@ public:
 
     char* userProvidedDownloadBuffer;
     QUrl redirectUrl;
+
+    // for QNetworkConnectionStatistics; not touched by clear(), since
+    // pipelined replies are cleared after having been dispatched
+    void statisticsDispatched(bool reusedConnection, bool http2);
+    void statisticsDone();
+    std::shared_ptr<QNetworkConnectionStatisticsCollector> statistics;
+    QElapsedTimer queueTimer;
+    bool inFlight = false;
+    bool inFlightOnHttp2 = false;
 };
 
 
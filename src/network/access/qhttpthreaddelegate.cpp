@@ -9,6 +9,8 @@
 #include <QAuthenticator>
 #include <QEventLoop>
 #include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QScopeGuard>
 
 #include "private/qhttpnetworkreply_p.h"
 #include "private/qnetworkaccesscache_p.h"
@@ -191,6 +193,9 @@ QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     , pendingDownloadProgress()
     , synchronous(false)
     , connectionCacheExpiryTimeoutSeconds(-1)
+    , warmUpConnectionCount(0)
+    , decompressInBackground(false)
+    , decompressedSafetyCheckThreshold(10 * 1024 * 1024)
     , incomingStatusCode(0)
     , isPipeliningUsed(false)
     , isHttp2Used(false)
@@ -200,6 +205,7 @@ QHttpThreadDelegate::QHttpThreadDelegate(QObject *parent) :
     , downloadBuffer()
     , httpConnection(nullptr)
     , httpReply(nullptr)
+    , finishAfterDecompressing(false)
     , synchronousRequestLoop(nullptr)
 {
 }
@@ -314,6 +320,7 @@ void QHttpThreadDelegate::startRequest()
         httpConnection->setCacheProxy(cacheProxy);
 #endif
         httpConnection->setPeerVerifyName(httpRequest.peerVerifyName());
+        httpConnection->d_func()->statistics = connectionStatistics;
         // cache the QHttpNetworkConnection corresponding to this cache key
         connections.localData()->addEntry(cacheKey, httpConnection, connectionCacheExpiryTimeoutSeconds);
     } else {
@@ -328,6 +335,9 @@ void QHttpThreadDelegate::startRequest()
         }
     }
 
+    if (warmUpConnectionCount > 0)
+        httpConnection->d_func()->warmUp(warmUpConnectionCount, connectionCacheExpiryTimeoutSeconds);
+
     // Send the request to the connection
     httpReply = httpConnection->sendRequest(httpRequest);
     httpReply->setParent(this);
@@ -436,6 +446,15 @@ void QHttpThreadDelegate::readyReadSlot()
     if (!downloadBuffer.isNull())
         return;
 
+    if (decompressHelper.isValid()) {
+        decompressAvailableData();
+        if (finishAfterDecompressing && httpReply && !decompressHelper.hasData()
+            && !httpReply->readAnyAvailable()) {
+            finishedSlot();
+        }
+        return;
+    }
+
     if (readBufferMaxSize) {
         if (bytesEmitted < readBufferMaxSize) {
             qint64 sizeEmitted = 0;
@@ -474,6 +493,17 @@ void QHttpThreadDelegate::finishedSlot()
 #endif
 
     // If there is still some data left emit that now
+    if (decompressHelper.isValid()) {
+        decompressAvailableData();
+        if (!httpReply)
+            return; // decompression failed
+        if (decompressHelper.hasData() || httpReply->readAnyAvailable()) {
+            // Finish once the user thread has read enough for us to emit the
+            // rest, see readyReadSlot()
+            finishAfterDecompressing = true;
+            return;
+        }
+    }
     while (httpReply->readAnyAvailable()) {
         pendingDownloadData->fetchAndAddRelease(1);
         emit downloadData(httpReply->readAny());
@@ -502,6 +532,69 @@ void QHttpThreadDelegate::finishedSlot()
     httpReply = nullptr;
 }
 
+// Moves the data available in the reply through the decompressor and emits the
+// result. This keeps to the read buffer size of the QNetworkReply, leaving the
+// rest of the compressed data with the reply so that it stops reading from the
+// socket.
+void QHttpThreadDelegate::decompressAvailableData()
+{
+    // Keep the signals reasonably sized so that the user thread gets to run
+    // while we are still decompressing the rest
+    constexpr qint64 MaxChunkSize = 64 * 1024;
+
+    // Sent after the data, so the reply's counters cover what it has received
+    const auto reportStatistics = qScopeGuard([this] {
+        if (decompressHelper.isValid()) {
+            emit decompressionStatistics(decompressHelper.compressedBytes(),
+                                         decompressHelper.decompressedBytes(),
+                                         decompressHelper.decompressionTime());
+        }
+    });
+
+    while (true) {
+        qint64 chunkSize = MaxChunkSize;
+        if (readBufferMaxSize) {
+            chunkSize = qMin(chunkSize, readBufferMaxSize - bytesEmitted);
+            if (chunkSize <= 0)
+                return; // We need to wait until the user thread read some data
+        }
+
+        if (decompressHelper.hasData()) {
+            QByteArray chunk(chunkSize, Qt::Uninitialized);
+            const qsizetype bytesRead = decompressHelper.read(chunk.data(), chunk.size());
+            if (bytesRead < 0) {
+                decompressionFailed();
+                return;
+            }
+            if (bytesRead > 0) {
+                chunk.truncate(bytesRead);
+                if (readBufferMaxSize)
+                    bytesEmitted += bytesRead;
+                pendingDownloadData->fetchAndAddRelease(1);
+                emit downloadData(chunk);
+                continue;
+            }
+        }
+
+        if (!httpReply->readAnyAvailable())
+            return;
+        decompressHelper.feed(httpReply->readAny());
+        if (!decompressHelper.isValid()) {
+            decompressionFailed();
+            return;
+        }
+    }
+}
+
+void QHttpThreadDelegate::decompressionFailed()
+{
+    const QString detail = QCoreApplication::translate("QHttp", "Decompression failed: %1")
+                                   .arg(decompressHelper.errorString());
+    decompressHelper.clear();
+    httpReply->abort();
+    finishedWithErrorSlot(QNetworkReply::UnknownContentError, detail);
+}
+
 void QHttpThreadDelegate::synchronousFinishedSlot()
 {
     if (!httpReply)
@@ -600,7 +693,18 @@ void QHttpThreadDelegate::headerChangedSlot()
     incomingContentLength = httpReply->contentLength();
     removedContentLength = httpReply->removedContentLength();
     isHttp2Used = httpReply->isHttp2Used();
-    isCompressed = httpReply->isCompressed();
+
+    // The body of a redirect we follow is never read by the user, so it must
+    // not be held back by the read buffer size
+    const bool followsRedirect = httpRequest.isFollowRedirects() && httpReply->isRedirecting();
+    if (decompressInBackground && httpReply->isCompressed() && !followsRedirect
+        && !decompressHelper.isValid()) {
+        // If this fails the user thread will try again and report the error
+        if (decompressHelper.setEncoding(httpReply->headerField("content-encoding")))
+            decompressHelper.setDecompressedSafetyCheckThreshold(decompressedSafetyCheckThreshold);
+    }
+    // Tells the user thread whether the data we emit still needs decompressing
+    isCompressed = httpReply->isCompressed() && !decompressHelper.isValid();
 
     emit downloadMetaData(incomingHeaders,
                           incomingStatusCode,
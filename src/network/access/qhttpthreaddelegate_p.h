@@ -31,6 +31,7 @@
 #include <QSharedPointer>
 #include <QScopedPointer>
 #include "private/qnoncontiguousbytedevice_p.h"
+#include "private/qdecompresshelper_p.h"
 #include "qnetworkaccessauthenticationmanager_p.h"
 #include <QtNetwork/private/http2protocol_p.h>
 
@@ -69,8 +70,14 @@ public:
     QNetworkProxy transparentProxy;
 #endif
     std::shared_ptr<QNetworkAccessAuthenticationManager> authenticationManager;
+    std::shared_ptr<QNetworkConnectionStatisticsCollector> connectionStatistics;
     bool synchronous;
     qint64 connectionCacheExpiryTimeoutSeconds;
+    // Number of connections to keep open, see QNetworkAccessManager::warmUpConnections()
+    int warmUpConnectionCount;
+    // Decompress the reply body here instead of in the user thread
+    bool decompressInBackground;
+    qint64 decompressedSafetyCheckThreshold;
 
     // outgoing, Retrieved in the synchronous HTTP case
     QByteArray synchronousDownloadData;
@@ -95,6 +102,12 @@ protected:
     QNetworkAccessCachedHttpConnection *httpConnection;
     QByteArray cacheKey;
     QHttpNetworkReply *httpReply;
+    // Only valid if decompressInBackground is set and the reply is compressed
+    QDecompressHelper decompressHelper;
+    bool finishAfterDecompressing;
+
+    void decompressAvailableData();
+    void decompressionFailed();
 
     // Used for implementing the synchronous HTTP, see startRequestSynchronously()
     QEventLoop *synchronousRequestLoop;
@@ -116,6 +129,8 @@ signals:
                           QSharedPointer<char>, qint64, qint64, bool, bool);
     void downloadProgress(qint64, qint64);
     void downloadData(const QByteArray &);
+    void decompressionStatistics(qint64 compressedBytes, qint64 decompressedBytes,
+                                 qint64 decompressionTime);
     void error(QNetworkReply::NetworkError, const QString &);
     void downloadFinished();
     void redirected(const QUrl &url, int httpStatus, int maxRedirectsRemainig);
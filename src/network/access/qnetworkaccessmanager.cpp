@@ -30,6 +30,7 @@
 #include "QtCore/qbuffer.h"
 #include "QtCore/qlist.h"
 #include "QtCore/qurl.h"
+#include "QtCore/qscopedvaluerollback.h"
 #include "QtNetwork/private/qauthenticator_p.h"
 #include "QtNetwork/qsslconfiguration.h"
 
@@ -1041,6 +1042,69 @@ void QNetworkAccessManager::connectToHost(const QString &hostName, quint16 port)
     get(request);
 }
 
+#if QT_CONFIG(http)
+/*!
+    \since 6.8
+
+    Opens up to \a connectionCount connections to the host that the URL of
+    \a request refers to, and keeps them open while they are not in use, so
+    that a burst of requests to that host does not wait for TCP and TLS
+    handshakes. Other than with connectToHost() and connectToHostEncrypted(),
+    the connections are opened in parallel, and any that the server closes
+    while idle are opened again.
+
+    The URL's scheme must be \c http or \c https. The request's attributes
+    and configuration select the connections in the same way as they do for
+    get(), for instance QNetworkRequest::Http2AllowedAttribute,
+    QNetworkRequest::Http2DirectAttribute, the SSL configuration and
+    QHttp1Configuration::numberOfConnectionsPerHost(), which is the most
+    connections that are opened.
+
+    When HTTP/2 is used, a single connection is opened regardless of
+    \a connectionCount, and the HTTP/2 connection preface and SETTINGS are
+    exchanged right away. An idle HTTP/2 connection is checked with a PING
+    frame, and replaced if the server does not answer. If ALPN makes the
+    connection fall back to HTTP/1.1, \a connectionCount connections are
+    opened.
+
+    The connections are kept open for as long as QNetworkAccessManager
+    keeps unused connections, which can be set with
+    QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute on
+    \a request, and are checked several times during this period.
+
+    \note This function has no possibility to report errors.
+
+    \sa connectToHost(), connectToHostEncrypted(), clearConnectionCache()
+*/
+void QNetworkAccessManager::warmUpConnections(const QNetworkRequest &request, int connectionCount)
+{
+    if (connectionCount < 1)
+        return;
+
+    QUrl url = request.url().adjusted(QUrl::RemovePath | QUrl::RemoveQuery
+                                      | QUrl::RemoveFragment);
+    const QString scheme = url.scheme().toLower();
+    if (scheme == "http"_L1) {
+        url.setScheme("preconnect-http"_L1);
+#ifndef QT_NO_SSL
+    } else if (scheme == "https"_L1) {
+        url.setScheme("preconnect-https"_L1);
+#endif
+    } else {
+        qWarning("QNetworkAccessManager::warmUpConnections: unsupported scheme '%ls'",
+                 qUtf16Printable(scheme));
+        return;
+    }
+
+    QNetworkRequest warmUpRequest(request);
+    warmUpRequest.setUrl(url);
+    warmUpRequest.setAttribute(QNetworkRequest::AutoDeleteReplyOnFinishAttribute, true);
+    Q_D(QNetworkAccessManager);
+    const QScopedValueRollback<int> rollback(d->warmUpConnectionCount, connectionCount);
+    get(warmUpRequest);
+}
+#endif // QT_CONFIG(http)
+
 /*!
     \since 5.9
 
@@ -1458,6 +1522,41 @@ void QNetworkAccessManager::setTransferTimeout(int timeout)
     d_func()->transferTimeout = timeout;
 }
 
+#if QT_CONFIG(http)
+/*!
+    \since 6.8
+
+    Returns the statistics this manager has collected about the connections
+    it used for HTTP and HTTPS requests: how long requests waited for a
+    connection, how long connecting took, and how busy and how often reused
+    the connections were.
+
+    The counters are updated from the thread that handles the network
+    traffic, so the values of a returned object may be a few events apart
+    from each other if requests are in progress.
+
+    \sa resetConnectionStatistics(), QNetworkConnectionStatistics
+*/
+QNetworkConnectionStatistics QNetworkAccessManager::connectionStatistics() const
+{
+    return d_func()->connectionStatistics->snapshot();
+}
+
+/*!
+    \since 6.8
+
+    Resets the totals and counts returned by connectionStatistics() to zero,
+    and the peak values to the current ones. Connections and requests that
+    are in progress keep being counted as open and in flight.
+
+    \sa connectionStatistics()
+*/
+void QNetworkAccessManager::resetConnectionStatistics()
+{
+    d_func()->connectionStatistics->reset();
+}
+#endif // QT_CONFIG(http)
+
 void QNetworkAccessManagerPrivate::_q_replyFinished(QNetworkReply *reply)
 {
     Q_Q(QNetworkAccessManager);
@@ -6,6 +6,9 @@
 
 #include <QtNetwork/qtnetworkglobal.h>
 #include <QtNetwork/qnetworkrequest.h>
+#if QT_CONFIG(http)
+#include <QtNetwork/qnetworkconnectionstatistics.h>
+#endif
 #include <QtCore/QString>
 #include <QtCore/QList>
 #include <QtCore/QObject>
@@ -104,6 +107,9 @@ public:
                                 const QString &peerName);
 #endif
     void connectToHost(const QString &hostName, quint16 port = 80);
+#if QT_CONFIG(http)
+    void warmUpConnections(const QNetworkRequest &request, int connectionCount = 1);
+#endif
 
     void setRedirectPolicy(QNetworkRequest::RedirectPolicy policy);
     QNetworkRequest::RedirectPolicy redirectPolicy() const;
@@ -114,6 +120,11 @@ public:
     int transferTimeout() const;
     void setTransferTimeout(int timeout = QNetworkRequest::DefaultTransferTimeoutConstant);
 
+#if QT_CONFIG(http)
+    QNetworkConnectionStatistics connectionStatistics() const;
+    void resetConnectionStatistics();
+#endif
+
 Q_SIGNALS:
 #ifndef QT_NO_NETWORKPROXY
     void proxyAuthenticationRequired(const QNetworkProxy &proxy, QAuthenticator *authenticator);
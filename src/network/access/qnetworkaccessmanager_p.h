@@ -30,6 +30,10 @@
 #include "qhstsstore_p.h"
 #endif // QT_CONFIG(settings)
 
+#if QT_CONFIG(http)
+#include "qnetworkconnectionstatistics_p.h"
+#endif
+
 QT_BEGIN_NAMESPACE
 
 class QAuthenticator;
@@ -116,6 +120,14 @@ public:
     // The cache with authorization data:
     std::shared_ptr<QNetworkAccessAuthenticationManager> authenticationManager;
 
+#if QT_CONFIG(http)
+    // Shared with the connections in our HTTP thread, which update it
+    std::shared_ptr<QNetworkConnectionStatisticsCollector> connectionStatistics =
+            std::make_shared<QNetworkConnectionStatisticsCollector>();
+    // Set by warmUpConnections() while it creates its reply, which takes it over
+    int warmUpConnectionCount = 0;
+#endif
+
     // this cache can be used by individual backends to cache e.g. their TCP connections to a server
     // and use the connections for multiple requests.
     QNetworkAccessCache objectCache;
@@ -0,0 +1,356 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qnetworkconnectionstatistics.h"
+#include "qnetworkconnectionstatistics_p.h"
+
+#include <qtnetwork_tracepoints_p.h>
+
+QT_BEGIN_NAMESPACE
+
+Q_TRACE_POINT(qtnetwork, QNetworkConnectionStatistics_requestDispatched, const QString &host, qint64 queueWaitNSecs, bool reusedConnection, bool http2);
+Q_TRACE_POINT(qtnetwork, QNetworkConnectionStatistics_requestDone, const QString &host, bool http2);
+Q_TRACE_POINT(qtnetwork, QNetworkConnectionStatistics_connectionOpened, const QString &host, qint64 connectNSecs);
+Q_TRACE_POINT(qtnetwork, QNetworkConnectionStatistics_tlsHandshakeDone, const QString &host, qint64 handshakeNSecs);
+Q_TRACE_POINT(qtnetwork, QNetworkConnectionStatistics_connectionClosed, const QString &host);
+
+using Counter = QNetworkConnectionStatisticsPrivate::Counter;
+
+/*!
+    \class QNetworkConnectionStatistics
+    \brief The QNetworkConnectionStatistics class describes how a
+    QNetworkAccessManager made use of its HTTP connections.
+    \since 6.8
+
+    \reentrant
+    \inmodule QtNetwork
+    \ingroup network
+    \ingroup shared
+
+    QNetworkAccessManager keeps a pool of connections for every host it talks
+    to over HTTP, and queues requests until a connection, or for HTTP/2 a
+    stream, is available to send them on. QNetworkConnectionStatistics is a
+    snapshot of the counters the manager keeps about this, as returned by
+    QNetworkAccessManager::connectionStatistics(). It tells whether requests
+    spend their time waiting for a connection, for the connection to be
+    established, or for the server, which helps with sizing the pool, for
+    instance with QHttp1Configuration::setNumberOfConnectionsPerHost().
+
+    The totals and counts accumulate from the creation of the manager, or from
+    the last call to QNetworkAccessManager::resetConnectionStatistics(). Dividing
+    a total time by its count gives the average. The in-flight and open counts
+    describe the state at the time the snapshot was taken.
+
+    The same events are also available as trace points of the \c qtnetwork
+    provider if Qt was built with tracing support.
+
+    \sa QNetworkAccessManager::connectionStatistics()
+*/
+
+/*!
+    Constructs an empty QNetworkConnectionStatistics object, with all
+    counters at zero.
+*/
+QNetworkConnectionStatistics::QNetworkConnectionStatistics()
+    : d(new QNetworkConnectionStatisticsPrivate)
+{
+}
+
+/*!
+    Copy-constructs a QNetworkConnectionStatistics object from \a other.
+*/
+QNetworkConnectionStatistics::QNetworkConnectionStatistics(const QNetworkConnectionStatistics &other)
+    = default;
+
+/*!
+    \fn QNetworkConnectionStatistics::QNetworkConnectionStatistics(QNetworkConnectionStatistics &&other)
+
+    Move-constructs a QNetworkConnectionStatistics object from \a other.
+
+    \note The moved-from object \a other is placed in a
+    partially-formed state, in which the only valid operations are
+    destruction and assignment of a new value.
+*/
+
+/*!
+    Copy-assigns \a other to this QNetworkConnectionStatistics object.
+*/
+QNetworkConnectionStatistics &
+QNetworkConnectionStatistics::operator=(const QNetworkConnectionStatistics &other) = default;
+
+/*!
+    \fn QNetworkConnectionStatistics &QNetworkConnectionStatistics::operator=(QNetworkConnectionStatistics &&other)
+
+    Move-assigns \a other to this QNetworkConnectionStatistics object.
+*/
+
+/*!
+    Destroys the QNetworkConnectionStatistics object.
+*/
+QNetworkConnectionStatistics::~QNetworkConnectionStatistics() = default;
+
+/*!
+    \fn void QNetworkConnectionStatistics::swap(QNetworkConnectionStatistics &other)
+
+    Swaps this object with \a other. This operation is very fast and never
+    fails.
+*/
+
+/*!
+    Returns the number of requests that were sent on a connection, or for
+    HTTP/2 on a stream. A request that has to be sent again, for instance
+    because the server closed a persistent connection, is counted again.
+
+    \sa reusedConnectionRequestCount(), totalQueueWaitTime()
+*/
+qint64 QNetworkConnectionStatistics::requestCount() const
+{
+    return d->values[Counter::RequestCount];
+}
+
+/*!
+    Returns the number of requests that were sent on a connection that was
+    already established, rather than on one opened for them.
+
+    \sa requestCount(), connectionReuseRatio()
+*/
+qint64 QNetworkConnectionStatistics::reusedConnectionRequestCount() const
+{
+    return d->values[Counter::ReusedConnectionRequestCount];
+}
+
+/*!
+    Returns the share of requests that were sent on an already established
+    connection, between 0 and 1, or 0 if no request was sent.
+
+    \sa reusedConnectionRequestCount()
+*/
+double QNetworkConnectionStatistics::connectionReuseRatio() const
+{
+    const qint64 requests = requestCount();
+    return requests ? double(reusedConnectionRequestCount()) / requests : 0.;
+}
+
+/*!
+    Returns the time that requests spent waiting for a connection or stream
+    to be sent on, in total.
+
+    \sa maximumQueueWaitTime(), requestCount()
+*/
+std::chrono::nanoseconds QNetworkConnectionStatistics::totalQueueWaitTime() const
+{
+    return std::chrono::nanoseconds(d->values[Counter::QueueWaitTime]);
+}
+
+/*!
+    Returns the longest time a request spent waiting for a connection or
+    stream to be sent on.
+
+    \sa totalQueueWaitTime()
+*/
+std::chrono::nanoseconds QNetworkConnectionStatistics::maximumQueueWaitTime() const
+{
+    return std::chrono::nanoseconds(d->values[Counter::MaximumQueueWaitTime]);
+}
+
+/*!
+    Returns the number of connections that were established.
+
+    \sa totalConnectTime(), openConnections()
+*/
+qint64 QNetworkConnectionStatistics::connectionCount() const
+{
+    return d->values[Counter::ConnectionCount];
+}
+
+/*!
+    Returns the time it took to establish connections, including looking up
+    the host name, in total. For encrypted connections this does not include
+    the TLS handshake.
+
+    \sa connectionCount(), totalTlsHandshakeTime()
+*/
+std::chrono::nanoseconds QNetworkConnectionStatistics::totalConnectTime() const
+{
+    return std::chrono::nanoseconds(d->values[Counter::ConnectTime]);
+}
+
+/*!
+    Returns the number of TLS handshakes that were completed.
+
+    \sa totalTlsHandshakeTime()
+*/
+qint64 QNetworkConnectionStatistics::tlsHandshakeCount() const
+{
+    return d->values[Counter::TlsHandshakeCount];
+}
+
+/*!
+    Returns the time that completed TLS handshakes took, in total.
+
+    \sa tlsHandshakeCount(), totalConnectTime()
+*/
+std::chrono::nanoseconds QNetworkConnectionStatistics::totalTlsHandshakeTime() const
+{
+    return std::chrono::nanoseconds(d->values[Counter::TlsHandshakeTime]);
+}
+
+/*!
+    Returns the number of connections that are open.
+
+    \sa peakOpenConnections(), connectionCount()
+*/
+qint64 QNetworkConnectionStatistics::openConnections() const
+{
+    return d->values[Counter::OpenConnections];
+}
+
+/*!
+    Returns the highest number of connections that were open at the same time.
+
+    \sa openConnections()
+*/
+qint64 QNetworkConnectionStatistics::peakOpenConnections() const
+{
+    return d->values[Counter::PeakOpenConnections];
+}
+
+/*!
+    Returns the number of HTTP/1 requests that have been sent and are waiting
+    for, or receiving, their reply. Without pipelining each of them occupies
+    one connection, so comparing this to openConnections() and to the number
+    of connections per host tells how busy the pool is.
+
+    \sa peakRequestsInFlight(), http2StreamsInFlight()
+*/
+qint64 QNetworkConnectionStatistics::requestsInFlight() const
+{
+    return d->values[Counter::RequestsInFlight];
+}
+
+/*!
+    Returns the highest number of HTTP/1 requests that were in flight at the
+    same time.
+
+    \sa requestsInFlight()
+*/
+qint64 QNetworkConnectionStatistics::peakRequestsInFlight() const
+{
+    return d->values[Counter::PeakRequestsInFlight];
+}
+
+/*!
+    Returns the number of HTTP/2 streams that are open.
+
+    \sa peakHttp2StreamsInFlight(), requestsInFlight()
+*/
+qint64 QNetworkConnectionStatistics::http2StreamsInFlight() const
+{
+    return d->values[Counter::Http2StreamsInFlight];
+}
+
+/*!
+    Returns the highest number of HTTP/2 streams that were open at the same
+    time.
+
+    \sa http2StreamsInFlight()
+*/
+qint64 QNetworkConnectionStatistics::peakHttp2StreamsInFlight() const
+{
+    return d->values[Counter::PeakHttp2StreamsInFlight];
+}
+
+void QNetworkConnectionStatisticsCollector::raise(Counter counter, qint64 value)
+{
+    qint64 current = counters[counter].load(std::memory_order_relaxed);
+    while (current < value
+           && !counters[counter].compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void QNetworkConnectionStatisticsCollector::increment(Counter gauge, Counter peak)
+{
+    raise(peak, counters[gauge].fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+void QNetworkConnectionStatisticsCollector::requestDispatched(const QString &host,
+                                                              qint64 queueWaitNSecs,
+                                                              bool reusedConnection, bool http2)
+{
+    Q_TRACE(QNetworkConnectionStatistics_requestDispatched, host, queueWaitNSecs,
+            reusedConnection, http2);
+    Q_UNUSED(host);
+    add(Counter::RequestCount, 1);
+    if (reusedConnection)
+        add(Counter::ReusedConnectionRequestCount, 1);
+    add(Counter::QueueWaitTime, queueWaitNSecs);
+    raise(Counter::MaximumQueueWaitTime, queueWaitNSecs);
+    if (http2)
+        increment(Counter::Http2StreamsInFlight, Counter::PeakHttp2StreamsInFlight);
+    else
+        increment(Counter::RequestsInFlight, Counter::PeakRequestsInFlight);
+}
+
+void QNetworkConnectionStatisticsCollector::requestDone(const QString &host, bool http2)
+{
+    Q_TRACE(QNetworkConnectionStatistics_requestDone, host, http2);
+    Q_UNUSED(host);
+    add(http2 ? Counter::Http2StreamsInFlight : Counter::RequestsInFlight, -1);
+}
+
+void QNetworkConnectionStatisticsCollector::connectionOpened(const QString &host,
+                                                             qint64 connectNSecs)
+{
+    Q_TRACE(QNetworkConnectionStatistics_connectionOpened, host, connectNSecs);
+    Q_UNUSED(host);
+    add(Counter::ConnectionCount, 1);
+    add(Counter::ConnectTime, connectNSecs);
+    increment(Counter::OpenConnections, Counter::PeakOpenConnections);
+}
+
+void QNetworkConnectionStatisticsCollector::tlsHandshakeDone(const QString &host,
+                                                             qint64 handshakeNSecs)
+{
+    Q_TRACE(QNetworkConnectionStatistics_tlsHandshakeDone, host, handshakeNSecs);
+    Q_UNUSED(host);
+    add(Counter::TlsHandshakeCount, 1);
+    add(Counter::TlsHandshakeTime, handshakeNSecs);
+}
+
+void QNetworkConnectionStatisticsCollector::connectionClosed(const QString &host)
+{
+    Q_TRACE(QNetworkConnectionStatistics_connectionClosed, host);
+    Q_UNUSED(host);
+    add(Counter::OpenConnections, -1);
+}
+
+QNetworkConnectionStatistics QNetworkConnectionStatisticsCollector::snapshot() const
+{
+    QNetworkConnectionStatistics statistics;
+    for (int i = 0; i < QNetworkConnectionStatisticsPrivate::CounterCount; ++i)
+        statistics.d->values[i] = counters[i].load(std::memory_order_relaxed);
+    return statistics;
+}
+
+// Clears what accumulates over time; what is open or in flight stays, and
+// becomes the new peak.
+void QNetworkConnectionStatisticsCollector::reset()
+{
+    for (Counter counter : { Counter::RequestCount, Counter::ReusedConnectionRequestCount,
+                             Counter::QueueWaitTime, Counter::MaximumQueueWaitTime,
+                             Counter::ConnectionCount, Counter::ConnectTime,
+                             Counter::TlsHandshakeCount, Counter::TlsHandshakeTime }) {
+        counters[counter].store(0, std::memory_order_relaxed);
+    }
+    counters[Counter::PeakOpenConnections].store(
+            counters[Counter::OpenConnections].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    counters[Counter::PeakRequestsInFlight].store(
+            counters[Counter::RequestsInFlight].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    counters[Counter::PeakHttp2StreamsInFlight].store(
+            counters[Counter::Http2StreamsInFlight].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+}
+
+QT_END_NAMESPACE
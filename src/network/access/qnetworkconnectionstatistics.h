@@ -0,0 +1,57 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QNETWORKCONNECTIONSTATISTICS_H
+#define QNETWORKCONNECTIONSTATISTICS_H
+
+#include <QtNetwork/qtnetworkglobal.h>
+
+#include <QtCore/qshareddata.h>
+
+#include <chrono>
+
+QT_REQUIRE_CONFIG(http);
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkConnectionStatisticsPrivate;
+class Q_NETWORK_EXPORT QNetworkConnectionStatistics
+{
+public:
+    QNetworkConnectionStatistics();
+    QNetworkConnectionStatistics(const QNetworkConnectionStatistics &other);
+    QNetworkConnectionStatistics(QNetworkConnectionStatistics &&other) noexcept = default;
+    QNetworkConnectionStatistics &operator=(const QNetworkConnectionStatistics &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QNetworkConnectionStatistics)
+    ~QNetworkConnectionStatistics();
+
+    void swap(QNetworkConnectionStatistics &other) noexcept { d.swap(other.d); }
+
+    qint64 requestCount() const;
+    qint64 reusedConnectionRequestCount() const;
+    double connectionReuseRatio() const;
+    std::chrono::nanoseconds totalQueueWaitTime() const;
+    std::chrono::nanoseconds maximumQueueWaitTime() const;
+
+    qint64 connectionCount() const;
+    std::chrono::nanoseconds totalConnectTime() const;
+    qint64 tlsHandshakeCount() const;
+    std::chrono::nanoseconds totalTlsHandshakeTime() const;
+
+    qint64 openConnections() const;
+    qint64 peakOpenConnections() const;
+    qint64 requestsInFlight() const;
+    qint64 peakRequestsInFlight() const;
+    qint64 http2StreamsInFlight() const;
+    qint64 peakHttp2StreamsInFlight() const;
+
+private:
+    friend class QNetworkConnectionStatisticsCollector;
+    QSharedDataPointer<QNetworkConnectionStatisticsPrivate> d;
+};
+
+Q_DECLARE_SHARED(QNetworkConnectionStatistics)
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKCONNECTIONSTATISTICS_H
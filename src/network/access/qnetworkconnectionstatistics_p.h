@@ -0,0 +1,84 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QNETWORKCONNECTIONSTATISTICS_P_H
+#define QNETWORKCONNECTIONSTATISTICS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the Network Access API.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include <QtNetwork/qnetworkconnectionstatistics.h>
+
+#include <array>
+#include <atomic>
+
+QT_REQUIRE_CONFIG(http);
+
+QT_BEGIN_NAMESPACE
+
+class QNetworkConnectionStatisticsPrivate : public QSharedData
+{
+public:
+    enum Counter {
+        RequestCount,
+        ReusedConnectionRequestCount,
+        QueueWaitTime,
+        MaximumQueueWaitTime,
+        ConnectionCount,
+        ConnectTime,
+        TlsHandshakeCount,
+        TlsHandshakeTime,
+        OpenConnections,
+        PeakOpenConnections,
+        RequestsInFlight,
+        PeakRequestsInFlight,
+        Http2StreamsInFlight,
+        PeakHttp2StreamsInFlight,
+
+        CounterCount
+    };
+
+    std::array<qint64, CounterCount> values = {};
+};
+
+/*
+    Collects the statistics of one QNetworkAccessManager. It is written to
+    from the manager's HTTP thread by QHttpNetworkConnection and its channels,
+    and read from the user's thread, so all of it is lock-free.
+*/
+class QNetworkConnectionStatisticsCollector
+{
+public:
+    void requestDispatched(const QString &host, qint64 queueWaitNSecs, bool reusedConnection,
+                           bool http2);
+    void requestDone(const QString &host, bool http2);
+    void connectionOpened(const QString &host, qint64 connectNSecs);
+    void tlsHandshakeDone(const QString &host, qint64 handshakeNSecs);
+    void connectionClosed(const QString &host);
+
+    QNetworkConnectionStatistics snapshot() const;
+    void reset();
+
+private:
+    using Counter = QNetworkConnectionStatisticsPrivate::Counter;
+
+    void add(Counter counter, qint64 value)
+    { counters[counter].fetch_add(value, std::memory_order_relaxed); }
+    void raise(Counter counter, qint64 value);
+    void increment(Counter gauge, Counter peak);
+
+    std::array<std::atomic<qint64>, QNetworkConnectionStatisticsPrivate::CounterCount> counters = {};
+};
+
+QT_END_NAMESPACE
+
+#endif // QNETWORKCONNECTIONSTATISTICS_P_H
@@ -90,11 +90,14 @@ QNetworkCookieJar::~QNetworkCookieJar()
     suitable for derived classes to save cookies to disk, as well as
     to implement cookie expiration and other policies.
 
+    Cookies that have expired are removed from the jar the next time
+    insertCookie() is called.
+
     \sa setAllCookies(), cookiesForUrl()
 */
 QList<QNetworkCookie> QNetworkCookieJar::allCookies() const
 {
-    return d_func()->allCookies;
+    return d_func()->allCookies();
 }
 
 /*!
@@ -109,7 +112,97 @@ QList<QNetworkCookie> QNetworkCookieJar::allCookies() const
 void QNetworkCookieJar::setAllCookies(const QList<QNetworkCookie> &cookieList)
 {
     Q_D(QNetworkCookieJar);
-    d->allCookies = cookieList;
+    d->setAllCookies(cookieList);
+}
+
+static QString domainKey(const QNetworkCookie &cookie)
+{
+    QString domain = cookie.domain();
+    if (domain.startsWith(u'.'))
+        domain.remove(0, 1);
+    return domain;
+}
+
+QList<QNetworkCookie> QNetworkCookieJarPrivate::allCookies() const
+{
+    if (!allCookiesCacheValid) {
+        allCookiesCache.clear();
+        allCookiesCache.reserve(qsizetype(cookies.size()));
+        for (const auto &[id, cookie] : cookies)
+            allCookiesCache += cookie;
+        allCookiesCacheValid = true;
+    }
+    return allCookiesCache;
+}
+
+void QNetworkCookieJarPrivate::setAllCookies(const QList<QNetworkCookie> &cookieList)
+{
+    cookies.clear();
+    domains.clear();
+    expiries = {};
+    for (const QNetworkCookie &cookie : cookieList)
+        addCookie(cookie);
+    allCookiesCache = cookieList;
+    allCookiesCacheValid = true;
+}
+
+void QNetworkCookieJarPrivate::addCookie(const QNetworkCookie &cookie)
+{
+    const quint64 id = nextId++;
+    cookies.emplace(id, cookie);
+    domains[domainKey(cookie)].append(id);
+    if (!cookie.isSessionCookie())
+        expiries.push({ cookie.expirationDate().toMSecsSinceEpoch(), id });
+    allCookiesCacheValid = false;
+}
+
+// removes the first cookie with the same identifier as \a cookie
+bool QNetworkCookieJarPrivate::removeCookie(const QNetworkCookie &cookie)
+{
+    const auto ids = domains.find(domainKey(cookie));
+    if (ids == domains.end())
+        return false;
+    for (auto it = ids->begin(); it != ids->end(); ++it) {
+        const auto found = cookies.find(*it);
+        if (!found->second.hasSameIdentifier(cookie))
+            continue;
+        cookies.erase(found);
+        ids->erase(it);
+        if (ids->isEmpty())
+            domains.erase(ids);
+        allCookiesCacheValid = false;
+        return true;
+    }
+    return false;
+}
+
+void QNetworkCookieJarPrivate::removeExpiredCookies(const QDateTime &now)
+{
+    const qint64 msecs = now.toMSecsSinceEpoch();
+    while (!expiries.empty() && expiries.top().msecs < msecs) {
+        const auto found = cookies.find(expiries.top().id);
+        expiries.pop();
+        if (found == cookies.end())
+            continue;
+        const QString domain = domainKey(found->second);
+        const auto ids = domains.find(domain);
+        ids->removeOne(found->first);
+        if (ids->isEmpty())
+            domains.erase(ids);
+        cookies.erase(found);
+        allCookiesCacheValid = false;
+    }
+
+    // don't let the entries of cookies that were replaced or deleted pile up
+    if (expiries.size() > 2 * cookies.size() + 64) {
+        std::vector<Expiry> live;
+        live.reserve(cookies.size());
+        for (const auto &[id, cookie] : cookies) {
+            if (!cookie.isSessionCookie())
+                live.push_back({ cookie.expirationDate().toMSecsSinceEpoch(), id });
+        }
+        expiries = decltype(expiries)(std::greater<Expiry>(), std::move(live));
+    }
 }
 
 static inline bool isParentPath(QStringView path, QStringView reference)
@@ -199,39 +292,58 @@ QList<QNetworkCookie> QNetworkCookieJar::cookiesForUrl(const QUrl &url) const
 
     Q_D(const QNetworkCookieJar);
     const QDateTime now = QDateTime::currentDateTimeUtc();
-    QList<QNetworkCookie> result;
     const bool isEncrypted = url.scheme() == "https"_L1;
-
-    // scan our cookies for something that matches
-    for (const auto &cookie : std::as_const(d->allCookies)) {
-        if (!isEncrypted && cookie.isSecure())
-            continue;
-        if (!cookie.isSessionCookie() && cookie.expirationDate() < now)
-            continue;
-        const QString urlHost = url.host();
-        const QString cookieDomain = cookie.domain();
-        if (!isParentDomain(urlHost, cookieDomain))
-            continue;
-        if (!isParentPath(url.path(), cookie.path()))
-            continue;
-
-        QStringView domain = cookieDomain;
-        if (domain.startsWith(u'.')) /// Qt6?: remove when compliant with RFC6265
-            domain = domain.sliced(1);
+    const QString urlHost = url.host();
+    const QString urlPath = url.path();
+
+    // only the cookies for the host and its parent domains can match
+    std::vector<std::pair<quint64, const QNetworkCookie *>> matches;
+    QStringView parentDomain = urlHost;
+    while (true) {
+        const auto ids = d->domains.constFind(parentDomain.toString());
+        for (quint64 id : ids == d->domains.cend() ? QList<quint64>() : *ids) {
+            const QNetworkCookie &cookie = d->cookies.at(id);
+            if (!isEncrypted && cookie.isSecure())
+                continue;
+            if (!cookie.isSessionCookie() && cookie.expirationDate() < now)
+                continue;
+            const QString cookieDomain = cookie.domain();
+            if (!isParentDomain(urlHost, cookieDomain))
+                continue;
+            if (!isParentPath(urlPath, cookie.path()))
+                continue;
+
+            QStringView domain = cookieDomain;
+            if (domain.startsWith(u'.')) /// Qt6?: remove when compliant with RFC6265
+                domain = domain.sliced(1);
 #if QT_CONFIG(topleveldomain)
-        if (urlHost != domain && qIsEffectiveTLD(domain))
-            continue;
+            if (urlHost != domain && qIsEffectiveTLD(domain))
+                continue;
 #else
-        if (!domain.contains(u'.') && urlHost != domain)
-            continue;
+            if (!domain.contains(u'.') && urlHost != domain)
+                continue;
 #endif // topleveldomain
 
-        result += cookie;
+            matches.emplace_back(id, &cookie);
+        }
+
+        const qsizetype dot = parentDomain.indexOf(u'.');
+        if (dot < 0)
+            break;
+        parentDomain = parentDomain.sliced(dot + 1);
     }
 
-    auto longerPath = [](const auto &c1, const auto &c2)
-                      { return c1.path().size() > c2.path().size(); };
-    std::sort(result.begin(), result.end(), longerPath);
+    // cookies with paths of the same length stay in the order they were added in
+    auto byId = [](const auto &m1, const auto &m2) { return m1.first < m2.first; };
+    std::sort(matches.begin(), matches.end(), byId);
+    auto longerPath = [](const auto &m1, const auto &m2)
+                      { return m1.second->path().size() > m2.second->path().size(); };
+    std::stable_sort(matches.begin(), matches.end(), longerPath);
+
+    QList<QNetworkCookie> result;
+    result.reserve(qsizetype(matches.size()));
+    for (const auto &match : matches)
+        result += *match.second;
     return result;
 }
 
@@ -251,10 +363,11 @@ bool QNetworkCookieJar::insertCookie(const QNetworkCookie &cookie)
     bool isDeletion = !cookie.isSessionCookie() &&
                       cookie.expirationDate() < now;
 
+    d->removeExpiredCookies(now);
     deleteCookie(cookie);
 
     if (!isDeletion) {
-        d->allCookies += cookie;
+        d->addCookie(cookie);
         return true;
     }
     return false;
@@ -288,13 +401,7 @@ bool QNetworkCookieJar::updateCookie(const QNetworkCookie &cookie)
 bool QNetworkCookieJar::deleteCookie(const QNetworkCookie &cookie)
 {
     Q_D(QNetworkCookieJar);
-    const auto it = std::find_if(d->allCookies.cbegin(), d->allCookies.cend(),
-                                 [&cookie](const auto &c) { return c.hasSameIdentifier(cookie); });
-    if (it != d->allCookies.cend()) {
-        d->allCookies.erase(it);
-        return true;
-    }
-    return false;
+    return d->removeCookie(cookie);
 }
 
 /*!
@@ -18,13 +18,42 @@
 #include <QtNetwork/private/qtnetworkglobal_p.h>
 #include "private/qobject_p.h"
 #include "qnetworkcookie.h"
+#include "QtCore/qhash.h"
+
+#include <map>
+#include <queue>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
 class QNetworkCookieJarPrivate: public QObjectPrivate
 {
 public:
-    QList<QNetworkCookie> allCookies;
+    QList<QNetworkCookie> allCookies() const;
+    void setAllCookies(const QList<QNetworkCookie> &cookieList);
+    void addCookie(const QNetworkCookie &cookie);
+    bool removeCookie(const QNetworkCookie &cookie);
+    void removeExpiredCookies(const QDateTime &now);
+
+    // Cookies get an increasing id when they are added, so that iterating
+    // over them by id visits them in the order they were added in.
+    std::map<quint64, QNetworkCookie> cookies;
+    // the ids of the cookies for each domain, without its leading dot
+    QHash<QString, QList<quint64>> domains;
+
+    struct Expiry
+    {
+        qint64 msecs;
+        quint64 id;
+        friend bool operator>(const Expiry &lhs, const Expiry &rhs) noexcept
+        { return lhs.msecs > rhs.msecs; }
+    };
+    // earliest expiration first; entries of cookies that were removed are stale
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> expiries;
+    quint64 nextId = 0;
+
+    mutable QList<QNetworkCookie> allCookiesCache;
+    mutable bool allCookiesCacheValid = true;
 
     Q_DECLARE_PUBLIC(QNetworkCookieJar)
 };
@@ -13,15 +13,23 @@
 #include <qdatastream.h>
 #include <qdatetime.h>
 #include <qdiriterator.h>
+#include <qendian.h>
 #include <qurl.h>
 #include <qcryptographichash.h>
 #include <qdebug.h>
 
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#endif
+
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #define CACHE_POSTFIX ".d"_L1
 #define CACHE_VERSION 8
 #define DATA_DIR "data"_L1
+#define INDEX_FILE ".index"_L1
 
 #define MAX_COMPRESSION_SIZE (1024 * 1024 * 3)
 
@@ -44,6 +52,11 @@ using namespace Qt::StringLiterals;
     Currently you cannot share the same cache files with more than
     one disk cache.
 
+    QNetworkDiskCache keeps an index of its files in the cacheDirectory,
+    so that expire() does not have to look at each of them. The index is
+    checked against the cache files when it is first used, and rebuilt from
+    them when it is missing or unreadable.
+
     QNetworkDiskCache by default limits the amount of space that the cache will
     use on the system to 50MB.
 
@@ -116,6 +129,7 @@ void QNetworkDiskCache::setCacheDirectory(const QString &cacheDir)
         d->cacheDirectory += u'/';
 
     d->dataDirectory = d->cacheDirectory + DATA_DIR + QString::number(CACHE_VERSION) + u'/';
+    d->index.unload();
     d->prepareLayout();
 }
 
@@ -255,8 +269,11 @@ void QNetworkDiskCachePrivate::storeItem(QCacheItem *cacheItem)
         // commit() invalidates the file-engine, and size() will create a new
         // one, pointing at an empty filename.
         qint64 size = cacheItem->file->size();
-        if (cacheItem->file->commit())
+        if (cacheItem->file->commit()) {
             currentCacheSize += size;
+            if (const quint64 key = indexKey(fileName))
+                loadedIndex().insert(key, size);
+        }
         // Delete and unset the QSaveFile, it's invalid now.
         delete std::exchange(cacheItem->file, nullptr);
     }
@@ -306,11 +323,35 @@ bool QNetworkDiskCachePrivate::removeFile(const QString &file)
     qint64 size = info.size();
     if (QFile::remove(file)) {
         currentCacheSize -= size;
+        if (const quint64 key = indexKey(file))
+            loadedIndex().remove(key);
         return true;
     }
     return false;
 }
 
+/*!
+    Returns the index key of the cache file \a fileName, or 0 if it is not
+    a file in the data directory.
+ */
+quint64 QNetworkDiskCachePrivate::indexKey(const QString &fileName) const
+{
+    if (dataDirectory.isEmpty() || !fileName.startsWith(dataDirectory))
+        return 0;
+    return QNetworkDiskCacheIndex::key(QStringView(fileName).sliced(dataDirectory.size()));
+}
+
+/*!
+    Returns the index of the data directory, reading it in if that hasn't
+    been done yet.
+ */
+QNetworkDiskCacheIndex &QNetworkDiskCachePrivate::loadedIndex()
+{
+    if (!index.isLoaded())
+        index.load(dataDirectory);
+    return index;
+}
+
 /*!
     \reimp
 */
@@ -322,7 +363,13 @@ QNetworkCacheMetaData QNetworkDiskCache::metaData(const QUrl &url)
     Q_D(QNetworkDiskCache);
     if (d->lastItem.metaData.url() == url)
         return d->lastItem.metaData;
-    return fileMetaData(d->cacheFileName(url));
+    const QString fileName = d->cacheFileName(url);
+    QNetworkCacheMetaData metaData = fileMetaData(fileName);
+    if (metaData.isValid()) {
+        if (const quint64 key = d->indexKey(fileName))
+            d->loadedIndex().touch(key);
+    }
+    return metaData;
 }
 
 /*!
@@ -372,6 +419,8 @@ QIODevice *QNetworkDiskCache::data(const QUrl &url)
             remove(url);
             return nullptr;
         }
+        if (const quint64 key = d->indexKey(file->fileName()))
+            d->loadedIndex().touch(key);
         if (d->lastItem.data.isOpen()) {
             // compressed
             buffer.reset(new QBuffer);
@@ -450,9 +499,10 @@ void QNetworkDiskCache::setMaximumCacheSize(qint64 size)
     Returns the current size of the cache.
 
     When the current size of the cache is greater than the maximumCacheSize()
-    older cache files are removed until the total size is less then 90% of
-    maximumCacheSize() starting with the oldest ones first using the file
-    creation date to determine how old a cache file is.
+    cache files are removed until the total size is less then 90% of
+    maximumCacheSize() starting with the least recently used ones first.
+    A cache file is used when it is inserted, and when its data or meta data
+    is read.
 
     Subclasses can reimplement this function to change the order that cache
     files are removed taking into account information in the application
@@ -477,54 +527,24 @@ qint64 QNetworkDiskCache::expire()
     // close file handle to prevent "in use" error when QFile::remove() is called
     d->lastItem.reset();
 
-    const QDir::Filters filters = QDir::AllDirs | QDir:: Files | QDir::NoDotAndDotDot;
-    QDirIterator it(cacheDirectory(), filters, QDirIterator::Subdirectories);
-
-    struct CacheItem
-    {
-        std::chrono::milliseconds msecs;
-        QString path;
-        qint64 size = 0;
-    };
-    std::vector<CacheItem> cacheItems;
-    qint64 totalSize = 0;
-    while (it.hasNext()) {
-        QFileInfo info = it.nextFileInfo();
-        if (!info.fileName().endsWith(CACHE_POSTFIX))
-            continue;
-
-        QDateTime fileTime = info.birthTime(QTimeZone::UTC);
-        if (!fileTime.isValid())
-            fileTime = info.metadataChangeTime(QTimeZone::UTC);
-        const std::chrono::milliseconds msecs{fileTime.toMSecsSinceEpoch()};
-        const qint64 size = info.size();
-        cacheItems.push_back(CacheItem{msecs, info.filePath(), size});
-        totalSize += size;
-    }
-
+    QNetworkDiskCacheIndex &index = d->loadedIndex();
     const qint64 goal = (maximumCacheSize() * 9) / 10;
-    if (totalSize < goal)
-        return totalSize; // Nothing to do
-
-    auto byFileTime = [&](const auto &a, const auto &b) { return a.msecs < b.msecs; };
-    std::sort(cacheItems.begin(), cacheItems.end(), byFileTime);
 
     [[maybe_unused]] int removedFiles = 0; // used under QNETWORKDISKCACHE_DEBUG
-    for (const CacheItem &cached : cacheItems) {
-        QFile::remove(cached.path);
+    while (index.totalSize() >= goal && !index.isEmpty()) {
+        const quint64 key = index.leastRecentlyUsed();
+        QFile::remove(d->dataDirectory + QNetworkDiskCacheIndex::pathFragment(key));
+        index.remove(key);
         ++removedFiles;
-        totalSize -= cached.size;
-        if (totalSize < goal)
-            break;
     }
 #if defined(QNETWORKDISKCACHE_DEBUG)
     if (removedFiles > 0) {
         qDebug() << "QNetworkDiskCache::expire()"
                 << "Removed:" << removedFiles
-                << "Kept:" << cacheItems.count() - removedFiles;
+                << "Kept:" << index.count();
     }
 #endif
-    return totalSize;
+    return index.totalSize();
 }
 
 /*!
@@ -536,10 +556,25 @@ void QNetworkDiskCache::clear()
     qDebug("QNetworkDiskCache::clear()");
 #endif
     Q_D(QNetworkDiskCache);
-    qint64 size = d->maximumCacheSize;
-    d->maximumCacheSize = 0;
-    d->currentCacheSize = expire();
-    d->maximumCacheSize = size;
+    if (cacheDirectory().isEmpty()) {
+        qWarning("QNetworkDiskCache::expire() The cache directory is not set");
+        d->currentCacheSize = 0;
+        return;
+    }
+
+    // close file handle to prevent "in use" error when QFile::remove() is called
+    d->lastItem.reset();
+
+    // not only the files in the index, but also those of other data versions
+    // and any that were left behind
+    QDirIterator it(cacheDirectory(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        if (path.endsWith(CACHE_POSTFIX))
+            QFile::remove(path);
+    }
+    d->index.reset(d->dataDirectory);
+    d->currentCacheSize = 0;
 }
 
 /*!
@@ -573,6 +608,410 @@ QString QNetworkDiskCachePrivate::cacheFileName(const QUrl &url) const
     return  fullpath;
 }
 
+enum
+{
+    IndexMagic = 0x51444349, // "QDCI"
+    IndexVersion = 1,
+    IndexHeaderSize = 8,
+    IndexRecordSize = 9,    // operation, key
+    IndexInsertRecordSize = 17, // operation, key, size
+    // how far the journal may grow past twice the number of entries before
+    // it is rewritten, so that compacting it is amortized over the records
+    IndexCompactionSlack = 4096
+};
+
+static void hideIndexFile(const QString &fileName)
+{
+#ifdef Q_OS_WIN
+    // the leading dot only hides it on Unix
+    const QString nativeName = QDir::toNativeSeparators(fileName);
+    SetFileAttributesW(reinterpret_cast<const wchar_t *>(nativeName.utf16()), FILE_ATTRIBUTE_HIDDEN);
+#else
+    Q_UNUSED(fileName);
+#endif
+}
+
+/*!
+    Returns the key for the cache file at \a pathFragment, relative to the data
+    directory, or 0 if that is not a name generated by uniqueFileName().
+ */
+quint64 QNetworkDiskCacheIndex::key(QStringView pathFragment)
+{
+    // <one-char subdir>/<up to 8-char id>.d
+    if (pathFragment.size() < 5 || pathFragment.size() > 12 || pathFragment.at(1) != u'/'
+            || !pathFragment.endsWith(CACHE_POSTFIX)) {
+        return 0;
+    }
+    const QStringView id = pathFragment.sliced(2, pathFragment.size() - 4);
+    quint64 key = 0;
+    for (QChar c : id) {
+        if (c != u'-' && !(c >= u'0' && c <= u'9') && !(c >= u'a' && c <= u'z'))
+            return 0;
+        key = (key << 8) | c.unicode();
+    }
+    const uint code = id.back().unicode() % 16;
+    if (pathFragment.at(0) != QLatin1Char("0123456789abcdef"[code]))
+        return 0;
+    return key;
+}
+
+/*!
+    Returns the path of the cache file for \a key, relative to the data directory.
+ */
+QString QNetworkDiskCacheIndex::pathFragment(quint64 key)
+{
+    char id[8];
+    qsizetype size = 0;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        if (const char c = char(key >> shift))
+            id[size++] = c;
+    }
+    Q_ASSERT(size > 0);
+    uint code = uint(id[size - 1]) % 16;
+    return QString::number(code, 16) + u'/' + QLatin1StringView(id, size) + CACHE_POSTFIX;
+}
+
+namespace {
+struct CacheFile
+{
+    std::chrono::milliseconds msecs;
+    quint64 key;
+    qint64 size;
+
+    CacheFile(quint64 key, const QFileInfo &info)
+        : key(key), size(info.size())
+    {
+        QDateTime fileTime = info.birthTime(QTimeZone::UTC);
+        if (!fileTime.isValid())
+            fileTime = info.metadataChangeTime(QTimeZone::UTC);
+        msecs = std::chrono::milliseconds{fileTime.toMSecsSinceEpoch()};
+    }
+    bool operator<(const CacheFile &other) const { return msecs < other.msecs; }
+};
+}
+
+/*!
+    Calls \a callback with the key and the (not yet stat'ed) file info of each
+    cache file in \a dataDirectory.
+ */
+template <typename Callback>
+static void forEachCacheFile(const QString &dataDirectory, Callback callback)
+{
+    for (uint i = 0; i < 16; ++i) {
+        const QString subdir = QString::number(i, 16);
+        QDirIterator it(dataDirectory + subdir, QDir::Files);
+        while (it.hasNext()) {
+            const QFileInfo info = it.nextFileInfo();
+            const QString relativePath = subdir + u'/' + info.fileName();
+            if (const quint64 key = QNetworkDiskCacheIndex::key(relativePath))
+                callback(key, info);
+        }
+    }
+}
+
+/*!
+    Reads the journal in \a dataDirectory and checks it against the cache
+    files, or rebuilds it from them.
+ */
+void QNetworkDiskCacheIndex::load(const QString &dataDirectory)
+{
+    unload();
+    directory = dataDirectory;
+    journal.setFileName(directory + INDEX_FILE);
+    if (replay()) {
+        reconcile();
+    } else {
+        clearEntries();
+        rebuild();
+    }
+    loaded = true;
+}
+
+/*!
+    Drops all entries and starts an empty journal in \a dataDirectory.
+ */
+void QNetworkDiskCacheIndex::reset(const QString &dataDirectory)
+{
+    unload();
+    directory = dataDirectory;
+    journal.setFileName(directory + INDEX_FILE);
+    compact();
+    loaded = true;
+}
+
+void QNetworkDiskCacheIndex::unload()
+{
+    journal.close();
+    clearEntries();
+    journalRecords = 0;
+    loaded = false;
+}
+
+void QNetworkDiskCacheIndex::clearEntries()
+{
+    nodes.clear();
+    head = 0;
+    tail = 0;
+    total = 0;
+}
+
+/*!
+    Adds or replaces the entry for \a key as the most recently used one.
+ */
+void QNetworkDiskCacheIndex::insert(quint64 key, qint64 size)
+{
+    take(key);
+    append(key, size);
+    record(InsertOperation, key, size);
+}
+
+/*!
+    Marks the entry for \a key, if any, as the most recently used one.
+ */
+void QNetworkDiskCacheIndex::touch(quint64 key)
+{
+    if (key == tail)
+        return;
+    const auto it = nodes.constFind(key);
+    if (it == nodes.cend())
+        return;
+    const qint64 size = it->size;
+    take(key);
+    append(key, size);
+    record(TouchOperation, key);
+}
+
+void QNetworkDiskCacheIndex::remove(quint64 key)
+{
+    if (take(key))
+        record(RemoveOperation, key);
+}
+
+void QNetworkDiskCacheIndex::prepend(quint64 key, qint64 size)
+{
+    Q_ASSERT(!nodes.contains(key));
+    nodes.insert(key, Node{ size, 0, head });
+    if (head)
+        nodes.find(head)->previous = key;
+    else
+        tail = key;
+    head = key;
+    total += size;
+}
+
+void QNetworkDiskCacheIndex::append(quint64 key, qint64 size)
+{
+    Q_ASSERT(!nodes.contains(key));
+    nodes.insert(key, Node{ size, tail, 0 });
+    if (tail)
+        nodes.find(tail)->next = key;
+    else
+        head = key;
+    tail = key;
+    total += size;
+}
+
+bool QNetworkDiskCacheIndex::take(quint64 key)
+{
+    const auto it = nodes.constFind(key);
+    if (it == nodes.cend())
+        return false;
+    const Node node = *it;
+    nodes.erase(it);
+
+    if (node.previous)
+        nodes.find(node.previous)->next = node.next;
+    else
+        head = node.next;
+    if (node.next)
+        nodes.find(node.next)->previous = node.previous;
+    else
+        tail = node.previous;
+    total -= node.size;
+    return true;
+}
+
+/*!
+    Restores the entries from the journal and opens it for appending.
+    Returns \c false if there is no journal, or if it is not one we can read.
+ */
+bool QNetworkDiskCacheIndex::replay()
+{
+    if (!journal.open(QIODevice::ReadWrite | QIODevice::ExistingOnly))
+        return false;
+
+    const QByteArray data = journal.readAll();
+    const char *begin = data.constData();
+    const char *end = begin + data.size();
+    if (data.size() < IndexHeaderSize || qFromBigEndian<quint32>(begin) != IndexMagic
+            || qFromBigEndian<quint32>(begin + 4) != IndexVersion) {
+        journal.close();
+        return false;
+    }
+
+    journalRecords = 0;
+    const char *ptr = begin + IndexHeaderSize;
+    while (ptr != end) {
+        const Operation operation = Operation(*ptr);
+        const qsizetype length = operation == InsertOperation ? IndexInsertRecordSize
+                                                              : IndexRecordSize;
+        if (end - ptr < length)
+            break; // the last record was not written completely
+        const quint64 key = qFromBigEndian<quint64>(ptr + 1);
+        if (!key) {
+            journal.close();
+            return false;
+        }
+        switch (operation) {
+        case InsertOperation:
+            take(key);
+            append(key, qFromBigEndian<qint64>(ptr + 9));
+            break;
+        case TouchOperation:
+            if (const auto it = nodes.constFind(key); it != nodes.cend()) {
+                const qint64 size = it->size;
+                take(key);
+                append(key, size);
+            }
+            break;
+        case RemoveOperation:
+            take(key);
+            break;
+        default:
+            journal.close();
+            return false;
+        }
+        ptr += length;
+        ++journalRecords;
+    }
+
+    if (ptr != end)
+        journal.resize(ptr - begin);
+    journal.close();
+    if (journalRecords > 2 * nodes.size() + IndexCompactionSlack
+            || !journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        compact();
+    }
+    return true;
+}
+
+/*!
+    Adds all cache files in the data directory, ordered by their creation
+    date, and writes a new journal for them.
+ */
+void QNetworkDiskCacheIndex::rebuild()
+{
+    std::vector<CacheFile> cacheFiles;
+    forEachCacheFile(directory, [&](quint64 key, const QFileInfo &info) {
+        cacheFiles.emplace_back(key, info);
+    });
+
+    std::sort(cacheFiles.begin(), cacheFiles.end());
+    nodes.reserve(qsizetype(cacheFiles.size()));
+    for (const CacheFile &cacheFile : cacheFiles)
+        append(cacheFile.key, cacheFile.size);
+
+    compact();
+}
+
+/*!
+    Brings the entries replayed from the journal in line with the cache files
+    in the data directory. Files the journal doesn't know about, like those
+    written just before a crash, become the least recently used entries, and
+    entries whose files are gone are dropped. Only the untracked files are
+    stat'ed, so this costs little more than listing the directory.
+ */
+void QNetworkDiskCacheIndex::reconcile()
+{
+    std::vector<CacheFile> untracked;
+    qsizetype tracked = 0;
+    forEachCacheFile(directory, [&](quint64 key, const QFileInfo &info) {
+        if (nodes.contains(key))
+            ++tracked;
+        else
+            untracked.emplace_back(key, info);
+    });
+    if (untracked.empty() && tracked == nodes.size())
+        return;
+
+    if (tracked != nodes.size()) {
+        QList<quint64> gone;
+        for (auto it = nodes.cbegin(); it != nodes.cend(); ++it) {
+            if (!QFileInfo::exists(directory + pathFragment(it.key())))
+                gone.append(it.key());
+        }
+        for (quint64 key : std::as_const(gone))
+            take(key);
+    }
+
+    // the newest of them ends up last
+    std::sort(untracked.begin(), untracked.end());
+    for (auto it = untracked.crbegin(); it != untracked.crend(); ++it)
+        prepend(it->key, it->size);
+
+    compact();
+}
+
+void QNetworkDiskCacheIndex::record(Operation operation, quint64 key, qint64 size)
+{
+    if (!journal.isOpen())
+        return;
+
+    char buffer[IndexInsertRecordSize];
+    buffer[0] = char(operation);
+    qToBigEndian(key, buffer + 1);
+    qsizetype length = IndexRecordSize;
+    if (operation == InsertOperation) {
+        qToBigEndian(size, buffer + 9);
+        length = IndexInsertRecordSize;
+    }
+
+    // accesses are not worth a write of their own, they go out with the next change
+    if (journal.write(buffer, length) != length
+            || (operation != TouchOperation && !journal.flush())) {
+        // the journal no longer matches the cache files, so have it rebuilt next time
+        journal.remove();
+        return;
+    }
+
+    if (++journalRecords > 2 * nodes.size() + IndexCompactionSlack)
+        compact();
+}
+
+/*!
+    Replaces the journal with one that only holds the current entries.
+ */
+void QNetworkDiskCacheIndex::compact()
+{
+    journal.close();
+
+    QByteArray data;
+    data.resize(IndexHeaderSize + nodes.size() * IndexInsertRecordSize);
+    char *ptr = data.data();
+    qToBigEndian(quint32(IndexMagic), ptr);
+    qToBigEndian(quint32(IndexVersion), ptr + 4);
+    ptr += IndexHeaderSize;
+    for (quint64 key = head; key; ) {
+        const Node &node = nodes.constFind(key).value();
+        *ptr = char(InsertOperation);
+        qToBigEndian(key, ptr + 1);
+        qToBigEndian(node.size, ptr + 9);
+        ptr += IndexInsertRecordSize;
+        key = node.next;
+    }
+
+    QSaveFile file(journal.fileName());
+    if (file.open(QIODevice::WriteOnly) && file.write(data) == data.size() && file.commit()) {
+        hideIndexFile(journal.fileName());
+        if (journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            journalRecords = nodes.size();
+            return;
+        }
+    }
+    // without a journal, the index is rebuilt from the cache files next time
+    journal.remove();
+}
+
 /*!
     We compress small text and JavaScript files.
  */
@@ -19,6 +19,7 @@
 #include "private/qabstractnetworkcache_p.h"
 
 #include <qbuffer.h>
+#include <qfile.h>
 #include <qhash.h>
 #include <qsavefile.h>
 
@@ -54,6 +55,72 @@ public:
     bool canCompress() const;
 };
 
+/*
+    Keeps track of the size and recency of every file in the data directory,
+    so that expiring the cache does not need to look at the files themselves.
+    Entries are keyed on the 8-character id in the file name, packed into an
+    integer, and kept in a doubly-linked list ordered from the least to the
+    most recently used.
+
+    The index is persisted as an append-only journal of insertions, accesses
+    and removals in the data directory; replaying it restores the LRU order.
+    When the journal grows well beyond the number of entries it is compacted.
+    After replaying it, the entries are checked against a listing of the
+    directory, and when it is missing or unreadable it is rebuilt from that.
+*/
+class QNetworkDiskCacheIndex
+{
+public:
+    static quint64 key(QStringView pathFragment);
+    static QString pathFragment(quint64 key);
+
+    bool isLoaded() const { return loaded; }
+    void load(const QString &dataDirectory);
+    void reset(const QString &dataDirectory);
+    void unload();
+
+    void insert(quint64 key, qint64 size);
+    void touch(quint64 key);
+    void remove(quint64 key);
+
+    bool isEmpty() const { return nodes.isEmpty(); }
+    qsizetype count() const { return nodes.size(); }
+    quint64 leastRecentlyUsed() const { return head; }
+    qint64 totalSize() const { return total; }
+
+private:
+    enum Operation : quint8 {
+        InsertOperation = 1,
+        TouchOperation,
+        RemoveOperation
+    };
+    struct Node
+    {
+        qint64 size = 0;
+        quint64 previous = 0;
+        quint64 next = 0;
+    };
+
+    void prepend(quint64 key, qint64 size);
+    void append(quint64 key, qint64 size);
+    bool take(quint64 key);
+    void clearEntries();
+    bool replay();
+    void rebuild();
+    void reconcile();
+    void record(Operation operation, quint64 key, qint64 size = 0);
+    void compact();
+
+    QHash<quint64, Node> nodes;
+    quint64 head = 0;
+    quint64 tail = 0;
+    qint64 total = 0;
+    QString directory;
+    QFile journal;
+    qsizetype journalRecords = 0;
+    bool loaded = false;
+};
+
 class QNetworkDiskCachePrivate : public QAbstractNetworkCachePrivate
 {
 public:
@@ -66,6 +133,8 @@ public:
     static QString uniqueFileName(const QUrl &url);
     QString cacheFileName(const QUrl &url) const;
     bool removeFile(const QString &file);
+    quint64 indexKey(const QString &fileName) const;
+    QNetworkDiskCacheIndex &loadedIndex();
     void storeItem(QCacheItem *item);
     void prepareLayout();
     static quint32 crc32(const char *data, uint len);
@@ -75,6 +144,7 @@ public:
     QString dataDirectory;
     qint64 maximumCacheSize;
     qint64 currentCacheSize;
+    QNetworkDiskCacheIndex index;
 
     QHash<QIODevice*, QCacheItem*> inserting;
     Q_DECLARE_PUBLIC(QNetworkDiskCache)
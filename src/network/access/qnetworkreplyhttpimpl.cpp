@@ -147,6 +147,7 @@ QNetworkReplyHttpImpl::QNetworkReplyHttpImpl(QNetworkAccessManager* const manage
     Q_ASSERT(manager);
     d->manager = manager;
     d->managerPrivate = manager->d_func();
+    d->warmUpConnectionCount = d->managerPrivate->warmUpConnectionCount;
     d->request = request;
     d->originalRequest = request;
     d->operation = operation;
@@ -337,6 +338,9 @@ qint64 QNetworkReplyHttpImpl::readData(char* data, qint64 maxlen)
             d->decompressHelper.clear();
             return -1;
         }
+        d->replyDecompressionStatistics(d->decompressHelper.compressedBytes(),
+                                        d->decompressHelper.decompressedBytes(),
+                                        d->decompressHelper.decompressionTime());
         if (d->cacheSaveDevice) {
             // Need to write to the cache now that we have the data
             d->cacheSaveDevice->write(data, bytesRead);
@@ -811,6 +815,8 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
 
     if (request.attribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute).isValid())
         delegate->connectionCacheExpiryTimeoutSeconds = request.attribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute).toInt();
+    if (preConnect)
+        delegate->warmUpConnectionCount = warmUpConnectionCount;
 
     // For the synchronous HTTP, this is the normal way the delegate gets deleted
     // For the asynchronous HTTP this is a safety measure, the delegate deletes itself when HTTP is finished
@@ -844,6 +850,7 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
     // The authentication manager is used to avoid the BlockingQueuedConnection communication
     // from HTTP thread to user thread in some cases.
     delegate->authenticationManager = managerPrivate->authenticationManager;
+    delegate->connectionStatistics = managerPrivate->connectionStatistics;
 
     if (!synchronous) {
         // Tell our zerocopy policy to the delegate
@@ -857,6 +864,12 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
             delegate->downloadBufferMaximumSize = 128*1024;
         }
 
+        // Only if we would be the ones decompressing, see replyDownloadMetaData()
+        delegate->decompressInBackground =
+                newHttpRequest.attribute(QNetworkRequest::BackgroundDecompressionAttribute).toBool()
+                && newHttpRequest.rawHeader("accept-encoding").isEmpty();
+        delegate->decompressedSafetyCheckThreshold =
+                newHttpRequest.decompressedSafetyCheckThreshold();
 
         // These atomic integers are used for signal compression
         delegate->pendingDownloadData = pendingDownloadDataEmissions;
@@ -875,6 +888,9 @@ void QNetworkReplyHttpImplPrivate::postRequest(const QNetworkRequest &newHttpReq
                 q, &QNetworkReply::requestSent, Qt::QueuedConnection);
         connect(delegate, &QHttpThreadDelegate::downloadMetaData, this,
                 &QNetworkReplyHttpImplPrivate::replyDownloadMetaData, Qt::QueuedConnection);
+        connect(delegate, &QHttpThreadDelegate::decompressionStatistics, this,
+                &QNetworkReplyHttpImplPrivate::replyDecompressionStatistics,
+                Qt::QueuedConnection);
         QObject::connect(delegate, SIGNAL(downloadProgress(qint64,qint64)),
                 q, SLOT(replyDownloadProgressSlot(qint64,qint64)),
                 Qt::QueuedConnection);
@@ -1047,6 +1063,18 @@ void QNetworkReplyHttpImplPrivate::initCacheSaveDevice()
     }
 }
 
+// Updates the reply's decompression counters, for the data decompressed in
+// either thread
+void QNetworkReplyHttpImplPrivate::replyDecompressionStatistics(qint64 compressedBytes,
+                                                                qint64 decompressedBytes,
+                                                                qint64 decompressionTime)
+{
+    Q_Q(QNetworkReplyHttpImpl);
+    q->setAttribute(QNetworkRequest::CompressedBytesAttribute, compressedBytes);
+    q->setAttribute(QNetworkRequest::DecompressedBytesAttribute, decompressedBytes);
+    q->setAttribute(QNetworkRequest::DecompressionTimeAttribute, decompressionTime);
+}
+
 void QNetworkReplyHttpImplPrivate::replyDownloadData(QByteArray d)
 {
     Q_Q(QNetworkReplyHttpImpl);
@@ -1106,6 +1134,9 @@ void QNetworkReplyHttpImplPrivate::replyDownloadData(QByteArray d)
                 }
             }
             d.resize(bytesRead);
+            replyDecompressionStatistics(decompressHelper.compressedBytes(),
+                                         decompressHelper.decompressedBytes(),
+                                         decompressHelper.decompressionTime());
             // we're synchronous so we're not calling this function again; reset the decompressHelper
             decompressHelper.clear();
         }
@@ -154,6 +154,7 @@ public:
     QNetworkAccessManagerPrivate *managerPrivate;
     QHttpNetworkRequest httpRequest; // There is also a copy in the HTTP thread
     bool synchronous;
+    int warmUpConnectionCount = 0; // see QNetworkAccessManager::warmUpConnections()
 
     State state;
 
@@ -243,6 +244,8 @@ public:
 public:
     // From HTTP thread:
     void replyDownloadData(QByteArray);
+    void replyDecompressionStatistics(qint64 compressedBytes, qint64 decompressedBytes,
+                                      qint64 decompressionTime);
     void replyFinished();
     void replyDownloadMetaData(const QList<QPair<QByteArray,QByteArray> > &, int, const QString &,
                                bool, QSharedPointer<char>, qint64, qint64, bool, bool);
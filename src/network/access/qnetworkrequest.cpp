@@ -316,6 +316,36 @@ QT_IMPL_METATYPE_EXTERN_TAGGED(QNetworkRequest::RedirectPolicy, QNetworkRequest_
         same-origin requests. This only affects the WebAssembly platform.
         (This value was introduced in 6.5.)
 
+    \value BackgroundDecompressionAttribute
+        Requests only, type: QMetaType::Bool (default: false)
+        If set, a compressed HTTP reply is decompressed as it arrives in the
+        thread that handles the network connection, instead of in the thread
+        that reads from the QNetworkReply. This takes the cost of decompressing
+        large downloads off the user's thread. If the read buffer size of the
+        reply is limited, no more than that much decompressed data is held
+        ahead of the reader. Has no effect on synchronous requests, or if the
+        Accept-Encoding header was set on the request.
+        (This value was introduced in 6.8.)
+
+    \value CompressedBytesAttribute
+        Replies only, type: QMetaType::LongLong
+        The number of compressed bytes of the body that have been passed to the
+        decoder so far. Only set if the reply is decompressed automatically.
+        (This value was introduced in 6.8.)
+
+    \value DecompressedBytesAttribute
+        Replies only, type: QMetaType::LongLong
+        The number of bytes the decoder has produced so far. Only set if the
+        reply is decompressed automatically.
+        (This value was introduced in 6.8.)
+
+    \value DecompressionTimeAttribute
+        Replies only, type: QMetaType::LongLong
+        The time, in nanoseconds, spent in the decoder so far. Together with
+        DecompressedBytesAttribute it gives the decompression throughput. Only
+        set if the reply is decompressed automatically.
+        (This value was introduced in 6.8.)
+
     \value User
         Special type. Additional information can be passed in
         QVariants with types ranging from User to UserMax. The default
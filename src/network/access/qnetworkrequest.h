@@ -65,6 +65,10 @@ public:
         ConnectionCacheExpiryTimeoutSecondsAttribute,
         Http2CleartextAllowedAttribute,
         UseCredentialsAttribute,
+        BackgroundDecompressionAttribute,
+        CompressedBytesAttribute,
+        DecompressedBytesAttribute,
+        DecompressionTimeAttribute,
 
         User = 1000,
         UserMax = 32767
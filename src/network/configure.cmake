@@ -317,6 +317,13 @@ qt_feature("dnslookup" PUBLIC
     PURPOSE "Provides API for DNS lookups."
     CONDITION QT_FEATURE_thread AND NOT INTEGRITY
 )
+qt_feature("async-dns" PRIVATE
+    SECTION "Networking"
+    LABEL "Asynchronous DNS resolver"
+    PURPOSE "Lets QHostInfo resolve host names over non-blocking sockets instead of a thread per lookup."
+    CONDITION LINUX AND QT_FEATURE_dnslookup AND QT_FEATURE_libresolv AND QT_FEATURE_udpsocket
+        AND QT_FEATURE_networkinterface
+)
 qt_feature("gssapi" PUBLIC
     SECTION "Networking"
     LABEL "GSSAPI"
@@ -379,6 +386,7 @@ qt_configure_add_summary_entry(ARGS "ocsp")
 qt_configure_add_summary_entry(ARGS "sctp")
 qt_configure_add_summary_entry(ARGS "system-proxies")
 qt_configure_add_summary_entry(ARGS "gssapi")
+qt_configure_add_summary_entry(ARGS "async-dns")
 qt_configure_add_summary_entry(ARGS "brotli")
 qt_configure_add_summary_entry(ARGS "topleveldomain")
 qt_configure_add_summary_entry(ARGS "publicsuffix-qt")
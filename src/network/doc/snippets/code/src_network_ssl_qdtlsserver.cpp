@@ -0,0 +1,20 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR BSD-3-Clause
+
+//! [0]
+auto *server = new QDtlsServer(this);
+QSslConfiguration configuration = QSslConfiguration::defaultDtlsConfiguration();
+configuration.setLocalCertificate(certificate);
+configuration.setPrivateKey(privateKey);
+server->setDtlsConfiguration(configuration);
+server->setIdleTimeout(60'000);
+
+// Echo everything back to the peers:
+connect(server, &QDtlsServer::datagramsReceived, server,
+        [server](const QList<QNetworkDatagram> &datagrams) {
+    for (const QNetworkDatagram &datagram : datagrams)
+        server->writeDatagram(datagram.makeReply(datagram.data()));
+});
+
+server->listen(QHostAddress::Any, 5684);
+//! [0]
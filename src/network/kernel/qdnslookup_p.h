@@ -184,6 +184,11 @@ public:
     QDnsLookupRunnable(const QDnsLookupPrivate *d);
     void run() override;
 
+#if QT_CONFIG(libresolv)
+    static void parseReply(QDnsLookupReply *reply, const unsigned char *response,
+                           int responseLength);
+#endif
+
 signals:
     void finished(const QDnsLookupReply &reply);
 
@@ -222,16 +222,27 @@ void QDnsLookupRunnable::query(QDnsLookupReply *reply)
     if (responseLength < 0)
         return;
 
+    parseReply(reply, buffer.data(), responseLength);
+}
+
+/*
+    Parses the DNS reply in \a response of \a responseLength bytes into
+    \a reply. This is shared with the asynchronous QHostInfo backend, which
+    sends its queries on its own sockets.
+*/
+void QDnsLookupRunnable::parseReply(QDnsLookupReply *reply, const unsigned char *response,
+                                    int responseLength)
+{
     // Check the reply is valid.
     if (responseLength < int(sizeof(HEADER)))
         return reply->makeInvalidReplyError();
 
     // Parse the reply.
+    auto header = reinterpret_cast<const HEADER *>(response);
     if (header->rcode)
         return reply->makeDnsRcodeError(header->rcode);
 
     qptrdiff offset = sizeof(HEADER);
-    unsigned char *response = buffer.data();
     int status;
 
     auto expandHost = [&, cache = Cache{}](qptrdiff offset) mutable {
@@ -260,17 +271,18 @@ void QDnsLookupRunnable::query(QDnsLookupReply *reply)
         return QString();
     };
 
-    if (ntohs(header->qdcount) == 1) {
+    int questionCount = ntohs(header->qdcount);
+    if (questionCount == 1) {
         // Skip the query host, type (2 bytes) and class (2 bytes).
         expandHost(offset);
         if (status < 0)
             return;
         if (offset + status + 4 >= responseLength)
-            header->qdcount = 0xffff;   // invalid reply below
+            questionCount = 0xffff;     // invalid reply below
         else
             offset += status + 4;
     }
-    if (ntohs(header->qdcount) > 1)
+    if (questionCount > 1)
         return reply->makeInvalidReplyError();
 
     // Extract results.
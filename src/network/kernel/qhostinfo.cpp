@@ -5,6 +5,9 @@
 
 #include "qhostinfo.h"
 #include "qhostinfo_p.h"
+#if QT_CONFIG(async_dns)
+#include "qhostinfoasyncresolver_p.h"
+#endif
 #include <qplatformdefs.h>
 
 #include "QtCore/qapplicationstatic.h"
@@ -184,6 +187,12 @@ void QHostInfoResult::finalizePostResultsReady(const QHostInfo &info)
     compared to previous versions of Qt.
     \note Since Qt 4.6.3 QHostInfo is using a small internal 60 second DNS cache
     for performance improvements.
+    \note On Linux, setting the \c QT_HOSTINFO_ASYNC_DNS environment variable
+    to \c 1 makes lookupHost() send the DNS queries itself from a single
+    thread, instead of calling the system resolver on a thread per lookup.
+    This only applies if \c /etc/nsswitch.conf lists no other sources than
+    \c files and \c dns for host names. Results are then cached for as long
+    as the DNS records allow.
 
     \sa QAbstractSocket, {RFC 3492}, {RFC 6724}
 */
@@ -855,6 +864,45 @@ void QHostInfoRunnable::run()
         hostInfo = QHostInfoAgent::fromName(toBeLookedUp);
     }
 
+    postResults(manager, std::move(hostInfo));
+    // thread goes back to QThreadPool
+}
+
+#if QT_CONFIG(async_dns)
+// Called by QHostInfoAsyncResolver from its own thread before it sends any
+// queries. Like run(), this delivers the cached result if another lookup has
+// stored one in the meanwhile; returns true (and deletes this) if it did, or
+// if the lookup was aborted.
+bool QHostInfoRunnable::asyncLookupFromCache()
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    QHostInfo hostInfo;
+    bool valid = manager->wasAborted(id);
+    if (!valid && manager->cache.isEnabled())
+        hostInfo = manager->cache.get(toBeLookedUp, &valid);
+    if (!valid)
+        return false;
+
+    postResults(manager, std::move(hostInfo));
+    manager->lookupFinished(this);
+    delete this;
+    return true;
+}
+
+// called by QHostInfoAsyncResolver from its own thread, instead of run()
+void QHostInfoRunnable::asyncLookupFinished(const QHostInfo &hostInfo, int ttl)
+{
+    QHostInfoLookupManager *manager = theHostInfoLookupManager();
+    if (manager->cache.isEnabled())
+        manager->cache.put(toBeLookedUp, hostInfo, ttl);
+    postResults(manager, hostInfo);
+    manager->lookupFinished(this);
+    delete this;
+}
+#endif
+
+void QHostInfoRunnable::postResults(QHostInfoLookupManager *manager, QHostInfo hostInfo)
+{
     // check aborted again
     if (manager->wasAborted(id))
         return;
@@ -879,9 +927,7 @@ void QHostInfoRunnable::run()
         }
         manager->postponedLookups.erase(partitionBegin, partitionEnd);
     }
-
 #endif
-    // thread goes back to QThreadPool
 }
 
 QHostInfoLookupManager::QHostInfoLookupManager() : wasDeleted(false)
@@ -892,6 +938,9 @@ QHostInfoLookupManager::QHostInfoLookupManager() : wasDeleted(false)
                      Qt::DirectConnection);
     threadPool.setMaxThreadCount(20); // do up to 20 DNS lookups in parallel
 #endif
+#if QT_CONFIG(async_dns)
+    asyncResolver = std::make_unique<QHostInfoAsyncResolver>();
+#endif
 }
 
 QHostInfoLookupManager::~QHostInfoLookupManager()
@@ -900,6 +949,10 @@ QHostInfoLookupManager::~QHostInfoLookupManager()
     wasDeleted = true;
     locker.unlock();
 
+#if QT_CONFIG(async_dns)
+    // nothing would be delivered anymore, so don't wait for the name servers
+    asyncResolver.reset();
+#endif
     // don't qDeleteAll currentLookups, the QThreadPool has ownership
     clear();
 }
@@ -920,6 +973,10 @@ void QHostInfoLookupManager::clear()
 
 #if QT_CONFIG(thread)
     threadPool.waitForDone();
+#endif
+#if QT_CONFIG(async_dns)
+    if (asyncResolver)
+        asyncResolver->waitForDone();
 #endif
     cache.clear();
 }
@@ -945,6 +1002,10 @@ void QHostInfoLookupManager::rescheduleWithMutexHeld()
 
 #if QT_CONFIG(thread)
     auto isAlreadyRunning = [this](QHostInfoRunnable *lookup) {
+#if QT_CONFIG(async_dns)
+        if (std::any_of(asyncLookups.cbegin(), asyncLookups.cend(), ToBeLookedUpEquals(lookup->toBeLookedUp)))
+            return true;
+#endif
         return std::any_of(currentLookups.cbegin(), currentLookups.cend(), ToBeLookedUpEquals(lookup->toBeLookedUp));
     };
 
@@ -964,6 +1025,25 @@ void QHostInfoLookupManager::rescheduleWithMutexHeld()
                                        isAlreadyRunning).second,
                            scheduledLookups.end());
 
+#if QT_CONFIG(async_dns)
+    // Hand everything the asynchronous resolver can answer over to it; those
+    // lookups don't occupy a thread, so they are not limited by the pool size:
+    if (asyncResolver->isActive()) {
+        const auto canResolve = [this](QHostInfoRunnable *lookup) {
+            return asyncResolver->canResolve(lookup->toBeLookedUp);
+        };
+        const qsizetype alreadyRunning = asyncLookups.size();
+        scheduledLookups.erase(separate_if(scheduledLookups.begin(),
+                                           scheduledLookups.end(),
+                                           std::back_inserter(asyncLookups),
+                                           scheduledLookups.begin(),
+                                           canResolve).second,
+                               scheduledLookups.end());
+        for (qsizetype i = alreadyRunning; i < asyncLookups.size(); ++i)
+            asyncResolver->start(asyncLookups.at(i));
+    }
+#endif
+
     const int availableThreads = threadPool.maxThreadCount() - currentLookups.size();
     if (availableThreads > 0) {
         int readyToStartCount = qMin(availableThreads, scheduledLookups.size());
@@ -1046,7 +1126,10 @@ void QHostInfoLookupManager::lookupFinished(QHostInfoRunnable *r)
     if (wasDeleted)
         return;
 
-#if QT_CONFIG(thread)
+#if QT_CONFIG(async_dns)
+    if (!currentLookups.removeOne(r))
+        asyncLookups.removeOne(r);
+#elif QT_CONFIG(thread)
     currentLookups.removeOne(r);
 #endif
     finishedLookups.append(r);
@@ -1100,9 +1183,23 @@ void qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolut
 
     manager->cache.put(hostname, resolution);
 }
+
+#if QT_CONFIG(async_dns)
+/*
+    Makes the asynchronous resolver send all queries to \a nameserver on
+    \a port, without applying the search domains of /etc/resolv.conf.
+    Passing a null address reverts to the system configuration.
+*/
+void qt_qhostinfo_set_async_nameserver(const QHostAddress &nameserver, quint16 port)
+{
+    QHostInfoLookupManager* manager = theHostInfoLookupManager();
+    if (manager && manager->asyncResolver)
+        manager->asyncResolver->setNameServer(nameserver, port);
+}
+#endif
 #endif
 
-// cache for 60 seconds
+// cache for 60 seconds, unless the lookup reported a time to live
 // cache 128 items
 QHostInfoCache::QHostInfoCache() : max_age(60), enabled(true), cache(128)
 {
@@ -1117,7 +1214,7 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
 
     *valid = false;
     if (QHostInfoCacheElement *element = cache.object(name)) {
-        if (element->age.elapsed() < max_age*1000)
+        if (!element->expiry.hasExpired())
             *valid = true;
         return element->info;
 
@@ -1129,16 +1226,19 @@ QHostInfo QHostInfoCache::get(const QString &name, bool *valid)
     return QHostInfo();
 }
 
-void QHostInfoCache::put(const QString &name, const QHostInfo &info)
+/*
+    Stores \a info for \a name. If \a ttl is not negative, it is the time
+    in seconds the DNS records may be cached for; otherwise, max_age applies.
+*/
+void QHostInfoCache::put(const QString &name, const QHostInfo &info, int ttl)
 {
-    // if the lookup failed, don't cache
-    if (info.error() != QHostInfo::NoError)
+    // if the lookup failed or must not be cached, don't cache
+    if (info.error() != QHostInfo::NoError || ttl == 0)
         return;
 
     QHostInfoCacheElement* element = new QHostInfoCacheElement();
     element->info = info;
-    element->age = QElapsedTimer();
-    element->age.start();
+    element->expiry = QDeadlineTimer(std::chrono::seconds(ttl < 0 ? max_age : ttl));
 
     QMutexLocker locker(&this->mutex);
     cache.insert(name, element); // cache will take ownership
@@ -31,10 +31,11 @@
 #include "QtCore/qrunnable.h"
 #include "QtCore/qlist.h"
 #include "QtCore/qqueue.h"
-#include <QElapsedTimer>
+#include <QDeadlineTimer>
 #include <QCache>
 
 #include <atomic>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -107,6 +108,9 @@ QHostInfo Q_NETWORK_EXPORT qt_qhostinfo_lookup(const QString &name, QObject *rec
 void Q_AUTOTEST_EXPORT qt_qhostinfo_clear_cache();
 void Q_AUTOTEST_EXPORT qt_qhostinfo_enable_cache(bool e);
 void Q_AUTOTEST_EXPORT qt_qhostinfo_cache_inject(const QString &hostname, const QHostInfo &resolution);
+#if QT_CONFIG(async_dns)
+void Q_AUTOTEST_EXPORT qt_qhostinfo_set_async_nameserver(const QHostAddress &nameserver, quint16 port);
+#endif
 
 class QHostInfoCache
 {
@@ -115,7 +119,7 @@ public:
     const int max_age; // seconds
 
     QHostInfo get(const QString &name, bool *valid);
-    void put(const QString &name, const QHostInfo &info);
+    void put(const QString &name, const QHostInfo &info, int ttl = -1);
     void clear();
 
     bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
@@ -126,7 +130,7 @@ private:
     std::atomic<bool> enabled;
     struct QHostInfoCacheElement {
         QHostInfo info;
-        QElapsedTimer age;
+        QDeadlineTimer expiry;
     };
     QCache<QString,QHostInfoCacheElement> cache;
     QMutex mutex;
@@ -134,6 +138,11 @@ private:
 
 // the following classes are used for the (normal) case: We use multiple threads to lookup DNS
 
+class QHostInfoLookupManager;
+#if QT_CONFIG(async_dns)
+class QHostInfoAsyncResolver;
+#endif
+
 class QHostInfoRunnable : public QRunnable
 {
 public:
@@ -142,10 +151,17 @@ public:
     ~QHostInfoRunnable() override;
 
     void run() override;
+#if QT_CONFIG(async_dns)
+    bool asyncLookupFromCache();
+    void asyncLookupFinished(const QHostInfo &hostInfo, int ttl);
+#endif
 
     QString toBeLookedUp;
     int id;
     QHostInfoResult resultEmitter;
+
+private:
+    void postResults(QHostInfoLookupManager *manager, QHostInfo hostInfo);
 };
 
 
@@ -168,6 +184,9 @@ public:
     QHostInfoCache cache;
 
     friend class QHostInfoRunnable;
+#if QT_CONFIG(async_dns)
+    friend void qt_qhostinfo_set_async_nameserver(const QHostAddress &, quint16);
+#endif
 protected:
 #if QT_CONFIG(thread)
     QList<QHostInfoRunnable*> currentLookups; // in progress
@@ -179,6 +198,10 @@ protected:
 
 #if QT_CONFIG(thread)
     QThreadPool threadPool;
+#endif
+#if QT_CONFIG(async_dns)
+    QList<QHostInfoRunnable*> asyncLookups; // in progress in the asynchronous resolver
+    std::unique_ptr<QHostInfoAsyncResolver> asyncResolver;
 #endif
     QMutex mutex;
 
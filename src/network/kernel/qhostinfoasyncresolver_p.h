@@ -0,0 +1,80 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QHOSTINFOASYNCRESOLVER_P_H
+#define QHOSTINFOASYNCRESOLVER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QHostInfo class.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+#include "QtNetwork/qhostaddress.h"
+#include "QtCore/qlist.h"
+#include "QtCore/qmutex.h"
+#include "QtCore/qthread.h"
+#include "QtCore/qwaitcondition.h"
+
+#include <atomic>
+
+QT_REQUIRE_CONFIG(async_dns);
+
+QT_BEGIN_NAMESPACE
+
+class QHostInfoRunnable;
+class QHostInfoDnsClient;
+
+/*
+    Resolves host names by sending DNS queries over non-blocking sockets from
+    a single thread, so that the number of concurrent lookups is not bound by
+    the size of QHostInfoLookupManager's thread pool. It honors /etc/hosts and
+    /etc/resolv.conf, and reports the time to live of the records it received.
+
+    Only names that the system's name service switch would look up in "files"
+    and "dns" are resolved here; everything else is left to getaddrinfo().
+*/
+class QHostInfoAsyncResolver
+{
+public:
+    QHostInfoAsyncResolver();
+    ~QHostInfoAsyncResolver();
+
+    bool isActive() const { return active.load(std::memory_order_relaxed); }
+    bool canResolve(const QString &name) const;
+
+    // takes ownership of the runnable, which deletes itself when done
+    void start(QHostInfoRunnable *runnable);
+    void waitForDone();
+
+    // for the auto tests
+    void setNameServer(const QHostAddress &address, quint16 port);
+
+private:
+    friend class QHostInfoDnsClient;
+    QList<QHostInfoRunnable *> takeIncomingLookups();
+    bool nameServerOverride(QHostAddress *address, quint16 *port);
+    void lookupDone();
+
+    QThread thread;
+    QHostInfoDnsClient *client = nullptr;
+    std::atomic<bool> active;
+    const bool useSystemConfig;
+
+    QMutex mutex;
+    QWaitCondition allDone;
+    QList<QHostInfoRunnable *> incomingLookups;
+    int pendingLookups = 0;
+    QHostAddress overrideAddress;
+    quint16 overridePort = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif // QHOSTINFOASYNCRESOLVER_P_H
@@ -0,0 +1,861 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+//#define QHOSTINFO_DEBUG
+
+#include "qhostinfoasyncresolver_p.h"
+#include "qhostinfo_p.h"
+#include "qdnslookup_p.h"
+
+#include <qcoreapplication.h>
+#include <qdeadlinetimer.h>
+#include <qendian.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qnetworkinterface.h>
+#include <qplatformdefs.h>
+#include <qqueue.h>
+#include <qrandom.h>
+#include <qset.h>
+#include <qtcpsocket.h>
+#include <qtimer.h>
+#include <qudpsocket.h>
+#include <qurl.h>
+#include <qvarlengtharray.h>
+
+#include <netdb.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <utility>
+
+#ifndef _PATH_RESCONF
+#  define _PATH_RESCONF "/etc/resolv.conf"
+#endif
+#ifndef _PATH_HOSTS
+#  define _PATH_HOSTS "/etc/hosts"
+#endif
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+// RFC 1035 section 4.1.1
+static constexpr qsizetype DnsHeaderSize = 12;
+static constexpr quint16 DnsFlagTruncated = 0x0200;
+static constexpr quint16 DnsFlagRecursionDesired = 0x0100;
+static constexpr quint16 DnsClassIN = 1;
+static constexpr quint16 DnsTypeOPT = 41;
+
+// like QDnsLookup: the minimum IPv6 MTU (1280) minus the IPv6 (40) and UDP headers (8)
+static constexpr quint16 Edns0PayloadSize = 1280 - 40 - 8;
+// root label, type, payload size, extended rcode, version, flags and option length
+static constexpr qsizetype Edns0RecordSize = 1 + 2 + 2 + 1 + 1 + 2 + 2;
+
+// same limits as the resolver in libc
+static constexpr qsizetype MaxNameServers = 3;
+static constexpr int MaxNdots = 15;
+static constexpr int MaxTimeout = 30;
+static constexpr int MaxAttempts = 5;
+
+// /etc/resolv.conf and /etc/hosts are checked for changes at most this often
+static constexpr auto ConfigRecheckInterval = 1s;
+
+// Each lookup has up to two queries in flight, and each query needs a unique
+// 16-bit ID. Stay well clear of that limit; any further lookups are queued.
+static constexpr qsizetype MaxRunningLookups = 8192;
+
+// the default UDP receive buffer would overflow during bursts of replies
+static constexpr int ReceiveBufferSize = 1024 * 1024;
+
+// The replies to the queries of lookups that haven't timed out yet can arrive
+// in a burst, and must fit into the receive buffer, which the system usually
+// caps well below what we ask for. Each datagram is charged with its payload
+// plus the kernel's bookkeeping, so budget this much per query.
+static constexpr int ReceiveBufferPerQuery = 2048;
+static constexpr qsizetype MinAnsweringLookups = 64;
+
+namespace {
+struct ResolverConfig
+{
+    QList<std::pair<QHostAddress, quint16>> nameServers;
+    QByteArrayList searchDomains;
+    std::chrono::seconds timeout = 5s;
+    int ndots = 1;
+    int attempts = 2;
+    bool queryIPv4 = true;
+    bool queryIPv6 = true;
+    bool preferIPv6 = false;
+};
+}
+
+/*
+    Returns true if the "hosts" database of /etc/nsswitch.conf consists of
+    only the "files" and "dns" sources, which are the two this resolver
+    implements. Any other source (mDNS, systemd-resolved, NIS, ...) means
+    we would return different results than getaddrinfo().
+*/
+static bool nsswitchUsesFilesAndDnsOnly()
+{
+    QFile nsswitch(u"/etc/nsswitch.conf"_s);
+    if (!nsswitch.open(QIODevice::ReadOnly))
+        return true;        // glibc's default is "dns [!UNAVAIL=return] files"
+
+    while (!nsswitch.atEnd()) {
+        QByteArray line = nsswitch.readLine();
+        if (qsizetype hash = line.indexOf('#'); hash >= 0)
+            line.truncate(hash);
+        line = line.simplified();
+        if (!line.startsWith("hosts:"))
+            continue;
+
+        bool inAction = false;
+        const QByteArrayList sources = line.sliced(qstrlen("hosts:")).simplified().split(' ');
+        for (const QByteArray &source : sources) {
+            // skip the action items, like [NOTFOUND=return]
+            if (source.startsWith('['))
+                inAction = true;
+            if (inAction) {
+                inAction = !source.endsWith(']');
+                continue;
+            }
+            if (!source.isEmpty() && source != "files" && source != "dns")
+                return false;
+        }
+        return true;
+    }
+    return true;
+}
+
+static void parseResolverOptions(ResolverConfig *config, const QByteArrayList &options)
+{
+    auto value = [](const QByteArray &option, int max) {
+        const qsizetype colon = option.indexOf(':');
+        return qBound(0, option.sliced(colon + 1).toInt(), max);
+    };
+    for (const QByteArray &option : options) {
+        if (option.startsWith("ndots:"))
+            config->ndots = value(option, MaxNdots);
+        else if (option.startsWith("timeout:"))
+            config->timeout = std::chrono::seconds(qMax(1, value(option, MaxTimeout)));
+        else if (option.startsWith("attempts:"))
+            config->attempts = qMax(1, value(option, MaxAttempts));
+    }
+}
+
+static QByteArrayList parseSearchDomains(const QByteArrayList &domains)
+{
+    QByteArrayList result;
+    for (QByteArray domain : domains) {
+        while (domain.endsWith('.'))
+            domain.chop(1);
+        if (!domain.isEmpty())
+            result.append(domain.toLower());
+    }
+    return result;
+}
+
+/*
+    Reads /etc/resolv.conf, applying the same environment overrides and
+    defaults as the resolver in libc.
+*/
+static ResolverConfig readResolverConfig()
+{
+    ResolverConfig config;
+
+    QFile resolvconf(QString::fromLatin1(_PATH_RESCONF));
+    if (resolvconf.open(QIODevice::ReadOnly)) {
+        while (!resolvconf.atEnd()) {
+            const QByteArrayList words = resolvconf.readLine().simplified().split(' ');
+            const QByteArray &keyword = words.first();
+            if (keyword == "nameserver" && words.size() > 1) {
+                QHostAddress address;
+                if (config.nameServers.size() < MaxNameServers
+                        && address.setAddress(QString::fromLatin1(words.at(1)))) {
+                    config.nameServers.emplaceBack(address, DnsPort);
+                }
+            } else if (keyword == "domain" && words.size() > 1) {
+                config.searchDomains = parseSearchDomains({ words.at(1) });
+            } else if (keyword == "search") {
+                config.searchDomains = parseSearchDomains(words.sliced(1));
+            } else if (keyword == "options") {
+                parseResolverOptions(&config, words.sliced(1));
+            }
+        }
+    }
+
+    if (qEnvironmentVariableIsSet("LOCALDOMAIN"))
+        config.searchDomains = parseSearchDomains(qgetenv("LOCALDOMAIN").simplified().split(' '));
+    if (qEnvironmentVariableIsSet("RES_OPTIONS"))
+        parseResolverOptions(&config, qgetenv("RES_OPTIONS").simplified().split(' '));
+
+    if (config.nameServers.isEmpty())
+        config.nameServers.emplaceBack(QHostAddress(QHostAddress::LocalHost), DnsPort);
+    return config;
+}
+
+/*
+    Implements AI_ADDRCONFIG: only ask for the address families that this
+    host has a (non-loopback, non-link-local) address of, and put IPv6
+    results first only if we have a global IPv6 address to reach them with.
+*/
+static void detectAddressFamilies(ResolverConfig *config)
+{
+    bool hasIPv4 = false;
+    bool hasIPv6 = false;
+    bool hasGlobalIPv6 = false;
+    const QList<QHostAddress> addresses = QNetworkInterface::allAddresses();
+    for (const QHostAddress &address : addresses) {
+        if (address.isLoopback() || address.isLinkLocal())
+            continue;
+        if (address.protocol() == QAbstractSocket::IPv4Protocol) {
+            hasIPv4 = true;
+        } else if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+            hasIPv6 = true;
+            hasGlobalIPv6 = hasGlobalIPv6 || address.isGlobal();
+        }
+    }
+
+    // if nothing is configured, ask for both like getaddrinfo() does
+    config->queryIPv4 = hasIPv4 || !hasIPv6;
+    config->queryIPv6 = hasIPv6 || !hasIPv4;
+    config->preferIPv6 = hasGlobalIPv6;
+}
+
+static QHash<QByteArray, QList<QHostAddress>> readHostsFile()
+{
+    QHash<QByteArray, QList<QHostAddress>> hosts;
+    QFile file(QString::fromLatin1(_PATH_HOSTS));
+    if (!file.open(QIODevice::ReadOnly))
+        return hosts;
+
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (qsizetype hash = line.indexOf('#'); hash >= 0)
+            line.truncate(hash);
+        const QByteArrayList words = line.simplified().split(' ');
+        if (words.size() < 2)
+            continue;
+
+        QHostAddress address;
+        if (!address.setAddress(QString::fromLatin1(words.first())))
+            continue;
+        for (qsizetype i = 1; i < words.size(); ++i) {
+            QList<QHostAddress> &addresses = hosts[words.at(i).toLower()];
+            if (!addresses.contains(address))
+                addresses.append(address);
+        }
+    }
+    return hosts;
+}
+
+// like maybeRefreshResolver() in qhostinfo_unix.cpp
+static bool fileChanged(const char *path, QT_STATBUF *lastStat)
+{
+    QT_STATBUF st = {};
+    if (QT_STAT(path, &st) != 0)
+        st = {};
+    const bool changed = lastStat->st_ctime != st.st_ctime
+            || lastStat->st_dev != st.st_dev
+            || lastStat->st_ino != st.st_ino;
+    *lastStat = st;
+    return changed;
+}
+
+/*
+    Builds a recursive query for \a name (already ACE-encoded) with an EDNS0
+    record, or returns an empty array if \a name is not a valid domain name.
+*/
+static QByteArray makeQuery(quint16 id, const QByteArray &name, QDnsLookup::Type type)
+{
+    QByteArray packet;
+    packet.reserve(DnsHeaderSize + name.size() + 2 + 4 + Edns0RecordSize);
+    auto append16 = [&packet](quint16 value) {
+        packet.append(char(value >> 8)).append(char(value & 0xff));
+    };
+
+    append16(id);
+    append16(DnsFlagRecursionDesired);
+    append16(1);        // questions
+    append16(0);        // answers
+    append16(0);        // authority records
+    append16(1);        // additional records: the EDNS0 record
+
+    const QByteArrayList labels = name.split('.');
+    for (const QByteArray &label : labels) {
+        if (label.isEmpty() || label.size() > 63)
+            return QByteArray();
+        packet.append(char(label.size())).append(label);
+    }
+    packet.append('\0');
+    if (packet.size() - DnsHeaderSize > MaxDomainNameLength)
+        return QByteArray();
+    append16(type);
+    append16(DnsClassIN);
+
+    // https://www.rfc-editor.org/rfc/rfc6891
+    packet.append('\0');
+    append16(DnsTypeOPT);
+    append16(Edns0PayloadSize);
+    packet.append(Edns0RecordSize - 5, '\0');
+    return packet;
+}
+
+static void sortAddresses(QList<QHostAddress> *addresses, bool preferIPv6)
+{
+    const auto preferred = preferIPv6 ? QAbstractSocket::IPv6Protocol
+                                      : QAbstractSocket::IPv4Protocol;
+    std::stable_partition(addresses->begin(), addresses->end(),
+                          [preferred](const QHostAddress &a) { return a.protocol() == preferred; });
+}
+
+class QHostInfoDnsClient : public QObject
+{
+public:
+    explicit QHostInfoDnsClient(QHostInfoAsyncResolver *resolver)
+        : resolver(resolver)
+    {
+    }
+    ~QHostInfoDnsClient() override;
+
+    void startPendingLookups();
+
+private:
+    struct Lookup
+    {
+        QHostInfoRunnable *runnable = nullptr;
+        QByteArrayList candidates;  // fully-qualified names to try, in order
+        qsizetype candidate = 0;
+        int runningQueries = 0;
+        bool failed = false;        // a query failed for a reason other than NXDOMAIN
+        bool stalled = false;       // a query timed out, so expect no reply soon
+        quint32 ttl = std::numeric_limits<quint32>::max();
+        QList<QHostAddress> addresses;
+    };
+
+    struct Query
+    {
+        Lookup *lookup = nullptr;
+        QByteArray packet;
+        QHostAddress server;
+        quint16 port = 0;
+        quint16 id = 0;
+        QDnsLookup::Type type = QDnsLookup::A;
+        int attempt = 0;
+        quint32 serial = 0;         // invalidates the timeouts of earlier attempts
+        QTcpSocket *tcpSocket = nullptr;
+        QByteArray tcpBuffer;
+    };
+
+    struct Timeout
+    {
+        QDeadlineTimer deadline;
+        quint16 id;
+        quint32 serial;
+    };
+
+    void refreshConfig();
+    void startWaitingLookups();
+    void startLookup(Lookup *lookup);
+    void sendQueries(Lookup *lookup);
+    void send(Query *query);
+    void sendOverTcp(Query *query);
+    void retry(Query *query);
+    void readDatagrams();
+    void readTcpReply(Query *query);
+    void processReply(Query *query, const unsigned char *data, qsizetype size);
+    void finishQuery(Query *query, const QDnsLookupReply &reply);
+    void finishLookup(Lookup *lookup);
+    void processTimeouts();
+    void armTimer();
+
+    QHostInfoAsyncResolver *resolver;
+    QUdpSocket *socket = nullptr;
+    QTimer *timer = nullptr;
+
+    QHash<quint16, Query *> queries;
+    std::deque<Timeout> timeouts;
+    QQueue<Lookup *> waitingLookups;
+    qsizetype runningLookups = 0;
+    qsizetype answeringLookups = 0;     // running, and not stalled
+    qsizetype maxAnsweringLookups = MinAnsweringLookups;
+    bool startingLookups = false;
+
+    ResolverConfig config;
+    QHash<QByteArray, QList<QHostAddress>> hosts;
+    QDeadlineTimer configRecheck;
+    QT_STATBUF resolvConfStat = {};
+    QT_STATBUF hostsStat = {};
+    QHostAddress overrideAddress;
+    quint16 overridePort = 0;
+};
+
+QHostInfoDnsClient::~QHostInfoDnsClient()
+{
+    // only reached when QHostInfoLookupManager is destroyed: nothing gets delivered
+    QSet<Lookup *> lookups;
+    for (Query *query : std::as_const(queries)) {
+        lookups.insert(query->lookup);
+        delete query;
+    }
+    lookups.unite(QSet<Lookup *>(waitingLookups.cbegin(), waitingLookups.cend()));
+    for (Lookup *lookup : std::as_const(lookups)) {
+        delete lookup->runnable;
+        delete lookup;
+    }
+}
+
+void QHostInfoDnsClient::startPendingLookups()
+{
+    if (!socket) {
+        socket = new QUdpSocket(this);
+        socket->bind();
+        socket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, ReceiveBufferSize);
+        const int receiveBufferSize =
+                socket->socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt();
+        maxAnsweringLookups = qMax(MinAnsweringLookups,
+                                   qsizetype(receiveBufferSize / (2 * ReceiveBufferPerQuery)));
+        connect(socket, &QUdpSocket::readyRead, this, &QHostInfoDnsClient::readDatagrams);
+
+        timer = new QTimer(this);
+        timer->setSingleShot(true);
+        connect(timer, &QTimer::timeout, this, &QHostInfoDnsClient::processTimeouts);
+    }
+
+    refreshConfig();
+
+    const QList<QHostInfoRunnable *> runnables = resolver->takeIncomingLookups();
+    for (QHostInfoRunnable *runnable : runnables) {
+        Lookup *lookup = new Lookup;
+        lookup->runnable = runnable;
+        waitingLookups.enqueue(lookup);
+    }
+    startWaitingLookups();
+}
+
+void QHostInfoDnsClient::refreshConfig()
+{
+    QHostAddress address;
+    quint16 port = 0;
+    const bool overridden = resolver->nameServerOverride(&address, &port);
+    const bool overrideChanged = address != overrideAddress || port != overridePort;
+    if (!overrideChanged && !configRecheck.hasExpired() && !config.nameServers.isEmpty())
+        return;
+    configRecheck.setRemainingTime(ConfigRecheckInterval);
+    overrideAddress = address;
+    overridePort = port;
+
+    if (fileChanged(_PATH_HOSTS, &hostsStat) || overrideChanged)
+        hosts = readHostsFile();
+    if (fileChanged(_PATH_RESCONF, &resolvConfStat) || overrideChanged
+            || config.nameServers.isEmpty()) {
+        config = readResolverConfig();
+        if (overridden) {
+            config.nameServers = { { address, port } };
+            config.searchDomains.clear();
+            config.timeout = 1s;
+        }
+    }
+
+    if (overridden) {
+        config.queryIPv4 = config.queryIPv6 = true;
+        config.preferIPv6 = false;
+    } else {
+        detectAddressFamilies(&config);
+    }
+}
+
+/*
+    Starts waiting lookups until the limits are reached. Lookups that stalled
+    don't count towards the limit on answering ones, so that a few unanswered
+    names don't hold up everything behind them. Lookups that finish right away
+    (from the cache or /etc/hosts) re-enter here through finishLookup(); the
+    outermost call does all the work, so the recursion doesn't build up.
+*/
+void QHostInfoDnsClient::startWaitingLookups()
+{
+    if (startingLookups)
+        return;
+    startingLookups = true;
+    while (!waitingLookups.isEmpty() && runningLookups < MaxRunningLookups
+           && answeringLookups < maxAnsweringLookups) {
+        Lookup *lookup = waitingLookups.dequeue();
+        if (lookup->runnable->asyncLookupFromCache()) {
+            delete lookup;
+            resolver->lookupDone();
+            continue;
+        }
+        startLookup(lookup);
+    }
+    startingLookups = false;
+}
+
+void QHostInfoDnsClient::startLookup(Lookup *lookup)
+{
+    ++runningLookups;
+    ++answeringLookups;
+
+    // IDN support
+    const QString &hostName = lookup->runnable->toBeLookedUp;
+    QByteArray aceHostname = QUrl::toAce(hostName).toLower();
+    const bool absolute = aceHostname.endsWith('.');
+    if (absolute)
+        aceHostname.chop(1);
+
+    if (const auto it = hosts.constFind(aceHostname); it != hosts.cend()) {
+        QList<QHostAddress> addresses;
+        for (const QHostAddress &address : *it) {
+            if (address.protocol() == QAbstractSocket::IPv4Protocol ? config.queryIPv4
+                                                                     : config.queryIPv6) {
+                addresses.append(address);
+            }
+        }
+        lookup->addresses = addresses.isEmpty() ? *it : addresses;
+        return finishLookup(lookup);
+    }
+
+    if (!aceHostname.isEmpty()) {
+        // the same search rules as res_nsearch()
+        const qsizetype dots = aceHostname.count('.');
+        if (absolute || dots >= config.ndots)
+            lookup->candidates.append(aceHostname);
+        if (!absolute) {
+            for (const QByteArray &domain : std::as_const(config.searchDomains))
+                lookup->candidates.append(aceHostname + '.' + domain);
+        }
+        if (!absolute && dots < config.ndots)
+            lookup->candidates.append(aceHostname);
+    }
+    sendQueries(lookup);
+}
+
+void QHostInfoDnsClient::sendQueries(Lookup *lookup)
+{
+    while (lookup->candidate < lookup->candidates.size()) {
+        const QByteArray &name = lookup->candidates.at(lookup->candidate);
+        for (QDnsLookup::Type type : { QDnsLookup::A, QDnsLookup::AAAA }) {
+            if (!(type == QDnsLookup::A ? config.queryIPv4 : config.queryIPv6))
+                continue;
+
+            quint16 id;
+            do {
+                id = quint16(QRandomGenerator::global()->generate());
+            } while (queries.contains(id));
+
+            QByteArray packet = makeQuery(id, name, type);
+            if (packet.isEmpty())
+                break;
+
+            Query *query = new Query;
+            query->lookup = lookup;
+            query->packet = std::move(packet);
+            query->id = id;
+            query->type = type;
+            queries.insert(id, query);
+            ++lookup->runningQueries;
+            send(query);
+        }
+        if (lookup->runningQueries)
+            return;
+
+        // not a valid domain name, try the next one
+        ++lookup->candidate;
+    }
+
+    // nothing left to query
+    finishLookup(lookup);
+}
+
+void QHostInfoDnsClient::send(Query *query)
+{
+    const auto &[server, port] =
+            config.nameServers.at(query->attempt % config.nameServers.size());
+    query->server = server;
+    query->port = port;
+    socket->writeDatagram(query->packet, server, port);
+
+    timeouts.push_back({ QDeadlineTimer(config.timeout), query->id, ++query->serial });
+    armTimer();
+}
+
+// the reply didn't fit in a datagram: repeat the query over TCP (RFC 7766)
+void QHostInfoDnsClient::sendOverTcp(Query *query)
+{
+    query->tcpSocket = new QTcpSocket(this);
+    connect(query->tcpSocket, &QTcpSocket::connected, this, [query] {
+        const quint16 length = qToBigEndian<quint16>(query->packet.size());
+        query->tcpSocket->write(reinterpret_cast<const char *>(&length), sizeof(length));
+        query->tcpSocket->write(query->packet);
+    });
+    connect(query->tcpSocket, &QTcpSocket::readyRead, this, [this, query] {
+        readTcpReply(query);
+    });
+    connect(query->tcpSocket, &QTcpSocket::errorOccurred, this, [this, query] {
+        query->lookup->failed = true;
+        finishQuery(query, QDnsLookupReply());
+    });
+    query->tcpSocket->connectToHost(query->server, query->port);
+
+    timeouts.push_back({ QDeadlineTimer(config.timeout), query->id, ++query->serial });
+    armTimer();
+}
+
+void QHostInfoDnsClient::retry(Query *query)
+{
+    if (!query->tcpSocket && ++query->attempt < config.attempts * config.nameServers.size())
+        return send(query);
+
+    query->lookup->failed = true;
+    finishQuery(query, QDnsLookupReply());
+}
+
+void QHostInfoDnsClient::readDatagrams()
+{
+    QVarLengthArray<unsigned char, Edns0PayloadSize> buffer;
+    while (socket->hasPendingDatagrams()) {
+        buffer.resize(qMax(socket->pendingDatagramSize(), qint64(0)));
+        QHostAddress sender;
+        quint16 senderPort = 0;
+        const qint64 size = socket->readDatagram(reinterpret_cast<char *>(buffer.data()),
+                                                 buffer.size(), &sender, &senderPort);
+        if (size < DnsHeaderSize)
+            continue;
+
+        // ignore anything that isn't a reply from the server we asked
+        Query *query = queries.value(qFromBigEndian<quint16>(buffer.data()));
+        if (!query || query->tcpSocket || senderPort != query->port
+                || !sender.isEqual(query->server, QHostAddress::ConvertV4MappedToIPv4)) {
+            continue;
+        }
+        processReply(query, buffer.data(), size);
+    }
+}
+
+void QHostInfoDnsClient::readTcpReply(Query *query)
+{
+    query->tcpBuffer += query->tcpSocket->readAll();
+    if (query->tcpBuffer.size() < qsizetype(sizeof(quint16)))
+        return;
+    const quint16 length = qFromBigEndian<quint16>(query->tcpBuffer.constData());
+    if (query->tcpBuffer.size() < qsizetype(sizeof(quint16)) + length)
+        return;
+
+    const auto data = reinterpret_cast<const unsigned char *>(query->tcpBuffer.constData());
+    if (length < DnsHeaderSize || qFromBigEndian<quint16>(data + sizeof(quint16)) != query->id) {
+        query->lookup->failed = true;
+        return finishQuery(query, QDnsLookupReply());
+    }
+    processReply(query, data + sizeof(quint16), length);
+}
+
+void QHostInfoDnsClient::processReply(Query *query, const unsigned char *data, qsizetype size)
+{
+    // the question must be repeated verbatim (except for the case)
+    const qsizetype questionSize = query->packet.size() - DnsHeaderSize - Edns0RecordSize;
+    const QByteArrayView question(query->packet.constData() + DnsHeaderSize, questionSize);
+    if (size < DnsHeaderSize + questionSize
+            || question.compare(QByteArrayView(data + DnsHeaderSize, questionSize),
+                                Qt::CaseInsensitive) != 0) {
+        return;
+    }
+
+    const quint16 flags = qFromBigEndian<quint16>(data + 2);
+    if ((flags & DnsFlagTruncated) && !query->tcpSocket)
+        return sendOverTcp(query);
+
+    QDnsLookupReply reply;
+    QDnsLookupRunnable::parseReply(&reply, data, int(size));
+    switch (reply.error) {
+    case QDnsLookup::NoError:
+    case QDnsLookup::NotFoundError:
+        break;
+    case QDnsLookup::ServerFailureError:
+    case QDnsLookup::ServerRefusedError:
+        // try the next server right away
+        return retry(query);
+    default:
+        query->lookup->failed = true;
+        break;
+    }
+    finishQuery(query, reply);
+}
+
+void QHostInfoDnsClient::finishQuery(Query *query, const QDnsLookupReply &reply)
+{
+    Lookup *lookup = query->lookup;
+    const auto protocol = query->type == QDnsLookup::A ? QAbstractSocket::IPv4Protocol
+                                                       : QAbstractSocket::IPv6Protocol;
+    for (const QDnsHostAddressRecord &record : reply.hostAddressRecords) {
+        if (record.value().protocol() != protocol)
+            continue;
+        if (!lookup->addresses.contains(record.value()))
+            lookup->addresses.append(record.value());
+        lookup->ttl = qMin(lookup->ttl, record.timeToLive());
+    }
+    for (const QDnsDomainNameRecord &record : reply.canonicalNameRecords)
+        lookup->ttl = qMin(lookup->ttl, record.timeToLive());
+
+    queries.remove(query->id);
+    if (query->tcpSocket) {
+        query->tcpSocket->disconnect(this);
+        query->tcpSocket->abort();
+        query->tcpSocket->deleteLater();
+    }
+    delete query;
+
+    if (--lookup->runningQueries)
+        return;
+    if (lookup->addresses.isEmpty() && ++lookup->candidate < lookup->candidates.size())
+        return sendQueries(lookup);
+    finishLookup(lookup);
+}
+
+void QHostInfoDnsClient::finishLookup(Lookup *lookup)
+{
+    QHostInfo hostInfo;
+    hostInfo.setHostName(lookup->runnable->toBeLookedUp);
+    int ttl = -1;
+    if (!lookup->addresses.isEmpty()) {
+        sortAddresses(&lookup->addresses, config.preferIPv6);
+        hostInfo.setAddresses(lookup->addresses);
+        if (lookup->ttl != std::numeric_limits<quint32>::max())
+            ttl = int(qMin(lookup->ttl, quint32(std::numeric_limits<int>::max())));
+    } else if (lookup->candidates.isEmpty()) {
+        hostInfo.setError(QHostInfo::HostNotFound);
+        hostInfo.setErrorString(QCoreApplication::translate("QHostInfoAgent", "Invalid hostname"));
+    } else if (lookup->failed) {
+        hostInfo.setError(QHostInfo::UnknownError);
+        hostInfo.setErrorString(QString::fromLocal8Bit(gai_strerror(EAI_AGAIN)));
+    } else {
+        hostInfo.setError(QHostInfo::HostNotFound);
+        hostInfo.setErrorString(QCoreApplication::translate("QHostInfoAgent", "Host not found"));
+    }
+
+#if defined(QHOSTINFO_DEBUG)
+    qDebug() << "QHostInfoDnsClient: resolved" << hostInfo.hostName() << "to"
+             << hostInfo.addresses() << "ttl" << ttl << hostInfo.errorString();
+#endif
+
+    lookup->runnable->asyncLookupFinished(hostInfo, ttl);
+    --runningLookups;
+    if (!lookup->stalled)
+        --answeringLookups;
+    delete lookup;
+    resolver->lookupDone();
+
+    startWaitingLookups();
+}
+
+void QHostInfoDnsClient::processTimeouts()
+{
+    // The timeouts are (nearly) sorted by deadline, since they all have the
+    // same duration; entries for queries that were answered are stale.
+    while (!timeouts.empty()) {
+        const Timeout &timeout = timeouts.front();
+        Query *query = queries.value(timeout.id);
+        if (query && query->serial == timeout.serial) {
+            if (!timeout.deadline.hasExpired())
+                break;
+            timeouts.pop_front();
+            if (!std::exchange(query->lookup->stalled, true))
+                --answeringLookups;
+            retry(query);
+        } else {
+            timeouts.pop_front();
+        }
+    }
+    armTimer();
+    startWaitingLookups();
+}
+
+void QHostInfoDnsClient::armTimer()
+{
+    if (timeouts.empty())
+        timer->stop();
+    else if (!timer->isActive())
+        timer->start(std::chrono::ceil<std::chrono::milliseconds>(
+                timeouts.front().deadline.remainingTimeAsDuration()));
+}
+
+QHostInfoAsyncResolver::QHostInfoAsyncResolver()
+    : active(false),
+      useSystemConfig(qEnvironmentVariableIntValue("QT_HOSTINFO_ASYNC_DNS") > 0
+                      && nsswitchUsesFilesAndDnsOnly())
+{
+    active.store(useSystemConfig, std::memory_order_relaxed);
+    thread.setObjectName(u"QHostInfo resolver"_s);
+}
+
+QHostInfoAsyncResolver::~QHostInfoAsyncResolver()
+{
+    thread.quit();
+    thread.wait();
+
+    // the client deleted the lookups it had started
+    qDeleteAll(incomingLookups);
+}
+
+bool QHostInfoAsyncResolver::canResolve(const QString &name) const
+{
+    // reverse lookups are left to getnameinfo()
+    QHostAddress address;
+    return !name.isEmpty() && !address.setAddress(name);
+}
+
+void QHostInfoAsyncResolver::start(QHostInfoRunnable *runnable)
+{
+    QMutexLocker locker(&mutex);
+    if (!client) {
+        client = new QHostInfoDnsClient(this);
+        client->moveToThread(&thread);
+        QObject::connect(&thread, &QThread::finished, client, &QObject::deleteLater);
+        thread.start();
+    }
+
+    ++pendingLookups;
+    incomingLookups.append(runnable);
+    if (incomingLookups.size() == 1) {
+        QMetaObject::invokeMethod(client, [client = client] { client->startPendingLookups(); },
+                                  Qt::QueuedConnection);
+    }
+}
+
+void QHostInfoAsyncResolver::waitForDone()
+{
+    QMutexLocker locker(&mutex);
+    while (pendingLookups)
+        allDone.wait(&mutex);
+}
+
+void QHostInfoAsyncResolver::setNameServer(const QHostAddress &address, quint16 port)
+{
+    QMutexLocker locker(&mutex);
+    overrideAddress = address;
+    overridePort = port;
+    active.store(useSystemConfig || !address.isNull(), std::memory_order_relaxed);
+}
+
+QList<QHostInfoRunnable *> QHostInfoAsyncResolver::takeIncomingLookups()
+{
+    QMutexLocker locker(&mutex);
+    return std::exchange(incomingLookups, {});
+}
+
+bool QHostInfoAsyncResolver::nameServerOverride(QHostAddress *address, quint16 *port)
+{
+    QMutexLocker locker(&mutex);
+    *address = overrideAddress;
+    *port = overridePort;
+    return !overrideAddress.isNull();
+}
+
+void QHostInfoAsyncResolver::lookupDone()
+{
+    QMutexLocker locker(&mutex);
+    if (--pendingLookups == 0)
+        allDone.wakeAll();
+}
+
+QT_END_NAMESPACE
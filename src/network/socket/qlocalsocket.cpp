@@ -124,6 +124,52 @@ QT_BEGIN_NAMESPACE
     \sa setSocketDescriptor()
 */
 
+/*!
+    \fn bool QLocalSocket::sendDescriptors(const QList<qintptr> &descriptors, const QByteArray &data)
+    \since 6.8
+
+    Writes \a data to the socket and passes the open file \a descriptors
+    to the peer along with it, which receives them as new descriptors
+    referring to the same open files, pipes or sockets. Returns \c true if
+    the data was written to the socket, or \c false if an error occurred.
+
+    The descriptors are duplicated immediately, so the caller may close its
+    own right after this call. \a data must not be empty: the descriptors
+    travel with its first byte, behind the data written before this call.
+    On Linux, up to 253 descriptors can be passed at once.
+
+    This is only supported on Unix, where QLocalSocket uses a local domain
+    socket. On other platforms this function returns \c false.
+
+    \sa takeReceivedDescriptors()
+*/
+
+/*!
+    \fn QList<qintptr> QLocalSocket::takeReceivedDescriptors()
+    \since 6.8
+
+    Returns the file descriptors the peer has passed with sendDescriptors(),
+    in the order they were sent, and transfers their ownership to the
+    caller, who is responsible for closing them. Descriptors are received
+    together with the data they were sent with, so they are available by
+    the time that data can be read.
+
+    The descriptors are not associated with a position in the data, so this
+    function cannot tell which bytes they arrived with; it may return those
+    of several sendDescriptors() calls at once. Protocols that pass
+    descriptors should announce them in the data, and take them once the
+    announcement has been read.
+
+    If the kernel had to discard descriptors, because the process cannot
+    open any more files, the socket reports
+    QLocalSocket::SocketResourceError and is closed.
+
+    Descriptors that have not been taken when the socket is closed are
+    closed along with it.
+
+    \sa sendDescriptors()
+*/
+
 /*!
     \fn qint64 QLocalSocket::readData(char *data, qint64 c)
     \reimp
@@ -85,6 +85,9 @@ public:
                              OpenMode openMode = ReadWrite);
     qintptr socketDescriptor() const;
 
+    bool sendDescriptors(const QList<qintptr> &descriptors, const QByteArray &data);
+    QList<qintptr> takeReceivedDescriptors();
+
     void setSocketOptions(SocketOptions option);
     SocketOptions socketOptions() const;
     QBindable<SocketOptions> bindableSocketOptions();
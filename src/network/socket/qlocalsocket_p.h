@@ -32,6 +32,7 @@ QT_REQUIRE_CONFIG(localserver);
 #   include <qwineventnotifier.h>
 #else
 #   include "private/qabstractsocketengine_p.h"
+#   include "private/qnativesocketengine_p.h"
 #   include <qtcpsocket.h>
 #   include <qsocketnotifier.h>
 #   include <errno.h>
@@ -116,6 +117,7 @@ public:
     void _q_abortConnectionAttempt();
     void cancelDelayedConnect();
     void describeSocket(qintptr socketDescriptor);
+    QNativeSocketEngine *socketEngine();
     static bool parseSockaddr(const sockaddr_un &addr, uint len,
                               QString &fullServerName, QString &serverName, bool &abstractNamespace);
     QSocketNotifier *delayConnect;
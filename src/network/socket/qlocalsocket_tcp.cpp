@@ -258,6 +258,19 @@ qintptr QLocalSocket::socketDescriptor() const
     return d->tcpSocket->socketDescriptor();
 }
 
+bool QLocalSocket::sendDescriptors(const QList<qintptr> &descriptors, const QByteArray &data)
+{
+    Q_UNUSED(descriptors);
+    Q_UNUSED(data);
+    qWarning("QLocalSocket::sendDescriptors: Not supported on this platform");
+    return false;
+}
+
+QList<qintptr> QLocalSocket::takeReceivedDescriptors()
+{
+    return {};
+}
+
 qint64 QLocalSocket::readData(char *data, qint64 c)
 {
     Q_D(QLocalSocket);
@@ -4,6 +4,8 @@
 #include "qlocalsocket.h"
 #include "qlocalsocket_p.h"
 #include "qnet_unix_p.h"
+#include "private/qabstractsocket_p.h"
+#include "private/qcore_unix_p.h"
 
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -323,6 +325,8 @@ void QLocalSocketPrivate::_q_connectToSocket()
     fullServerName = connectingPathName;
     if (unixSocket.setSocketDescriptor(connectingSocket,
         QAbstractSocket::ConnectedState, connectingOpenMode)) {
+        if (QNativeSocketEngine *engine = socketEngine())
+            engine->setDescriptorPassingEnabled(true);
         q->QIODevice::open(connectingOpenMode);
         q->emit connected();
     } else {
@@ -356,8 +360,59 @@ bool QLocalSocket::setSocketDescriptor(qintptr socketDescriptor,
     QIODevice::open(openMode);
     d->state = socketState;
     d->describeSocket(socketDescriptor);
-    return d->unixSocket.setSocketDescriptor(socketDescriptor,
-                                             newSocketState, openMode);
+    if (!d->unixSocket.setSocketDescriptor(socketDescriptor, newSocketState, openMode))
+        return false;
+    if (QNativeSocketEngine *engine = d->socketEngine())
+        engine->setDescriptorPassingEnabled(true);
+    return true;
+}
+
+QNativeSocketEngine *QLocalSocketPrivate::socketEngine()
+{
+    auto socketPrivate = static_cast<QAbstractSocketPrivate *>(QObjectPrivate::get(&unixSocket));
+    return qobject_cast<QNativeSocketEngine *>(socketPrivate->socketEngine);
+}
+
+bool QLocalSocket::sendDescriptors(const QList<qintptr> &descriptors, const QByteArray &data)
+{
+    Q_D(QLocalSocket);
+    if (data.isEmpty()) {
+        qWarning("QLocalSocket::sendDescriptors: Descriptors must be sent along with data");
+        return false;
+    }
+    QNativeSocketEngine *engine = d->socketEngine();
+    if (!engine || d->state != ConnectedState || !isWritable()) {
+        qWarning("QLocalSocket::sendDescriptors: Socket is not connected");
+        return false;
+    }
+
+    // The engine sends them once the data buffered ahead has been written,
+    // by which time the caller may have closed its own.
+    QList<int> copies;
+    copies.reserve(descriptors.size());
+    for (qintptr descriptor : descriptors) {
+        const int copy = qt_safe_dup(int(descriptor));
+        if (copy == -1) {
+            setErrorString(qt_error_string(errno));
+            for (int fd : std::as_const(copies))
+                qt_safe_close(fd);
+            return false;
+        }
+        copies.append(copy);
+    }
+    engine->queueDescriptors(copies, d->unixSocket.bytesToWrite());
+    return write(data) == data.size();
+}
+
+QList<qintptr> QLocalSocket::takeReceivedDescriptors()
+{
+    Q_D(QLocalSocket);
+    QList<qintptr> descriptors;
+    if (QNativeSocketEngine *engine = d->socketEngine()) {
+        const QList<int> received = engine->takeReceivedDescriptors();
+        descriptors.assign(received.cbegin(), received.cend());
+    }
+    return descriptors;
 }
 
 void QLocalSocketPrivate::describeSocket(qintptr socketDescriptor)
@@ -440,6 +440,19 @@ qintptr QLocalSocket::socketDescriptor() const
     return reinterpret_cast<qintptr>(d->handle);
 }
 
+bool QLocalSocket::sendDescriptors(const QList<qintptr> &descriptors, const QByteArray &data)
+{
+    Q_UNUSED(descriptors);
+    Q_UNUSED(data);
+    qWarning("QLocalSocket::sendDescriptors: Not supported on this platform");
+    return false;
+}
+
+QList<qintptr> QLocalSocket::takeReceivedDescriptors()
+{
+    return {};
+}
+
 qint64 QLocalSocket::readBufferSize() const
 {
     Q_D(const QLocalSocket);
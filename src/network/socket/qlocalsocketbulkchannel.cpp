@@ -0,0 +1,313 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qlocalsocketbulkchannel_p.h"
+
+#include <QtCore/qrandom.h>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <sys/mman.h>
+
+#if defined(Q_OS_LINUX) && defined(MFD_ALLOW_SEALING) && defined(F_ADD_SEALS)
+// The segments are memfds that can't change their size
+#  define QT_BULKCHANNEL_SEALED_SEGMENTS
+#endif
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QLocalSocketBulkChannel
+    \internal
+    \inmodule QtNetwork
+
+    \brief Transfers large payloads between processes through shared memory,
+    using a QLocalSocket only to tell the peer where they are.
+
+    Each side that sends creates one shared memory segment of segmentSize()
+    bytes, passes its descriptor to the peer with
+    QLocalSocket::sendDescriptors(), and then places payloads in it as in a
+    ring buffer. Only a small frame with the offset and length of a payload
+    goes through the socket. The peer maps the segment read-only, so it reads
+    payloads in place, and gives their space back with releasePayload().
+
+    This bounds what is in flight: reserve() and write() fail while the
+    segment has no room for a payload, until the peer releases earlier ones
+    and spaceAvailable() is emitted. A payload can't be larger than the
+    segment.
+
+    The channel uses the socket's data stream for its frames, so nothing
+    else may be read from or written to the socket while it is in use. Both
+    ends of the socket need a QLocalSocketBulkChannel.
+
+    On Linux, segments are memfds sealed against shrinking and growing, and
+    the receiver maps only segments that carry these seals, so the peer
+    can't make it crash by truncating the segment while it is mapped.
+    Elsewhere, the receiver only checks that the segment is large enough
+    when it maps it.
+*/
+
+/*!
+    Creates a channel that uses \a socket, which must be connected, and
+    segments of \a segmentSize bytes for the payloads it sends.
+*/
+QLocalSocketBulkChannel::QLocalSocketBulkChannel(QLocalSocket *socket, qsizetype segmentSize,
+                                                 QObject *parent)
+    : QObject(parent), m_socket(socket), m_segmentSize(segmentSize)
+{
+    Q_ASSERT(socket);
+    Q_ASSERT(segmentSize > 0);
+    connect(socket, &QLocalSocket::readyRead, this, &QLocalSocketBulkChannel::readFrames);
+    if (socket->bytesAvailable())
+        QMetaObject::invokeMethod(this, &QLocalSocketBulkChannel::readFrames, Qt::QueuedConnection);
+}
+
+QLocalSocketBulkChannel::~QLocalSocketBulkChannel()
+{
+    if (m_outgoing)
+        ::munmap(m_outgoing, m_segmentSize);
+    if (m_incomingSegment)
+        ::munmap(const_cast<uchar *>(m_incomingSegment), m_incomingSegmentSize);
+}
+
+static int createSharedMemoryFile(qsizetype size)
+{
+#ifdef QT_BULKCHANNEL_SEALED_SEGMENTS
+    // no fallback, the peer does not accept segments without the seals
+    int fd = ::memfd_create("QLocalSocketBulkChannel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd != -1
+        && (QT_FTRUNCATE(fd, size) == -1
+            || ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)) {
+        qt_safe_close(fd);
+        fd = -1;
+    }
+#else
+    // an anonymous POSIX shared memory object
+    const QByteArray name = "/qt-bulk-"
+            + QByteArray::number(QRandomGenerator::global()->generate64(), 36);
+    int fd = ::shm_open(name.constData(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd != -1)
+        ::shm_unlink(name.constData());
+    if (fd != -1 && QT_FTRUNCATE(fd, size) == -1) {
+        qt_safe_close(fd);
+        fd = -1;
+    }
+#endif
+    return fd;
+}
+
+// Whether the peer's segment fd can be mapped with length bytes without
+// touching memory beyond its end, now or later.
+static bool isUsableSegment(int fd, qsizetype length)
+{
+#ifdef QT_BULKCHANNEL_SEALED_SEGMENTS
+    constexpr int RequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+    const int seals = ::fcntl(fd, F_GET_SEALS);
+    if (seals == -1 || (seals & RequiredSeals) != RequiredSeals)
+        return false;
+#endif
+    QT_STATBUF st;
+    return QT_FSTAT(fd, &st) == 0 && st.st_size >= length;
+}
+
+bool QLocalSocketBulkChannel::ensureOutgoingSegment()
+{
+    if (m_outgoing)
+        return true;
+    if (!m_socket || m_socket->state() != QLocalSocket::ConnectedState)
+        return false;
+
+    const int fd = createSharedMemoryFile(m_segmentSize);
+    if (fd == -1) {
+        qErrnoWarning("QLocalSocketBulkChannel: Cannot create a shared memory segment");
+        return false;
+    }
+    void *mapping = ::mmap(nullptr, m_segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        qErrnoWarning("QLocalSocketBulkChannel: Cannot map the shared memory segment");
+        qt_safe_close(fd);
+        return false;
+    }
+
+    const Frame frame = { FrameType::Segment, 0, 0, quint64(m_segmentSize) };
+    const bool sent = m_socket->sendDescriptors(
+            { fd }, QByteArray(reinterpret_cast<const char *>(&frame), sizeof(frame)));
+    qt_safe_close(fd);
+    if (!sent) {
+        ::munmap(mapping, m_segmentSize);
+        return false;
+    }
+    m_outgoing = static_cast<uchar *>(mapping);
+    return true;
+}
+
+// Returns the offset of a contiguous free range of size bytes, or -1.
+qsizetype QLocalSocketBulkChannel::findSpace(qsizetype size) const
+{
+    if (m_inFlight.isEmpty())
+        return 0;
+    const qsizetype tail = m_inFlight.constFirst().offset;
+    const qsizetype head = m_inFlight.constLast().offset + m_inFlight.constLast().length;
+    if (head > tail) {
+        // used: [tail, head)
+        if (m_segmentSize - head >= size)
+            return head;
+        if (tail >= size)
+            return 0;
+        return -1;
+    }
+    // wrapped around, used: [tail, end) and [0, head)
+    return tail - head >= size ? head : -1;
+}
+
+/*!
+    Returns a pointer to \a size bytes of shared memory for the next payload,
+    or \c nullptr if there is not enough room for it now. Write the payload
+    there and call commit() to send it. Until then, reserve() may be called
+    again to change the size.
+
+    \sa write(), spaceAvailable()
+*/
+char *QLocalSocketBulkChannel::reserve(qsizetype size)
+{
+    if (size <= 0 || size > m_segmentSize || !ensureOutgoingSegment())
+        return nullptr;
+    const qsizetype offset = findSpace(size);
+    if (offset < 0)
+        return nullptr;
+    m_reserved = { offset, size };
+    return reinterpret_cast<char *>(m_outgoing + offset);
+}
+
+/*!
+    Sends the payload placed in the space returned by the last reserve().
+*/
+bool QLocalSocketBulkChannel::commit()
+{
+    if (m_reserved.offset < 0 || !m_socket)
+        return false;
+    const Span span = std::exchange(m_reserved, { -1, 0 });
+    m_inFlight.append(span);
+    m_bytesInFlight += span.length;
+    sendFrame(FrameType::Payload, span.offset, span.length);
+    return true;
+}
+
+/*!
+    Copies \a payload to shared memory and sends it. Returns \c false if
+    there is not enough room for it now.
+*/
+bool QLocalSocketBulkChannel::write(QByteArrayView payload)
+{
+    char *space = reserve(payload.size());
+    if (!space)
+        return false;
+    memcpy(space, payload.data(), payload.size());
+    return commit();
+}
+
+void QLocalSocketBulkChannel::sendFrame(FrameType type, qsizetype offset, qsizetype length)
+{
+    const Frame frame = { type, 0, quint64(offset), quint64(length) };
+    m_socket->write(reinterpret_cast<const char *>(&frame), sizeof(frame));
+}
+
+/*!
+    Returns the oldest payload received and not released yet, or an empty
+    view if there is none. The view stays valid until releasePayload().
+*/
+QByteArrayView QLocalSocketBulkChannel::peekPayload() const
+{
+    if (m_incoming.isEmpty())
+        return {};
+    const Span &span = m_incoming.constFirst();
+    return QByteArrayView(m_incomingSegment + span.offset, span.length);
+}
+
+/*!
+    Gives the space of the payload returned by peekPayload() back to the
+    sender.
+*/
+void QLocalSocketBulkChannel::releasePayload()
+{
+    if (m_incoming.isEmpty())
+        return;
+    const Span span = m_incoming.takeFirst();
+    if (m_socket)
+        sendFrame(FrameType::Release, span.offset, span.length);
+}
+
+/*!
+    Returns a copy of the oldest payload received and releases it.
+*/
+QByteArray QLocalSocketBulkChannel::readPayload()
+{
+    const QByteArray payload = peekPayload().toByteArray();
+    releasePayload();
+    return payload;
+}
+
+bool QLocalSocketBulkChannel::mapIncomingSegment(qsizetype length)
+{
+    const QList<qintptr> descriptors = m_socket->takeReceivedDescriptors();
+    bool mapped = false;
+    if (!descriptors.isEmpty() && !m_incomingSegment && length > 0
+        && isUsableSegment(int(descriptors.constFirst()), length)) {
+        void *mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED,
+                               int(descriptors.constFirst()), 0);
+        if (mapping != MAP_FAILED) {
+            m_incomingSegment = static_cast<const uchar *>(mapping);
+            m_incomingSegmentSize = length;
+            mapped = true;
+        }
+    }
+    for (qintptr fd : descriptors)
+        qt_safe_close(int(fd));
+    return mapped;
+}
+
+void QLocalSocketBulkChannel::readFrames()
+{
+    bool received = false;
+    bool released = false;
+    while (m_socket && m_socket->bytesAvailable() >= qint64(sizeof(Frame))) {
+        Frame frame;
+        m_socket->read(reinterpret_cast<char *>(&frame), sizeof(frame));
+        switch (frame.type) {
+        case FrameType::Segment:
+            if (!mapIncomingSegment(qsizetype(frame.length)))
+                return protocolError("Cannot map the peer's shared memory segment");
+            break;
+        case FrameType::Payload:
+            if (!m_incomingSegment || frame.offset > quint64(m_incomingSegmentSize)
+                || frame.length > quint64(m_incomingSegmentSize) - frame.offset) {
+                return protocolError("Payload outside of the shared memory segment");
+            }
+            m_incoming.append({ qsizetype(frame.offset), qsizetype(frame.length) });
+            received = true;
+            break;
+        case FrameType::Release:
+            if (m_inFlight.isEmpty() || quint64(m_inFlight.constFirst().offset) != frame.offset)
+                return protocolError("Release of a payload that was not sent");
+            m_bytesInFlight -= m_inFlight.takeFirst().length;
+            released = true;
+            break;
+        default:
+            return protocolError("Unknown frame");
+        }
+    }
+    if (received)
+        emit readyRead();
+    if (released)
+        emit spaceAvailable();
+}
+
+void QLocalSocketBulkChannel::protocolError(const char *message)
+{
+    qWarning("QLocalSocketBulkChannel: %s", message);
+    if (m_socket)
+        m_socket->abort();
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qlocalsocketbulkchannel_p.cpp"
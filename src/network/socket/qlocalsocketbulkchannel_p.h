@@ -0,0 +1,97 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QLOCALSOCKETBULKCHANNEL_P_H
+#define QLOCALSOCKETBULKCHANNEL_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of the QLocalSocket class.  This header file may change from
+// version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtNetwork/private/qtnetworkglobal_p.h>
+
+#include <QtNetwork/qlocalsocket.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+
+QT_REQUIRE_CONFIG(localserver);
+
+QT_BEGIN_NAMESPACE
+
+class Q_NETWORK_EXPORT QLocalSocketBulkChannel : public QObject
+{
+    Q_OBJECT
+public:
+    static constexpr qsizetype DefaultSegmentSize = 16 * 1024 * 1024;
+
+    explicit QLocalSocketBulkChannel(QLocalSocket *socket,
+                                     qsizetype segmentSize = DefaultSegmentSize,
+                                     QObject *parent = nullptr);
+    ~QLocalSocketBulkChannel();
+
+    QLocalSocket *socket() const { return m_socket; }
+    qsizetype segmentSize() const { return m_segmentSize; }
+
+    // sending
+    char *reserve(qsizetype size);
+    bool commit();
+    bool write(QByteArrayView payload);
+    qsizetype bytesInFlight() const { return m_bytesInFlight; }
+
+    // receiving
+    qsizetype pendingPayloadCount() const { return m_incoming.size(); }
+    QByteArrayView peekPayload() const;
+    void releasePayload();
+    QByteArray readPayload();
+
+Q_SIGNALS:
+    void readyRead();
+    void spaceAvailable();
+
+private:
+    struct Span
+    {
+        qsizetype offset;
+        qsizetype length;
+    };
+    enum class FrameType : quint32 { Segment, Payload, Release };
+    struct Frame
+    {
+        FrameType type;
+        quint32 reserved;
+        quint64 offset;
+        quint64 length;
+    };
+
+    bool ensureOutgoingSegment();
+    qsizetype findSpace(qsizetype size) const;
+    void sendFrame(FrameType type, qsizetype offset, qsizetype length);
+    void readFrames();
+    bool mapIncomingSegment(qsizetype length);
+    void protocolError(const char *message);
+
+    QPointer<QLocalSocket> m_socket;
+    qsizetype m_segmentSize;
+
+    uchar *m_outgoing = nullptr;
+    QList<Span> m_inFlight; // in the order sent, which is the order released
+    qsizetype m_bytesInFlight = 0;
+    Span m_reserved = { -1, 0 };
+
+    const uchar *m_incomingSegment = nullptr;
+    qsizetype m_incomingSegmentSize = 0;
+    QList<Span> m_incoming;
+};
+
+QT_END_NAMESPACE
+
+#endif // QLOCALSOCKETBULKCHANNEL_P_H
@@ -888,6 +888,57 @@ qint64 QNativeSocketEngine::bytesToWrite() const
     return 0;
 }
 
+#ifdef Q_OS_UNIX
+/*!
+    \internal
+
+    Makes read() receive file descriptors over a local stream socket, which
+    it then does with recvmsg() instead of read(). Descriptors received are
+    collected until takeReceivedDescriptors() is called. This has to be
+    enabled before the peer sends any, since read() discards them.
+
+    write() only uses sendmsg() while descriptors queued with
+    queueDescriptors() are waiting to be sent.
+*/
+void QNativeSocketEngine::setDescriptorPassingEnabled(bool enable)
+{
+    Q_D(QNativeSocketEngine);
+    d->descriptorPassing = enable;
+}
+
+/*!
+    \internal
+
+    Queues \a descriptors to be sent with the byte that follows the next
+    \a bytesAhead bytes written, which the caller still has buffered. The
+    engine takes ownership of \a descriptors and closes them once they are
+    sent, or when the socket is closed.
+*/
+void QNativeSocketEngine::queueDescriptors(const QList<int> &descriptors, qint64 bytesAhead)
+{
+    Q_D(QNativeSocketEngine);
+    Q_ASSERT(d->descriptorPassing);
+    // the bytes written are only counted while descriptors are pending
+    if (d->descriptorsToSend.isEmpty())
+        d->streamBytesWritten = 0;
+    Q_ASSERT(d->descriptorsToSend.isEmpty()
+             || d->descriptorsToSend.constLast().streamOffset < d->streamBytesWritten + bytesAhead);
+    d->descriptorsToSend.append({ d->streamBytesWritten + bytesAhead, descriptors });
+}
+
+/*!
+    \internal
+
+    Returns the descriptors that were received so far, in order, and passes
+    their ownership to the caller.
+*/
+QList<int> QNativeSocketEngine::takeReceivedDescriptors()
+{
+    Q_D(QNativeSocketEngine);
+    return std::exchange(d->receivedDescriptors, {});
+}
+#endif // Q_OS_UNIX
+
 /*!
     Reads up to \a maxSize bytes into \a data from the socket.
     Returns the number of bytes read, or -1 if an error occurred.
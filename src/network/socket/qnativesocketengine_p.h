@@ -170,6 +170,13 @@ public:
     bool isExceptionNotificationEnabled() const override;
     void setExceptionNotificationEnabled(bool enable) override;
 
+#ifdef Q_OS_UNIX
+    // SCM_RIGHTS on local stream sockets
+    void setDescriptorPassingEnabled(bool enable);
+    void queueDescriptors(const QList<int> &descriptors, qint64 bytesAhead);
+    QList<int> takeReceivedDescriptors();
+#endif
+
 public Q_SLOTS:
     // non-virtual override;
     void connectionNotification();
@@ -152,6 +152,22 @@ public:
 
     void nativeClose();
 
+#ifdef Q_OS_UNIX
+    struct PendingDescriptors
+    {
+        qint64 streamOffset; // of the byte they are sent with
+        QList<int> descriptors; // owned
+    };
+    QList<PendingDescriptors> descriptorsToSend;
+    QList<int> receivedDescriptors; // owned until taken
+    qint64 streamBytesWritten = 0;
+    bool descriptorPassing = false;
+
+    qint64 nativeWriteWithDescriptors(const char *data, qint64 length);
+    qint64 nativeReadWithDescriptors(char *data, qint64 maxLength, bool *descriptorsDropped);
+    void closePassedDescriptors();
+#endif
+
     bool checkProxy(const QHostAddress &address);
     bool fetchConnectionParameters();
 
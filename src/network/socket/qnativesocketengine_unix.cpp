@@ -1258,6 +1258,7 @@ void QNativeSocketEnginePrivate::nativeClose()
 #endif
 
     qt_safe_close(socketDescriptor);
+    closePassedDescriptors();
 }
 
 qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
@@ -1265,7 +1266,10 @@ qint64 QNativeSocketEnginePrivate::nativeWrite(const char *data, qint64 len)
     Q_Q(QNativeSocketEngine);
 
     ssize_t writtenBytes;
-    writtenBytes = qt_safe_write_nosignal(socketDescriptor, data, len);
+    if (!descriptorsToSend.isEmpty())
+        writtenBytes = nativeWriteWithDescriptors(data, len);
+    else
+        writtenBytes = qt_safe_write_nosignal(socketDescriptor, data, len);
 
     if (writtenBytes < 0) {
         switch (errno) {
@@ -1304,7 +1308,17 @@ qint64 QNativeSocketEnginePrivate::nativeRead(char *data, qint64 maxSize)
     }
 
     ssize_t r = 0;
-    r = qt_safe_read(socketDescriptor, data, maxSize);
+    if (descriptorPassing) {
+        bool descriptorsDropped = false;
+        r = nativeReadWithDescriptors(data, maxSize, &descriptorsDropped);
+        if (descriptorsDropped) {
+            // the descriptors we got no longer line up with the stream
+            setError(QAbstractSocket::SocketResourceError, ResourceErrorString);
+            return -1;
+        }
+    } else {
+        r = qt_safe_read(socketDescriptor, data, maxSize);
+    }
 
     if (r < 0) {
         r = -1;
@@ -1344,6 +1358,121 @@ qint64 QNativeSocketEnginePrivate::nativeRead(char *data, qint64 maxSize)
     return qint64(r);
 }
 
+// The descriptors are sent along with the byte at their stream offset, so
+// they can't be sent before the data written ahead of them, and a write
+// never spans two sets of them.
+qint64 QNativeSocketEnginePrivate::nativeWriteWithDescriptors(const char *data, qint64 len)
+{
+    const PendingDescriptors *attached = nullptr;
+    for (const PendingDescriptors &pending : std::as_const(descriptorsToSend)) {
+        if (pending.streamOffset > streamBytesWritten) {
+            len = qMin(len, pending.streamOffset - streamBytesWritten);
+            break;
+        }
+        attached = &pending;
+    }
+
+    ssize_t writtenBytes;
+    if (!attached) {
+        writtenBytes = qt_safe_write_nosignal(socketDescriptor, data, len);
+    } else {
+        const qsizetype payloadSize = attached->descriptors.size() * sizeof(int);
+        QVarLengthArray<char, CMSG_SPACE(16 * sizeof(int))> cbuf(CMSG_SPACE(payloadSize));
+        memset(cbuf.data(), 0, cbuf.size());
+
+        iovec vec;
+        vec.iov_base = const_cast<char *>(data);
+        vec.iov_len = len;
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &vec;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf.data();
+        msg.msg_controllen = cbuf.size();
+
+        cmsghdr *cmsgptr = CMSG_FIRSTHDR(&msg);
+        cmsgptr->cmsg_level = SOL_SOCKET;
+        cmsgptr->cmsg_type = SCM_RIGHTS;
+        cmsgptr->cmsg_len = CMSG_LEN(payloadSize);
+        memcpy(CMSG_DATA(cmsgptr), attached->descriptors.constData(), payloadSize);
+
+        writtenBytes = qt_safe_sendmsg(socketDescriptor, &msg, 0);
+        if (writtenBytes > 0) {
+            // the peer has its own copies now
+            for (int fd : attached->descriptors)
+                qt_safe_close(fd);
+            descriptorsToSend.removeFirst();
+        }
+    }
+
+    if (writtenBytes > 0)
+        streamBytesWritten += writtenBytes;
+    return writtenBytes;
+}
+
+// Sets *descriptorsDropped if the kernel discarded descriptors that were sent
+// with the data read, because they didn't fit into the control buffer or the
+// process has no room for more open files.
+qint64 QNativeSocketEnginePrivate::nativeReadWithDescriptors(char *data, qint64 maxSize,
+                                                            bool *descriptorsDropped)
+{
+    // SCM_MAX_FD on Linux
+    constexpr int MaxDescriptors = 253;
+    union {
+        cmsghdr align;
+        char buffer[CMSG_SPACE(MaxDescriptors * sizeof(int))];
+    } cbuf;
+
+    iovec vec;
+    vec.iov_base = data;
+    vec.iov_len = maxSize;
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &vec;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf.buffer;
+    msg.msg_controllen = sizeof(cbuf.buffer);
+
+    int flags = 0;
+#ifdef MSG_CMSG_CLOEXEC
+    flags |= MSG_CMSG_CLOEXEC;
+#endif
+    const ssize_t r = qt_safe_recvmsg(socketDescriptor, &msg, flags);
+    if (r < 0)
+        return r;
+
+    for (cmsghdr *cmsgptr = CMSG_FIRSTHDR(&msg); cmsgptr != nullptr;
+         cmsgptr = CMSG_NXTHDR(&msg, cmsgptr)) {
+        if (cmsgptr->cmsg_level != SOL_SOCKET || cmsgptr->cmsg_type != SCM_RIGHTS)
+            continue;
+        const qsizetype count = (cmsgptr->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const uchar *fds = CMSG_DATA(cmsgptr);
+        for (qsizetype i = 0; i < count; ++i) {
+            int fd;
+            memcpy(&fd, fds + i * sizeof(int), sizeof(int));
+#ifndef MSG_CMSG_CLOEXEC
+            ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#endif
+            receivedDescriptors.append(fd);
+        }
+    }
+    *descriptorsDropped = msg.msg_flags & MSG_CTRUNC;
+    return r;
+}
+
+void QNativeSocketEnginePrivate::closePassedDescriptors()
+{
+    for (const PendingDescriptors &pending : std::as_const(descriptorsToSend)) {
+        for (int fd : pending.descriptors)
+            qt_safe_close(fd);
+    }
+    descriptorsToSend.clear();
+    for (int fd : std::as_const(receivedDescriptors))
+        qt_safe_close(fd);
+    receivedDescriptors.clear();
+    streamBytesWritten = 0;
+}
+
 int QNativeSocketEnginePrivate::nativeSelect(QDeadlineTimer deadline, bool selectForRead) const
 {
     bool dummy;
@@ -0,0 +1,638 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qdtlsserver_p.h"
+#include "qdtlsserver.h"
+
+#include "qsslpresharedkeyauthenticator.h"
+#include "qnetworkdatagram.h"
+
+/*!
+    \class QDtlsServer
+    \brief The QDtlsServer class serves DTLS sessions with many peers on a single UDP socket.
+    \since 6.8
+
+    \ingroup network
+    \ingroup ssl
+    \inmodule QtNetwork
+
+    QDtls protects the datagrams exchanged with one peer, and QDtlsClientVerifier
+    protects a server from Denial-of-Service attacks that use forged client hello
+    messages. A DTLS server that talks to many peers on one port has to combine
+    them: it reads the datagrams from its QUdpSocket, looks up the QDtls that
+    belongs to the datagram's sender, and verifies the cookie of any sender it
+    does not know yet. QDtlsServer does this for you.
+
+    QDtlsServer owns its QUdpSocket, which is bound by listen(). When a datagram
+    arrives from an unknown peer, the server verifies its cookie (if
+    QSslConfiguration::dtlsCookieVerificationEnabled() is set in the
+    dtlsConfiguration(), the default), and then starts a session with the peer.
+    No state is kept for a peer until it has passed cookie verification.
+    Handshake messages, including their retransmission, are handled by the
+    server, which emits newSession() once the handshake with a peer is
+    complete.
+
+    Incoming datagrams are processed in batches of up to readBatchSize(): the
+    application data that the datagrams of a batch carry is delivered, decrypted,
+    by a single datagramsReceived() signal. Each QNetworkDatagram in the list has
+    the peer's address and port as its sender. Use writeDatagram() to send
+    a datagram to a peer, encrypted with the peer's session.
+
+    \snippet code/src_network_ssl_qdtlsserver.cpp 0
+
+    A session is closed when the peer sends a shutdown alert, when the server
+    closes it with closeSession(), or, if idleTimeout() is set, when nothing
+    has been received from the peer for about that long. The server emits
+    sessionClosed() unless it was closed by closeSession(). The number of
+    sessions can be limited with setMaximumSessionCount(), in which case client
+    hello messages from new peers are dropped while the limit is reached.
+
+    \note A session keeps no more state than the QDtls object it uses, which is
+    owned by the server. session() gives access to it, but it must not be used
+    to read or write datagrams, nor be deleted.
+
+    \sa QDtls, QDtlsClientVerifier, QSslServer
+*/
+
+/*!
+    \fn void QDtlsServer::newSession(const QHostAddress &address, quint16 port)
+
+    This signal is emitted when the handshake with the peer at \a address and
+    \a port is complete, and the server can exchange datagrams with it.
+
+    \sa sessionClosed(), session()
+*/
+
+/*!
+    \fn void QDtlsServer::datagramsReceived(const QList<QNetworkDatagram> &datagrams)
+
+    This signal is emitted once for each batch of incoming datagrams that
+    contained application data. \a datagrams holds the decrypted data, with
+    the peer's address and port as their sender.
+
+    \sa readBatchSize(), writeDatagram()
+*/
+
+/*!
+    \fn void QDtlsServer::sessionClosed(const QHostAddress &address, quint16 port)
+
+    This signal is emitted when the session with the peer at \a address and
+    \a port was closed, either by the peer, or because it was idle for longer
+    than idleTimeout().
+
+    \sa closeSession(), newSession()
+*/
+
+/*!
+    \fn void QDtlsServer::pskRequired(const QHostAddress &address, quint16 port, QSslPreSharedKeyAuthenticator *authenticator)
+
+    This signal is emitted during the handshake with the peer at \a address and
+    \a port, when the negotiated cipher suite uses a pre-shared key. The
+    \a authenticator must be filled in from a slot connected to this signal
+    with a direct connection.
+
+    \sa QDtls::pskRequired()
+*/
+
+/*!
+    \fn void QDtlsServer::errorOccurred(const QHostAddress &address, quint16 port, QDtlsError error, const QString &errorString)
+
+    This signal is emitted when the handshake or session with the peer at
+    \a address and \a port failed with \a error, described by \a errorString.
+    Unless \a error is QDtlsError::TlsNonFatalError, the session is gone.
+*/
+
+QT_BEGIN_NAMESPACE
+
+QDtlsServerPrivate::QDtlsServerPrivate() = default;
+
+QDtlsServerPrivate::~QDtlsServerPrivate()
+{
+    for (const Session &session : std::as_const(sessions))
+        delete session.dtls;
+}
+
+void QDtlsServerPrivate::processDatagram(const QNetworkDatagram &datagram,
+                                         QList<QNetworkDatagram> *received)
+{
+    Q_Q(QDtlsServer);
+
+    const PeerKey key{datagram.senderAddress(), quint16(datagram.senderPort())};
+    if (key.address.isNull() || !key.port)
+        return;
+
+    const auto it = sessions.find(key);
+    if (it == sessions.end()) {
+        if (listening)
+            startSession(key, datagram.data());
+        return;
+    }
+
+    it->lastActivity = now;
+    QDtls *dtls = it->dtls;
+    if (!dtls->isConnectionEncrypted())
+        return continueHandshake(key, datagram.data());
+
+    QByteArray plainText = dtls->decryptDatagram(&socket, datagram.data());
+    if (!plainText.isEmpty()) {
+        QNetworkDatagram message(std::move(plainText));
+        message.setSender(key.address, key.port);
+        message.setDestination(datagram.destinationAddress(), quint16(datagram.destinationPort()));
+        received->append(std::move(message));
+        return;
+    }
+
+    switch (dtls->dtlsError()) {
+    case QDtlsError::NoError:
+        // Not application data (for instance, a retransmitted Finished message)
+        break;
+    case QDtlsError::RemoteClosedConnectionError:
+        discardSession(it);
+        emit q->sessionClosed(key.address, key.port);
+        break;
+    case QDtlsError::TlsNonFatalError:
+        emit q->errorOccurred(key.address, key.port, dtls->dtlsError(), dtls->dtlsErrorString());
+        break;
+    default:
+        failSession(it);
+        break;
+    }
+}
+
+void QDtlsServerPrivate::startSession(const PeerKey &key, const QByteArray &clientHello)
+{
+    Q_Q(QDtlsServer);
+
+    // The peer will retransmit its hello, so we might have room for it then:
+    if (maximumSessionCount > 0 && sessions.size() >= maximumSessionCount)
+        return;
+
+    if (configuration.dtlsCookieVerificationEnabled()
+        && !verifier.verifyClient(&socket, clientHello, key.address, key.port)) {
+        if (verifier.dtlsError() != QDtlsError::NoError) {
+            emit q->errorOccurred(key.address, key.port, verifier.dtlsError(),
+                                  verifier.dtlsErrorString());
+        }
+        return;
+    }
+
+    auto *dtls = new QDtls(QSslSocket::SslServerMode);
+    dtls->setDtlsConfiguration(configuration);
+    // QDtls verifies the cookie in the hello once more:
+    dtls->setCookieGeneratorParameters(verifier.cookieGeneratorParameters());
+    dtls->setPeer(key.address, key.port);
+    // Both are only needed until the handshake is complete:
+    QObject::connect(dtls, SIGNAL(handshakeTimeout()), q, SLOT(_q_handshakeTimeout()));
+    QObject::connect(dtls, SIGNAL(pskRequired(QSslPreSharedKeyAuthenticator*)),
+                     q, SLOT(_q_pskRequired(QSslPreSharedKeyAuthenticator*)));
+    sessions.insert(key, {dtls, now});
+
+    continueHandshake(key, clientHello);
+}
+
+void QDtlsServerPrivate::continueHandshake(const PeerKey &key, const QByteArray &datagram)
+{
+    Q_Q(QDtlsServer);
+
+    QDtls *dtls = sessions.value(key).dtls;
+    Q_ASSERT(dtls);
+    const bool ok = dtls->doHandshake(&socket, datagram);
+
+    // A slot connected to pskRequired() may have closed the session:
+    const auto it = sessions.find(key);
+    if (it == sessions.end() || it->dtls != dtls)
+        return;
+
+    if (!ok)
+        return failSession(it);
+
+    switch (dtls->handshakeState()) {
+    case QDtls::HandshakeComplete:
+        QObject::disconnect(dtls, nullptr, q, nullptr);
+        emit q->newSession(key.address, key.port);
+        break;
+    case QDtls::PeerVerificationFailed:
+        dtls->abortHandshake(&socket);
+        failSession(it);
+        break;
+    default:
+        break;
+    }
+}
+
+void QDtlsServerPrivate::failSession(Sessions::iterator it)
+{
+    Q_Q(QDtlsServer);
+
+    const PeerKey key = it.key();
+    const QDtlsError error = it->dtls->dtlsError();
+    const QString errorString = it->dtls->dtlsErrorString();
+    discardSession(it);
+    emit q->errorOccurred(key.address, key.port, error, errorString);
+}
+
+QDtlsServerPrivate::Sessions::iterator QDtlsServerPrivate::discardSession(Sessions::iterator it)
+{
+    Q_Q(QDtlsServer);
+
+    // We might be called from one of its signals, so it must not go away right now:
+    QObject::disconnect(it->dtls, nullptr, q, nullptr);
+    it->dtls->deleteLater();
+    return sessions.erase(it);
+}
+
+void QDtlsServerPrivate::_q_readDatagrams()
+{
+    Q_Q(QDtlsServer);
+
+    readScheduled = false;
+    now = clock.elapsed();
+
+    QList<QNetworkDatagram> received;
+    for (int i = 0; i < readBatchSize && socket.hasPendingDatagrams(); ++i) {
+        const QNetworkDatagram datagram = socket.receiveDatagram();
+        if (datagram.isValid())
+            processDatagram(datagram, &received);
+    }
+
+    if (socket.hasPendingDatagrams() && !readScheduled) {
+        // Let other events in before we process the next batch:
+        readScheduled = true;
+        QMetaObject::invokeMethod(q, "_q_readDatagrams", Qt::QueuedConnection);
+    }
+
+    if (!received.isEmpty())
+        emit q->datagramsReceived(received);
+}
+
+void QDtlsServerPrivate::_q_handshakeTimeout()
+{
+    Q_Q(QDtlsServer);
+
+    auto *dtls = qobject_cast<QDtls *>(q->sender());
+    if (!dtls)
+        return;
+
+    const auto it = sessions.find({dtls->peerAddress(), dtls->peerPort()});
+    if (it == sessions.end() || it->dtls != dtls)
+        return;
+
+    if (!dtls->handleTimeout(&socket) && dtls->dtlsError() != QDtlsError::NoError)
+        failSession(it);
+}
+
+void QDtlsServerPrivate::_q_pskRequired(QSslPreSharedKeyAuthenticator *authenticator)
+{
+    Q_Q(QDtlsServer);
+
+    if (auto *dtls = qobject_cast<QDtls *>(q->sender()))
+        emit q->pskRequired(dtls->peerAddress(), dtls->peerPort(), authenticator);
+}
+
+void QDtlsServerPrivate::_q_expireIdleSessions()
+{
+    Q_Q(QDtlsServer);
+
+    if (idleTimeout <= 0)
+        return;
+
+    now = clock.elapsed();
+    QList<PeerKey> expired;
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (now - it->lastActivity < idleTimeout) {
+            ++it;
+            continue;
+        }
+        if (it->dtls->isConnectionEncrypted())
+            it->dtls->shutdown(&socket);
+        expired.append(it.key());
+        it = discardSession(it);
+    }
+
+    for (const PeerKey &key : std::as_const(expired))
+        emit q->sessionClosed(key.address, key.port);
+}
+
+/*!
+    Constructs a QDtlsServer with the given \a parent. The server uses
+    QSslConfiguration::defaultDtlsConfiguration() until you call
+    setDtlsConfiguration().
+*/
+QDtlsServer::QDtlsServer(QObject *parent)
+    : QObject(*new QDtlsServerPrivate, parent)
+{
+    Q_D(QDtlsServer);
+
+    d->configuration = QSslConfiguration::defaultDtlsConfiguration();
+    connect(&d->socket, SIGNAL(readyRead()), this, SLOT(_q_readDatagrams()));
+    connect(&d->idleTimer, SIGNAL(timeout()), this, SLOT(_q_expireIdleSessions()));
+}
+
+/*!
+    Destroys the server, after closing it.
+
+    \sa close()
+*/
+QDtlsServer::~QDtlsServer()
+{
+    close();
+}
+
+/*!
+    Binds the server's socket to \a address and \a port, and starts accepting
+    new sessions. If \a port is 0, a port is chosen automatically. Returns
+    \c true on success; otherwise returns \c false, and socket() has the
+    details of the error.
+
+    \sa serverAddress(), serverPort(), close()
+*/
+bool QDtlsServer::listen(const QHostAddress &address, quint16 port)
+{
+    Q_D(QDtlsServer);
+
+    close();
+    if (!d->socket.bind(address, port))
+        return false;
+
+    d->listening = true;
+    d->clock.start();
+    if (d->idleTimeout > 0)
+        d->idleTimer.start(qMax(d->idleTimeout / 2, 1));
+    return true;
+}
+
+/*!
+    Returns \c true if the server is listening for new sessions.
+
+    \sa listen()
+*/
+bool QDtlsServer::isListening() const
+{
+    Q_D(const QDtlsServer);
+    return d->listening;
+}
+
+/*!
+    Sends a shutdown alert to all peers the server has a session with, discards
+    the sessions and closes the socket. sessionClosed() is not emitted.
+
+    \sa listen(), closeSession()
+*/
+void QDtlsServer::close()
+{
+    Q_D(QDtlsServer);
+
+    d->listening = false;
+    d->idleTimer.stop();
+    for (auto it = d->sessions.begin(); it != d->sessions.end();) {
+        if (it->dtls->isConnectionEncrypted())
+            it->dtls->shutdown(&d->socket);
+        it = d->discardSession(it);
+    }
+    d->socket.close();
+}
+
+/*!
+    Returns the address the server's socket is bound to.
+
+    \sa serverPort(), listen()
+*/
+QHostAddress QDtlsServer::serverAddress() const
+{
+    Q_D(const QDtlsServer);
+    return d->socket.localAddress();
+}
+
+/*!
+    Returns the port the server's socket is bound to.
+
+    \sa serverAddress(), listen()
+*/
+quint16 QDtlsServer::serverPort() const
+{
+    Q_D(const QDtlsServer);
+    return d->socket.localPort();
+}
+
+/*!
+    Returns the server's socket, for instance to set its receive buffer size.
+    Do not read from or write to it.
+*/
+QUdpSocket *QDtlsServer::socket() const
+{
+    Q_D(const QDtlsServer);
+    return const_cast<QUdpSocket *>(&d->socket);
+}
+
+/*!
+    Sets the DTLS configuration for new sessions to \a configuration.
+    Sessions that already exist keep the configuration they started with.
+
+    \sa dtlsConfiguration(), QDtls::setDtlsConfiguration()
+*/
+void QDtlsServer::setDtlsConfiguration(const QSslConfiguration &configuration)
+{
+    Q_D(QDtlsServer);
+    d->configuration = configuration;
+}
+
+/*!
+    Returns the DTLS configuration for new sessions.
+
+    \sa setDtlsConfiguration()
+*/
+QSslConfiguration QDtlsServer::dtlsConfiguration() const
+{
+    Q_D(const QDtlsServer);
+    return d->configuration;
+}
+
+/*!
+    Sets the secret and the cryptographic hash algorithm from \a params that
+    the server uses to generate and verify cookies. Returns \c true on success.
+
+    \sa QDtlsClientVerifier::setCookieGeneratorParameters()
+*/
+bool QDtlsServer::setCookieGeneratorParameters(const GeneratorParameters &params)
+{
+    Q_D(QDtlsServer);
+    return d->verifier.setCookieGeneratorParameters(params);
+}
+
+/*!
+    Returns the parameters that the server uses to generate and verify cookies.
+
+    \sa setCookieGeneratorParameters()
+*/
+QDtlsServer::GeneratorParameters QDtlsServer::cookieGeneratorParameters() const
+{
+    Q_D(const QDtlsServer);
+    return d->verifier.cookieGeneratorParameters();
+}
+
+/*!
+    Sets the maximum number of sessions, including the ones whose handshake
+    is in progress, to \a count. 0, the default, means there is no limit.
+
+    \sa maximumSessionCount(), sessionCount()
+*/
+void QDtlsServer::setMaximumSessionCount(qsizetype count)
+{
+    Q_D(QDtlsServer);
+    d->maximumSessionCount = qMax(count, qsizetype(0));
+}
+
+/*!
+    Returns the maximum number of sessions, 0 if there is no limit.
+
+    \sa setMaximumSessionCount()
+*/
+qsizetype QDtlsServer::maximumSessionCount() const
+{
+    Q_D(const QDtlsServer);
+    return d->maximumSessionCount;
+}
+
+/*!
+    Sets the time, in milliseconds, after which a session is closed if
+    nothing was received from its peer, to \a msecs. Sessions are checked
+    every \a msecs / 2 milliseconds. 0, the default, means sessions are never
+    closed for being idle.
+
+    \sa idleTimeout(), sessionClosed()
+*/
+void QDtlsServer::setIdleTimeout(int msecs)
+{
+    Q_D(QDtlsServer);
+
+    d->idleTimeout = qMax(msecs, 0);
+    if (d->idleTimeout > 0 && d->listening)
+        d->idleTimer.start(qMax(d->idleTimeout / 2, 1));
+    else
+        d->idleTimer.stop();
+}
+
+/*!
+    Returns the time, in milliseconds, after which an idle session is closed,
+    0 if idle sessions are kept.
+
+    \sa setIdleTimeout()
+*/
+int QDtlsServer::idleTimeout() const
+{
+    Q_D(const QDtlsServer);
+    return d->idleTimeout;
+}
+
+/*!
+    Sets the maximum number of datagrams processed before the server returns
+    to the event loop, and emits datagramsReceived(), to \a count. The default
+    is 64.
+
+    \sa readBatchSize(), datagramsReceived()
+*/
+void QDtlsServer::setReadBatchSize(int count)
+{
+    Q_D(QDtlsServer);
+    d->readBatchSize = qMax(count, 1);
+}
+
+/*!
+    Returns the maximum number of datagrams processed in one batch.
+
+    \sa setReadBatchSize()
+*/
+int QDtlsServer::readBatchSize() const
+{
+    Q_D(const QDtlsServer);
+    return d->readBatchSize;
+}
+
+/*!
+    Returns the number of sessions, including the ones whose handshake
+    is in progress.
+*/
+qsizetype QDtlsServer::sessionCount() const
+{
+    Q_D(const QDtlsServer);
+    return d->sessions.size();
+}
+
+/*!
+    Returns \c true if the server has a session with the peer at \a address
+    and \a port, whether its handshake is complete or not.
+
+    \sa session()
+*/
+bool QDtlsServer::hasSession(const QHostAddress &address, quint16 port) const
+{
+    Q_D(const QDtlsServer);
+    return d->sessions.contains({address, port});
+}
+
+/*!
+    Returns the QDtls object of the session with the peer at \a address and
+    \a port, or \nullptr if there is no such session. Use it to query the
+    session's state, cipher or protocol; the object is owned by the server.
+
+    \sa hasSession()
+*/
+QDtls *QDtlsServer::session(const QHostAddress &address, quint16 port) const
+{
+    Q_D(const QDtlsServer);
+    return d->sessions.value({address, port}).dtls;
+}
+
+/*!
+    Encrypts \a datagram and sends it to the peer at \a address and \a port.
+    Returns the number of bytes written, or -1 if there is no session with
+    the peer whose handshake is complete, or on error.
+
+    \sa datagramsReceived(), QDtls::writeDatagramEncrypted()
+*/
+qint64 QDtlsServer::writeDatagram(const QByteArray &datagram, const QHostAddress &address,
+                                  quint16 port)
+{
+    Q_D(QDtlsServer);
+
+    QDtls *dtls = d->sessions.value({address, port}).dtls;
+    if (!dtls || !dtls->isConnectionEncrypted())
+        return -1;
+    return dtls->writeDatagramEncrypted(&d->socket, datagram);
+}
+
+/*!
+    \overload
+
+    Sends the data of \a datagram to its destination address and port.
+*/
+qint64 QDtlsServer::writeDatagram(const QNetworkDatagram &datagram)
+{
+    return writeDatagram(datagram.data(), datagram.destinationAddress(),
+                         quint16(datagram.destinationPort()));
+}
+
+/*!
+    Sends a shutdown alert to the peer at \a address and \a port, if the
+    handshake with it is complete, and discards the session. Returns \c false
+    if there is no session with the peer.
+
+    \sa close(), sessionClosed()
+*/
+bool QDtlsServer::closeSession(const QHostAddress &address, quint16 port)
+{
+    Q_D(QDtlsServer);
+
+    const auto it = d->sessions.find({address, port});
+    if (it == d->sessions.end())
+        return false;
+
+    if (it->dtls->isConnectionEncrypted())
+        it->dtls->shutdown(&d->socket);
+    d->discardSession(it);
+    return true;
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qdtlsserver.cpp"
@@ -0,0 +1,89 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QDTLSSERVER_H
+#define QDTLSSERVER_H
+
+#include <QtNetwork/qtnetworkglobal.h>
+
+#include <QtNetwork/qdtls.h>
+#include <QtNetwork/qhostaddress.h>
+#include <QtNetwork/qnetworkdatagram.h>
+
+#include <QtCore/qobject.h>
+#include <QtCore/qlist.h>
+
+Q_MOC_INCLUDE(<QtNetwork/QSslPreSharedKeyAuthenticator>)
+
+#ifndef Q_QDOC
+QT_REQUIRE_CONFIG(dtls);
+#endif
+
+QT_BEGIN_NAMESPACE
+
+class QSslConfiguration;
+class QSslPreSharedKeyAuthenticator;
+
+class QDtlsServerPrivate;
+class Q_NETWORK_EXPORT QDtlsServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QDtlsServer(QObject *parent = nullptr);
+    ~QDtlsServer() override;
+
+    bool listen(const QHostAddress &address = QHostAddress::Any, quint16 port = 0);
+    bool isListening() const;
+    void close();
+
+    QHostAddress serverAddress() const;
+    quint16 serverPort() const;
+    QUdpSocket *socket() const;
+
+    void setDtlsConfiguration(const QSslConfiguration &configuration);
+    QSslConfiguration dtlsConfiguration() const;
+
+    using GeneratorParameters = QDtlsClientVerifier::GeneratorParameters;
+    bool setCookieGeneratorParameters(const GeneratorParameters &params);
+    GeneratorParameters cookieGeneratorParameters() const;
+
+    void setMaximumSessionCount(qsizetype count);
+    qsizetype maximumSessionCount() const;
+
+    void setIdleTimeout(int msecs);
+    int idleTimeout() const;
+
+    void setReadBatchSize(int count);
+    int readBatchSize() const;
+
+    qsizetype sessionCount() const;
+    bool hasSession(const QHostAddress &address, quint16 port) const;
+    QDtls *session(const QHostAddress &address, quint16 port) const;
+
+    qint64 writeDatagram(const QByteArray &datagram, const QHostAddress &address, quint16 port);
+    qint64 writeDatagram(const QNetworkDatagram &datagram);
+    bool closeSession(const QHostAddress &address, quint16 port);
+
+Q_SIGNALS:
+    void newSession(const QHostAddress &address, quint16 port);
+    void datagramsReceived(const QList<QNetworkDatagram> &datagrams);
+    void sessionClosed(const QHostAddress &address, quint16 port);
+    void pskRequired(const QHostAddress &address, quint16 port,
+                     QSslPreSharedKeyAuthenticator *authenticator);
+    void errorOccurred(const QHostAddress &address, quint16 port, QDtlsError error,
+                       const QString &errorString);
+
+private:
+    Q_DECLARE_PRIVATE(QDtlsServer)
+    Q_DISABLE_COPY_MOVE(QDtlsServer)
+
+    Q_PRIVATE_SLOT(d_func(), void _q_readDatagrams())
+    Q_PRIVATE_SLOT(d_func(), void _q_handshakeTimeout())
+    Q_PRIVATE_SLOT(d_func(), void _q_pskRequired(QSslPreSharedKeyAuthenticator *))
+    Q_PRIVATE_SLOT(d_func(), void _q_expireIdleSessions())
+};
+
+QT_END_NAMESPACE
+
+#endif // QDTLSSERVER_H
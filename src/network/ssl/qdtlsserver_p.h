@@ -0,0 +1,95 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QDTLSSERVER_P_H
+#define QDTLSSERVER_P_H
+
+#include <private/qtnetworkglobal_p.h>
+
+#include "qdtlsserver.h"
+
+#include <QtNetwork/qsslconfiguration.h>
+#include <QtNetwork/qudpsocket.h>
+
+#include <QtCore/private/qobject_p.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qtimer.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_REQUIRE_CONFIG(dtls);
+
+QT_BEGIN_NAMESPACE
+
+class QDtlsServerPrivate : public QObjectPrivate
+{
+public:
+    Q_DECLARE_PUBLIC(QDtlsServer)
+
+    QDtlsServerPrivate();
+    ~QDtlsServerPrivate();
+
+    struct PeerKey
+    {
+        QHostAddress address;
+        quint16 port = 0;
+
+        friend bool operator==(const PeerKey &lhs, const PeerKey &rhs) noexcept
+        { return lhs.port == rhs.port && lhs.address == rhs.address; }
+        friend size_t qHash(const PeerKey &key, size_t seed = 0) noexcept
+        { return qHashMulti(seed, key.address, key.port); }
+    };
+
+    // The socket, configuration and cookie verifier are shared by all
+    // sessions, so all a session needs is its QDtls, which it owns, and the
+    // time we last heard from the peer. Sessions only exist for peers that
+    // have passed cookie verification.
+    struct Session
+    {
+        QDtls *dtls = nullptr;
+        qint64 lastActivity = 0;
+    };
+    using Sessions = QHash<PeerKey, Session>;
+
+    void processDatagram(const QNetworkDatagram &datagram, QList<QNetworkDatagram> *received);
+    void startSession(const PeerKey &key, const QByteArray &clientHello);
+    void continueHandshake(const PeerKey &key, const QByteArray &datagram);
+    void failSession(Sessions::iterator it);
+    Sessions::iterator discardSession(Sessions::iterator it);
+
+    // private slots
+    void _q_readDatagrams();
+    void _q_handshakeTimeout();
+    void _q_pskRequired(QSslPreSharedKeyAuthenticator *authenticator);
+    void _q_expireIdleSessions();
+
+    QUdpSocket socket;
+    QDtlsClientVerifier verifier;
+    QSslConfiguration configuration;
+    Sessions sessions;
+
+    QElapsedTimer clock;
+    // clock.elapsed() for the batch of datagrams we are processing:
+    qint64 now = 0;
+    QTimer idleTimer;
+
+    qsizetype maximumSessionCount = 0;
+    int idleTimeout = 0;
+    int readBatchSize = 64;
+    bool listening = false;
+    bool readScheduled = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QDTLSSERVER_P_H
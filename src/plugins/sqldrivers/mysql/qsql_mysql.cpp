@@ -149,6 +149,9 @@ protected:
 
     bool prepare(const QString &stmt) override;
     bool exec() override;
+
+private:
+    void fetchColumns(QSqlFetchColumnsData *request);
 };
 
 class QMYSQLResultPrivate: public QSqlResultPrivate
@@ -829,7 +832,67 @@ bool QMYSQLResult::nextResult()
 
 void QMYSQLResult::virtual_hook(int id, void *data)
 {
-    QSqlResult::virtual_hook(id, data);
+    switch (id) {
+    case FetchColumnsOperation:
+        fetchColumns(static_cast<QSqlFetchColumnsData *>(data));
+        break;
+    default:
+        QSqlResult::virtual_hook(id, data);
+    }
+}
+
+// Decodes the rows of a query that is not prepared straight from the
+// MYSQL_ROW, without a QVariant per value as far as the column buffers'
+// types allow. The values of a prepared query are decoded by data().
+void QMYSQLResult::fetchColumns(QSqlFetchColumnsData *request)
+{
+    Q_D(QMYSQLResult);
+    request->handled = true;
+    QList<QSqlColumnBuffer> &columns = *request->columns;
+    while (request->rowsFetched < request->maxRows) {
+        const bool fetched = at() == QSql::BeforeFirstRow ? fetchFirst() : fetchNext();
+        if (!fetched)
+            return;
+        const unsigned long *lengths = d->preparedQuery ? nullptr
+                                                        : mysql_fetch_lengths(d->result);
+        for (int i = 0; i < columns.size(); ++i) {
+            QSqlColumnBuffer &column = columns[i];
+            const QMYSQLResultPrivate::QMyField &f = d->fields.at(i);
+            if (d->preparedQuery || column.type() == QSqlColumnBuffer::Type::Variant
+                || qIsBitfield(f.myField->type)) {
+                column.appendVariant(data(i));
+                continue;
+            }
+            if (d->row[i] == nullptr) {
+                column.appendNull();
+                continue;
+            }
+            const QByteArrayView text(d->row[i], qsizetype(lengths[i]));
+            switch (column.type()) {
+            case QSqlColumnBuffer::Type::Integer:
+                if (f.type.id() == QMetaType::Double)
+                    column.appendInteger(qRound64(text.toDouble()));
+                else
+                    column.appendInteger(text.toLongLong());
+                break;
+            case QSqlColumnBuffer::Type::Double: {
+                bool ok = false;
+                const double dbl = text.toDouble(&ok);
+                if (ok)
+                    column.appendDouble(dbl);
+                else
+                    column.appendNull();
+                break;
+            }
+            case QSqlColumnBuffer::Type::String:
+                column.appendString(QString::fromUtf8(text));
+                break;
+            case QSqlColumnBuffer::Type::Variant:
+                Q_UNREACHABLE();
+            }
+        }
+        ++request->rowsFetched;
+    }
 }
 
 static QT_MYSQL_TIME *toMySqlDate(QDate date, QTime time, int type)
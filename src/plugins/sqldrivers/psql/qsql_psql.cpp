@@ -15,11 +15,16 @@
 #include <qsocketnotifier.h>
 #include <qstringlist.h>
 #include <qlocale.h>
+#include <qtimezone.h>
+#include <qendian.h>
+#include <qvarlengtharray.h>
 #include <QtSql/private/qsqlresult_p.h>
 #include <QtSql/private/qsqldriver_p.h>
 #include <QtCore/private/qlocale_tools_p.h>
 
+#include <algorithm>
 #include <queue>
+#include <vector>
 
 #include <libpq-fe.h>
 #include <pg_config.h>
@@ -28,9 +33,11 @@
 
 // workaround for postgres defining their OIDs in a private header file
 #define QBOOLOID 16
+#define QNAMEOID 19
 #define QINT8OID 20
 #define QINT2OID 21
 #define QINT4OID 23
+#define QTEXTOID 25
 #define QNUMERICOID 1700
 #define QFLOAT4OID 700
 #define QFLOAT8OID 701
@@ -49,6 +56,8 @@
 
 #define QBITOID 1560
 #define QVARBITOID 1562
+#define QBPCHAROID 1042
+#define QVARCHAROID 1043
 
 #define VARHDRSZ 4
 
@@ -80,6 +89,18 @@ static constexpr int PGRES_SINGLE_TUPLE = 9;
 typedef int StatementId;
 static constexpr StatementId InvalidStatementId = 0;
 
+// Parameters of a prepared statement, as passed to PQsendQueryPrepared()
+struct QPSQLParams
+{
+    std::vector<QByteArray> buffers;
+    QVarLengthArray<const char *> values;
+    QVarLengthArray<int> lengths;
+    QVarLengthArray<int> formats;
+};
+
+// Rows of an execBatch() sent before we wait for their results
+static constexpr qsizetype PipelineChunkSize = 256;
+
 class QPSQLResultPrivate;
 
 class QPSQLResult final : public QSqlResult
@@ -109,6 +130,10 @@ protected:
     QVariant lastInsertId() const override;
     bool prepare(const QString &query) override;
     bool exec() override;
+    bool execBatch(bool arrayBind) override;
+
+private:
+    void fetchColumns(QSqlFetchColumnsData *request);
 };
 
 class QPSQLDriverPrivate final : public QSqlDriverPrivate
@@ -125,11 +150,15 @@ public:
     StatementId stmtCount = InvalidStatementId;
     mutable bool pendingNotifyCheck = false;
     bool hasBackslashEscape = false;
+    bool integerDatetimes = false;
 
     void appendTables(QStringList &tl, QSqlQuery &t, QChar type);
     PGresult *exec(const char *stmt);
     PGresult *exec(const QString &stmt);
     StatementId sendQuery(const QString &stmt);
+    StatementId sendQueryPrepared(const QByteArray &stmtName, const QPSQLParams &params,
+                                  bool binaryResults);
+    PGresult *describePrepared(const QByteArray &stmtName);
     bool setSingleRowMode() const;
     PGresult *getResult(StatementId stmtId) const;
     void finishQuery(StatementId stmtId);
@@ -141,6 +170,7 @@ public:
     void setDatestyle();
     void setByteaOutput();
     void detectBackslashEscape();
+    void detectIntegerDatetimes();
     mutable QHash<int, QString> oidToTable;
 };
 
@@ -187,6 +217,26 @@ StatementId QPSQLDriverPrivate::sendQuery(const QString &stmt)
     return currentStmtId;
 }
 
+StatementId QPSQLDriverPrivate::sendQueryPrepared(const QByteArray &stmtName,
+                                                  const QPSQLParams &params, bool binaryResults)
+{
+    discardResults();
+    const int result = PQsendQueryPrepared(connection, stmtName.constData(),
+                                           int(params.values.size()), params.values.constData(),
+                                           params.lengths.constData(), params.formats.constData(),
+                                           binaryResults ? 1 : 0);
+    currentStmtId = result ? generateStatementId() : InvalidStatementId;
+    return currentStmtId;
+}
+
+PGresult *QPSQLDriverPrivate::describePrepared(const QByteArray &stmtName)
+{
+    PGresult *result = PQdescribePrepared(connection, stmtName.constData());
+    currentStmtId = result ? generateStatementId() : InvalidStatementId;
+    checkPendingNotifications();
+    return result;
+}
+
 bool QPSQLDriverPrivate::setSingleRowMode() const
 {
     // Activates single-row mode for last sent query, see:
@@ -256,14 +306,28 @@ public:
 
     QString fieldSerial(qsizetype i) const override { return QString("$%1"_L1).arg(i + 1); }
     void deallocatePreparedStmt();
+    void describePreparedStmt();
+    bool bindParams(const QList<QVariant> &values, QPSQLParams *params) const;
+    bool execCopy(const QList<QVariant> &values, bool batch);
+#if defined(LIBPQ_HAS_PIPELINING)
+    bool execPipelined(const std::vector<QPSQLParams> &batch);
+#endif
 
     std::queue<PGresult*> nextResultSets;
     QString preparedStmtId;
+    // COPY ... FROM STDIN statement, which cannot be prepared on the server
+    QString copyStatement;
+    // Parameter types of the prepared statement, as described by the server
+    QList<Oid> paramTypes;
     PGresult *result = nullptr;
     StatementId stmtId = InvalidStatementId;
     int currentSize = -1;
     bool canFetchMoreRows = false;
     bool preparedQueriesEnabled = false;
+    bool preparedStmtDescribed = false;
+    // All columns of the prepared statement's result can be decoded from
+    // the binary format
+    bool binaryResults = false;
 
     bool processResults();
 };
@@ -374,6 +438,165 @@ static QMetaType qDecodePSQLType(int t)
     return QMetaType(type);
 }
 
+// Types whose binary representation data() can decode. We can only ask libpq
+// for binary results for all columns or none, so a statement gets them if all
+// of its columns are of one of these types.
+static bool qIsBinaryDecodable(Oid type)
+{
+    switch (type) {
+    case QBOOLOID:
+    case QINT2OID:
+    case QINT4OID:
+    case QINT8OID:
+    case QFLOAT8OID:
+    case QNUMERICOID:
+    case QDATEOID:
+    case QTIMEOID:
+    case QTIMESTAMPOID:
+    case QTIMESTAMPTZOID:
+    case QBYTEAOID:
+    case QTEXTOID:
+    case QVARCHAROID:
+    case QBPCHAROID:
+    case QNAMEOID:
+        return true;
+    default:
+        // float4 is left out on purpose: its text form is the shortest one
+        // that round-trips as a float, which is not what converting the
+        // binary float to double gives.
+        return false;
+    }
+}
+
+// Converts a NUMERIC in binary format into its text format, which data()
+// then handles the same way as for text results.
+static QByteArray qNumericToText(const char *data, int length)
+{
+    // Four int16: number of base 10000 digits, weight of the first digit,
+    // sign, and number of decimal digits after the point; then the digits.
+    if (length < 8)
+        return QByteArray();
+    const int ndigits = qFromBigEndian<qint16>(data);
+    const int weight = qFromBigEndian<qint16>(data + 2);
+    const quint16 sign = qFromBigEndian<quint16>(data + 4);
+    const int dscale = qFromBigEndian<qint16>(data + 6);
+    switch (sign) {
+    case 0xC000:
+        return QByteArrayLiteral("NaN");
+    case 0xD000:
+        return QByteArrayLiteral("Infinity");
+    case 0xF000:
+        return QByteArrayLiteral("-Infinity");
+    default:
+        break;
+    }
+    if (ndigits < 0 || length < 8 + 2 * ndigits)
+        return QByteArray();
+
+    const auto digit = [&](int i) {
+        return i >= 0 && i < ndigits ? int(qFromBigEndian<qint16>(data + 8 + 2 * i)) : 0;
+    };
+    const auto appendDigitGroup = [](QByteArray &out, int group) {
+        char buffer[4];
+        for (int i = 3; i >= 0; --i, group /= 10)
+            buffer[i] = char('0' + group % 10);
+        out.append(buffer, 4);
+    };
+
+    QByteArray text;
+    if (sign == 0x4000)
+        text += '-';
+    if (weight < 0) {
+        text += '0';
+    } else {
+        text += QByteArray::number(digit(0));
+        for (int i = 1; i <= weight; ++i)
+            appendDigitGroup(text, digit(i));
+    }
+    if (dscale > 0) {
+        text += '.';
+        const qsizetype fractionStart = text.size();
+        for (int i = weight + 1; text.size() - fractionStart < dscale; ++i)
+            appendDigitGroup(text, digit(i));
+        text.truncate(fractionStart + dscale);
+    }
+    return text;
+}
+
+// Decodes a value in binary format; numeric values are handled by the caller.
+static QVariant qBinaryValue(int ptype, const char *val, int length)
+{
+    // date and timestamp values count from here, and use the extreme values
+    // for -infinity and infinity:
+    const QDate postgresEpoch(2000, 1, 1);
+    constexpr qint64 usecsPerDay = Q_INT64_C(86400000000);
+    constexpr qint64 msecsPerDay = usecsPerDay / 1000;
+
+    switch (ptype) {
+    case QBOOLOID:
+        return QVariant(length == 1 && val[0] != 0);
+    case QINT2OID:
+        return int(qFromBigEndian<qint16>(val));
+    case QINT4OID:
+        return int(qFromBigEndian<qint32>(val));
+    case QINT8OID: {
+        // Same as for text results
+        const qint64 value = qFromBigEndian<qint64>(val);
+        if (value < 0)
+            return qlonglong(value);
+        return qulonglong(value);
+    }
+    case QFLOAT8OID:
+        return qFromBigEndian<double>(val);
+    case QDATEOID: {
+        const qint32 days = qFromBigEndian<qint32>(val);
+        if (days == std::numeric_limits<qint32>::min() || days == std::numeric_limits<qint32>::max())
+            return QDate();
+        return postgresEpoch.addDays(days);
+    }
+    case QTIMEOID: {
+        // Rounded to the nearest millisecond, like QTime::fromString() does
+        // with the text; that doesn't round past the end of the day, either.
+        const qint64 usecs = qFromBigEndian<qint64>(val);
+        qint64 msecs = (usecs + 500) / 1000;
+        if (usecs < usecsPerDay)
+            msecs = qMin(msecs, msecsPerDay - 1);
+        return QTime::fromMSecsSinceStartOfDay(int(msecs));
+    }
+    case QTIMESTAMPOID:
+    case QTIMESTAMPTZOID: {
+        const qint64 usecs = qFromBigEndian<qint64>(val);
+        if (usecs == std::numeric_limits<qint64>::min() || usecs == std::numeric_limits<qint64>::max())
+            return QDateTime();
+        // Round towards minus infinity, so that the time of day is positive
+        qint64 days = usecs / usecsPerDay;
+        qint64 usecsOfDay = usecs % usecsPerDay;
+        if (usecsOfDay < 0) {
+            --days;
+            usecsOfDay += usecsPerDay;
+        }
+        // Rounded to the nearest millisecond, like QDateTime::fromString()
+        // does with the text, carrying into the next day
+        qint64 msecsOfDay = (usecsOfDay + 500) / 1000;
+        if (msecsOfDay == msecsPerDay) {
+            ++days;
+            msecsOfDay = 0;
+        }
+        const QDate date = postgresEpoch.addDays(days);
+        const QTime time = QTime::fromMSecsSinceStartOfDay(int(msecsOfDay));
+        // A timestamp with time zone is in UTC; one without is a local time,
+        // which is what parsing its text gives, too.
+        if (ptype == QTIMESTAMPTZOID)
+            return QDateTime(date, time, QTimeZone::UTC).toLocalTime();
+        return QDateTime(date, time);
+    }
+    case QBYTEAOID:
+        return QByteArray(val, length);
+    default:
+        return QString::fromUtf8(val, length);
+    }
+}
+
 void QPSQLResultPrivate::deallocatePreparedStmt()
 {
     if (drv_d_func()) {
@@ -589,6 +812,23 @@ bool QPSQLResult::nextResult()
     return d->processResults();
 }
 
+static double qTextToDouble(const char *val, bool *ok)
+{
+    double dbl = qstrtod(val, nullptr, ok);
+    if (!*ok) {
+        *ok = true;
+        if (qstricmp(val, "NaN") == 0)
+            dbl = qQNaN();
+        else if (qstricmp(val, "Infinity") == 0)
+            dbl = qInf();
+        else if (qstricmp(val, "-Infinity") == 0)
+            dbl = -qInf();
+        else
+            *ok = false;
+    }
+    return dbl;
+}
+
 QVariant QPSQLResult::data(int i)
 {
     Q_D(const QPSQLResult);
@@ -602,6 +842,14 @@ QVariant QPSQLResult::data(int i)
     if (PQgetisnull(d->result, currentRow, i))
         return QVariant(type, nullptr);
     const char *val = PQgetvalue(d->result, currentRow, i);
+    QByteArray numericText;
+    if (PQfformat(d->result, i) == 1) {
+        const int length = PQgetlength(d->result, currentRow, i);
+        if (ptype != QNUMERICOID)
+            return qBinaryValue(ptype, val, length);
+        numericText = qNumericToText(val, length);
+        val = numericText.constData();
+    }
     switch (type.id()) {
     case QMetaType::Bool:
         return QVariant((bool)(val[0] == 't'));
@@ -620,17 +868,9 @@ QVariant QPSQLResult::data(int i)
                 return QString::fromLatin1(val);
         }
         bool ok;
-        double dbl = qstrtod(val, nullptr, &ok);
-        if (!ok) {
-            if (qstricmp(val, "NaN") == 0)
-                dbl = qQNaN();
-            else if (qstricmp(val, "Infinity") == 0)
-                dbl = qInf();
-            else if (qstricmp(val, "-Infinity") == 0)
-                dbl = -qInf();
-            else
-                return QVariant();
-        }
+        const double dbl = qTextToDouble(val, &ok);
+        if (!ok)
+            return QVariant();
         if (ptype == QNUMERICOID) {
             if (numericalPrecisionPolicy() == QSql::LowPrecisionInt64)
                 return QVariant((qlonglong)dbl);
@@ -807,7 +1047,74 @@ QSqlRecord QPSQLResult::record() const
 void QPSQLResult::virtual_hook(int id, void *data)
 {
     Q_ASSERT(data);
-    QSqlResult::virtual_hook(id, data);
+    switch (id) {
+    case FetchColumnsOperation:
+        fetchColumns(static_cast<QSqlFetchColumnsData *>(data));
+        break;
+    default:
+        QSqlResult::virtual_hook(id, data);
+    }
+}
+
+// Decodes the rows straight from the PGresult, without a QVariant per value
+// as far as the column buffers' types allow.
+void QPSQLResult::fetchColumns(QSqlFetchColumnsData *request)
+{
+    Q_D(QPSQLResult);
+    request->handled = true;
+    QList<QSqlColumnBuffer> &columns = *request->columns;
+    while (request->rowsFetched < request->maxRows) {
+        const bool fetched = at() == QSql::BeforeFirstRow ? fetchFirst() : fetchNext();
+        if (!fetched)
+            return;
+        const int row = isForwardOnly() ? 0 : at();
+        for (int i = 0; i < columns.size(); ++i) {
+            QSqlColumnBuffer &column = columns[i];
+            if (PQgetisnull(d->result, row, i)) {
+                if (column.type() == QSqlColumnBuffer::Type::Variant)
+                    column.appendVariant(QVariant(qDecodePSQLType(PQftype(d->result, i))));
+                else
+                    column.appendNull();
+                continue;
+            }
+            const char *val = PQgetvalue(d->result, row, i);
+            const int ptype = PQftype(d->result, i);
+            // Binary values and the other types take the long way
+            if (PQfformat(d->result, i) != 0 || column.type() == QSqlColumnBuffer::Type::Variant
+                || ptype == QBYTEAOID) {
+                column.appendVariant(data(i));
+                continue;
+            }
+            switch (column.type()) {
+            case QSqlColumnBuffer::Type::Integer:
+                if (ptype == QBOOLOID) {
+                    column.appendInteger(val[0] == 't');
+                } else if (ptype == QNUMERICOID || ptype == QFLOAT4OID || ptype == QFLOAT8OID) {
+                    bool ok;
+                    column.appendInteger(qint64(qTextToDouble(val, &ok)));
+                } else {
+                    column.appendInteger(QByteArrayView(val, PQgetlength(d->result, row, i))
+                                                 .toLongLong());
+                }
+                break;
+            case QSqlColumnBuffer::Type::Double: {
+                bool ok;
+                const double dbl = qTextToDouble(val, &ok);
+                if (ok)
+                    column.appendDouble(dbl);
+                else
+                    column.appendNull();
+                break;
+            }
+            case QSqlColumnBuffer::Type::String:
+                column.appendString(QString::fromUtf8(val, PQgetlength(d->result, row, i)));
+                break;
+            case QSqlColumnBuffer::Type::Variant:
+                Q_UNREACHABLE();
+            }
+        }
+        ++request->rowsFetched;
+    }
 }
 
 static QString qCreateParamString(const QList<QVariant> &boundValues, const QSqlDriver *driver)
@@ -837,6 +1144,437 @@ QString qMakePreparedStmtId()
     return id;
 }
 
+void QPSQLResultPrivate::describePreparedStmt()
+{
+    // Learn the parameter types, so that exec() can pass the bound values
+    // as such, rather than formatted into an EXECUTE statement, and the
+    // result columns, to decide whether we can have them in binary.
+    paramTypes.clear();
+    preparedStmtDescribed = false;
+    binaryResults = false;
+
+    PGresult *description = drv_d_func()->describePrepared(preparedStmtId.toUtf8());
+    if (PQresultStatus(description) == PGRES_COMMAND_OK) {
+        const int paramCount = PQnparams(description);
+        paramTypes.reserve(paramCount);
+        for (int i = 0; i < paramCount; ++i)
+            paramTypes.append(PQparamtype(description, i));
+        preparedStmtDescribed = true;
+
+        const int fieldCount = PQnfields(description);
+        binaryResults = fieldCount > 0 && drv_d_func()->integerDatetimes;
+        for (int i = 0; binaryResults && i < fieldCount; ++i)
+            binaryResults = qIsBinaryDecodable(PQftype(description, i));
+    }
+    PQclear(description);
+}
+
+// Converts a bound value into the text (or, for bytea, binary) format of a
+// parameter of the given type. Returns false if that would not mean the same
+// as the literal formatValue() makes of it.
+static bool qMakeParam(const QVariant &value, Oid type, QByteArray *buffer, int *format)
+{
+    *format = 0;
+    switch (value.metaType().id()) {
+#if QT_CONFIG(datestring)
+    case QMetaType::QDateTime:
+        // formatValue() makes a timestamptz literal; assigned to a parameter
+        // of another type, the server converts it with the session time zone.
+        if (type != QTIMESTAMPTZOID || !value.toDateTime().isValid())
+            return false;
+        *buffer = QLocale::c().toString(value.toDateTime().toUTC(),
+                                        u"yyyy-MM-ddThh:mm:ss.zzz").toLatin1() + 'Z';
+        return true;
+    case QMetaType::QTime:
+        if (!value.toTime().isValid())
+            return false;
+        *buffer = value.toTime().toString(u"hh:mm:ss.zzz").toLatin1();
+        return true;
+    case QMetaType::QDate:
+        if (!value.toDate().isValid())
+            return false;
+        *buffer = value.toDate().toString(Qt::ISODate).toLatin1();
+        return true;
+#endif
+    case QMetaType::Bool:
+        *buffer = value.toBool() ? QByteArrayLiteral("TRUE") : QByteArrayLiteral("FALSE");
+        return true;
+    case QMetaType::QByteArray:
+        if (type != QBYTEAOID)
+            return false;
+        *buffer = value.toByteArray();
+        *format = 1;
+        return true;
+    case QMetaType::Float:
+    case QMetaType::Double: {
+        const double d = value.toDouble();
+        if (qIsNaN(d))
+            *buffer = QByteArrayLiteral("NaN");
+        else if (qIsInf(d))
+            *buffer = d < 0 ? QByteArrayLiteral("-Infinity") : QByteArrayLiteral("Infinity");
+        else
+            *buffer = value.toString().toLatin1();
+        return true;
+    }
+    case QMetaType::QString:
+    case QMetaType::QChar:
+        *buffer = value.toString().toUtf8();
+        return true;
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::QUuid:
+        *buffer = value.toString().toLatin1();
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool QPSQLResultPrivate::bindParams(const QList<QVariant> &values, QPSQLParams *params) const
+{
+    if (!preparedStmtDescribed || values.size() != paramTypes.size())
+        return false;
+
+    params->buffers.resize(values.size());
+    params->values.resize(values.size());
+    params->lengths.resize(values.size());
+    params->formats.resize(values.size());
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        const QVariant &value = values.at(i);
+        if (isVariantNull(value)) {
+            params->values[i] = nullptr;
+            params->lengths[i] = 0;
+            params->formats[i] = 0;
+            continue;
+        }
+        QByteArray &buffer = params->buffers[i];
+        if (!qMakeParam(value, paramTypes.at(i), &buffer, &params->formats[i]))
+            return false;
+        params->values[i] = buffer.constData();
+        params->lengths[i] = int(buffer.size());
+    }
+    return true;
+}
+
+// Appends a value in the text format of COPY. Date-times are written in the
+// session's time zone, see execCopy().
+static void qAppendCopyValue(QByteArray &row, const QVariant &value,
+                             const QTimeZone &sessionZone)
+{
+    const char nullValue[] = "\\N";
+    if (QSqlResultPrivate::isVariantNull(value)) {
+        row += nullValue;
+        return;
+    }
+
+    QByteArray text;
+    switch (value.metaType().id()) {
+    case QMetaType::Bool:
+        row += value.toBool() ? 't' : 'f';
+        return;
+    case QMetaType::QByteArray:
+        // The hex format of bytea, with its backslash escaped for COPY
+        row += "\\\\x" + value.toByteArray().toHex();
+        return;
+#if QT_CONFIG(datestring)
+    case QMetaType::QDateTime:
+        if (!value.toDateTime().isValid()) {
+            row += nullValue;
+            return;
+        }
+    {
+        const QDateTime dateTime = value.toDateTime().toTimeZone(sessionZone);
+        const int offset = dateTime.offsetFromUtc();
+        const QTime offsetTime = QTime::fromMSecsSinceStartOfDay(qAbs(offset) * 1000);
+        text = QLocale::c().toString(dateTime, u"yyyy-MM-ddThh:mm:ss.zzz").toLatin1()
+                + (offset < 0 ? '-' : '+') + offsetTime.toString(u"hh:mm:ss").toLatin1();
+        break;
+    }
+    case QMetaType::QTime:
+        if (!value.toTime().isValid()) {
+            row += nullValue;
+            return;
+        }
+        text = value.toTime().toString(u"hh:mm:ss.zzz").toLatin1();
+        break;
+    case QMetaType::QDate:
+        if (!value.toDate().isValid()) {
+            row += nullValue;
+            return;
+        }
+        text = value.toDate().toString(Qt::ISODate).toLatin1();
+        break;
+#endif
+    case QMetaType::Float:
+    case QMetaType::Double: {
+        const double d = value.toDouble();
+        if (qIsNaN(d))
+            text = QByteArrayLiteral("NaN");
+        else if (qIsInf(d))
+            text = d < 0 ? QByteArrayLiteral("-Infinity") : QByteArrayLiteral("Infinity");
+        else
+            text = value.toString().toLatin1();
+        break;
+    }
+    default:
+        text = value.toString().toUtf8();
+        break;
+    }
+
+    for (const char c : std::as_const(text)) {
+        switch (c) {
+        case '\\':
+            row += "\\\\";
+            break;
+        case '\t':
+            row += "\\t";
+            break;
+        case '\n':
+            row += "\\n";
+            break;
+        case '\r':
+            row += "\\r";
+            break;
+        default:
+            row += c;
+            break;
+        }
+    }
+}
+
+bool QPSQLResultPrivate::execCopy(const QList<QVariant> &values, bool batch)
+{
+    Q_Q(QPSQLResult);
+    QList<QVariantList> columns;
+    columns.reserve(values.size());
+    for (const QVariant &value : values)
+        columns.append(batch ? value.toList() : QVariantList{ value });
+    const qsizetype rowCount = columns.isEmpty() ? 0 : columns.constFirst().size();
+    for (const QVariantList &column : std::as_const(columns)) {
+        if (column.size() != rowCount) {
+            q->setLastError(QSqlError("QPSQL: "_L1 + QCoreApplication::translate("QPSQLResult",
+                                      "Bound value lists differ in length"), QString(),
+                                      QSqlError::StatementError));
+            return false;
+        }
+    }
+
+    PGconn *connection = drv_d_func()->connection;
+
+    // formatValue() makes a timestamptz literal of a date-time, which the
+    // server converts with the session's time zone when it is assigned to a
+    // timestamp column. COPY, though, takes the wall-clock time of the text
+    // for a timestamp column and ignores its offset. Writing date-times as
+    // the wall-clock time in the session's time zone, with that zone's
+    // offset, gives both kinds of column the same value as exec() does.
+    QTimeZone sessionZone;
+    const bool hasDateTimes = std::any_of(columns.cbegin(), columns.cend(),
+                                          [](const QVariantList &column) {
+        return std::any_of(column.cbegin(), column.cend(), [](const QVariant &value) {
+            return value.metaType().id() == QMetaType::QDateTime;
+        });
+    });
+#if QT_CONFIG(timezone)
+    if (hasDateTimes) {
+        if (const char *zone = PQparameterStatus(connection, "TimeZone"))
+            sessionZone = QTimeZone(QByteArray(zone));
+    }
+#endif
+    if (hasDateTimes && !sessionZone.isValid()) {
+        q->setLastError(QSqlError("QPSQL: "_L1 + QCoreApplication::translate("QPSQLResult",
+                                  "Unable to convert date and time values to the session's "
+                                  "time zone"), QString(), QSqlError::StatementError));
+        return false;
+    }
+
+    result = drv_d_func()->exec(copyStatement);
+    if (PQresultStatus(result) != PGRES_COPY_IN)
+        return processResults();
+    PQclear(result);
+    result = nullptr;
+
+    // Send the rows in chunks of about this size
+    constexpr qsizetype CopyBufferSize = 64 * 1024;
+    QByteArray buffer;
+    buffer.reserve(CopyBufferSize + 1024);
+    bool sent = true;
+    for (qsizetype row = 0; sent && row < rowCount; ++row) {
+        for (qsizetype column = 0; column < columns.size(); ++column) {
+            if (column)
+                buffer += '\t';
+            qAppendCopyValue(buffer, columns.at(column).at(row), sessionZone);
+        }
+        buffer += '\n';
+        if (buffer.size() >= CopyBufferSize || row == rowCount - 1) {
+            sent = PQputCopyData(connection, buffer.constData(), int(buffer.size())) == 1;
+            buffer.clear();
+        }
+    }
+    // On failure, this makes the server abort the COPY, and the result below
+    // report the error
+    PQputCopyEnd(connection, sent ? nullptr : "QPSQL: unable to send data");
+
+    result = PQgetResult(connection);
+    while (PGresult *next = PQgetResult(connection))
+        PQclear(next);
+    return processResults();
+}
+
+#if defined(LIBPQ_HAS_PIPELINING)
+// Reads the results still pending in pipeline mode, up to and including the
+// sync point, so that we can leave it; gives up if the connection is gone.
+static void qDrainPipeline(PGconn *connection, bool syncSent)
+{
+    if (!syncSent && !PQpipelineSync(connection))
+        return;
+    // Each statement's results end with a nullptr; two in a row mean that
+    // there is nothing left to read.
+    bool atEnd = false;
+    while (PQstatus(connection) == CONNECTION_OK) {
+        PGresult *result = PQgetResult(connection);
+        if (!result) {
+            if (atEnd)
+                return;
+            atEnd = true;
+            continue;
+        }
+        atEnd = false;
+        const bool sync = PQresultStatus(result) == PGRES_PIPELINE_SYNC;
+        PQclear(result);
+        if (sync)
+            return;
+    }
+}
+
+// The rows of a batch are executed in one transaction: unless the user has
+// started one, we wrap the batch in our own, so that the sync points between
+// the chunks don't commit part of the rows. If a row fails, none are stored.
+bool QPSQLResultPrivate::execPipelined(const std::vector<QPSQLParams> &batch)
+{
+    Q_Q(QPSQLResult);
+    QPSQLDriverPrivate *driver = drv_d_func();
+    PGconn *connection = driver->connection;
+
+    // Like sendQuery(), this takes over the connection from any forward-only
+    // query still fetching its rows.
+    driver->discardResults();
+    const bool ownTransaction = PQtransactionStatus(connection) == PQTRANS_IDLE;
+    if (ownTransaction) {
+        PGresult *begin = driver->exec("BEGIN");
+        const bool begun = PQresultStatus(begin) == PGRES_COMMAND_OK;
+        if (!begun) {
+            q->setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
+                                       "Unable to execute batch"), QSqlError::TransactionError,
+                                       driver, begin));
+        }
+        PQclear(begin);
+        if (!begun)
+            return false;
+    }
+    driver->currentStmtId = driver->generateStatementId();
+    if (PQenterPipelineMode(connection) != 1) {
+        q->setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
+                                   "Unable to enter pipeline mode"), QSqlError::StatementError,
+                                   driver));
+        if (ownTransaction)
+            PQclear(driver->exec("ROLLBACK"));
+        return false;
+    }
+
+    // Send the statements a chunk at a time, each chunk followed by a sync
+    // point, and read its results before sending the next one, so that
+    // neither side blocks writing while the other one does, too.
+    const QByteArray stmtName = preparedStmtId.toUtf8();
+    PGresult *error = nullptr;
+    bool connectionLost = false;
+    bool syncSent = true;
+    for (size_t first = 0; !error && !connectionLost && first < batch.size();
+         first += PipelineChunkSize) {
+        const size_t end = qMin(first + size_t(PipelineChunkSize), batch.size());
+        size_t sent = first;
+        for (; sent < end; ++sent) {
+            const QPSQLParams &params = batch[sent];
+            if (!PQsendQueryPrepared(connection, stmtName.constData(), int(params.values.size()),
+                                     params.values.constData(), params.lengths.constData(),
+                                     params.formats.constData(), binaryResults ? 1 : 0)) {
+                break;
+            }
+        }
+        if (sent < end || !PQpipelineSync(connection)) {
+            connectionLost = true;
+            syncSent = false;
+            break;
+        }
+
+        // Each statement yields its result followed by a nullptr, then comes
+        // the sync point. After an error, the remaining statements of the
+        // chunk are reported as aborted.
+        for (size_t i = first; !connectionLost && i < end; ++i) {
+            PGresult *statementResult = PQgetResult(connection);
+            if (!statementResult)
+                connectionLost = true;
+            for (; statementResult; statementResult = PQgetResult(connection)) {
+                switch (PQresultStatus(statementResult)) {
+                case PGRES_COMMAND_OK:
+                case PGRES_TUPLES_OK:
+                    PQclear(result);
+                    result = statementResult;
+                    break;
+                case PGRES_PIPELINE_ABORTED:
+                    PQclear(statementResult);
+                    break;
+                default:
+                    if (!error)
+                        error = statementResult;
+                    else
+                        PQclear(statementResult);
+                    break;
+                }
+            }
+        }
+        if (!connectionLost) {
+            PGresult *sync = PQgetResult(connection);
+            connectionLost = PQresultStatus(sync) != PGRES_PIPELINE_SYNC;
+            PQclear(sync);
+        }
+    }
+    // libpq only leaves pipeline mode once we have read every result
+    if (connectionLost)
+        qDrainPipeline(connection, syncSent);
+    if (PQexitPipelineMode(connection) != 1)
+        connectionLost = true;
+
+    if (ownTransaction && !error && !connectionLost) {
+        PGresult *commit = driver->exec("COMMIT");
+        if (PQresultStatus(commit) != PGRES_COMMAND_OK)
+            error = commit;
+        else
+            PQclear(commit);
+    }
+
+    if (error || connectionLost) {
+        q->setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
+                                   "Unable to execute batch"), QSqlError::StatementError,
+                                   driver, error));
+        PQclear(error);
+        if (ownTransaction && PQpipelineStatus(connection) == PQ_PIPELINE_OFF
+            && PQtransactionStatus(connection) != PQTRANS_IDLE) {
+            PQclear(driver->exec("ROLLBACK"));
+        }
+        PQclear(result);
+        result = nullptr;
+        q->setSelect(false);
+        q->setActive(false);
+        return false;
+    }
+    return processResults();
+}
+#endif
+
 bool QPSQLResult::prepare(const QString &query)
 {
     Q_D(QPSQLResult);
@@ -847,6 +1585,21 @@ bool QPSQLResult::prepare(const QString &query)
 
     if (!d->preparedStmtId.isEmpty())
         d->deallocatePreparedStmt();
+    d->copyStatement.clear();
+    d->paramTypes.clear();
+    d->preparedStmtDescribed = false;
+    d->binaryResults = false;
+
+    // COPY cannot be prepared; exec() and execBatch() send the bound values
+    // as its data.
+    static const QRegularExpression copyFromStdin(
+            QStringLiteral("^\\s*COPY\\b.*\\bFROM\\s+STDIN\\b"),
+            QRegularExpression::CaseInsensitiveOption
+            | QRegularExpression::DotMatchesEverythingOption);
+    if (copyFromStdin.match(query).hasMatch()) {
+        d->copyStatement = query;
+        return true;
+    }
 
     const QString stmtId = qMakePreparedStmtId();
     const QString stmt = QStringLiteral("PREPARE %1 AS ").arg(stmtId).append(d->positionalToNamedBinding(query));
@@ -863,6 +1616,7 @@ bool QPSQLResult::prepare(const QString &query)
 
     PQclear(result);
     d->preparedStmtId = stmtId;
+    d->describePreparedStmt();
     return true;
 }
 
@@ -874,14 +1628,22 @@ bool QPSQLResult::exec()
 
     cleanup();
 
-    QString stmt;
-    const QString params = qCreateParamString(boundValues(), driver());
-    if (params.isEmpty())
-        stmt = QStringLiteral("EXECUTE %1").arg(d->preparedStmtId);
-    else
-        stmt = QStringLiteral("EXECUTE %1 (%2)").arg(d->preparedStmtId, params);
+    if (!d->copyStatement.isEmpty())
+        return d->execCopy(boundValues(), false);
 
-    d->stmtId = d->drv_d_func()->sendQuery(stmt);
+    QPSQLParams params;
+    if (d->bindParams(boundValues(), &params)) {
+        d->stmtId = d->drv_d_func()->sendQueryPrepared(d->preparedStmtId.toUtf8(), params,
+                                                       d->binaryResults);
+    } else {
+        QString stmt;
+        const QString paramString = qCreateParamString(boundValues(), driver());
+        if (paramString.isEmpty())
+            stmt = QStringLiteral("EXECUTE %1").arg(d->preparedStmtId);
+        else
+            stmt = QStringLiteral("EXECUTE %1 (%2)").arg(d->preparedStmtId, paramString);
+        d->stmtId = d->drv_d_func()->sendQuery(stmt);
+    }
     if (d->stmtId == InvalidStatementId) {
         setLastError(qMakeError(QCoreApplication::translate("QPSQLResult",
                                 "Unable to send query"), QSqlError::StatementError, d->drv_d_func()));
@@ -900,6 +1662,50 @@ bool QPSQLResult::exec()
     return d->processResults();
 }
 
+bool QPSQLResult::execBatch(bool arrayBind)
+{
+    Q_D(QPSQLResult);
+    if (arrayBind || !d->preparedQueriesEnabled)
+        return QSqlResult::execBatch(arrayBind);
+
+    if (!d->copyStatement.isEmpty()) {
+        cleanup();
+        return d->execCopy(boundValues(), true);
+    }
+
+#if defined(LIBPQ_HAS_PIPELINING)
+    // Bind all rows up front, and fall back to executing them one at a time
+    // if any of them cannot be sent as parameters. Pipelining relies on the
+    // same protocol support as PreparedQueries, so on the same server version.
+    const QList<QVariant> values = boundValues();
+    if (!values.isEmpty() && d->drv_d_func()->pro >= QPSQLDriver::Version8_2) {
+        QList<QVariantList> columns;
+        columns.reserve(values.size());
+        for (const QVariant &value : values)
+            columns.append(value.toList());
+        const qsizetype rowCount = columns.constFirst().size();
+        bool bound = rowCount > 0;
+        for (const QVariantList &column : std::as_const(columns))
+            bound = bound && column.size() == rowCount;
+
+        std::vector<QPSQLParams> batch;
+        if (bound)
+            batch.resize(rowCount);
+        QList<QVariant> row(values.size());
+        for (qsizetype i = 0; bound && i < rowCount; ++i) {
+            for (qsizetype j = 0; j < columns.size(); ++j)
+                row[j] = columns.at(j).at(i);
+            bound = d->bindParams(row, &batch[i]);
+        }
+        if (bound) {
+            cleanup();
+            return d->execPipelined(batch);
+        }
+    }
+#endif
+    return QSqlResult::execBatch(arrayBind);
+}
+
 ///////////////////////////////////////////////////////////////////
 
 bool QPSQLDriverPrivate::setEncodingUtf8()
@@ -933,6 +1739,15 @@ void QPSQLDriverPrivate::setByteaOutput()
     }
 }
 
+void QPSQLDriverPrivate::detectIntegerDatetimes()
+{
+    // Binary date and time values are 64-bit integers, rather than doubles,
+    // unless the server was built with --disable-integer-datetimes, which is
+    // no longer possible as of PostgreSQL 10.
+    const char *value = PQparameterStatus(connection, "integer_datetimes");
+    integerDatetimes = value && qstrcmp(value, "on") == 0;
+}
+
 void QPSQLDriverPrivate::detectBackslashEscape()
 {
     // standard_conforming_strings option introduced in 8.2
@@ -1093,6 +1908,7 @@ QPSQLDriver::QPSQLDriver(PGconn *conn, QObject *parent)
     if (conn) {
         d->pro = d->getPSQLVersion();
         d->detectBackslashEscape();
+        d->detectIntegerDatetimes();
         setOpen(true);
         setOpenError(false);
     }
@@ -1189,6 +2005,7 @@ bool QPSQLDriver::open(const QString &db,
 
     d->pro = d->getPSQLVersion();
     d->detectBackslashEscape();
+    d->detectIntegerDatetimes();
     if (!d->setEncodingUtf8()) {
         setLastError(qMakeError(tr("Unable to set client encoding to 'UNICODE'"), QSqlError::ConnectionError, d));
         setOpenError(true);
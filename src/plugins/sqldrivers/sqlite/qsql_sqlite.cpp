@@ -166,6 +166,10 @@ public:
     using QSqlCachedResultPrivate::QSqlCachedResultPrivate;
     void cleanup();
     bool fetchNext(QSqlCachedResult::ValueCache &values, int idx, bool initialFetch);
+    bool stepFailed(int res);
+    void fetchColumns(QSqlFetchColumnsData *request);
+    QVariant columnValue(int i) const;
+    QString columnText(int i) const;
     // initializes the recordInfo and the cache
     void initColumns(bool emptyResultset);
     void finalize();
@@ -252,6 +256,39 @@ void QSQLiteResultPrivate::initColumns(bool emptyResultset)
     }
 }
 
+QVariant QSQLiteResultPrivate::columnValue(int i) const
+{
+    Q_Q(const QSQLiteResult);
+    switch (sqlite3_column_type(stmt, i)) {
+    case SQLITE_BLOB:
+        return QByteArray(static_cast<const char *>(sqlite3_column_blob(stmt, i)),
+                          sqlite3_column_bytes(stmt, i));
+    case SQLITE_INTEGER:
+        return sqlite3_column_int64(stmt, i);
+    case SQLITE_FLOAT:
+        switch (q->numericalPrecisionPolicy()) {
+        case QSql::LowPrecisionInt32:
+            return sqlite3_column_int(stmt, i);
+        case QSql::LowPrecisionInt64:
+            return sqlite3_column_int64(stmt, i);
+        case QSql::LowPrecisionDouble:
+        case QSql::HighPrecision:
+        default:
+            return sqlite3_column_double(stmt, i);
+        };
+    case SQLITE_NULL:
+        return QVariant(QMetaType::fromType<QString>());
+    default:
+        return columnText(i);
+    }
+}
+
+QString QSQLiteResultPrivate::columnText(int i) const
+{
+    return QString(reinterpret_cast<const QChar *>(sqlite3_column_text16(stmt, i)),
+                   sqlite3_column_bytes16(stmt, i) / sizeof(QChar));
+}
+
 bool QSQLiteResultPrivate::fetchNext(QSqlCachedResult::ValueCache &values, int idx, bool initialFetch)
 {
     Q_Q(QSQLiteResult);
@@ -278,50 +315,25 @@ bool QSQLiteResultPrivate::fetchNext(QSqlCachedResult::ValueCache &values, int i
         return false;
     }
     int res = sqlite3_step(stmt);
-    switch(res) {
-    case SQLITE_ROW:
-        // check to see if should fill out columns
-        if (rInf.isEmpty())
-            // must be first call.
-            initColumns(false);
-        if (idx < 0 && !initialFetch)
-            return true;
-        for (int i = 0; i < rInf.count(); ++i) {
-            switch (sqlite3_column_type(stmt, i)) {
-            case SQLITE_BLOB:
-                values[i + idx] = QByteArray(static_cast<const char *>(
-                            sqlite3_column_blob(stmt, i)),
-                            sqlite3_column_bytes(stmt, i));
-                break;
-            case SQLITE_INTEGER:
-                values[i + idx] = sqlite3_column_int64(stmt, i);
-                break;
-            case SQLITE_FLOAT:
-                switch(q->numericalPrecisionPolicy()) {
-                    case QSql::LowPrecisionInt32:
-                        values[i + idx] = sqlite3_column_int(stmt, i);
-                        break;
-                    case QSql::LowPrecisionInt64:
-                        values[i + idx] = sqlite3_column_int64(stmt, i);
-                        break;
-                    case QSql::LowPrecisionDouble:
-                    case QSql::HighPrecision:
-                    default:
-                        values[i + idx] = sqlite3_column_double(stmt, i);
-                        break;
-                };
-                break;
-            case SQLITE_NULL:
-                values[i + idx] = QVariant(QMetaType::fromType<QString>());
-                break;
-            default:
-                values[i + idx] = QString(reinterpret_cast<const QChar *>(
-                            sqlite3_column_text16(stmt, i)),
-                            sqlite3_column_bytes16(stmt, i) / sizeof(QChar));
-                break;
-            }
-        }
+    if (res != SQLITE_ROW)
+        return stepFailed(res);
+
+    // check to see if should fill out columns
+    if (rInf.isEmpty())
+        // must be first call.
+        initColumns(false);
+    if (idx < 0 && !initialFetch)
         return true;
+    for (int i = 0; i < rInf.count(); ++i)
+        values[i + idx] = columnValue(i);
+    return true;
+}
+
+// Handles the result of an sqlite3_step() that did not return a row.
+bool QSQLiteResultPrivate::stepFailed(int res)
+{
+    Q_Q(QSQLiteResult);
+    switch(res) {
     case SQLITE_DONE:
         if (rInf.isEmpty())
             // must be first call.
@@ -351,6 +363,70 @@ bool QSQLiteResultPrivate::fetchNext(QSqlCachedResult::ValueCache &values, int i
     return false;
 }
 
+// The rows of a scrollable query end up in the cache anyway, but those of a
+// forward only query can be decoded straight from the statement.
+void QSQLiteResultPrivate::fetchColumns(QSqlFetchColumnsData *request)
+{
+    Q_Q(QSQLiteResult);
+    if (!forwardOnly || !stmt || atEnd)
+        return;
+    request->handled = true;
+    QList<QSqlColumnBuffer> &columns = *request->columns;
+    while (request->rowsFetched < request->maxRows) {
+        const bool lastInBlock = request->rowsFetched + 1 == request->maxRows;
+        if (skipRow) {
+            // exec() fetched the first row already
+            skipRow = false;
+            if (!skippedStatus) {
+                atEnd = true;
+                return;
+            }
+            for (int i = 0; i < columns.size(); ++i)
+                columns[i].appendVariant(firstRow.at(i));
+            if (lastInBlock)
+                cache = firstRow;
+        } else {
+            const int res = sqlite3_step(stmt);
+            if (res != SQLITE_ROW) {
+                stepFailed(res);
+                atEnd = true;
+                return;
+            }
+            for (int i = 0; i < columns.size(); ++i) {
+                QSqlColumnBuffer &column = columns[i];
+                if (sqlite3_column_type(stmt, i) == SQLITE_NULL) {
+                    if (column.type() == QSqlColumnBuffer::Type::Variant)
+                        column.appendVariant(QVariant(QMetaType::fromType<QString>()));
+                    else
+                        column.appendNull();
+                    continue;
+                }
+                switch (column.type()) {
+                case QSqlColumnBuffer::Type::Integer:
+                    column.appendInteger(sqlite3_column_int64(stmt, i));
+                    break;
+                case QSqlColumnBuffer::Type::Double:
+                    column.appendDouble(sqlite3_column_double(stmt, i));
+                    break;
+                case QSqlColumnBuffer::Type::String:
+                    column.appendString(columnText(i));
+                    break;
+                case QSqlColumnBuffer::Type::Variant:
+                    column.appendVariant(columnValue(i));
+                    break;
+                }
+            }
+            // Keep value() working for the row the query is positioned on
+            if (lastInBlock) {
+                for (int i = 0; i < colCount; ++i)
+                    cache[i] = columnValue(i);
+            }
+        }
+        ++request->rowsFetched;
+        q->setAt(q->at() + 1);
+    }
+}
+
 QSQLiteResult::QSQLiteResult(const QSQLiteDriver* db)
     : QSqlCachedResult(*new QSQLiteResultPrivate(this, db))
 {
@@ -368,7 +444,14 @@ QSQLiteResult::~QSQLiteResult()
 
 void QSQLiteResult::virtual_hook(int id, void *data)
 {
-    QSqlCachedResult::virtual_hook(id, data);
+    Q_D(QSQLiteResult);
+    switch (id) {
+    case FetchColumnsOperation:
+        d->fetchColumns(static_cast<QSqlFetchColumnsData *>(data));
+        break;
+    default:
+        QSqlCachedResult::virtual_hook(id, data);
+    }
 }
 
 bool QSQLiteResult::reset(const QString &query)
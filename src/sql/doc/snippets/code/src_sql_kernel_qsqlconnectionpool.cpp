@@ -0,0 +1,34 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR BSD-3-Clause
+#include <QSqlConnectionPool>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QThreadPool>
+
+void poolConnections(const QStringList &orders)
+{
+//! [0]
+QSqlDatabase prototype = QSqlDatabase::addDatabase("QPSQL", "orders");
+prototype.setHostName("db.example.com");
+prototype.setDatabaseName("orders");
+prototype.setUserName("clerk");
+prototype.setPassword("secret");
+
+QSqlConnectionPool pool(prototype);
+for (const QString &order : orders) {
+    QThreadPool::globalInstance()->start([&pool, order] {
+        QSqlDatabase db = pool.acquire();
+        if (!db.isValid())
+            return;
+        {
+            QSqlQuery query(db);
+            query.prepare("UPDATE orders SET shipped = TRUE WHERE id = ?");
+            query.addBindValue(order);
+            query.exec();
+        }
+        pool.release(db);
+    });
+}
+QThreadPool::globalInstance()->waitForDone();
+//! [0]
+}
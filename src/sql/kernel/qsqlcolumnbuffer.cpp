@@ -0,0 +1,340 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsqlcolumnbuffer.h"
+
+QT_BEGIN_NAMESPACE
+
+class QSqlColumnBufferPrivate : public QSharedData
+{
+public:
+    explicit QSqlColumnBufferPrivate(QSqlColumnBuffer::Type type) : type(type) {}
+
+    QList<qint64> integers;
+    QList<double> doubles;
+    QStringList strings;
+    QVariantList variants;
+    // Only as long as needed to hold the last null
+    QBitArray nulls;
+    QSqlColumnBuffer::Type type;
+};
+
+QT_DEFINE_QSDP_SPECIALIZATION_DTOR(QSqlColumnBufferPrivate)
+
+/*!
+    \class QSqlColumnBuffer
+    \brief The QSqlColumnBuffer class holds the values of one column for a
+    block of rows.
+    \since 6.8
+
+    \ingroup database
+    \inmodule QtSql
+
+    QSqlQuery::fetchColumns() returns a QSqlColumnBuffer for each column of
+    the result set. Rather than a QVariant per value, a buffer stores the
+    values in a list of the type() chosen for the column: integers(),
+    doubles() or strings(); only columns of other types, such as dates or
+    binary data, are held in variants(). Whether a value is NULL is recorded
+    separately, see isNull() and nulls(); the list entry of a NULL value is
+    a default-constructed value.
+
+    \sa QSqlQuery::fetchColumns()
+*/
+
+/*!
+    \enum QSqlColumnBuffer::Type
+
+    This enum type describes in which list a buffer stores its values.
+
+    \value Integer  Integral and boolean values, in integers().
+    \value Double   Floating point values, in doubles().
+    \value String   Text, in strings().
+    \value Variant  Values of any other type, in variants().
+*/
+
+/*!
+    Constructs an empty buffer of type Type::Variant.
+*/
+QSqlColumnBuffer::QSqlColumnBuffer()
+    : d(new QSqlColumnBufferPrivate(Type::Variant))
+{
+}
+
+/*!
+    Constructs an empty buffer that stores values of \a type.
+*/
+QSqlColumnBuffer::QSqlColumnBuffer(Type type)
+    : d(new QSqlColumnBufferPrivate(type))
+{
+}
+
+/*!
+    Constructs a copy of \a other.
+*/
+QSqlColumnBuffer::QSqlColumnBuffer(const QSqlColumnBuffer &other)
+    = default;
+
+/*!
+    \fn QSqlColumnBuffer::QSqlColumnBuffer(QSqlColumnBuffer &&other)
+
+    Move-constructs a buffer from \a other.
+
+    \note The moved-from object \a other is placed in a
+    partially-formed state, in which the only valid operations are
+    destruction and assignment of a new value.
+*/
+
+/*!
+    Assigns \a other to this buffer.
+*/
+QSqlColumnBuffer &QSqlColumnBuffer::operator=(const QSqlColumnBuffer &other)
+    = default;
+
+/*!
+    \fn QSqlColumnBuffer &QSqlColumnBuffer::operator=(QSqlColumnBuffer &&other)
+
+    Move-assigns \a other to this buffer.
+
+    \note The moved-from object \a other is placed in a
+    partially-formed state, in which the only valid operations are
+    destruction and assignment of a new value.
+*/
+
+/*!
+    Destroys the buffer.
+*/
+QSqlColumnBuffer::~QSqlColumnBuffer()
+    = default;
+
+/*!
+    \fn void QSqlColumnBuffer::swap(QSqlColumnBuffer &other)
+
+    Swaps this buffer with \a other. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    Returns the type of the values stored in the buffer.
+*/
+QSqlColumnBuffer::Type QSqlColumnBuffer::type() const
+{
+    return d->type;
+}
+
+/*!
+    \fn bool QSqlColumnBuffer::isEmpty() const
+
+    Returns \c true if the buffer holds no values.
+*/
+
+/*!
+    Returns \c true if the value in \a row is NULL.
+*/
+bool QSqlColumnBuffer::isNull(qsizetype row) const
+{
+    return row >= 0 && row < d->nulls.size() && d->nulls.testBit(row);
+}
+
+/*!
+    Returns the values of a buffer of type Type::Integer.
+*/
+QList<qint64> QSqlColumnBuffer::integers() const
+{
+    return d->integers;
+}
+
+/*!
+    Returns the values of a buffer of type Type::Double.
+*/
+QList<double> QSqlColumnBuffer::doubles() const
+{
+    return d->doubles;
+}
+
+/*!
+    Returns the values of a buffer of type Type::String.
+*/
+QStringList QSqlColumnBuffer::strings() const
+{
+    return d->strings;
+}
+
+/*!
+    Returns the values of a buffer of type Type::Variant.
+*/
+QVariantList QSqlColumnBuffer::variants() const
+{
+    return d->variants;
+}
+
+/*!
+    Appends \a value to a buffer of type Type::Integer.
+*/
+void QSqlColumnBuffer::appendInteger(qint64 value)
+{
+    d->integers.append(value);
+}
+
+/*!
+    Appends \a value to a buffer of type Type::Double.
+*/
+void QSqlColumnBuffer::appendDouble(double value)
+{
+    d->doubles.append(value);
+}
+
+/*!
+    Appends \a value to a buffer of type Type::String.
+*/
+void QSqlColumnBuffer::appendString(const QString &value)
+{
+    d->strings.append(value);
+}
+
+/*!
+    \overload
+*/
+void QSqlColumnBuffer::appendString(QString &&value)
+{
+    d->strings.append(std::move(value));
+}
+
+/*!
+    Returns the number of values in the buffer.
+*/
+qsizetype QSqlColumnBuffer::size() const
+{
+    switch (d->type) {
+    case Type::Integer:
+        return d->integers.size();
+    case Type::Double:
+        return d->doubles.size();
+    case Type::String:
+        return d->strings.size();
+    case Type::Variant:
+        break;
+    }
+    return d->variants.size();
+}
+
+/*!
+    Returns a bit array with one bit for each value in the buffer, which is
+    set if the value is NULL.
+*/
+QBitArray QSqlColumnBuffer::nulls() const
+{
+    QBitArray nulls = d->nulls;
+    nulls.resize(size());
+    return nulls;
+}
+
+/*!
+    Returns the value in \a row as a QVariant; a NULL value is returned as
+    a null QVariant of the buffer's type.
+*/
+QVariant QSqlColumnBuffer::value(qsizetype row) const
+{
+    if (row < 0 || row >= size())
+        return QVariant();
+    switch (d->type) {
+    case Type::Integer:
+        return isNull(row) ? QVariant(QMetaType::fromType<qint64>()) : QVariant(d->integers.at(row));
+    case Type::Double:
+        return isNull(row) ? QVariant(QMetaType::fromType<double>()) : QVariant(d->doubles.at(row));
+    case Type::String:
+        return isNull(row) ? QVariant(QMetaType::fromType<QString>()) : QVariant(d->strings.at(row));
+    case Type::Variant:
+        break;
+    }
+    return d->variants.at(row);
+}
+
+/*!
+    Reserves space for \a rows values.
+*/
+void QSqlColumnBuffer::reserve(qsizetype rows)
+{
+    switch (d->type) {
+    case Type::Integer:
+        d->integers.reserve(rows);
+        break;
+    case Type::Double:
+        d->doubles.reserve(rows);
+        break;
+    case Type::String:
+        d->strings.reserve(rows);
+        break;
+    case Type::Variant:
+        d->variants.reserve(rows);
+        break;
+    }
+}
+
+/*!
+    Removes all values from the buffer.
+*/
+void QSqlColumnBuffer::clear()
+{
+    d->integers.clear();
+    d->doubles.clear();
+    d->strings.clear();
+    d->variants.clear();
+    d->nulls.clear();
+}
+
+/*!
+    Appends \a value, converted to the buffer's type. A null \a value is
+    appended as NULL.
+*/
+void QSqlColumnBuffer::appendVariant(const QVariant &value)
+{
+    if (value.isNull() && d->type != Type::Variant) {
+        appendNull();
+        return;
+    }
+    switch (d->type) {
+    case Type::Integer:
+        d->integers.append(value.toLongLong());
+        return;
+    case Type::Double:
+        d->doubles.append(value.toDouble());
+        return;
+    case Type::String:
+        d->strings.append(value.toString());
+        return;
+    case Type::Variant:
+        break;
+    }
+    if (value.isNull()) {
+        const qsizetype row = d->variants.size();
+        d->nulls.resize(row + 1);
+        d->nulls.setBit(row);
+    }
+    d->variants.append(value);
+}
+
+/*!
+    Appends a NULL value.
+*/
+void QSqlColumnBuffer::appendNull()
+{
+    const qsizetype row = size();
+    d->nulls.resize(row + 1);
+    d->nulls.setBit(row);
+    switch (d->type) {
+    case Type::Integer:
+        d->integers.append(0);
+        break;
+    case Type::Double:
+        d->doubles.append(0.0);
+        break;
+    case Type::String:
+        d->strings.append(QString());
+        break;
+    case Type::Variant:
+        d->variants.append(QVariant());
+        break;
+    }
+}
+
+QT_END_NAMESPACE
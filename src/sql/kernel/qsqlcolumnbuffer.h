@@ -0,0 +1,71 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSQLCOLUMNBUFFER_H
+#define QSQLCOLUMNBUFFER_H
+
+#include <QtSql/qtsqlglobal.h>
+
+#include <QtCore/qbitarray.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvariant.h>
+
+QT_BEGIN_NAMESPACE
+
+class QSqlColumnBufferPrivate;
+QT_DECLARE_QSDP_SPECIALIZATION_DTOR_WITH_EXPORT(QSqlColumnBufferPrivate, Q_SQL_EXPORT)
+
+class Q_SQL_EXPORT QSqlColumnBuffer
+{
+public:
+    enum class Type {
+        Integer,
+        Double,
+        String,
+        Variant
+    };
+
+    QSqlColumnBuffer();
+    explicit QSqlColumnBuffer(Type type);
+    QSqlColumnBuffer(const QSqlColumnBuffer &other);
+    QSqlColumnBuffer(QSqlColumnBuffer &&other) noexcept = default;
+    QSqlColumnBuffer &operator=(const QSqlColumnBuffer &other);
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QSqlColumnBuffer)
+    ~QSqlColumnBuffer();
+
+    void swap(QSqlColumnBuffer &other) noexcept { d.swap(other.d); }
+
+    Type type() const;
+    qsizetype size() const;
+    bool isEmpty() const { return size() == 0; }
+
+    bool isNull(qsizetype row) const;
+    QBitArray nulls() const;
+    QVariant value(qsizetype row) const;
+
+    QList<qint64> integers() const;
+    QList<double> doubles() const;
+    QStringList strings() const;
+    QVariantList variants() const;
+
+    void reserve(qsizetype rows);
+    void clear();
+
+    void appendInteger(qint64 value);
+    void appendDouble(double value);
+    void appendString(const QString &value);
+    void appendString(QString &&value);
+    void appendVariant(const QVariant &value);
+    void appendNull();
+
+private:
+    QSharedDataPointer<QSqlColumnBufferPrivate> d;
+};
+
+Q_DECLARE_SHARED(QSqlColumnBuffer)
+
+QT_END_NAMESPACE
+
+#endif // QSQLCOLUMNBUFFER_H
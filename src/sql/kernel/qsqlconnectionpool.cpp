@@ -0,0 +1,556 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsqlconnectionpool.h"
+
+#include "qsqldriver.h"
+#include "qsqlquery.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+QT_BEGIN_NAMESPACE
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+/*!
+    \class QSqlConnectionPool
+    \brief The QSqlConnectionPool class keeps a pool of open database
+    connections that can be shared by many threads.
+    \since 6.8
+
+    \ingroup database
+    \inmodule QtSql
+
+    A QSqlDatabase connection can only be used by the thread that created it,
+    so code that runs in a QThreadPool, or with QtConcurrent, has to open a
+    connection of its own, paying for the connection handshake and
+    authentication every time. QSqlConnectionPool keeps connections open
+    between uses instead, and hands them to whichever thread needs one.
+
+    The pool opens its connections with the settings of a \e prototype
+    connection, which need not be open itself: the driver, database name,
+    user name, password, host name, port, connect options and numerical
+    precision policy are copied from it. Call acquire() to get an open
+    connection, and release() to return it to the pool once done:
+
+    \snippet code/src_sql_kernel_qsqlconnectionpool.cpp 0
+
+    acquire() reuses an idle connection if there is one, and opens a new one
+    otherwise, unless maximumSize() connections are in use already; it then
+    waits for another thread to release one, until its deadline expires.
+    The connections the pool opens are added to the list of connections
+    (see QSqlDatabase::connectionNames()) with names that start with the
+    pool's name(), followed by a slash.
+
+    A connection must be released by the thread that acquired it, and it
+    must not be used once released. The connection's QSqlQuery objects
+    should be gone by then, and no transaction should be in progress.
+
+    Before an idle connection is handed out, the pool checks that it is still
+    open, and runs validationQuery() if set. When a connection is released,
+    the pool runs resetQuery() to bring its session back to a clean state.
+    A connection that fails either is closed and removed, as are connections
+    that have been idle for longer than idleTimeout().
+
+    statistics() reports how busy the pool is. In particular, the ratio of
+    Statistics::waitCount to Statistics::acquireCount tells how often
+    acquire() found the pool saturated, and Statistics::totalWaitTime how
+    long the callers waited in total.
+
+    All functions of QSqlConnectionPool are thread-safe.
+
+    \sa QSqlDatabase::cloneDatabase()
+*/
+
+/*!
+    \class QSqlConnectionPool::Statistics
+    \inmodule QtSql
+    \since 6.8
+
+    \brief The Statistics struct reports the usage of a QSqlConnectionPool.
+
+    \variable QSqlConnectionPool::Statistics::size
+    \brief The number of open connections, both idle and in use.
+
+    \variable QSqlConnectionPool::Statistics::idleCount
+    \brief The number of open connections waiting in the pool.
+
+    \variable QSqlConnectionPool::Statistics::inUseCount
+    \brief The number of connections that have been acquired but not released.
+
+    \variable QSqlConnectionPool::Statistics::peakInUseCount
+    \brief The highest number of connections that were in use at once.
+
+    \variable QSqlConnectionPool::Statistics::acquireCount
+    \brief The number of successful calls to acquire().
+
+    \variable QSqlConnectionPool::Statistics::waitCount
+    \brief The number of calls to acquire() that had to wait for a
+    connection, because maximumSize() connections were in use.
+
+    \variable QSqlConnectionPool::Statistics::timeoutCount
+    \brief The number of calls to acquire() that failed because their
+    deadline expired.
+
+    \variable QSqlConnectionPool::Statistics::openCount
+    \brief The number of connections the pool has opened.
+
+    \variable QSqlConnectionPool::Statistics::discardCount
+    \brief The number of connections the pool has closed because they failed
+    validation or reset, or had been idle for too long.
+
+    \variable QSqlConnectionPool::Statistics::totalWaitTime
+    \brief The time the callers of acquire() spent waiting for a connection
+    to be released.
+
+    \variable QSqlConnectionPool::Statistics::maximumWaitTime
+    \brief The longest time a single call to acquire() waited for a
+    connection to be released.
+*/
+
+class QSqlConnectionPoolPrivate
+{
+public:
+    struct IdleConnection
+    {
+        QSqlDatabase db;
+        QElapsedTimer idleSince;
+    };
+
+    QSqlDatabase openConnection();
+    bool activate(const QSqlDatabase &db) const;
+    bool deactivate(const QSqlDatabase &db) const;
+    static void discard(QSqlDatabase &db);
+    QList<QSqlDatabase> takeExpired();
+    void acquired(const QSqlDatabase &db, const QElapsedTimer &waitTimer);
+
+    static QString defaultResetQuery(const QString &driverName);
+
+    QString name;
+    QString driverName;
+    QString databaseName;
+    QString userName;
+    QString password;
+    QString hostName;
+    int port = -1;
+    QString connectOptions;
+    QSql::NumericalPrecisionPolicy precisionPolicy = QSql::LowPrecisionDouble;
+
+    mutable QMutex mutex;
+    QWaitCondition released;
+    // Least recently released first; acquire() takes from the back, so the
+    // connections that are used least often are the ones that expire:
+    QList<IdleConnection> idle;
+    QSet<QString> inUse;
+    // Connections being opened, counted against maximumSize:
+    int opening = 0;
+    quint64 nextId = 0;
+
+    int maximumSize = QThread::idealThreadCount();
+    std::chrono::milliseconds idleTimeout = 5min;
+    QString validationQuery;
+    QString resetQuery;
+
+    QSqlError error;
+    QSqlConnectionPool::Statistics stats;
+};
+
+QString QSqlConnectionPoolPrivate::defaultResetQuery(const QString &driverName)
+{
+    // Not DISCARD ALL, which would also reset the session settings the
+    // driver made when it opened the connection:
+    if (driverName == "QPSQL"_L1)
+        return u"CLOSE ALL; SELECT pg_advisory_unlock_all(); DISCARD TEMP"_s;
+    return QString();
+}
+
+// Called without the mutex held.
+QSqlDatabase QSqlConnectionPoolPrivate::openConnection()
+{
+    QString connectionName;
+    {
+        QMutexLocker locker(&mutex);
+        connectionName = name + u'/' + QString::number(nextId++);
+    }
+    QSqlDatabase db = QSqlDatabase::addDatabase(driverName, connectionName);
+    db.setDatabaseName(databaseName);
+    db.setUserName(userName);
+    db.setPassword(password);
+    db.setHostName(hostName);
+    db.setPort(port);
+    db.setConnectOptions(connectOptions);
+    db.setNumericalPrecisionPolicy(precisionPolicy);
+    db.open();
+    return db;
+}
+
+// Hands an idle connection to the calling thread. Called without the mutex
+// held.
+bool QSqlConnectionPoolPrivate::activate(const QSqlDatabase &db) const
+{
+    // Idle connections have no thread affinity, which allows the calling
+    // thread to pull them:
+    db.driver()->moveToThread(QThread::currentThread());
+    if (!db.isOpen())
+        return false;
+    if (validationQuery.isEmpty())
+        return true;
+    QSqlQuery query(db);
+    return query.exec(validationQuery);
+}
+
+// Prepares a released connection for being idle. Called without the mutex
+// held.
+bool QSqlConnectionPoolPrivate::deactivate(const QSqlDatabase &db) const
+{
+    QSqlDriver *driver = db.driver();
+    if (!db.isOpen() || driver->thread() != QThread::currentThread())
+        return false;
+    if (!resetQuery.isEmpty()) {
+        QSqlQuery query(db);
+        if (!query.exec(resetQuery))
+            return false;
+    }
+    driver->moveToThread(nullptr);
+    return true;
+}
+
+// Closes and removes a connection; db must be the pool's last reference to
+// it. Called without the mutex held.
+void QSqlConnectionPoolPrivate::discard(QSqlDatabase &db)
+{
+    const QString connectionName = db.connectionName();
+    db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+// Called with the mutex held.
+QList<QSqlDatabase> QSqlConnectionPoolPrivate::takeExpired()
+{
+    QList<QSqlDatabase> expired;
+    if (idleTimeout <= 0ms)
+        return expired;
+    while (!idle.isEmpty() && idle.constFirst().idleSince.durationElapsed() >= idleTimeout)
+        expired.append(idle.takeFirst().db);
+    stats.discardCount += expired.size();
+    return expired;
+}
+
+// Called with the mutex held.
+void QSqlConnectionPoolPrivate::acquired(const QSqlDatabase &db, const QElapsedTimer &waitTimer)
+{
+    inUse.insert(db.connectionName());
+    ++stats.acquireCount;
+    stats.peakInUseCount = qMax(stats.peakInUseCount, int(inUse.size()));
+    if (waitTimer.isValid()) {
+        const std::chrono::nanoseconds waited = waitTimer.durationElapsed();
+        stats.totalWaitTime += waited;
+        stats.maximumWaitTime = qMax(stats.maximumWaitTime, waited);
+    }
+}
+
+/*!
+    Constructs a connection pool that opens its connections with the settings
+    of \a prototype. The names of the connections start with \a name, which
+    must be unique among the pools of the application; if \a name is empty,
+    a unique name is chosen.
+
+    The resetQuery() is set to a default suitable for the driver.
+*/
+QSqlConnectionPool::QSqlConnectionPool(const QSqlDatabase &prototype, const QString &name)
+    : d(new QSqlConnectionPoolPrivate)
+{
+    d->name = name.isEmpty()
+            ? u"qt_sql_pool_0x"_s + QString::number(quintptr(this), 16)
+            : name;
+    d->driverName = prototype.driverName();
+    d->databaseName = prototype.databaseName();
+    d->userName = prototype.userName();
+    d->password = prototype.password();
+    d->hostName = prototype.hostName();
+    d->port = prototype.port();
+    d->connectOptions = prototype.connectOptions();
+    d->precisionPolicy = prototype.numericalPrecisionPolicy();
+    d->resetQuery = QSqlConnectionPoolPrivate::defaultResetQuery(d->driverName);
+}
+
+/*!
+    Destroys the pool, and closes and removes its connections. All
+    connections should have been released by then.
+*/
+QSqlConnectionPool::~QSqlConnectionPool()
+{
+    clear();
+    QMutexLocker locker(&d->mutex);
+    const QSet<QString> inUse = std::exchange(d->inUse, {});
+    locker.unlock();
+    for (const QString &connectionName : inUse) {
+        qWarning("QSqlConnectionPool: connection '%s' is still in use, and will be removed",
+                 qPrintable(connectionName));
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+/*!
+    Returns the name of the pool, with which the names of its connections
+    start.
+*/
+QString QSqlConnectionPool::name() const
+{
+    return d->name;
+}
+
+/*!
+    Sets the maximum number of connections that can be in use at once to
+    \a size. The default is QThread::idealThreadCount(), which is also the
+    default maximum number of threads of a QThreadPool.
+
+    \sa acquire(), Statistics::waitCount
+*/
+void QSqlConnectionPool::setMaximumSize(int size)
+{
+    QMutexLocker locker(&d->mutex);
+    d->maximumSize = qMax(size, 1);
+    d->released.wakeAll();
+}
+
+/*!
+    Returns the maximum number of connections that can be in use at once.
+*/
+int QSqlConnectionPool::maximumSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->maximumSize;
+}
+
+/*!
+    Sets the time after which an idle connection is closed to \a timeout.
+    The default is five minutes. If \a timeout is zero, idle connections are
+    kept open until clear() is called or the pool is destroyed.
+
+    Idle connections are closed by the next call to acquire() or release()
+    after they expired.
+*/
+void QSqlConnectionPool::setIdleTimeout(std::chrono::milliseconds timeout)
+{
+    QMutexLocker locker(&d->mutex);
+    d->idleTimeout = timeout;
+}
+
+/*!
+    Returns the time after which an idle connection is closed.
+*/
+std::chrono::milliseconds QSqlConnectionPool::idleTimeout() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->idleTimeout;
+}
+
+/*!
+    Sets the statement that acquire() runs on an idle connection before
+    handing it out to \a query, for example \c{SELECT 1}. If it fails, the
+    connection is discarded. By default, no statement is run, and acquire()
+    only checks that the connection is open.
+*/
+void QSqlConnectionPool::setValidationQuery(const QString &query)
+{
+    QMutexLocker locker(&d->mutex);
+    d->validationQuery = query;
+}
+
+/*!
+    Returns the statement that validates idle connections.
+*/
+QString QSqlConnectionPool::validationQuery() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->validationQuery;
+}
+
+/*!
+    Sets the statement that release() runs to reset the session of a
+    connection to \a query. If it fails, the connection is discarded.
+
+    The default depends on the driver. For QPSQL, it closes open cursors,
+    releases advisory locks and drops temporary tables; other drivers have
+    none.
+*/
+void QSqlConnectionPool::setResetQuery(const QString &query)
+{
+    QMutexLocker locker(&d->mutex);
+    d->resetQuery = query;
+}
+
+/*!
+    Returns the statement that resets released connections.
+*/
+QString QSqlConnectionPool::resetQuery() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->resetQuery;
+}
+
+/*!
+    Returns an open connection for use by the calling thread, or an invalid
+    QSqlDatabase if no connection could be opened, or \a deadline expired
+    while maximumSize() connections were in use. lastError() tells why.
+
+    The connection must be returned with release() from the same thread.
+*/
+QSqlDatabase QSqlConnectionPool::acquire(QDeadlineTimer deadline)
+{
+    QElapsedTimer waitTimer;
+    QMutexLocker locker(&d->mutex);
+    for (;;) {
+        QList<QSqlDatabase> expired = d->takeExpired();
+        if (!expired.isEmpty()) {
+            locker.unlock();
+            for (QSqlDatabase &db : expired)
+                QSqlConnectionPoolPrivate::discard(db);
+            locker.relock();
+            continue;
+        }
+
+        if (!d->idle.isEmpty()) {
+            QSqlDatabase db = d->idle.takeLast().db;
+            const QString connectionName = db.connectionName();
+            // Reserve its place while we validate it:
+            d->inUse.insert(connectionName);
+            locker.unlock();
+            const bool valid = d->activate(db);
+            if (!valid)
+                QSqlConnectionPoolPrivate::discard(db);
+            locker.relock();
+            d->inUse.remove(connectionName);
+            if (valid) {
+                d->acquired(db, waitTimer);
+                return db;
+            }
+            ++d->stats.discardCount;
+            continue;
+        }
+
+        if (d->inUse.size() + d->opening < d->maximumSize) {
+            ++d->opening;
+            locker.unlock();
+            QSqlDatabase db = d->openConnection();
+            const bool valid = db.isOpen();
+            const QSqlError error = db.lastError();
+            if (!valid)
+                QSqlConnectionPoolPrivate::discard(db);
+            locker.relock();
+            --d->opening;
+            if (!valid) {
+                d->error = error;
+                d->released.wakeOne();
+                return QSqlDatabase();
+            }
+            ++d->stats.openCount;
+            d->acquired(db, waitTimer);
+            return db;
+        }
+
+        if (!waitTimer.isValid()) {
+            waitTimer.start();
+            ++d->stats.waitCount;
+        }
+        if (!d->released.wait(&d->mutex, deadline)) {
+            ++d->stats.timeoutCount;
+            const std::chrono::nanoseconds waited = waitTimer.durationElapsed();
+            d->stats.totalWaitTime += waited;
+            d->stats.maximumWaitTime = qMax(d->stats.maximumWaitTime, waited);
+            d->error = QSqlError(QCoreApplication::translate("QSqlConnectionPool",
+                                                             "Timed out waiting for a connection"),
+                                 QString(), QSqlError::ConnectionError);
+            return QSqlDatabase();
+        }
+    }
+}
+
+/*!
+    Returns \a connection, which must have been acquired from this pool by
+    the calling thread, to the pool, and resets \a connection to an invalid
+    QSqlDatabase.
+
+    \sa acquire(), resetQuery()
+*/
+void QSqlConnectionPool::release(QSqlDatabase &connection)
+{
+    const QString connectionName = connection.connectionName();
+    QMutexLocker locker(&d->mutex);
+    if (!d->inUse.contains(connectionName)) {
+        qWarning("QSqlConnectionPool::release: connection '%s' is not in use from pool '%s'",
+                 qPrintable(connectionName), qPrintable(d->name));
+        return;
+    }
+    QList<QSqlDatabase> expired = d->takeExpired();
+    locker.unlock();
+
+    for (QSqlDatabase &db : expired)
+        QSqlConnectionPoolPrivate::discard(db);
+
+    QSqlDatabase db = std::exchange(connection, QSqlDatabase());
+    if (db.driver()->thread() != QThread::currentThread()) {
+        qWarning("QSqlConnectionPool::release: connection '%s' was acquired by another thread",
+                 qPrintable(connectionName));
+    }
+    const bool reusable = d->deactivate(db);
+    if (!reusable)
+        QSqlConnectionPoolPrivate::discard(db);
+
+    locker.relock();
+    d->inUse.remove(connectionName);
+    if (reusable) {
+        QElapsedTimer idleSince;
+        idleSince.start();
+        d->idle.append({ std::move(db), idleSince });
+    } else {
+        ++d->stats.discardCount;
+    }
+    d->released.wakeOne();
+}
+
+/*!
+    Closes and removes the idle connections of the pool. Connections in use
+    are not affected.
+*/
+void QSqlConnectionPool::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    QList<QSqlConnectionPoolPrivate::IdleConnection> idle = std::exchange(d->idle, {});
+    locker.unlock();
+    for (auto &connection : idle)
+        QSqlConnectionPoolPrivate::discard(connection.db);
+}
+
+/*!
+    Returns information about the last error that made acquire() fail.
+*/
+QSqlError QSqlConnectionPool::lastError() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->error;
+}
+
+/*!
+    Returns the current usage statistics of the pool.
+*/
+QSqlConnectionPool::Statistics QSqlConnectionPool::statistics() const
+{
+    QMutexLocker locker(&d->mutex);
+    Statistics stats = d->stats;
+    stats.idleCount = int(d->idle.size());
+    stats.inUseCount = int(d->inUse.size());
+    stats.size = stats.idleCount + stats.inUseCount;
+    return stats;
+}
+
+QT_END_NAMESPACE
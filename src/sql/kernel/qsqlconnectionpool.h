@@ -0,0 +1,69 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSQLCONNECTIONPOOL_H
+#define QSQLCONNECTIONPOOL_H
+
+#include <QtSql/qtsqlglobal.h>
+#include <QtSql/qsqldatabase.h>
+#include <QtSql/qsqlerror.h>
+
+#include <QtCore/qdeadlinetimer.h>
+#include <QtCore/qstring.h>
+
+#include <chrono>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QSqlConnectionPoolPrivate;
+class Q_SQL_EXPORT QSqlConnectionPool
+{
+public:
+    struct Statistics
+    {
+        int size = 0;
+        int idleCount = 0;
+        int inUseCount = 0;
+        int peakInUseCount = 0;
+        qint64 acquireCount = 0;
+        qint64 waitCount = 0;
+        qint64 timeoutCount = 0;
+        qint64 openCount = 0;
+        qint64 discardCount = 0;
+        std::chrono::nanoseconds totalWaitTime{0};
+        std::chrono::nanoseconds maximumWaitTime{0};
+    };
+
+    explicit QSqlConnectionPool(const QSqlDatabase &prototype, const QString &name = QString());
+    ~QSqlConnectionPool();
+
+    QString name() const;
+
+    void setMaximumSize(int size);
+    int maximumSize() const;
+
+    void setIdleTimeout(std::chrono::milliseconds timeout);
+    std::chrono::milliseconds idleTimeout() const;
+
+    void setValidationQuery(const QString &query);
+    QString validationQuery() const;
+
+    void setResetQuery(const QString &query);
+    QString resetQuery() const;
+
+    QSqlDatabase acquire(QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+    void release(QSqlDatabase &connection);
+    void clear();
+
+    QSqlError lastError() const;
+    Statistics statistics() const;
+
+private:
+    Q_DISABLE_COPY_MOVE(QSqlConnectionPool)
+    std::unique_ptr<QSqlConnectionPoolPrivate> d;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSQLCONNECTIONPOOL_H
@@ -7,11 +7,13 @@
 
 #include "qatomic.h"
 #include "qdebug.h"
+#include "qsqlfield.h"
 #include "qsqlrecord.h"
 #include "qsqlresult.h"
 #include "qsqldriver.h"
 #include "qsqldatabase.h"
 #include "private/qsqlnulldriver_p.h"
+#include "private/qsqlresult_p.h"
 
 #ifdef QT_DEBUG_SQL
 #include "qelapsedtimer.h"
@@ -668,6 +670,118 @@ bool QSqlQuery::next()
     }
 }
 
+static QSqlColumnBuffer::Type qColumnBufferType(QMetaType type,
+                                               QSql::NumericalPrecisionPolicy precisionPolicy)
+{
+    switch (type.id()) {
+    case QMetaType::Bool:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::UChar:
+    case QMetaType::Short:
+    case QMetaType::UShort:
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        return QSqlColumnBuffer::Type::Integer;
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        // Values above the range of qint64 would wrap around
+        return sizeof(ulong) < sizeof(qint64) && type.id() == QMetaType::ULong
+                ? QSqlColumnBuffer::Type::Integer : QSqlColumnBuffer::Type::Variant;
+    case QMetaType::Float:
+    case QMetaType::Double:
+        switch (precisionPolicy) {
+        case QSql::LowPrecisionInt32:
+        case QSql::LowPrecisionInt64:
+            return QSqlColumnBuffer::Type::Integer;
+        case QSql::LowPrecisionDouble:
+            return QSqlColumnBuffer::Type::Double;
+        case QSql::HighPrecision:
+            break;
+        }
+        // Drivers return some of them as strings, to not lose precision
+        return QSqlColumnBuffer::Type::Variant;
+    case QMetaType::QString:
+        return QSqlColumnBuffer::Type::String;
+    default:
+        break;
+    }
+    return QSqlColumnBuffer::Type::Variant;
+}
+
+/*!
+    \since 6.8
+
+    Retrieves up to \a maxRows records following the current one, and
+    returns their values column by column, one QSqlColumnBuffer for each
+    field of record(). The query is positioned on the last record retrieved,
+    as if next() had been called for each of them; if fewer than \a maxRows
+    records were left, it is positioned after the last record. An empty list
+    is returned if the query is not \l{isActive()}{active}, is not a
+    \l{isSelect()}{SELECT} statement, or is already positioned after the
+    last record.
+
+    The type of a column's buffer follows the field's type: integral and
+    boolean fields are stored as QSqlColumnBuffer::Type::Integer, strings as
+    QSqlColumnBuffer::Type::String, and floating point fields depending on
+    numericalPrecisionPolicy(): as QSqlColumnBuffer::Type::Integer for the
+    low precision integer policies, as QSqlColumnBuffer::Type::Double for
+    QSql::LowPrecisionDouble, and as they would be returned by value() for
+    QSql::HighPrecision. Fields of other types are stored as variants; so are
+    unsigned 64-bit integers, whose values need not fit into a qint64.
+
+    Drivers that support it decode the values of the retrieved records
+    directly into the column buffers, without creating a QVariant for each
+    value; this makes reading large result sets considerably faster than
+    calling value() for each field of each record. Use a
+    \l{setForwardOnly()}{forward only} query for the best performance.
+
+    \sa next(), value(), setForwardOnly()
+*/
+QList<QSqlColumnBuffer> QSqlQuery::fetchColumns(int maxRows)
+{
+    QList<QSqlColumnBuffer> columns;
+    if (!isSelect() || !isActive() || maxRows <= 0 || at() == QSql::AfterLastRow)
+        return columns;
+
+    const QSqlRecord rec = d->sqlResult->record();
+    const QSql::NumericalPrecisionPolicy precisionPolicy = numericalPrecisionPolicy();
+    columns.reserve(rec.count());
+    for (int i = 0; i < rec.count(); ++i) {
+        columns.emplace_back(qColumnBufferType(rec.field(i).metaType(), precisionPolicy));
+        columns.last().reserve(maxRows);
+    }
+
+    QSqlFetchColumnsData data;
+    data.columns = &columns;
+    data.maxRows = maxRows;
+    d->sqlResult->virtual_hook(QSqlResult::FetchColumnsOperation, &data);
+    if (!data.handled) {
+        // One QVariant per value after all
+        while (data.rowsFetched < maxRows) {
+            const bool fetched = at() == QSql::BeforeFirstRow ? d->sqlResult->fetchFirst()
+                                                              : d->sqlResult->fetchNext();
+            if (!fetched)
+                break;
+            for (int i = 0; i < columns.size(); ++i) {
+                QSqlColumnBuffer &column = columns[i];
+                if (!d->sqlResult->isNull(i))
+                    column.appendVariant(d->sqlResult->data(i));
+                else if (column.type() == QSqlColumnBuffer::Type::Variant)
+                    column.appendVariant(QVariant(rec.field(i).metaType()));
+                else
+                    column.appendNull();
+            }
+            ++data.rowsFetched;
+        }
+    }
+    if (data.rowsFetched < maxRows)
+        d->sqlResult->setAt(QSql::AfterLastRow);
+    return columns;
+}
+
 /*!
 
   Retrieves the previous record in the result, if available, and
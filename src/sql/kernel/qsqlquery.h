@@ -5,6 +5,7 @@
 #define QSQLQUERY_H
 
 #include <QtSql/qtsqlglobal.h>
+#include <QtSql/qsqlcolumnbuffer.h>
 #include <QtSql/qsqldatabase.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qvariant.h>
@@ -74,6 +75,7 @@ public:
 
     bool seek(int i, bool relative = false);
     bool next();
+    QList<QSqlColumnBuffer> fetchColumns(int maxRows);
     bool previous();
     bool first();
     bool last();
@@ -20,6 +20,7 @@
 #include <QtCore/qhash.h>
 #include "qsqlerror.h"
 #include "qsqlresult.h"
+#include "qsqlcolumnbuffer.h"
 #include "qsqldriver.h"
 
 QT_BEGIN_NAMESPACE
@@ -29,6 +30,19 @@ QT_BEGIN_NAMESPACE
     inline const Class##Private* drv_d_func() const { return !sqldriver ? nullptr : reinterpret_cast<const Class *>(static_cast<const QSqlDriver*>(sqldriver))->d_func(); } \
     inline Class##Private* drv_d_func()  { return !sqldriver ? nullptr : reinterpret_cast<Class *>(static_cast<QSqlDriver*>(sqldriver))->d_func(); }
 
+// The argument of QSqlResult::virtual_hook(QSqlResult::FetchColumnsOperation).
+// A result that supports it appends up to maxRows rows following the current
+// one to the columns, whose types QSqlQuery::fetchColumns() has chosen,
+// leaves the result positioned on the last of them, and sets handled.
+// Fetching fewer than maxRows rows means the result set is exhausted.
+struct QSqlFetchColumnsData
+{
+    QList<QSqlColumnBuffer> *columns = nullptr;
+    int maxRows = 0;
+    int rowsFetched = 0;
+    bool handled = false;
+};
+
 struct QHolder {
     QHolder(const QString &hldr = QString(), qsizetype index = -1): holderName(hldr), holderPos(index) { }
     bool operator==(const QHolder &h) const { return h.holderPos == holderPos && h.holderName == holderName; }
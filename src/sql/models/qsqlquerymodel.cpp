@@ -12,8 +12,6 @@ QT_BEGIN_NAMESPACE
 
 using namespace Qt::StringLiterals;
 
-#define QSQL_PREFETCH 255
-
 void QSqlQueryModelPrivate::prefetch(int limit)
 {
     Q_Q(QSqlQueryModel);
@@ -66,6 +64,211 @@ int QSqlQueryModelPrivate::columnInQuery(int modelColumn) const
     return modelColumn - colOffsets[modelColumn];
 }
 
+void QSqlQueryModelPrivate::startFetcher(const QString &statement, const QSqlDatabase &db)
+{
+    Q_Q(QSqlQueryModel);
+    const QString connectionName = db.isValid() ? db.connectionName()
+                                                : QLatin1StringView(QSqlDatabase::defaultConnection);
+    fetcher = std::make_unique<QSqlQueryModelFetcher>(this, q, fetchGeneration, connectionName,
+                                                      statement, fetchBatchSize);
+    // One batch for the view, and one to have ready when it scrolls down:
+    fetcher->requestRows(2 * fetchBatchSize);
+    fetcher->start();
+}
+
+void QSqlQueryModelPrivate::stopFetcher()
+{
+    // Results the old worker has already posted are dropped by processFetched():
+    ++fetchGeneration;
+    if (fetcher) {
+        fetcher->cancel();
+        fetcher->wait();
+        fetcher.reset();
+    }
+    fetchedColumns.clear();
+    fetchedInBackground = false;
+}
+
+void QSqlQueryModelPrivate::processFetched(int generation)
+{
+    Q_Q(QSqlQueryModel);
+    if (generation != fetchGeneration || !fetcher)
+        return;
+
+    QSqlQueryModelFetcher::Results results = fetcher->takeResults();
+    if (results.hasRecord) {
+        // The columns are only known once the worker has executed the query:
+        q->beginResetModel();
+        rec = results.record;
+        initColOffsets(rec.count());
+        fetchedColumns.resize(rec.count());
+        bottom = q->createIndex(-1, rec.count() - 1);
+        q->endResetModel();
+    }
+
+    if (results.rowCount > 0) {
+        const int first = bottom.row() + 1;
+        const int last = first + results.rowCount - 1;
+        q->beginInsertRows(QModelIndex(), first, last);
+        for (qsizetype i = 0; i < fetchedColumns.size(); ++i)
+            fetchedColumns[i].append(std::move(results.columns[i]));
+        bottom = q->createIndex(last, bottom.column());
+        q->endInsertRows();
+        emit q->fetchProgress(last + 1);
+    }
+
+    if (results.finished) {
+        atEnd = true;
+        error = results.error;
+        fetcher->wait();
+        fetcher.reset();
+        emit q->fetchFinished();
+    }
+}
+
+QSqlQueryModelFetcher::QSqlQueryModelFetcher(QSqlQueryModelPrivate *d, QObject *model,
+                                             int generation, const QString &connectionName,
+                                             const QString &statement, int batchSize)
+    : d(d),
+      model(model),
+      generation(generation),
+      connectionName(connectionName),
+      statement(statement),
+      batchSize(batchSize)
+{
+}
+
+QSqlQueryModelFetcher::~QSqlQueryModelFetcher()
+{
+    cancel();
+    wait();
+}
+
+void QSqlQueryModelFetcher::requestRows(int limit)
+{
+    QMutexLocker locker(&mutex);
+    if (limit > rowLimit) {
+        rowLimit = limit;
+        demand.wakeOne();
+    }
+}
+
+void QSqlQueryModelFetcher::cancel()
+{
+    QMutexLocker locker(&mutex);
+    cancelled = true;
+    demand.wakeOne();
+}
+
+QSqlQueryModelFetcher::Results QSqlQueryModelFetcher::takeResults()
+{
+    QMutexLocker locker(&mutex);
+    notifyPending = false;
+    return std::exchange(results, Results());
+}
+
+void QSqlQueryModelFetcher::run()
+{
+    const QString cloneName = "qt_sql_querymodel_fetcher_"_L1
+                              + QString::number(quintptr(this), 16);
+    {
+        // A connection may only be used by the thread that created it, so
+        // the clone is made (and its driver is created) here:
+        QSqlDatabase db = QSqlDatabase::cloneDatabase(connectionName, cloneName);
+        if (!db.open()) {
+            finish(db.lastError());
+        } else {
+            QSqlQuery query(db);
+            // We never go back, and the model caches what it has seen:
+            query.setForwardOnly(true);
+            if (query.exec(statement))
+                fetch(query);
+            else
+                finish(query.lastError());
+        }
+    }
+    QSqlDatabase::removeDatabase(cloneName);
+}
+
+void QSqlQueryModelFetcher::fetch(QSqlQuery &query)
+{
+    const QSqlRecord record = query.record();
+    const int columnCount = record.count();
+    {
+        QMutexLocker locker(&mutex);
+        results.record = record;
+        results.hasRecord = true;
+        notify();
+    }
+
+    int fetched = 0;
+    bool atEnd = false;
+    while (!atEnd) {
+        const int limit = waitForDemand(fetched);
+        if (limit < 0)
+            return;
+
+        const int count = qMin(batchSize, limit - fetched);
+        QList<QList<QVariant>> columns(columnCount);
+        for (QList<QVariant> &column : columns)
+            column.reserve(count);
+        int rows = 0;
+        while (rows < count && !cancelled) {
+            if (!query.next()) {
+                atEnd = true;
+                break;
+            }
+            for (int i = 0; i < columnCount; ++i)
+                columns[i].append(query.value(i));
+            ++rows;
+        }
+        fetched += rows;
+
+        QMutexLocker locker(&mutex);
+        if (cancelled)
+            return;
+        // The model may not have picked up the previous batch yet, in which
+        // case it gets both with a single row insertion:
+        results.columns.resize(columnCount);
+        for (int i = 0; i < columnCount; ++i)
+            results.columns[i].append(std::move(columns[i]));
+        results.rowCount += rows;
+        if (atEnd) {
+            results.finished = true;
+            if (query.lastError().isValid())
+                results.error = query.lastError();
+        }
+        notify();
+    }
+}
+
+int QSqlQueryModelFetcher::waitForDemand(int fetched)
+{
+    QMutexLocker locker(&mutex);
+    while (!cancelled && fetched >= rowLimit)
+        demand.wait(&mutex);
+    return cancelled ? -1 : rowLimit;
+}
+
+void QSqlQueryModelFetcher::finish(const QSqlError &error)
+{
+    QMutexLocker locker(&mutex);
+    results.error = error;
+    results.finished = true;
+    notify();
+}
+
+void QSqlQueryModelFetcher::notify()
+{
+    // Called with the mutex locked.
+    if (cancelled || notifyPending)
+        return;
+    notifyPending = true;
+    QMetaObject::invokeMethod(model, [d = d, generation = generation] {
+        d->processFetched(generation);
+    }, Qt::QueuedConnection);
+}
+
 /*!
     \class QSqlQueryModel
     \brief The QSqlQueryModel class provides a read-only data model for SQL
@@ -110,6 +313,12 @@ int QSqlQueryModelPrivate::columnInQuery(int modelColumn) const
     a query, the model will fetch rows incrementally.
     See fetchMore() for more information.
 
+    With setBackgroundFetch(), a query set as a string is executed by a
+    worker thread on a clone of the connection instead, and the rows it
+    fetches are added to the model in batches as they arrive, so that
+    network roundtrips to the database server do not block the thread the
+    model lives in.
+
     \sa QSqlTableModel, QSqlRelationalTableModel, QSqlQuery,
         {Model/View Programming}, {Query Model Example}
 */
@@ -136,6 +345,8 @@ QSqlQueryModel::QSqlQueryModel(QSqlQueryModelPrivate &dd, QObject *parent)
 */
 QSqlQueryModel::~QSqlQueryModel()
 {
+    Q_D(QSqlQueryModel);
+    d->stopFetcher();
 }
 
 /*!
@@ -151,14 +362,23 @@ QSqlQueryModel::~QSqlQueryModel()
 
     \a parent should always be an invalid QModelIndex.
 
-    \sa canFetchMore()
+    If the query is fetched in the background, fetchMore() does not block;
+    it lets the worker read further ahead, and the rows are inserted once
+    they have arrived.
+
+    \sa canFetchMore(), fetchBatchSize(), backgroundFetch()
 */
 void QSqlQueryModel::fetchMore(const QModelIndex &parent)
 {
     Q_D(QSqlQueryModel);
     if (parent.isValid())
         return;
-    d->prefetch(qMax(d->bottom.row(), 0) + QSQL_PREFETCH);
+    if (d->fetchedInBackground) {
+        if (d->fetcher)
+            d->fetcher->requestRows(rowCount() + 2 * d->fetchBatchSize);
+        return;
+    }
+    d->prefetch(qMax(d->bottom.row(), 0) + d->fetchBatchSize);
 }
 
 /*!
@@ -178,6 +398,125 @@ bool QSqlQueryModel::canFetchMore(const QModelIndex &parent) const
     return (!parent.isValid() && !d->atEnd);
 }
 
+/*!
+    \since 6.8
+
+    Sets the number of rows fetchMore() fetches at a time to \a size. When
+    the query is fetched in the background, this is also the number of rows
+    the worker thread fetches before it hands them over to the model.
+
+    The default is 255. A new size takes effect with the next query.
+
+    \sa fetchBatchSize(), fetchMore()
+*/
+void QSqlQueryModel::setFetchBatchSize(int size)
+{
+    Q_D(QSqlQueryModel);
+    d->fetchBatchSize = qMax(size, 1);
+}
+
+/*!
+    \since 6.8
+
+    Returns the number of rows fetchMore() fetches at a time.
+
+    \sa setFetchBatchSize()
+*/
+int QSqlQueryModel::fetchBatchSize() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->fetchBatchSize;
+}
+
+/*!
+    \since 6.8
+
+    If \a enabled is \c true, queries set with
+    \l{setQuery(const QString &, const QSqlDatabase &)}{setQuery()} are
+    executed and fetched in a worker thread. The worker opens its own clone
+    of the database connection (see QSqlDatabase::cloneDatabase()), fetches
+    the rows with a forward-only query, and keeps a couple of batches of
+    fetchBatchSize() rows ahead of what fetchMore() asked for. The model
+    caches the values, column by column, and inserts the rows in batches as
+    they arrive, emitting fetchProgress(). Once the result set is exhausted,
+    or an error has occurred, fetchFinished() is emitted.
+
+    setQuery() returns straight away: the model is empty until the query has
+    been executed, at which point it is reset again with the columns of the
+    result. Errors are reported by lastError() once fetchFinished() has been
+    emitted. query() returns an inactive query while fetching in the
+    background.
+
+    Background fetching requires a driver that can be used from a thread
+    other than the one the connection was made in, and a database a second
+    connection sees the same data in; in particular, an in-memory SQLite
+    database is not shared with its clone. Queries set with
+    \l{setQuery(QSqlQuery &&)}{a QSqlQuery} are always fetched in the
+    calling thread.
+
+    Destroying the model, calling clear(), or setting a new query waits for
+    the worker to finish the row it is fetching.
+
+    The default is \c false. The setting takes effect with the next query.
+
+    \sa backgroundFetch(), isFetching(), fetchBatchSize()
+*/
+void QSqlQueryModel::setBackgroundFetch(bool enabled)
+{
+    Q_D(QSqlQueryModel);
+    d->backgroundFetch = enabled;
+}
+
+/*!
+    \since 6.8
+
+    Returns \c true if queries set as a string are fetched in a worker
+    thread.
+
+    \sa setBackgroundFetch()
+*/
+bool QSqlQueryModel::backgroundFetch() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->backgroundFetch;
+}
+
+/*!
+    \since 6.8
+
+    Returns \c true while a worker thread is executing the model's query or
+    fetching its rows.
+
+    \sa setBackgroundFetch(), fetchFinished()
+*/
+bool QSqlQueryModel::isFetching() const
+{
+    Q_D(const QSqlQueryModel);
+    return d->fetcher != nullptr;
+}
+
+/*!
+    \fn void QSqlQueryModel::fetchProgress(int rowCount)
+    \since 6.8
+
+    This signal is emitted when rows fetched in the background have been
+    inserted into the model. \a rowCount is the number of rows in the model.
+
+    \sa setBackgroundFetch(), fetchFinished()
+*/
+
+/*!
+    \fn void QSqlQueryModel::fetchFinished()
+    \since 6.8
+
+    This signal is emitted when the worker thread fetching the model's query
+    in the background has fetched the last row, or has failed to execute the
+    query or to fetch a row. In the latter case, lastError() returns the
+    error.
+
+    \sa setBackgroundFetch(), fetchProgress()
+*/
+
 /*!
     \since 5.10
     \reimp
@@ -341,6 +680,13 @@ QVariant QSqlQueryModel::data(const QModelIndex &item, int role) const
     if (!d->rec.isGenerated(item.column()))
         return v;
     QModelIndex dItem = indexInQuery(item);
+    if (d->fetchedInBackground) {
+        if (dItem.row() < 0 || dItem.row() > d->bottom.row() || dItem.column() < 0
+                || dItem.column() >= d->fetchedColumns.size()) {
+            return v;
+        }
+        return d->fetchedColumns.at(dItem.column()).at(dItem.row());
+    }
     if (dItem.row() > d->bottom.row())
         const_cast<QSqlQueryModelPrivate *>(d)->prefetch(dItem.row());
 
@@ -417,6 +763,8 @@ void QSqlQueryModel::setQuery(QSqlQuery &&query)
     Q_D(QSqlQueryModel);
     beginResetModel();
 
+    d->stopFetcher();
+
     QSqlRecord newRec = query.record();
     bool columnsChanged = (newRec != d->rec);
 
@@ -469,11 +817,31 @@ void QSqlQueryModel::setQuery(QSqlQuery &&query)
     Example:
     \snippet code/src_sql_models_qsqlquerymodel.cpp 1
 
-    \sa query(), queryChange(), lastError()
+    If backgroundFetch() is \c true, the query is executed in a worker
+    thread instead, and this function returns before it has been.
+
+    \sa query(), queryChange(), lastError(), setBackgroundFetch()
 */
 void QSqlQueryModel::setQuery(const QString &query, const QSqlDatabase &db)
 {
-    setQuery(QSqlQuery(query, db));
+    Q_D(QSqlQueryModel);
+    if (!d->backgroundFetch) {
+        setQuery(QSqlQuery(query, db));
+        return;
+    }
+
+    beginResetModel();
+    d->stopFetcher();
+    d->bottom = QModelIndex();
+    d->error = QSqlError();
+    d->query = QSqlQuery(nullptr);
+    d->rec.clear();
+    d->colOffsets.clear();
+    d->atEnd = false;
+    d->fetchedInBackground = true;
+    d->startFetcher(query, db);
+    endResetModel();
+    queryChange();
 }
 
 /*!
@@ -483,6 +851,7 @@ void QSqlQueryModel::clear()
 {
     Q_D(QSqlQueryModel);
     beginResetModel();
+    d->stopFetcher();
     d->error = QSqlError();
     d->atEnd = true;
     d->query.clear();
@@ -58,8 +58,19 @@ public:
     void fetchMore(const QModelIndex &parent = QModelIndex()) override;
     bool canFetchMore(const QModelIndex &parent = QModelIndex()) const override;
 
+    void setFetchBatchSize(int size);
+    int fetchBatchSize() const;
+
+    void setBackgroundFetch(bool enabled);
+    bool backgroundFetch() const;
+    bool isFetching() const;
+
     QHash<int, QByteArray> roleNames() const override;
 
+Q_SIGNALS:
+    void fetchProgress(int rowCount);
+    void fetchFinished();
+
 protected:
     void beginInsertRows(const QModelIndex &parent, int first, int last);
     void endInsertRows();
@@ -22,12 +22,70 @@
 #include "QtSql/qsqlrecord.h"
 #include "QtCore/qhash.h"
 #include "QtCore/qlist.h"
+#include "QtCore/qmutex.h"
+#include "QtCore/qthread.h"
 #include "QtCore/qvarlengtharray.h"
+#include "QtCore/qwaitcondition.h"
+
+#include <atomic>
+#include <memory>
 
 QT_REQUIRE_CONFIG(sqlmodel);
 
 QT_BEGIN_NAMESPACE
 
+class QSqlQueryModelPrivate;
+
+// Executes a query on its own clone of a connection and streams the rows, a
+// batch at a time, into column-wise lists the model picks up on its thread.
+class QSqlQueryModelFetcher : public QThread
+{
+public:
+    struct Results
+    {
+        QSqlRecord record;
+        QList<QList<QVariant>> columns;
+        QSqlError error;
+        int rowCount = 0;
+        bool hasRecord = false;
+        bool finished = false;
+    };
+
+    QSqlQueryModelFetcher(QSqlQueryModelPrivate *d, QObject *model, int generation,
+                          const QString &connectionName, const QString &statement,
+                          int batchSize);
+    ~QSqlQueryModelFetcher() override;
+
+    // Lets the worker read ahead until it has fetched limit rows:
+    void requestRows(int limit);
+    void cancel();
+    Results takeResults();
+
+protected:
+    void run() override;
+
+private:
+    void fetch(QSqlQuery &query);
+    int waitForDemand(int fetched);
+    void finish(const QSqlError &error);
+    void notify();
+
+    QSqlQueryModelPrivate *const d;
+    QObject *const model;
+    const int generation;
+    const QString connectionName;
+    const QString statement;
+    const int batchSize;
+
+    std::atomic<bool> cancelled = false;
+    QMutex mutex;
+    QWaitCondition demand;
+    // Guarded by mutex:
+    int rowLimit = 0;
+    Results results;
+    bool notifyPending = false;
+};
+
 class QSqlQueryModelPrivate: public QAbstractItemModelPrivate
 {
     Q_DECLARE_PUBLIC(QSqlQueryModel)
@@ -39,6 +97,10 @@ public:
     void initColOffsets(int size);
     int columnInQuery(int modelColumn) const;
 
+    void startFetcher(const QString &statement, const QSqlDatabase &db);
+    void stopFetcher();
+    void processFetched(int generation);
+
     mutable QSqlQuery query = { QSqlQuery(nullptr) };
     mutable QSqlError error;
     QModelIndex bottom;
@@ -47,6 +109,14 @@ public:
     QList<QHash<int, QVariant>> headers;
     QVarLengthArray<int, 56> colOffsets; // used to calculate indexInQuery of columns
     int nestedResetLevel;
+    int fetchBatchSize = 255;
+
+    // Background fetching, see setBackgroundFetch():
+    bool backgroundFetch = false;
+    bool fetchedInBackground = false;
+    int fetchGeneration = 0;
+    std::unique_ptr<QSqlQueryModelFetcher> fetcher;
+    QList<QList<QVariant>> fetchedColumns;
 };
 
 // helpers for building SQL expressions
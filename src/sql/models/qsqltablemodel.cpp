@@ -342,7 +342,9 @@ bool QSqlTableModel::select()
 
     d->clearCache();
 
-    this->QSqlQueryModel::setQuery(query, d->db);
+    // The table model edits the rows it has selected, so it never fetches
+    // them in the background:
+    this->QSqlQueryModel::setQuery(QSqlQuery(query, d->db));
 
     if (!d->query.isActive() || lastError().isValid()) {
         // something went wrong - revert to non-select state
@@ -16,9 +16,11 @@
 #include <qxmlstream.h>
 
 #include <algorithm>
+#include <numeric>
 
 #if QT_CONFIG(zstd)
 #  include <zstd.h>
+#  include <zdict.h>
 #endif
 
 // Note: A copy of this file is used in Qt Designer (qttools/src/designer/src/lib/shared/rcc.cpp)
@@ -32,7 +34,17 @@ enum {
     CONSTANT_COMPRESSLEVEL_DEFAULT = -1,
     CONSTANT_ZSTDCOMPRESSLEVEL_CHECK = 1,   // Zstd level to check if compressing is a good idea
     CONSTANT_ZSTDCOMPRESSLEVEL_STORE = 14,  // Zstd level to actually store the data
-    CONSTANT_COMPRESSTHRESHOLD_DEFAULT = 70
+    CONSTANT_COMPRESSTHRESHOLD_DEFAULT = 70,
+    CONSTANT_ZSTDDICTIONARY_MINSAMPLES = 8,
+    CONSTANT_ZSTDDICTIONARY_MINSIZE = 1024,
+    CONSTANT_ZSTDDICTIONARY_MAXSIZE = 110 * 1024
+};
+
+enum {
+    // In binary files of format version 4, uncompressed payloads of at least
+    // this size start at a multiple of it, so that they can be mapped
+    // directly from the file.
+    CONSTANT_PAYLOAD_ALIGNMENT = 4096
 };
 
 void RCCResourceLibrary::write(const char *str, int len)
@@ -222,9 +234,7 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
 {
     const bool text = lib.m_format == RCCResourceLibrary::C_Code;
     const bool pass1 = lib.m_format == RCCResourceLibrary::Pass1;
-    const bool pass2 = lib.m_format == RCCResourceLibrary::Pass2;
     const bool binary = lib.m_format == RCCResourceLibrary::Binary;
-    const bool python = lib.m_format == RCCResourceLibrary::Python_Code;
 
     //capture the offset
     m_dataOffset = offset;
@@ -249,8 +259,6 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
             m_compressLevel = 19;   // not ZSTD_maxCLevel(), as 20+ are experimental
         }
         if (m_compressAlgo == RCCResourceLibrary::CompressionAlgorithm::Zstd && !m_noZstd) {
-            if (lib.m_zstdCCtx == nullptr)
-                lib.m_zstdCCtx = ZSTD_createCCtx();
             qsizetype size = data.size();
             size = ZSTD_COMPRESSBOUND(size);
 
@@ -260,16 +268,12 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
 
             QByteArray compressed(size, Qt::Uninitialized);
             char *dst = const_cast<char *>(compressed.constData());
-            size_t n = ZSTD_compressCCtx(lib.m_zstdCCtx, dst, size,
-                                         data.constData(), data.size(),
-                                         compressLevel);
+            size_t n = lib.zstdCompress(dst, size, data, compressLevel);
             if (n * 100.0 < data.size() * 1.0 * (100 - m_compressThreshold) ) {
                 // compressing is worth it
                 if (m_compressLevel < 0) {
                     // heuristic compression, so recompress
-                    n = ZSTD_compressCCtx(lib.m_zstdCCtx, dst, size,
-                                          data.constData(), data.size(),
-                                          CONSTANT_ZSTDCOMPRESSLEVEL_STORE);
+                    n = lib.zstdCompress(dst, size, data, CONSTANT_ZSTDCOMPRESSLEVEL_STORE);
                 }
                 if (ZSTD_isError(n)) {
                     QString msg = QString::fromLatin1("%1: error: compression with zstd failed: %2\n")
@@ -325,38 +329,61 @@ qint64 RCCFileInfo::writeDataBlob(RCCResourceLibrary &lib, qint64 offset,
         lib.writeString("\n  ");
     }
 
+    // align large uncompressed payloads to a page
+    if (binary && lib.formatVersion() >= 4 && data.size() >= CONSTANT_PAYLOAD_ALIGNMENT
+        && !(m_flags & (Compressed | CompressedZstd))) {
+        const qint64 payloadPos = lib.m_dataOffset + offset + 4;
+        const qint64 padding = (CONSTANT_PAYLOAD_ALIGNMENT - payloadPos % CONSTANT_PAYLOAD_ALIGNMENT)
+                % CONSTANT_PAYLOAD_ALIGNMENT;
+        for (qint64 i = 0; i < padding; ++i)
+            lib.writeChar(0);
+        offset += padding;
+        m_dataOffset = offset;
+    }
+
+    return lib.writeDataPayload(data, offset);
+}
+
+qint64 RCCResourceLibrary::writeDataPayload(const QByteArray &data, qint64 offset)
+{
+    const bool text = m_format == C_Code;
+    const bool pass1 = m_format == Pass1;
+    const bool pass2 = m_format == Pass2;
+    const bool binary = m_format == Binary;
+    const bool python = m_format == Python_Code;
+
     // write the length
     if (text || binary || pass2 || python)
-        lib.writeNumber4(data.size());
+        writeNumber4(data.size());
     if (text || pass1)
-        lib.writeString("\n  ");
+        writeString("\n  ");
     else if (python)
-        lib.writeString("\\\n");
+        writeString("\\\n");
     offset += 4;
 
     // write the payload
     const char *p = data.constData();
     if (text || python) {
         for (int i = data.size(), j = 0; --i >= 0; --j) {
-            lib.writeHex(*p++);
+            writeHex(*p++);
             if (j == 0) {
                 if (text)
-                    lib.writeString("\n  ");
+                    writeString("\n  ");
                 else
-                    lib.writeString("\\\n");
+                    writeString("\\\n");
                 j = 16;
             }
         }
     } else if (binary || pass2) {
-        lib.writeByteArray(data);
+        writeByteArray(data);
     }
     offset += data.size();
 
     // done
     if (text || pass1)
-        lib.writeString("\n  ");
+        writeString("\n  ");
     else if (python)
-        lib.writeString("\\\n");
+        writeString("\\\n");
 
     return offset;
 }
@@ -449,7 +476,9 @@ RCCResourceLibrary::RCCResourceLibrary(quint8 formatVersion)
     m_errorDevice(nullptr),
     m_outDevice(nullptr),
     m_formatVersion(formatVersion),
-    m_noZstd(false)
+    m_noZstd(false),
+    m_zstdDictionary(false),
+    m_zstdDictionaryOffset(-1)
 {
     m_out.reserve(30 * 1000 * 1000);
 #if QT_CONFIG(zstd)
@@ -462,6 +491,8 @@ RCCResourceLibrary::~RCCResourceLibrary()
     delete m_root;
 #if QT_CONFIG(zstd)
     ZSTD_freeCCtx(m_zstdCCtx);
+    for (ZSTD_CDict *dictionary : std::as_const(m_zstdCDicts))
+        ZSTD_freeCDict(dictionary);
 #endif
 }
 
@@ -1145,9 +1176,21 @@ bool RCCResourceLibrary::writeDataBlobs()
     if (!m_root)
         return false;
 
+    qint64 offset = 0;
+#if QT_CONFIG(zstd)
+    // the dictionary comes first, so that all passes agree on its offset
+    if (m_zstdDictionary && m_zstdDictionaryData.isEmpty())
+        trainZstdDictionary();
+    if (!m_zstdDictionaryData.isEmpty()) {
+        if (m_format == C_Code || m_format == Pass1)
+            writeString("  // zstd dictionary\n  ");
+        m_zstdDictionaryOffset = offset;
+        offset = writeDataPayload(m_zstdDictionaryData, offset);
+    }
+#endif
+
     QStack<RCCFileInfo*> pending;
     pending.push(m_root);
-    qint64 offset = 0;
     QString errorMessage;
     while (!pending.isEmpty()) {
         RCCFileInfo *file = pending.pop();
@@ -1184,6 +1227,92 @@ bool RCCResourceLibrary::writeDataBlobs()
     return true;
 }
 
+#if QT_CONFIG(zstd)
+/*
+    Trains a zstd dictionary on the files that may be compressed with zstd.
+    Many small files of the same kind (QML, SVG, JSON) each compress badly
+    on their own, as every frame starts without any history; with the
+    dictionary, which is stored once in the data, they share what they have
+    in common. If there are too few files to train on, no dictionary is used.
+*/
+void RCCResourceLibrary::trainZstdDictionary()
+{
+    QByteArray samples;
+    QList<size_t> sampleSizes;
+    QStack<RCCFileInfo*> pending;
+    pending.push(m_root);
+    while (!pending.isEmpty()) {
+        RCCFileInfo *file = pending.pop();
+        for (auto it = file->m_children.cbegin(); it != file->m_children.cend(); ++it) {
+            RCCFileInfo *child = it.value();
+            if (child->m_flags & RCCFileInfo::Directory) {
+                pending.push(child);
+                continue;
+            }
+            if (child->m_isEmpty || child->m_noZstd
+                || (child->m_compressAlgo != CompressionAlgorithm::Best
+                    && child->m_compressAlgo != CompressionAlgorithm::Zstd)) {
+                continue;
+            }
+            QFile input(child->m_fileInfo.absoluteFilePath());
+            if (!input.open(QFile::ReadOnly))
+                continue;   // reported when writing the file
+            const QByteArray data = input.readAll();
+            if (data.isEmpty())
+                continue;
+            samples += data;
+            sampleSizes.append(size_t(data.size()));
+        }
+    }
+
+    // the zstd documentation suggests a dictionary of about a hundredth of
+    // the samples, and 110 KiB at most
+    const size_t capacity = qBound(size_t(CONSTANT_ZSTDDICTIONARY_MINSIZE),
+                                   size_t(samples.size() / 100),
+                                   size_t(CONSTANT_ZSTDDICTIONARY_MAXSIZE));
+    QByteArray dictionary(capacity, Qt::Uninitialized);
+    size_t n = 0;
+    if (sampleSizes.size() >= CONSTANT_ZSTDDICTIONARY_MINSAMPLES) {
+        n = ZDICT_trainFromBuffer(dictionary.data(), capacity, samples.constData(),
+                                  sampleSizes.constData(), unsigned(sampleSizes.size()));
+        if (ZDICT_isError(n))
+            n = 0;
+    }
+    if (n == 0) {
+        if (m_verbose) {
+            const QString msg = QString::fromLatin1("note: not using a zstd dictionary (%1 files)\n")
+                    .arg(sampleSizes.size());
+            m_errorDevice->write(msg.toUtf8());
+        }
+        return;
+    }
+    dictionary.truncate(n);
+    if (m_verbose) {
+        const QString msg = QString::fromLatin1("note: trained a zstd dictionary of %1 bytes on %2 files\n")
+                .arg(n).arg(sampleSizes.size());
+        m_errorDevice->write(msg.toUtf8());
+    }
+    m_zstdDictionaryData = std::move(dictionary);
+}
+
+size_t RCCResourceLibrary::zstdCompress(char *dst, size_t capacity, const QByteArray &data,
+                                        int level)
+{
+    if (m_zstdCCtx == nullptr)
+        m_zstdCCtx = ZSTD_createCCtx();
+    if (m_zstdDictionaryData.isEmpty())
+        return ZSTD_compressCCtx(m_zstdCCtx, dst, capacity, data.constData(), data.size(), level);
+
+    ZSTD_CDict *&dictionary = m_zstdCDicts[level];
+    if (!dictionary) {
+        dictionary = ZSTD_createCDict(m_zstdDictionaryData.constData(),
+                                      m_zstdDictionaryData.size(), level);
+    }
+    return ZSTD_compress_usingCDict(m_zstdCCtx, dst, capacity, data.constData(), data.size(),
+                                    dictionary);
+}
+#endif
+
 bool RCCResourceLibrary::writeDataNames()
 {
     switch (m_format) {
@@ -1237,6 +1366,87 @@ bool RCCResourceLibrary::writeDataNames()
     return true;
 }
 
+// The hash of the full path of a node, used by the lookup index of format
+// version 4. Must match qresource.cpp.
+static quint64 qt_rcc_path_hash(QStringView path)
+{
+    quint64 h = Q_UINT64_C(14695981039346656037);
+    for (QChar c : path) {
+        h ^= c.unicode();
+        h *= Q_UINT64_C(1099511628211);
+    }
+    return h;
+}
+
+static quint32 qt_rcc_path_slot(quint64 hash, quint32 displacement, quint32 slotCount)
+{
+    quint64 h = hash ^ (displacement * Q_UINT64_C(0x9e3779b97f4a7c15));
+    h = (h ^ (h >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+    h = (h ^ (h >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+    h ^= h >> 31;
+    return quint32(h % slotCount);
+}
+
+/*
+    Builds a minimal perfect hash of the given path hashes with the "hash
+    and displace" method: the keys are distributed in buckets of about four,
+    and for each bucket, largest first, a displacement is searched that
+    moves all of its keys to free slots. Returns the displacement of each
+    bucket and the node of each slot (0 for the empty ones).
+*/
+static bool qt_rcc_build_path_index(const QList<quint64> &hashes, const QList<int> &nodes,
+                                    QList<quint32> *displacements, QList<quint32> *slotNodes)
+{
+    const quint32 keyCount = quint32(hashes.size());
+    const quint32 bucketCount = qMax(1u, (keyCount + 3) / 4);
+    QList<QList<int>> buckets(bucketCount);
+    for (quint32 i = 0; i < keyCount; ++i)
+        buckets[hashes.at(i) % bucketCount].append(i);
+    QList<quint32> order(bucketCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&buckets](quint32 a, quint32 b) {
+        return buckets.at(a).size() > buckets.at(b).size();
+    });
+
+    // if some bucket cannot be placed, retry with more slots
+    for (quint32 slotCount = keyCount + keyCount / 8 + 1; slotCount <= 2 * keyCount + 16;
+         slotCount += slotCount / 8 + 1) {
+        displacements->fill(0, bucketCount);
+        slotNodes->fill(0, slotCount);
+        bool placedAll = true;
+        for (quint32 bucket : order) {
+            const QList<int> &keys = buckets.at(bucket);
+            if (keys.isEmpty())
+                break;
+            QList<quint32> taken;
+            bool placed = false;
+            for (quint32 d = 0; d < 0x10000 && !placed; ++d) {
+                taken.clear();
+                placed = true;
+                for (int key : keys) {
+                    const quint32 slot = qt_rcc_path_slot(hashes.at(key), d, slotCount);
+                    if (slotNodes->at(slot) != 0 || taken.contains(slot)) {
+                        placed = false;
+                        break;
+                    }
+                    taken.append(slot);
+                }
+                if (placed)
+                    (*displacements)[bucket] = d;
+            }
+            if (!placed) {
+                placedAll = false;
+                break;
+            }
+            for (qsizetype i = 0; i < keys.size(); ++i)
+                (*slotNodes)[taken.at(i)] = quint32(nodes.at(keys.at(i)));
+        }
+        if (placedAll)
+            return true;
+    }
+    return false;
+}
+
 struct qt_rcc_compare_hash
 {
     typedef bool result_type;
@@ -1268,12 +1478,19 @@ bool RCCResourceLibrary::writeDataStructure()
     if (!m_root)
         return false;
 
+    // the full path and parent of each node, for the lookup index
+    QStringList paths(1);
+    QList<int> parents(1, 0);
+    QHash<const RCCFileInfo *, int> nodeNumbers;
+    nodeNumbers.insert(m_root, 0);
+
     //calculate the child offsets (flat)
     pending.push(m_root);
     int offset = 1;
     while (!pending.isEmpty()) {
         RCCFileInfo *file = pending.pop();
         file->m_childOffset = offset;
+        const int parent = nodeNumbers.value(file);
 
         //sort by hash value for binary lookup
         QList<RCCFileInfo*> m_children = file->m_children.values();
@@ -1282,12 +1499,18 @@ bool RCCResourceLibrary::writeDataStructure()
         //write out the actual data now
         for (int i = 0; i < m_children.size(); ++i) {
             RCCFileInfo *child = m_children.at(i);
+            nodeNumbers.insert(child, offset);
+            paths.append(paths.at(parent) + u'/' + child->m_name);
+            parents.append(parent);
             ++offset;
             if (child->m_flags & RCCFileInfo::Directory)
                 pending.push(child);
         }
     }
 
+    if (m_formatVersion >= 4 && !writeDataIndex(paths, parents))
+        return false;
+
     //write out the structure (ie iterate again!)
     pending.push(m_root);
     m_root->writeDataInfo(*this);
@@ -1321,6 +1544,73 @@ bool RCCResourceLibrary::writeDataStructure()
     return true;
 }
 
+/*
+    Writes the lookup index of format version 4, which precedes the nodes in
+    the structure: a minimal perfect hash of the full paths of all nodes but
+    the root, and the parent of each node, to verify a match without
+    walking down the tree. The header also locates the zstd dictionary, if
+    the files were compressed with one.
+
+        quint32 nodeCount, bucketCount, slotCount
+        quint32 zstdDictionary          (offset in the data, or 0xffffffff)
+        quint32 displacement[bucketCount]
+        quint32 slotNode[slotCount]     (0 if the slot is empty)
+        quint32 parent[nodeCount]
+
+    Localized variants of a file share their path; the index holds the first
+    of them and the others follow it in the structure.
+*/
+bool RCCResourceLibrary::writeDataIndex(const QStringList &paths, const QList<int> &parents)
+{
+    const bool text = m_format == C_Code || m_format == Pass1;
+    const bool python = m_format == Python_Code;
+
+    QList<quint64> hashes;
+    QList<int> nodes;
+    QHash<quint64, QString> seen;
+    for (int node = 1; node < paths.size(); ++node) {
+        const QString &path = paths.at(node);
+        const quint64 hash = qt_rcc_path_hash(path);
+        const auto it = seen.constFind(hash);
+        if (it != seen.cend()) {
+            if (*it == path)
+                continue;   // a localized variant
+            m_errorDevice->write(QString::fromLatin1("RCC: Error: paths %1 and %2 have the same hash, "
+                                                     "use format version 3 or lower\n")
+                                         .arg(*it, path).toUtf8());
+            return false;
+        }
+        seen.insert(hash, path);
+        hashes.append(hash);
+        nodes.append(node);
+    }
+
+    QList<quint32> displacements;
+    QList<quint32> slotNodes;
+    if (!qt_rcc_build_path_index(hashes, nodes, &displacements, &slotNodes)) {
+        m_errorDevice->write("RCC: Error: could not build the resource lookup index\n");
+        return false;
+    }
+
+    if (text)
+        writeString("  // lookup index\n  ");
+    writeNumber4(paths.size());
+    writeNumber4(displacements.size());
+    writeNumber4(slotNodes.size());
+    writeNumber4(m_zstdDictionaryOffset < 0 ? 0xffffffffu : quint32(m_zstdDictionaryOffset));
+    for (quint32 displacement : std::as_const(displacements))
+        writeNumber4(displacement);
+    for (quint32 node : std::as_const(slotNodes))
+        writeNumber4(node);
+    for (int parent : parents)
+        writeNumber4(parent);
+    if (text)
+        writeString("\n");
+    else if (python)
+        writeString("\\\n");
+    return true;
+}
+
 void RCCResourceLibrary::writeMangleNamespaceFunction(const QByteArray &name)
 {
     if (m_useNameSpace) {
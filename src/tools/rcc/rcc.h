@@ -12,6 +12,7 @@
 #include <qstring.h>
 
 typedef struct ZSTD_CCtx_s ZSTD_CCtx;
+typedef struct ZSTD_CDict_s ZSTD_CDict;
 
 QT_BEGIN_NAMESPACE
 
@@ -87,6 +88,9 @@ public:
     void setNoZstd(bool v) { m_noZstd = v; }
     bool noZstd() const { return m_noZstd; }
 
+    void setZstdDictionary(bool v) { m_zstdDictionary = v; }
+    bool zstdDictionary() const { return m_zstdDictionary; }
+
 private:
     struct Strings {
         Strings();
@@ -108,8 +112,10 @@ private:
         QString currentPath = QString(), bool listMode = false);
     bool writeHeader();
     bool writeDataBlobs();
+    qint64 writeDataPayload(const QByteArray &data, qint64 offset);
     bool writeDataNames();
     bool writeDataStructure();
+    bool writeDataIndex(const QStringList &paths, const QList<int> &parents);
     bool writeInitializer();
     void writeMangleNamespaceFunction(const QByteArray &name);
     void writeAddNamespaceFunction(const QByteArray &name);
@@ -125,7 +131,11 @@ private:
     void writeString(const char *s) { write(s, static_cast<int>(strlen(s))); }
 
 #if QT_CONFIG(zstd)
+    void trainZstdDictionary();
+    size_t zstdCompress(char *dst, size_t capacity, const QByteArray &data, int level);
+
     ZSTD_CCtx *m_zstdCCtx;
+    QHash<int, ZSTD_CDict *> m_zstdCDicts;
 #endif
 
     const Strings m_strings;
@@ -150,6 +160,9 @@ private:
     QByteArray m_out;
     quint8 m_formatVersion;
     bool m_noZstd;
+    bool m_zstdDictionary;
+    QByteArray m_zstdDictionaryData;
+    qint64 m_zstdDictionaryOffset;
 };
 
 QT_END_NAMESPACE
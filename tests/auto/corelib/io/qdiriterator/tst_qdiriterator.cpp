@@ -10,6 +10,7 @@
 #include <qstringlist.h>
 #include <QSet>
 #include <QString>
+#include <QTemporaryDir>
 
 #include <QtCore/private/qfsfileengine_p.h>
 
@@ -88,6 +89,9 @@ private slots:
 #ifndef Q_OS_WIN
     void hiddenDirs_hiddenFiles();
 #endif
+    void parallelTraversal_data();
+    void parallelTraversal();
+    void parallelTraversalEarlyExit();
 #ifdef BUILTIN_TESTDATA
 private:
     QSharedPointer<QTemporaryDir> m_dataDir;
@@ -306,6 +310,18 @@ void tst_QDirIterator::iterateRelativeDirectory_data()
                    "entrylist/directory/dummy,"
                    "entrylist/writable").split(',');
 
+    QTest::newRow("QDir::Subdirectories | QDirIterator::ParallelTraversal / QDir::Files")
+        << QString("entrylist")
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories
+                                       | QDirIterator::ParallelTraversal)
+        << QDir::Filters(QDir::Files) << QStringList("*")
+        << QString("entrylist/directory/dummy,"
+                   "entrylist/file,"
+#ifndef Q_NO_SYMLINKS
+                   "entrylist/linktofile.lnk,"
+#endif
+                   "entrylist/writable").split(',');
+
     QTest::newRow("empty, default")
         << QString("empty") << QDirIterator::IteratorFlags{}
         << QDir::Filters(QDir::NoFilter) << QStringList("*")
@@ -613,6 +629,125 @@ void tst_QDirIterator::hiddenDirs_hiddenFiles()
 }
 #endif // Q_OS_WIN
 
+static QStringList listEntries(QDirIterator &it)
+{
+    QStringList list;
+    while (it.hasNext())
+        list << it.next();
+    return list;
+}
+
+static bool createTree(const QString &path, int depth)
+{
+    QDir dir(path);
+    for (int i = 0; i < 8; ++i) {
+        QFile file(dir.filePath(QString::number(i) + ".txt"));
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+    }
+    QFile hidden(dir.filePath(".hidden"));
+    if (!hidden.open(QIODevice::WriteOnly))
+        return false;
+    if (depth == 0)
+        return true;
+    for (int i = 0; i < 4; ++i) {
+        const QString name = "dir" + QString::number(i);
+        if (!dir.mkdir(name) || !createTree(dir.filePath(name), depth - 1))
+            return false;
+    }
+    return dir.mkdir(".hiddendir") && createTree(dir.filePath(".hiddendir"), 0);
+}
+
+void tst_QDirIterator::parallelTraversal_data()
+{
+    QTest::addColumn<QDirIterator::IteratorFlags>("flags");
+    QTest::addColumn<QDir::Filters>("filters");
+    QTest::addColumn<QStringList>("nameFilters");
+
+    const QDirIterator::IteratorFlags subdirectories = QDirIterator::Subdirectories;
+    QTest::newRow("all") << subdirectories << QDir::Filters(QDir::NoFilter) << QStringList();
+    QTest::newRow("files") << subdirectories << QDir::Filters(QDir::Files) << QStringList();
+    QTest::newRow("dirs, hidden")
+        << subdirectories << QDir::Filters(QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot)
+        << QStringList();
+    QTest::newRow("name filter")
+        << subdirectories << QDir::Filters(QDir::Files) << QStringList("[13].txt");
+    QTest::newRow("follow symlinks")
+        << (subdirectories | QDirIterator::FollowSymlinks)
+        << QDir::Filters(QDir::AllEntries | QDir::NoDotAndDotDot) << QStringList();
+}
+
+void tst_QDirIterator::parallelTraversal()
+{
+    QFETCH(QDirIterator::IteratorFlags, flags);
+    QFETCH(QDir::Filters, filters);
+    QFETCH(QStringList, nameFilters);
+
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(createTree(root.path(), 2));
+#if !defined(Q_NO_SYMLINKS) && !defined(Q_NO_SYMLINKS_TO_DIRS) && !defined(Q_OS_WIN)
+    QVERIFY(QFile::link("dir1", root.filePath("dir0/link")));
+    QVERIFY(QFile::link("..", root.filePath("dir2/loop")));
+#endif
+
+    QDirIterator sequential(root.path(), nameFilters, filters, flags);
+    const QStringList expected = listEntries(sequential);
+    QVERIFY(!expected.isEmpty());
+
+    QDirIterator parallel(root.path(), nameFilters, filters,
+                          flags | QDirIterator::ParallelTraversal);
+    QCOMPARE(parallel.path(), root.path());
+    QStringList entries = listEntries(parallel);
+    if (flags & QDirIterator::FollowSymlinks) {
+        // which path of a directory reached through a link is visited first
+        // depends on the timing
+        QCOMPARE(entries.size(), expected.size());
+    } else {
+        QCOMPARE(entries, expected);
+    }
+    QVERIFY(!parallel.hasNext());
+    QVERIFY(parallel.next().isEmpty());
+
+    QDirIterator unordered(root.path(), nameFilters, filters,
+                           flags | QDirIterator::ParallelTraversal
+                                 | QDirIterator::UnorderedResults);
+    entries = listEntries(unordered);
+    QCOMPARE(entries.size(), expected.size());
+    if (!(flags & QDirIterator::FollowSymlinks)) {
+        QStringList sortedExpected = expected;
+        sortedExpected.sort();
+        entries.sort();
+        QCOMPARE(entries, sortedExpected);
+    }
+}
+
+void tst_QDirIterator::parallelTraversalEarlyExit()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    QVERIFY(createTree(root.path(), 2));
+
+    for (auto flags : { QDirIterator::IteratorFlags(QDirIterator::ParallelTraversal),
+                        QDirIterator::ParallelTraversal | QDirIterator::UnorderedResults }) {
+        // the workers are stopped when the iterator is destroyed
+        QDirIterator it(root.path(), QDir::Files, QDirIterator::Subdirectories | flags);
+        for (int i = 0; i < 5; ++i) {
+            QVERIFY(it.hasNext());
+            QVERIFY(it.nextFileInfo().isFile());
+        }
+    }
+
+    // without Subdirectories, the flag has no effect
+    QDirIterator flat(root.path(), QDir::Files, QDirIterator::ParallelTraversal);
+    QCOMPARE(listEntries(flat).size(), 8);
+
+    // nor does it on a directory that does not exist
+    QDirIterator missing(root.filePath("missing"), QDirIterator::Subdirectories
+                                                   | QDirIterator::ParallelTraversal);
+    QVERIFY(!missing.hasNext());
+}
+
 QTEST_MAIN(tst_QDirIterator)
 
 #include "tst_qdiriterator.moc"
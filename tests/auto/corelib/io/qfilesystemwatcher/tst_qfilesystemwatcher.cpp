@@ -15,6 +15,7 @@
 #include <QSignalSpy>
 #include <QTimer>
 #include <QTemporaryFile>
+#include <QScopeGuard>
 #if defined(Q_OS_WIN)
 #include <qt_windows.h>
 #endif
@@ -67,6 +68,10 @@ private slots:
     void signalsEmittedAfterFileMoved();
 
     void watchUnicodeCharacters();
+    void watchDirectoryRecursive_data();
+    void watchDirectoryRecursive();
+    void removeRecursiveRoot_data() { watchDirectoryRecursive_data(); }
+    void removeRecursiveRoot();
 #if defined(Q_OS_WIN)
     void watchDirectoryAttributeChanges();
 #endif
@@ -819,6 +824,128 @@ void tst_QFileSystemWatcher::watchUnicodeCharacters()
     QTRY_COMPARE(changedSpy.count(), 1);
 }
 
+void tst_QFileSystemWatcher::watchDirectoryRecursive_data()
+{
+    QTest::addColumn<bool>("fanotify");
+
+    // fanotify is only used if the process is privileged, inotify otherwise
+    QTest::newRow("default") << true;
+    QTest::newRow("inotify") << false;
+}
+
+void tst_QFileSystemWatcher::watchDirectoryRecursive()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Recursive watching is only supported on Linux");
+#else
+    QFETCH(bool, fanotify);
+    if (!fanotify)
+        qputenv("QT_NO_FANOTIFY", "1");
+    const auto restoreEnvironment = qScopeGuard([] { qunsetenv("QT_NO_FANOTIFY"); });
+
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+    const QString root = temporaryDirectory.path();
+    QDir testDir(root);
+    QVERIFY(testDir.mkpath("a/b/c"));
+    QVERIFY(testDir.mkpath("d"));
+
+    QFileSystemWatcher watcher;
+    QVERIFY(!watcher.addPathRecursive(testDir.filePath("missing")));
+    QVERIFY(watcher.addPathRecursive(root));
+    QVERIFY(!watcher.addPathRecursive(root));
+    QCOMPARE(watcher.recursiveDirectories(), QStringList(root));
+    QVERIFY(watcher.directories().isEmpty());
+
+    QStringList reported;
+    QStringList batch;
+    connect(&watcher, &QFileSystemWatcher::directoryChanged,
+            this, [&](const QString &path) { batch.append(path); });
+    connect(&watcher, &QFileSystemWatcher::directoriesChanged,
+            this, [&](const QStringList &paths) {
+        // directoryChanged() has been emitted for each of the paths right before
+        QCOMPARE(batch, paths);
+        batch.clear();
+        reported += paths;
+    });
+
+    // a change deep in the tree
+    QFile file(testDir.filePath("a/b/c/file"));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+    QTRY_VERIFY2(reported.contains(root + "/a/b/c"), qPrintable(reported.join(u' ')));
+    QVERIFY(!reported.contains(root + "/d"));
+
+    // a burst of changes is reported once
+    reported.clear();
+    for (int i = 0; i < 10; ++i) {
+        QFile file(testDir.filePath("d/file" + QString::number(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+    QTRY_VERIFY2(reported.contains(root + "/d"), qPrintable(reported.join(u' ')));
+    QCOMPARE(reported.count(root + "/d"), 1);
+
+    // new directories are watched
+    reported.clear();
+    QVERIFY(testDir.mkpath("new/sub"));
+    QTRY_VERIFY2(reported.contains(root), qPrintable(reported.join(u' ')));
+    reported.clear();
+    QVERIFY(testDir.mkdir("new/sub/subsub"));
+    QTRY_VERIFY2(reported.contains(root + "/new/sub"), qPrintable(reported.join(u' ')));
+
+    // renamed directories are reported with their new path
+    reported.clear();
+    QVERIFY(testDir.rename("a", "renamed"));
+    QTRY_VERIFY2(reported.contains(root), qPrintable(reported.join(u' ')));
+    reported.clear();
+    QVERIFY(testDir.rename("renamed/b/c/file", "renamed/b/c/moved"));
+    QTRY_VERIFY2(reported.contains(root + "/renamed/b/c"), qPrintable(reported.join(u' ')));
+
+    // directories moved out of the tree are no longer watched
+    QTemporaryDir outside(m_tempDirPattern);
+    QVERIFY2(outside.isValid(), qPrintable(outside.errorString()));
+    reported.clear();
+    QVERIFY(QFile::rename(testDir.filePath("new"), outside.filePath("new")));
+    QTRY_VERIFY2(reported.contains(root), qPrintable(reported.join(u' ')));
+    QVERIFY(QDir(outside.path()).mkdir("new/sub/other"));
+
+    // removing the tree stops the notifications
+    QVERIFY(watcher.removePath(root));
+    QVERIFY(watcher.recursiveDirectories().isEmpty());
+    reported.clear();
+    QVERIFY(testDir.mkdir("e"));
+    QTest::qWait(200);
+    QVERIFY2(!reported.contains(outside.path() + "/new/sub"), qPrintable(reported.join(u' ')));
+    QVERIFY2(reported.isEmpty(), qPrintable(reported.join(u' ')));
+#endif
+}
+
+void tst_QFileSystemWatcher::removeRecursiveRoot()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Recursive watching is only supported on Linux");
+#else
+    QFETCH(bool, fanotify);
+    if (!fanotify)
+        qputenv("QT_NO_FANOTIFY", "1");
+    const auto restoreEnvironment = qScopeGuard([] { qunsetenv("QT_NO_FANOTIFY"); });
+
+    QTemporaryDir temporaryDirectory(m_tempDirPattern);
+    QVERIFY2(temporaryDirectory.isValid(), qPrintable(temporaryDirectory.errorString()));
+    const QString root = temporaryDirectory.filePath("tree");
+    QVERIFY(QDir().mkpath(root + "/a/b"));
+
+    QFileSystemWatcher watcher;
+    QVERIFY(watcher.addPathRecursive(root));
+    QSignalSpy spy(&watcher, &QFileSystemWatcher::directoryChanged);
+
+    QVERIFY(QDir(root).removeRecursively());
+    QTRY_VERIFY(spy.contains(QVariantList{ root }));
+    QTRY_VERIFY(watcher.recursiveDirectories().isEmpty());
+    QVERIFY(!watcher.removePath(root));
+#endif
+}
+
 #if defined(Q_OS_WIN)
 void tst_QFileSystemWatcher::watchDirectoryAttributeChanges()
 {
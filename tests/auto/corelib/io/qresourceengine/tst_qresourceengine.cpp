@@ -145,6 +145,11 @@ void tst_QResourceEngine::compressedResource()
     QByteArray data = resource.uncompressedData();
     QCOMPARE(data.size(), expectedData.size());
     QCOMPARE(data, expectedData);
+    if (compressionAlgo != QResource::NoCompression) {
+        // decompressed once and then shared
+        QCOMPARE(static_cast<const void *>(QResource("zero.txt").uncompressedData().constData()),
+                 static_cast<const void *>(data.constData()));
+    }
 
     // decompression through the engine
     data = f.readAll();
@@ -11,6 +11,8 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
 #include <QtCore/QEventLoop>
+#include <QtCore/QSaveFile>
+#include <QtCore/QScopeGuard>
 #include <QtCore/QtGlobal>
 #include <QtCore/QThread>
 #include <QtCore/QSysInfo>
@@ -178,6 +180,7 @@ private slots:
     void testVariantTypes();
     void testMetaTypes_data();
     void testMetaTypes();
+    void iniIndex();
 #endif
     void rainersSyncBugOnMac_data() { populateWithFormats(); }
     void rainersSyncBugOnMac();
@@ -3539,6 +3542,102 @@ void tst_QSettings::dontReorderIniKeysNeedlessly()
 }
 #endif
 
+#ifdef QT_BUILD_INTERNAL
+void tst_QSettings::iniIndex()
+{
+    qputenv("QT_SETTINGS_INDEX", "1");
+    auto restoreEnvironment = qScopeGuard([] { qunsetenv("QT_SETTINGS_INDEX"); });
+
+    const QString fileName = settingsPath("indexed.ini");
+    const QString indexFileName = fileName + ".index";
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        settings.setValue("number", 1);
+        settings.setValue("group/list", QStringList{ "one", "two" });
+        settings.setValue("group/text", "some text");
+        settings.setValue("group/removed", true);
+    }
+    QVERIFY(QFile::exists(indexFileName));
+
+    // the changes of a sync are appended to the index
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("number").toInt(), 1);
+        QCOMPARE(settings.value("group/list").toStringList(), QStringList({ "one", "two" }));
+        QVERIFY(!settings.contains("group/missing"));
+        settings.setValue("group/text", "other text");
+        settings.remove("group/removed");
+    }
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("group/text").toString(), QString("other text"));
+        QVERIFY(!settings.contains("group/removed"));
+        QCOMPARE(settings.status(), QSettings::NoError);
+    }
+
+    // the index answers lookups while it matches the INI file's size,
+    // modification time and identity...
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    const QDateTime modificationTime = file.fileTime(QFileDevice::FileModificationTime);
+    QByteArray contents = file.readAll();
+    QVERIFY(contents.contains("number=1"));
+    contents.replace("number=1", "number=2");
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(contents), contents.size());
+    QVERIFY(file.flush());
+    QVERIFY(file.setFileTime(modificationTime, QFileDevice::FileModificationTime));
+    file.close();
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("number").toInt(), 1);
+        // ...but listing the keys parses the file
+        QVERIFY(settings.allKeys().contains("group/list"));
+        QCOMPARE(settings.value("number").toInt(), 2);
+    }
+
+    // and is rebuilt once the INI file changes
+    {
+        QSaveFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("number=3\n");
+        QVERIFY(file.commit());
+    }
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("number").toInt(), 3);
+        QVERIFY(!settings.contains("group/text"));
+    }
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::IniFormat);
+        QCOMPARE(settings.value("number").toInt(), 3);
+    }
+
+#ifdef Q_OS_UNIX
+    // the state of an open INI file is the one of the contents read from it,
+    // even once another process has replaced the file
+    {
+        QFile opened(fileName);
+        QVERIFY(opened.open(QIODevice::ReadOnly));
+        const QSettingsIniIndex::SourceKey openedKey = QSettingsIniIndex::sourceKey(opened);
+        QVERIFY(openedKey.isValid());
+        QVERIFY(openedKey == QSettingsIniIndex::sourceKey(fileName));
+        QSaveFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("number=4\nsome=more\n");
+        QVERIFY(file.commit());
+        QVERIFY(QSettingsIniIndex::sourceKey(opened) == openedKey);
+        QVERIFY(QSettingsIniIndex::sourceKey(fileName) != openedKey);
+    }
+#endif
+}
+#endif
+
 void tst_QSettings::rainersSyncBugOnMac()
 {
     QFETCH(QSettings::Format, format);
@@ -0,0 +1,237 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QtTest/qtesteventloop.h>
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qsocketnotifier.h>
+#include <QtCore/qthread.h>
+#include <QtCore/private/qsharedmemoryringbuffer_p.h>
+
+using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+class tst_QSharedMemoryRingBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+
+    void createAndAttach();
+    void singleProducer();
+    void multiProducer();
+    void blockingWrite();
+    void waitForReadyRead();
+    void eventDescriptor();
+
+private:
+    QNativeIpcKey key;
+    int keyCounter = 0;
+};
+
+void tst_QSharedMemoryRingBuffer::init()
+{
+    key = QSharedMemory::platformSafeKey(u"tst_qsharedmemoryringbuffer_%1_%2"_s
+                                                 .arg(QCoreApplication::applicationPid())
+                                                 .arg(++keyCounter));
+}
+
+void tst_QSharedMemoryRingBuffer::createAndAttach()
+{
+    QSharedMemoryRingBuffer producer;
+    QVERIFY(!producer.attach(key));
+    QVERIFY(!producer.isValid());
+    QVERIFY(!producer.errorString().isEmpty());
+
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY(!consumer.create(key, 0, 4));
+    QVERIFY(!consumer.create(key, 16, 0));
+    QVERIFY2(consumer.create(key, 100, 5, QSharedMemoryRingBuffer::Mode::MultiProducer),
+             qPrintable(consumer.errorString()));
+    QVERIFY(consumer.isValid());
+    QCOMPARE(consumer.capacity(), 8);
+    QCOMPARE(consumer.maximumMessageSize(), 100);
+
+    QVERIFY2(producer.attach(key), qPrintable(producer.errorString()));
+    QCOMPARE(producer.capacity(), 8);
+    QCOMPARE(producer.maximumMessageSize(), 100);
+    QCOMPARE(producer.mode(), QSharedMemoryRingBuffer::Mode::MultiProducer);
+
+    // a segment that is not a ring buffer
+    QSharedMemory other(QSharedMemory::platformSafeKey(u"tst_qsharedmemoryringbuffer_other"_s));
+    QVERIFY(other.create(1024) || other.attach());
+    QSharedMemoryRingBuffer wrong;
+    QVERIFY(!wrong.attach(other.nativeIpcKey()));
+    QVERIFY(!wrong.isValid());
+
+    // the ring buffer goes away with its consumer
+    consumer.detach();
+    producer.detach();
+    QVERIFY(!producer.attach(key));
+}
+
+void tst_QSharedMemoryRingBuffer::singleProducer()
+{
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY2(consumer.create(key, 8, 4), qPrintable(consumer.errorString()));
+    QSharedMemoryRingBuffer producer;
+    QVERIFY2(producer.attach(key), qPrintable(producer.errorString()));
+
+    QByteArray message;
+    QVERIFY(!consumer.tryRead(&message));
+    QVERIFY(!producer.tryWrite("too large"));
+
+    // go around the ring a few times
+    int written = 0;
+    int read = 0;
+    for (int round = 0; round < 5; ++round) {
+        while (producer.tryWrite(QByteArray::number(written)))
+            ++written;
+        QCOMPARE(written - read, 4);
+        for (int i = 0; i < 3; ++i) {
+            QVERIFY(consumer.tryRead(&message));
+            QCOMPARE(message, QByteArray::number(read++));
+        }
+    }
+    while (consumer.tryRead(&message))
+        QCOMPARE(message, QByteArray::number(read++));
+    QCOMPARE(read, written);
+
+    // empty messages, and truncation
+    QVERIFY(producer.tryWrite(""));
+    QVERIFY(producer.tryWrite("12345678"));
+    char buffer[4];
+    QCOMPARE(consumer.tryRead(buffer, sizeof(buffer)), 0);
+    QCOMPARE(consumer.tryRead(buffer, sizeof(buffer)), 4);
+    QCOMPARE(QByteArrayView(buffer, 4), "1234");
+    QCOMPARE(consumer.tryRead(buffer, sizeof(buffer)), -1);
+}
+
+void tst_QSharedMemoryRingBuffer::multiProducer()
+{
+    constexpr int ProducerCount = 4;
+    constexpr int MessageCount = 20000;
+
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY2(consumer.create(key, 2 * sizeof(int), 64,
+                             QSharedMemoryRingBuffer::Mode::MultiProducer),
+             qPrintable(consumer.errorString()));
+
+    QList<QThread *> threads;
+    for (int id = 0; id < ProducerCount; ++id) {
+        threads << QThread::create([this, id]() {
+            QSharedMemoryRingBuffer producer;
+            if (!producer.attach(key))
+                return;
+            for (int i = 0; i < MessageCount; ++i) {
+                const int message[2] = { id, i };
+                producer.write(QByteArrayView(reinterpret_cast<const char *>(message),
+                                              sizeof(message)));
+            }
+        });
+        threads.last()->start();
+    }
+
+    int next[ProducerCount] = {};
+    for (int received = 0; received < ProducerCount * MessageCount; ++received) {
+        int message[2];
+        while (consumer.tryRead(reinterpret_cast<char *>(message), sizeof(message)) == -1)
+            QVERIFY(consumer.waitForReadyRead(QDeadlineTimer(10s)));
+        QVERIFY(message[0] >= 0 && message[0] < ProducerCount);
+        // each producer's messages arrive in order
+        QCOMPARE(message[1], next[message[0]]++);
+    }
+    for (QThread *thread : std::as_const(threads)) {
+        QVERIFY(thread->wait(10s));
+        delete thread;
+    }
+    QByteArray extra;
+    QVERIFY(!consumer.tryRead(&extra));
+}
+
+void tst_QSharedMemoryRingBuffer::blockingWrite()
+{
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY2(consumer.create(key, 4, 1), qPrintable(consumer.errorString()));
+    QCOMPARE(consumer.capacity(), 2);
+    QSharedMemoryRingBuffer producer;
+    QVERIFY2(producer.attach(key), qPrintable(producer.errorString()));
+
+    QVERIFY(producer.write("a"));
+    QVERIFY(producer.write("b"));
+    QVERIFY(!producer.write("c", QDeadlineTimer(50ms)));
+
+    QScopedPointer<QThread> thread(QThread::create([&consumer]() {
+        QThread::sleep(50ms);
+        QByteArray message;
+        consumer.tryRead(&message);
+    }));
+    thread->start();
+    QVERIFY(producer.write("c", QDeadlineTimer(10s)));
+    QVERIFY(thread->wait(10s));
+
+    QByteArray message;
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "b");
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "c");
+}
+
+void tst_QSharedMemoryRingBuffer::waitForReadyRead()
+{
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY2(consumer.create(key, 4, 4), qPrintable(consumer.errorString()));
+    QVERIFY(!consumer.waitForReadyRead(QDeadlineTimer(20ms)));
+
+    QScopedPointer<QThread> thread(QThread::create([this]() {
+        QSharedMemoryRingBuffer producer;
+        if (!producer.attach(key))
+            return;
+        QThread::sleep(50ms);
+        producer.write("x");
+    }));
+    thread->start();
+    QVERIFY(consumer.waitForReadyRead(QDeadlineTimer(10s)));
+    QByteArray message;
+    QVERIFY(consumer.tryRead(&message));
+    QCOMPARE(message, "x");
+    QVERIFY(thread->wait(10s));
+}
+
+void tst_QSharedMemoryRingBuffer::eventDescriptor()
+{
+    QSharedMemoryRingBuffer consumer;
+    QVERIFY2(consumer.create(key, 4, 4), qPrintable(consumer.errorString()));
+    if (consumer.eventDescriptor() == -1)
+        QSKIP("Event descriptors are not supported on this platform");
+
+    QSharedMemoryRingBuffer producer;
+    QVERIFY2(producer.attach(key), qPrintable(producer.errorString()));
+    QVERIFY(producer.setEventDescriptor(consumer.eventDescriptor()));
+
+    QByteArray message;
+    QByteArrayList received;
+    QTestEventLoop loop;
+    QSocketNotifier notifier(consumer.eventDescriptor(), QSocketNotifier::Read);
+    connect(&notifier, &QSocketNotifier::activated, this, [&]() {
+        while (consumer.tryRead(&message))
+            received << message;
+        if (received.size() == 3)
+            loop.exitLoop();
+    });
+
+    // the consumer is idle once it has found the queue empty
+    QVERIFY(!consumer.tryRead(&message));
+    QVERIFY(producer.tryWrite("1"));
+    QVERIFY(producer.tryWrite("2"));
+    QTest::qWait(10);
+    QVERIFY(producer.tryWrite("3"));
+    loop.enterLoop(10s);
+    QVERIFY(!loop.timeout());
+    QCOMPARE(received, QByteArrayList({ "1", "2", "3" }));
+}
+
+QTEST_MAIN(tst_QSharedMemoryRingBuffer)
+#include "tst_qsharedmemoryringbuffer.moc"
@@ -3,11 +3,15 @@
 
 #include <QtTest/qtest.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qplugin.h>
 #include <QtCore/qversionnumber.h>
 #include <private/qfactoryloader_p.h>
 #include <private/qlibrary_p.h>
+#if QT_CONFIG(library) && defined(QT_BUILD_INTERNAL)
+#include <private/qpluginmetadatacache_p.h>
+#endif
 #include "plugin1/plugininterface1.h"
 #include "plugin2/plugininterface2.h"
 
@@ -28,6 +32,7 @@ private slots:
     void usingTwoFactoriesFromSameDir();
     void extraSearchPath();
     void multiplePaths();
+    void metaDataCache();
     void staticPlugin_data();
     void staticPlugin();
 };
@@ -173,6 +178,116 @@ void tst_QFactoryLoader::multiplePaths()
 #endif
 }
 
+void tst_QFactoryLoader::metaDataCache()
+{
+#if !QT_CONFIG(library) || !defined(QT_BUILD_INTERNAL) || defined(Q_OS_ANDROID)
+    QSKIP("Test not applicable in this configuration.");
+#else
+    auto findPlugin = [this](const char *name) {
+        QDirIterator it(binFolder, QDir::Files);
+        while (it.hasNext()) {
+            const QString fileName = it.next();
+            if (QLibrary::isLibrary(fileName) && it.fileName().contains(QLatin1String(name)))
+                return fileName;
+        }
+        return QString();
+    };
+    const QString plugin1 = findPlugin("plugin1");
+    const QString plugin2 = findPlugin("plugin2");
+    QVERIFY(!plugin1.isEmpty());
+    QVERIFY(!plugin2.isEmpty());
+
+    QTemporaryDir cacheDir;
+    QTemporaryDir root;
+    QVERIFY(cacheDir.isValid());
+    QVERIFY(root.isValid());
+    qputenv("QT_PLUGIN_METADATA_CACHE_DIR", QFile::encodeName(cacheDir.path()));
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_PLUGIN_METADATA_CACHE_DIR"); });
+
+    // a plugin and a file that is not one
+    QVERIFY(QDir(root.path()).mkdir("cached"));
+    const QString pluginDir = root.filePath("cached");
+    const QString suffix = QFileInfo(plugin1).suffix();
+    QVERIFY(QFile::copy(plugin1, pluginDir + "/plugin." + suffix));
+    QFile garbage(pluginDir + "/garbage." + suffix);
+    QVERIFY(garbage.open(QIODevice::WriteOnly));
+    garbage.write("not a plugin");
+    garbage.close();
+    const QString pluginFile = QFileInfo(pluginDir + "/plugin." + suffix).canonicalFilePath();
+    const QString garbageFile = QFileInfo(garbage).canonicalFilePath();
+
+    QCoreApplication::setLibraryPaths({ root.path() });
+    {
+        QFactoryLoader loader(PluginInterface1_iid, "/cached");
+        QCOMPARE(loader.metaData().size(), 1);
+    }
+
+    // both files were cached, the plugin with its metadata
+    {
+        QPluginMetaDataCache cache(pluginDir);
+        QVERIFY(cache.isEnabled());
+        QVERIFY(cache.cacheFileName().startsWith(cacheDir.path()));
+        QVERIFY(QFile::exists(cache.cacheFileName()));
+        const QPluginMetaDataCache::Entry *entry =
+                cache.find(pluginFile, QPluginMetaDataCache::fileKey(pluginFile));
+        QVERIFY(entry);
+        QVERIFY(entry->metaData.contains(PluginInterface1_iid));
+        entry = cache.find(garbageFile, QPluginMetaDataCache::fileKey(garbageFile));
+        QVERIFY(entry);
+        QVERIFY(entry->metaData.isEmpty());
+    }
+
+    // the cache is used
+    {
+        QFactoryLoader loader(PluginInterface1_iid, "/cached");
+        QCOMPARE(loader.metaData().size(), 1);
+        QCOMPARE(loader.metaData().at(0).value(QtPluginMetaDataKeys::ClassName), "Plugin1");
+    }
+
+    // rescanning a plugin that is still loaded keeps its entry
+    {
+        QFactoryLoader loader1(PluginInterface1_iid, "/cached");
+        QCOMPARE(loader1.metaData().size(), 1);
+        QFactoryLoader loader2(PluginInterface2_iid, "/cached");
+        QVERIFY(loader2.metaData().isEmpty());
+    }
+    {
+        QPluginMetaDataCache cache(pluginDir);
+        QVERIFY(cache.find(pluginFile, QPluginMetaDataCache::fileKey(pluginFile)));
+        QVERIFY(cache.find(garbageFile, QPluginMetaDataCache::fileKey(garbageFile)));
+    }
+
+    // replacing the plugin invalidates its entry
+    QVERIFY(QFile::remove(pluginFile));
+    QVERIFY(QFile::copy(plugin2, pluginFile));
+    {
+        QFactoryLoader loader1(PluginInterface1_iid, "/cached");
+        QVERIFY(loader1.metaData().isEmpty());
+        QFactoryLoader loader2(PluginInterface2_iid, "/cached");
+        QCOMPARE(loader2.metaData().size(), 1);
+        QCOMPARE(loader2.metaData().at(0).value(QtPluginMetaDataKeys::ClassName), "Plugin2");
+    }
+
+    // a corrupt cache is ignored and rewritten
+    {
+        QFile cacheFile(QPluginMetaDataCache(pluginDir).cacheFileName());
+        QVERIFY(cacheFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        cacheFile.write("\xff\x00garbage");
+    }
+    {
+        QFactoryLoader loader(PluginInterface2_iid, "/cached");
+        QCOMPARE(loader.metaData().size(), 1);
+    }
+    QPluginMetaDataCache cache(pluginDir);
+    QVERIFY(cache.find(pluginFile, QPluginMetaDataCache::fileKey(pluginFile)));
+
+    // and caching can be turned off
+    qputenv("QT_NO_PLUGIN_METADATA_CACHE", "1");
+    QVERIFY(!QPluginMetaDataCache(pluginDir).isEnabled());
+    qunsetenv("QT_NO_PLUGIN_METADATA_CACHE");
+#endif
+}
+
 Q_IMPORT_PLUGIN(StaticPlugin1)
 Q_IMPORT_PLUGIN(StaticPlugin2)
 constexpr bool IsDebug =
@@ -2860,6 +2860,12 @@ void tst_QDateTime::fromStringDateFormat_data()
         << Qt::ISODate << QDateTime(QDate(2014, 12, 15), QTime(15, 37, 9, 745), UTC);
     QTest::newRow("ISO lower-case") << QString::fromLatin1("2005-06-28T07:57:30.002z")
         << Qt::ISODate << QDateTime(QDate(2005, 6, 28), QTime(7, 57, 30, 2), UTC);
+    QTest::newRow("ISO lower-case t") << QString::fromLatin1("2005-06-28t13:27:30.002+05:30")
+        << Qt::ISODate << QDateTime(QDate(2005, 6, 28), QTime(7, 57, 30, 2), UTC);
+    QTest::newRow("ISO comma zz") << QString::fromLatin1("2005-06-28T07:57:30,25Z")
+        << Qt::ISODate << QDateTime(QDate(2005, 6, 28), QTime(7, 57, 30, 250), UTC);
+    QTest::newRow("ISO invalid day") << QString::fromLatin1("2005-02-29T07:57:30.002Z")
+        << Qt::ISODate << QDateTime();
     // No time specified - defaults to Qt::LocalTime.
     QTest::newRow("ISO data3") << QString::fromLatin1("2002-10-01")
                                << Qt::ISODate << QDate(2002, 10, 1).startOfDay();
@@ -43,6 +43,9 @@ private Q_SLOTS:
     void archiveBomb();
 
     void bigZlib();
+
+    void statistics_data();
+    void statistics();
 };
 
 void tst_QDecompressHelper::initTestCase()
@@ -147,6 +150,37 @@ void tst_QDecompressHelper::decompress()
     QCOMPARE(actual, expected);
 }
 
+void tst_QDecompressHelper::statistics_data()
+{
+    sharedDecompress_data();
+}
+
+void tst_QDecompressHelper::statistics()
+{
+    QDecompressHelper helper;
+
+    QFETCH(QByteArray, encoding);
+    QVERIFY(helper.setEncoding(encoding));
+    QCOMPARE(helper.compressedBytes(), 0);
+    QCOMPARE(helper.decompressedBytes(), 0);
+    QCOMPARE(helper.decompressionTime(), 0);
+
+    QFETCH(QByteArray, data);
+    helper.feed(data);
+    QCOMPARE(helper.compressedBytes(), data.size());
+
+    QFETCH(QByteArray, expected);
+    QByteArray actual(expected.size(), Qt::Uninitialized);
+    QCOMPARE(helper.read(actual.data(), actual.size()), expected.size());
+    QCOMPARE(helper.decompressedBytes(), expected.size());
+    QCOMPARE_GT(helper.decompressionTime(), 0);
+
+    helper.clear();
+    QCOMPARE(helper.compressedBytes(), 0);
+    QCOMPARE(helper.decompressedBytes(), 0);
+    QCOMPARE(helper.decompressionTime(), 0);
+}
+
 void tst_QDecompressHelper::partialDecompress_data()
 {
     sharedDecompress_data();
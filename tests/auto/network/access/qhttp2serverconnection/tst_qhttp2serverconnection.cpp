@@ -0,0 +1,502 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <QtNetwork/private/bitstreams_p.h>
+#include <QtNetwork/private/qhttp2serverconnection_p.h>
+#include <QtNetwork/qhttp2configuration.h>
+#include <QtNetwork/qnetworkaccessmanager.h>
+#include <QtNetwork/qnetworkreply.h>
+#include <QtNetwork/qnetworkrequest.h>
+#include <QtNetwork/qtcpserver.h>
+#include <QtNetwork/qtcpsocket.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qtimer.h>
+
+#include <functional>
+#include <optional>
+
+using namespace Qt::StringLiterals;
+
+class tst_QHttp2ServerConnection : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+
+    void singleRequest();
+    void postRequest();
+    void largeResponse();
+    void multiplexing();
+    void maxConcurrentStreams();
+    void priority();
+    void priorityOrder();
+    void clientAbort();
+    void invalidPreface();
+    void maxHeaderListSize();
+    void continuationFlood();
+    void shutdown();
+
+private:
+    QNetworkRequest request(const QString &path) const;
+    static void respond(QHttp2ServerStream *stream, const QByteArray &body);
+    static QByteArray frame(Http2::FrameType type, Http2::FrameFlags flags, quint32 streamID,
+                            const QByteArray &payload);
+    static QByteArray requestBlock(const QByteArray &path);
+
+    QNetworkAccessManager manager;
+    QTcpServer server;
+    QHttp2Configuration serverConfiguration;
+    QList<QHttp2ServerConnection *> connections;
+    std::function<void(QHttp2ServerStream *)> handler;
+};
+
+void tst_QHttp2ServerConnection::init()
+{
+    serverConfiguration = QHttp2Configuration();
+    connections.clear();
+    handler = [](QHttp2ServerStream *stream) { respond(stream, stream->path()); };
+
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    connect(&server, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = server.nextPendingConnection()) {
+            auto connection = new QHttp2ServerConnection(socket, serverConfiguration, socket);
+            connect(connection, &QHttp2ServerConnection::newRequest, this,
+                    [this](QHttp2ServerStream *stream) { handler(stream); });
+            connections.append(connection);
+        }
+    });
+}
+
+void tst_QHttp2ServerConnection::cleanup()
+{
+    server.close();
+    server.disconnect(this);
+    manager.clearConnectionCache();
+}
+
+QNetworkRequest tst_QHttp2ServerConnection::request(const QString &path) const
+{
+    QNetworkRequest request(QUrl(u"http://127.0.0.1:%1%2"_s.arg(server.serverPort()).arg(path)));
+    request.setAttribute(QNetworkRequest::Http2DirectAttribute, true);
+    return request;
+}
+
+void tst_QHttp2ServerConnection::respond(QHttp2ServerStream *stream, const QByteArray &body)
+{
+    HPack::HttpHeader headers;
+    headers.emplace_back(":status", "200");
+    headers.emplace_back("content-type", "text/plain");
+    headers.emplace_back("content-length", QByteArray::number(body.size()));
+    QVERIFY(stream->sendHeaders(headers, body.isEmpty()));
+    if (!body.isEmpty())
+        QVERIFY(stream->sendData(body, true));
+}
+
+// Frames for the tests that talk to the server over a plain socket:
+QByteArray tst_QHttp2ServerConnection::frame(Http2::FrameType type, Http2::FrameFlags flags,
+                                             quint32 streamID, const QByteArray &payload)
+{
+    QByteArray frame(Http2::frameHeaderSize, Qt::Uninitialized);
+    frame[0] = char(payload.size() >> 16);
+    frame[1] = char(payload.size() >> 8);
+    frame[2] = char(payload.size());
+    frame[3] = char(type);
+    frame[4] = char(flags.toInt());
+    qToBigEndian(streamID, frame.data() + 5);
+    return frame + payload;
+}
+
+QByteArray tst_QHttp2ServerConnection::requestBlock(const QByteArray &path)
+{
+    HPack::HttpHeader headers;
+    headers.emplace_back(":method", "GET");
+    headers.emplace_back(":scheme", "http");
+    headers.emplace_back(":authority", "localhost");
+    headers.emplace_back(":path", path);
+
+    std::vector<uchar> buffer;
+    HPack::BitOStream stream(buffer);
+    HPack::Encoder encoder(HPack::FieldLookupTable::DefaultSize, false);
+    if (!encoder.encodeRequest(stream, headers))
+        return {};
+    return QByteArray(reinterpret_cast<const char *>(buffer.data()), buffer.size());
+}
+
+void tst_QHttp2ServerConnection::singleRequest()
+{
+    QByteArray method;
+    QByteArray authority;
+    QByteArray userAgent;
+    bool requestFinished = false;
+    handler = [&](QHttp2ServerStream *stream) {
+        method = stream->method();
+        authority = stream->authority();
+        userAgent = stream->requestHeader("user-agent");
+        requestFinished = stream->isRequestFinished();
+        respond(stream, "Hello, HTTP/2");
+    };
+
+    QNetworkRequest request = this->request(u"/index.html"_s);
+    request.setHeader(QNetworkRequest::UserAgentHeader, "tst_qhttp2serverconnection");
+    std::unique_ptr<QNetworkReply> reply(manager.get(request));
+    QTRY_VERIFY(reply->isFinished());
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QVERIFY(reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->rawHeader("content-type"), "text/plain");
+    QCOMPARE(reply->readAll(), "Hello, HTTP/2");
+
+    QCOMPARE(method, "GET");
+    QCOMPARE(authority, u"127.0.0.1:%1"_s.arg(server.serverPort()).toLatin1());
+    QCOMPARE(userAgent, "tst_qhttp2serverconnection");
+    QVERIFY(requestFinished);
+    QCOMPARE(connections.size(), 1);
+}
+
+void tst_QHttp2ServerConnection::postRequest()
+{
+    // The server's windows are small and only reopened as the request body
+    // is read.
+    QVERIFY(serverConfiguration.setStreamReceiveWindowSize(Http2::minPayloadLimit));
+    handler = [](QHttp2ServerStream *stream) {
+        QVERIFY(!stream->isRequestFinished());
+        auto body = std::make_shared<QByteArray>();
+        connect(stream, &QHttp2ServerStream::readyRead, stream, [stream, body]() {
+            body->append(stream->readAll());
+        });
+        connect(stream, &QHttp2ServerStream::requestFinished, stream, [stream, body]() {
+            body->append(stream->readAll());
+            respond(stream, QCryptographicHash::hash(*body, QCryptographicHash::Sha1).toHex());
+        });
+    };
+
+    QByteArray body(1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < body.size(); ++i)
+        body[i] = char(i * 7);
+
+    QNetworkRequest request = this->request(u"/upload"_s);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/octet-stream");
+    std::unique_ptr<QNetworkReply> reply(manager.post(request, body));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 20000);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), QCryptographicHash::hash(body, QCryptographicHash::Sha1).toHex());
+}
+
+void tst_QHttp2ServerConnection::largeResponse()
+{
+    // The client's windows are small, so the server has to wait for its
+    // WINDOW_UPDATEs.
+    QByteArray body(4 * 1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < body.size(); ++i)
+        body[i] = char(i * 13);
+
+    qint64 written = 0;
+    handler = [&](QHttp2ServerStream *stream) {
+        connect(stream, &QHttp2ServerStream::bytesWritten, this,
+                [&written](qint64 bytes) { written += bytes; });
+        respond(stream, body);
+    };
+
+    QHttp2Configuration clientConfiguration;
+    QVERIFY(clientConfiguration.setStreamReceiveWindowSize(Http2::defaultSessionWindowSize));
+    QVERIFY(clientConfiguration.setSessionReceiveWindowSize(Http2::defaultSessionWindowSize));
+    QNetworkRequest request = this->request(u"/large"_s);
+    request.setHttp2Configuration(clientConfiguration);
+    std::unique_ptr<QNetworkReply> reply(manager.get(request));
+    QTRY_VERIFY_WITH_TIMEOUT(reply->isFinished(), 20000);
+
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), body);
+    QCOMPARE(written, body.size());
+}
+
+void tst_QHttp2ServerConnection::multiplexing()
+{
+    constexpr int RequestCount = 20;
+
+    // Hold all responses until every request has arrived, then answer them
+    // in reverse order: this only works if the requests share a connection.
+    QList<QPointer<QHttp2ServerStream>> streams;
+    handler = [&](QHttp2ServerStream *stream) {
+        streams.append(stream);
+        if (streams.size() < RequestCount)
+            return;
+        QCOMPARE(stream->connection()->activeStreamCount(), RequestCount);
+        for (auto it = streams.crbegin(); it != streams.crend(); ++it)
+            respond(*it, (*it)->path());
+    };
+
+    std::vector<std::unique_ptr<QNetworkReply>> replies;
+    for (int i = 0; i < RequestCount; ++i)
+        replies.emplace_back(manager.get(request(u"/%1"_s.arg(i))));
+    for (const auto &reply : replies)
+        QTRY_VERIFY(reply->isFinished());
+
+    for (int i = 0; i < RequestCount; ++i) {
+        QCOMPARE(replies[i]->error(), QNetworkReply::NoError);
+        QCOMPARE(replies[i]->readAll(), u"/%1"_s.arg(i).toLatin1());
+    }
+    QCOMPARE(connections.size(), 1);
+    QTRY_COMPARE(connections.first()->activeStreamCount(), 0);
+}
+
+void tst_QHttp2ServerConnection::maxConcurrentStreams()
+{
+    constexpr int RequestCount = 8;
+
+    int active = 0;
+    int maxActive = 0;
+    handler = [&](QHttp2ServerStream *stream) {
+        stream->connection()->setMaxConcurrentStreams(2);
+        maxActive = std::max(maxActive, ++active);
+        QTimer::singleShot(10, stream, [&active, stream]() {
+            --active;
+            respond(stream, stream->path());
+        });
+    };
+
+    // The first request makes sure the client has seen our SETTINGS.
+    std::unique_ptr<QNetworkReply> first(manager.get(request(u"/first"_s)));
+    QTRY_VERIFY(first->isFinished());
+    QCOMPARE(first->error(), QNetworkReply::NoError);
+
+    maxActive = 0;
+    std::vector<std::unique_ptr<QNetworkReply>> replies;
+    for (int i = 0; i < RequestCount; ++i)
+        replies.emplace_back(manager.get(request(u"/%1"_s.arg(i))));
+    for (const auto &reply : replies) {
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+    }
+    QCOMPARE(maxActive, 2);
+    QCOMPARE(connections.size(), 1);
+}
+
+void tst_QHttp2ServerConnection::priority()
+{
+    QMap<QByteArray, int> weights;
+    handler = [&](QHttp2ServerStream *stream) {
+        weights.insert(stream->path(), stream->weight());
+        QCOMPARE(stream->dependency(), 0u);
+        respond(stream, {});
+    };
+
+    QNetworkRequest high = request(u"/high"_s);
+    high.setPriority(QNetworkRequest::HighPriority);
+    QNetworkRequest low = request(u"/low"_s);
+    low.setPriority(QNetworkRequest::LowPriority);
+    std::unique_ptr<QNetworkReply> highReply(manager.get(high));
+    std::unique_ptr<QNetworkReply> lowReply(manager.get(low));
+    QTRY_VERIFY(highReply->isFinished() && lowReply->isFinished());
+
+    QCOMPARE(weights.value("/high"), 256);
+    QCOMPARE(weights.value("/low"), 1);
+}
+
+void tst_QHttp2ServerConnection::priorityOrder()
+{
+    // Both responses are queued together, the low-weight one first; the
+    // high-weight stream still has all of its DATA written before the other.
+    const QByteArray body(64 * 1024, 'x');
+    QList<QPointer<QHttp2ServerStream>> streams;
+    QList<int> weights;
+    handler = [&](QHttp2ServerStream *stream) {
+        streams.append(stream);
+        weights.append(stream->weight());
+        if (streams.size() == 2) {
+            respond(streams.at(1), body);
+            respond(streams.at(0), body);
+        }
+    };
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected());
+
+    // Open the windows wide, so that flow control has no say in the order:
+    QByteArray settings(6, Qt::Uninitialized);
+    qToBigEndian(quint16(Http2::Settings::INITIAL_WINDOW_SIZE_ID), settings.data());
+    qToBigEndian(quint32(Http2::maxSessionReceiveWindowSize), settings.data() + 2);
+    QByteArray increment(4, Qt::Uninitialized);
+    qToBigEndian(quint32(Http2::maxSessionReceiveWindowSize - Http2::defaultSessionWindowSize),
+                 increment.data());
+
+    const auto priorityHeaders = [](quint32 streamID, uchar weight, const QByteArray &block) {
+        QByteArray payload(5, '\0');
+        payload[4] = char(weight);
+        return frame(Http2::FrameType::HEADERS,
+                     Http2::FrameFlag::PRIORITY | Http2::FrameFlag::END_HEADERS
+                             | Http2::FrameFlag::END_STREAM,
+                     streamID, payload + block);
+    };
+
+    QByteArray data(Http2::Http2clientPreface, Http2::clientPrefaceLength);
+    data += frame(Http2::FrameType::SETTINGS, Http2::FrameFlag::EMPTY, 0, settings);
+    data += frame(Http2::FrameType::WINDOW_UPDATE, Http2::FrameFlag::EMPTY, 0, increment);
+    data += priorityHeaders(1, 255, requestBlock("/high"));
+    data += priorityHeaders(3, 0, requestBlock("/low"));
+    client.write(data);
+
+    // Collect the stream IDs of the DATA frames, in the order they arrive:
+    QByteArray received;
+    QList<quint32> dataFrames;
+    int streamsEnded = 0;
+    const auto readFrames = [&]() {
+        received += client.readAll();
+        while (received.size() >= Http2::frameHeaderSize) {
+            const quint32 length = quint32(uchar(received.at(0))) << 16
+                                   | quint32(uchar(received.at(1))) << 8 | uchar(received.at(2));
+            if (quint32(received.size()) < Http2::frameHeaderSize + length)
+                break;
+            if (Http2::FrameType(received.at(3)) == Http2::FrameType::DATA) {
+                dataFrames.append(qFromBigEndian<quint32>(received.constData() + 5));
+                if (Http2::FrameFlags(uchar(received.at(4))).testFlag(Http2::FrameFlag::END_STREAM))
+                    ++streamsEnded;
+            }
+            received.remove(0, Http2::frameHeaderSize + length);
+        }
+        return streamsEnded == 2;
+    };
+    QTRY_VERIFY(readFrames());
+
+    QCOMPARE(weights, QList<int>({ 256, 1 }));
+    QVERIFY(dataFrames.size() > 2);
+    QCOMPARE(dataFrames.first(), 1u);
+    QCOMPARE(dataFrames.lastIndexOf(1u) + 1, dataFrames.indexOf(3u));
+    QCOMPARE(dataFrames.last(), 3u);
+}
+
+void tst_QHttp2ServerConnection::clientAbort()
+{
+    QPointer<QHttp2ServerStream> serverStream;
+    std::unique_ptr<QSignalSpy> errorSpy;
+    std::unique_ptr<QSignalSpy> closedSpy;
+    handler = [&](QHttp2ServerStream *stream) {
+        serverStream = stream;
+        errorSpy.reset(new QSignalSpy(stream, &QHttp2ServerStream::errorOccurred));
+        closedSpy.reset(new QSignalSpy(stream, &QHttp2ServerStream::closed));
+        HPack::HttpHeader headers;
+        headers.emplace_back(":status", "200");
+        QVERIFY(stream->sendHeaders(headers));
+        QVERIFY(stream->sendData("partial"));
+    };
+
+    std::unique_ptr<QNetworkReply> reply(manager.get(request(u"/slow"_s)));
+    QTRY_VERIFY(serverStream);
+    QTRY_VERIFY(reply->bytesAvailable());
+    reply->abort();
+
+    QTRY_COMPARE(closedSpy->size(), 1);
+    QCOMPARE(errorSpy->size(), 1);
+    QCOMPARE(errorSpy->first().first().toUInt(), quint32(Http2::CANCEL));
+    QTRY_VERIFY(!serverStream);
+    QCOMPARE(connections.size(), 1);
+    QCOMPARE(connections.first()->activeStreamCount(), 0);
+}
+
+void tst_QHttp2ServerConnection::invalidPreface()
+{
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected());
+    client.write("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    QTRY_COMPARE(connections.size(), 1);
+    QSignalSpy errorSpy(connections.first(), &QHttp2ServerConnection::errorOccurred);
+    QTRY_COMPARE(errorSpy.size(), 1);
+    QCOMPARE(errorSpy.first().first().toUInt(), quint32(Http2::PROTOCOL_ERROR));
+    QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+
+    // What we got before the disconnect is our SETTINGS and a GOAWAY:
+    const QByteArray data = client.readAll();
+    QVERIFY(data.size() > 2 * Http2::frameHeaderSize);
+    QCOMPARE(Http2::FrameType(data.at(3)), Http2::FrameType::SETTINGS);
+}
+
+void tst_QHttp2ServerConnection::maxHeaderListSize()
+{
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(connections.size(), 1);
+    QCOMPARE(connections.first()->maxHeaderListSize(), 64u * 1024);
+
+    // Our SETTINGS frame is the first thing the client gets:
+    QByteArray data;
+    QTRY_VERIFY((data += client.readAll()).size() >= Http2::frameHeaderSize);
+    QCOMPARE(Http2::FrameType(data.at(3)), Http2::FrameType::SETTINGS);
+    const quint32 length = quint32(uchar(data.at(1))) << 8 | uchar(data.at(2));
+    QTRY_VERIFY((data += client.readAll()).size() >= Http2::frameHeaderSize + length);
+
+    std::optional<quint32> advertised;
+    for (quint32 i = 0; i + 6 <= length; i += 6) {
+        const char *setting = data.constData() + Http2::frameHeaderSize + i;
+        if (qFromBigEndian<quint16>(setting) == quint16(Http2::Settings::MAX_HEADER_LIST_SIZE_ID))
+            advertised = qFromBigEndian<quint32>(setting + 2);
+    }
+    QCOMPARE(advertised, 64u * 1024);
+}
+
+void tst_QHttp2ServerConnection::continuationFlood()
+{
+    bool requested = false;
+    handler = [&](QHttp2ServerStream *) { requested = true; };
+
+    QTcpSocket client;
+    client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+    QVERIFY(client.waitForConnected());
+    QTRY_COMPARE(connections.size(), 1);
+    QSignalSpy errorSpy(connections.first(), &QHttp2ServerConnection::errorOccurred);
+
+    // A header block that never ends: the connection must give up on it once
+    // it is larger than the header list size we advertised.
+    QByteArray data(Http2::Http2clientPreface, Http2::clientPrefaceLength);
+    data += frame(Http2::FrameType::SETTINGS, Http2::FrameFlag::EMPTY, 0, {});
+    data += frame(Http2::FrameType::HEADERS, Http2::FrameFlag::END_STREAM, 1,
+                  requestBlock("/flood"));
+    const QByteArray continuation = frame(Http2::FrameType::CONTINUATION, Http2::FrameFlag::EMPTY, 1,
+                                          QByteArray(Http2::minPayloadLimit, 'x'));
+    for (int i = 0; i < 8; ++i)
+        data += continuation;
+    client.write(data);
+
+    QTRY_COMPARE(errorSpy.size(), 1);
+    QCOMPARE(errorSpy.first().first().toUInt(), quint32(Http2::ENHANCE_YOUR_CALM));
+    QTRY_COMPARE(client.state(), QAbstractSocket::UnconnectedState);
+    QVERIFY(!requested);
+}
+
+void tst_QHttp2ServerConnection::shutdown()
+{
+    QPointer<QHttp2ServerStream> pending;
+    handler = [&](QHttp2ServerStream *stream) { pending = stream; };
+
+    std::unique_ptr<QNetworkReply> reply(manager.get(request(u"/pending"_s)));
+    QTRY_VERIFY(pending);
+
+    QHttp2ServerConnection *connection = connections.first();
+    QSignalSpy finishedSpy(connection, &QHttp2ServerConnection::finished);
+    connection->shutdown();
+    QVERIFY(connection->isGoingAway());
+
+    // The active stream may still complete.
+    QTest::qWait(20);
+    QVERIFY(!reply->isFinished());
+    respond(pending, "done");
+    QTRY_VERIFY(reply->isFinished());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), "done");
+    QTRY_COMPARE(finishedSpy.size(), 1);
+}
+
+QTEST_MAIN(tst_QHttp2ServerConnection)
+#include "tst_qhttp2serverconnection.moc"
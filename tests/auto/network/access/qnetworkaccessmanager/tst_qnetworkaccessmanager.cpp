@@ -5,9 +5,54 @@
 
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
 
 #include <QtCore/QDebug>
 
+using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
+
+// Counts the connections made to it, and answers every request on them
+// with a small HTTP/1.1 response.
+class ConnectionCountingServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    ConnectionCountingServer()
+    {
+        connect(this, &QTcpServer::pendingConnectionAvailable, this, [this]() {
+            while (QTcpSocket *socket = nextPendingConnection()) {
+                ++connectionCount;
+                sockets << socket;
+                connect(socket, &QTcpSocket::readyRead, socket, [this, socket]() {
+                    QByteArray &data = received[socket];
+                    data += socket->readAll();
+                    if (data.startsWith("PRI * HTTP/2.0"))
+                        return;
+                    qsizetype end;
+                    while ((end = data.indexOf("\r\n\r\n")) != -1) {
+                        data.remove(0, end + 4);
+                        socket->write("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok");
+                    }
+                });
+            }
+        });
+    }
+
+    QUrl url() const { return QUrl(u"http://127.0.0.1:%1/"_s.arg(serverPort())); }
+    qsizetype openConnections() const
+    {
+        return std::count_if(sockets.cbegin(), sockets.cend(), [](const QTcpSocket *socket) {
+            return socket->state() == QAbstractSocket::ConnectedState;
+        });
+    }
+
+    int connectionCount = 0;
+    QList<QTcpSocket *> sockets;
+    QHash<QTcpSocket *, QByteArray> received;
+};
+
 class tst_QNetworkAccessManager : public QObject
 {
     Q_OBJECT
@@ -17,6 +62,9 @@ public:
 
 private slots:
     void alwaysCacheRequest();
+    void warmUpConnections();
+    void warmUpConnectionsReconnect();
+    void warmUpConnectionsHttp2Direct();
 };
 
 tst_QNetworkAccessManager::tst_QNetworkAccessManager()
@@ -34,5 +82,77 @@ void tst_QNetworkAccessManager::alwaysCacheRequest()
     delete reply;
 }
 
+void tst_QNetworkAccessManager::warmUpConnections()
+{
+    ConnectionCountingServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(server.url());
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    manager.warmUpConnections(request, 4);
+    QTRY_COMPARE(server.connectionCount, 4);
+    QTest::qWait(100ms);
+    QCOMPARE(server.connectionCount, 4);
+
+    // a burst of requests goes out on the warm connections
+    QList<QNetworkReply *> replies;
+    for (int i = 0; i < 4; ++i)
+        replies << manager.get(request);
+    for (QNetworkReply *reply : std::as_const(replies)) {
+        QTRY_VERIFY(reply->isFinished());
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), "ok");
+        delete reply;
+    }
+    QCOMPARE(server.connectionCount, 4);
+
+    // more connections than we have channels per host
+    manager.clearConnectionCache();
+    QTRY_COMPARE(server.openConnections(), 0);
+    manager.warmUpConnections(request, 100);
+    QTRY_COMPARE(server.connectionCount, 4 + 6);
+    QTest::qWait(100ms);
+    QCOMPARE(server.connectionCount, 4 + 6);
+}
+
+void tst_QNetworkAccessManager::warmUpConnectionsReconnect()
+{
+    ConnectionCountingServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(server.url());
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    // connections are checked on every second
+    request.setAttribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute, 4);
+    manager.warmUpConnections(request, 2);
+    QTRY_COMPARE(server.openConnections(), 2);
+
+    // the server drops an idle connection, we open a new one
+    server.sockets.first()->disconnectFromHost();
+    QTRY_COMPARE_WITH_TIMEOUT(server.connectionCount, 3, 5000);
+    QTRY_COMPARE(server.openConnections(), 2);
+}
+
+void tst_QNetworkAccessManager::warmUpConnectionsHttp2Direct()
+{
+    ConnectionCountingServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(server.url());
+    request.setAttribute(QNetworkRequest::Http2DirectAttribute, true);
+    manager.warmUpConnections(request, 3);
+
+    // one connection for HTTP/2, on which we start the session right away
+    QTRY_COMPARE(server.connectionCount, 1);
+    QTRY_VERIFY(server.received.value(server.sockets.first()).size() > 24);
+    QVERIFY(server.received.value(server.sockets.first())
+                    .startsWith("PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"));
+    QTest::qWait(100ms);
+    QCOMPARE(server.connectionCount, 1);
+}
+
 QTEST_MAIN(tst_QNetworkAccessManager)
 #include "tst_qnetworkaccessmanager.moc"
@@ -27,6 +27,7 @@ private slots:
     void setCookiesFromUrl();
     void cookiesForUrl_data();
     void cookiesForUrl();
+    void removeExpiredCookies();
 #if defined(QT_BUILD_INTERNAL) && QT_CONFIG(topleveldomain)
     void effectiveTLDs_data();
     void effectiveTLDs();
@@ -400,6 +401,33 @@ void tst_QNetworkCookieJar::cookiesForUrl()
     QCOMPARE(result, expectedResult);
 }
 
+void tst_QNetworkCookieJar::removeExpiredCookies()
+{
+    QNetworkCookie expired("expired", "value");
+    expired.setDomain(".qt-project.org");
+    expired.setPath("/");
+    expired.setExpirationDate(QDateTime::currentDateTimeUtc().addSecs(-1));
+    QNetworkCookie session("session", "value");
+    session.setDomain(".qt-project.org");
+    session.setPath("/");
+    QNetworkCookie persistent("persistent", "value");
+    persistent.setDomain("qt-project.org");
+    persistent.setPath("/");
+    persistent.setExpirationDate(QDateTime::currentDateTimeUtc().addDays(1));
+
+    MyCookieJar jar;
+    jar.setAllCookies({ expired, session });
+    QCOMPARE(jar.allCookies(), QList<QNetworkCookie>({ expired, session }));
+    QCOMPARE(jar.cookiesForUrl(QUrl("http://www.qt-project.org/")), QList<QNetworkCookie>{ session });
+
+    // expired cookies are dropped once the jar changes
+    QVERIFY(jar.insertCookie(persistent));
+    QCOMPARE(jar.allCookies(), QList<QNetworkCookie>({ session, persistent }));
+    QCOMPARE(jar.cookiesForUrl(QUrl("http://qt-project.org/")),
+             QList<QNetworkCookie>({ session, persistent }));
+    QCOMPARE(jar.cookiesForUrl(QUrl("http://www.qt-project.org/")), QList<QNetworkCookie>{ session });
+}
+
 // This test requires private API.
 #if defined(QT_BUILD_INTERNAL) && QT_CONFIG(topleveldomain)
 void tst_QNetworkCookieJar::effectiveTLDs_data()
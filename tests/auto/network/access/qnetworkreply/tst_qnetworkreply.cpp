@@ -551,6 +551,11 @@ private Q_SLOTS:
     void downloadProgressWithContentEncoding();
     void contentEncodingError_data();
     void contentEncodingError();
+    void backgroundDecompression_data();
+    void backgroundDecompression();
+    void decompressionStatistics_data();
+    void decompressionStatistics();
+    void connectionStatistics();
     void compressedReadyRead();
     void notFoundWithCompression_data();
     void notFoundWithCompression();
@@ -10274,9 +10279,12 @@ void tst_QNetworkReply::contentEncodingError_data()
     QTest::addColumn<QByteArray>("encoding");
     QTest::addColumn<QString>("path");
     QTest::addColumn<QNetworkReply::NetworkError>("expectedError");
+    QTest::addColumn<bool>("backgroundDecompression");
 
     QTest::addRow("archive-bomb") << QByteArray("gzip") << (":/4G.gz")
-                                  << QNetworkReply::UnknownContentError;
+                                  << QNetworkReply::UnknownContentError << false;
+    QTest::addRow("archive-bomb-background") << QByteArray("gzip") << (":/4G.gz")
+                                             << QNetworkReply::UnknownContentError << true;
 }
 
 void tst_QNetworkReply::contentEncodingError()
@@ -10294,12 +10302,180 @@ void tst_QNetworkReply::contentEncodingError()
 
     QNetworkRequest request(
             QUrl(QLatin1String("http://localhost:%1").arg(QString::number(server.serverPort()))));
+    QFETCH(bool, backgroundDecompression);
+    request.setAttribute(QNetworkRequest::BackgroundDecompressionAttribute,
+                         backgroundDecompression);
     QNetworkReplyPtr reply(manager.get(request));
 
     QTRY_VERIFY2_WITH_TIMEOUT(reply->isFinished(), qPrintable(reply->errorString()), 15000);
     QTEST(reply->error(), "expectedError");
 }
 
+void tst_QNetworkReply::backgroundDecompression_data()
+{
+    QTest::addColumn<QByteArray>("encoding");
+    QTest::addColumn<QByteArray>("body");
+    QTest::addColumn<QByteArray>("expected");
+    QTest::addColumn<qint64>("readBufferSize");
+
+    const QByteArray helloWorld = "hello world";
+    QTest::newRow("gzip-hello-world")
+            << QByteArray("gzip")
+            << QByteArray::fromBase64("H4sIAAAAAAAAA8tIzcnJVyjPL8pJAQCFEUoNCwAAAA==")
+            << helloWorld << qint64(0);
+    QTest::newRow("deflate-hello-world")
+            << QByteArray("deflate") << QByteArray::fromBase64("eJzLSM3JyVcozy/KSQEAGgsEXQ==")
+            << helloWorld << qint64(0);
+#if QT_CONFIG(brotli)
+    QTest::newRow("brotli-hello-world")
+            << QByteArray("br") << QByteArray::fromBase64("DwWAaGVsbG8gd29ybGQD")
+            << helloWorld << qint64(0);
+#endif
+
+    // Large enough to be decompressed in several chunks and to be sent in
+    // several reads from the socket
+    QByteArray large;
+    for (int i = 0; large.size() < 4 * 1024 * 1024; ++i)
+        large += "line " + QByteArray::number(i) + ": the quick brown fox jumps over the lazy dog\n";
+    // Strip the length that qCompress() puts in front of the zlib stream
+    const QByteArray deflated = qCompress(large).sliced(4);
+    QTest::newRow("deflate-large") << QByteArray("deflate") << deflated << large << qint64(0);
+    QTest::newRow("deflate-large-read-buffer")
+            << QByteArray("deflate") << deflated << large << qint64(100 * 1024);
+}
+
+void tst_QNetworkReply::backgroundDecompression()
+{
+    QFETCH(QByteArray, encoding);
+    QFETCH(QByteArray, body);
+    QFETCH(QByteArray, expected);
+    QFETCH(qint64, readBufferSize);
+    QString header("HTTP/1.0 200 OK\r\nContent-Encoding: %1\r\nContent-Length: %2\r\n\r\n");
+    header = header.arg(encoding, QString::number(body.size()));
+
+    MiniHttpServer server(header.toLatin1() + body);
+
+    QNetworkRequest request(
+            QUrl(QLatin1String("http://localhost:%1").arg(QString::number(server.serverPort()))));
+    request.setAttribute(QNetworkRequest::BackgroundDecompressionAttribute, true);
+    QNetworkReplyPtr reply(manager.get(request));
+    reply->setReadBufferSize(readBufferSize);
+
+    QByteArray received;
+    qint64 mostBuffered = 0;
+    QObject::connect(reply.get(), &QNetworkReply::readyRead, reply.get(),
+                     [reply = reply.get(), &received, &mostBuffered]() {
+                         mostBuffered = qMax(mostBuffered, reply->bytesAvailable());
+                         received += reply->readAll();
+                     });
+    QTRY_VERIFY2_WITH_TIMEOUT(reply->isFinished(), qPrintable(reply->errorString()), 15000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    received += reply->readAll();
+    QCOMPARE(received.size(), expected.size());
+    QCOMPARE(received, expected);
+    if (readBufferSize)
+        QCOMPARE_LE(mostBuffered, readBufferSize);
+}
+
+void tst_QNetworkReply::decompressionStatistics_data()
+{
+    QTest::addColumn<bool>("backgroundDecompression");
+
+    QTest::newRow("user-thread") << false;
+    QTest::newRow("background") << true;
+}
+
+void tst_QNetworkReply::decompressionStatistics()
+{
+    QFETCH(bool, backgroundDecompression);
+    const QByteArray body =
+            QByteArray::fromBase64("H4sIAAAAAAAAA8tIzcnJVyjPL8pJAQCFEUoNCwAAAA==");
+    const QByteArray expected = "hello world";
+    QString header("HTTP/1.0 200 OK\r\nContent-Encoding: gzip\r\nContent-Length: %1\r\n\r\n");
+    header = header.arg(body.size());
+
+    MiniHttpServer server(header.toLatin1() + body);
+
+    QNetworkRequest request(
+            QUrl(QLatin1String("http://localhost:%1").arg(QString::number(server.serverPort()))));
+    request.setAttribute(QNetworkRequest::BackgroundDecompressionAttribute,
+                         backgroundDecompression);
+    QNetworkReplyPtr reply(manager.get(request));
+    QVERIFY(waitForFinish(reply) != Timeout);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    QCOMPARE(reply->readAll(), expected);
+
+    QCOMPARE(reply->attribute(QNetworkRequest::CompressedBytesAttribute).toLongLong(),
+             body.size());
+    QCOMPARE(reply->attribute(QNetworkRequest::DecompressedBytesAttribute).toLongLong(),
+             expected.size());
+    QCOMPARE_GT(reply->attribute(QNetworkRequest::DecompressionTimeAttribute).toLongLong(), 0);
+
+    // uncompressed replies have no decompression counters
+    MiniHttpServer plainServer("HTTP/1.0 200 OK\r\nContent-Length: 3\r\n\r\nabc");
+    request.setUrl(QUrl(QLatin1String("http://localhost:%1")
+                                .arg(QString::number(plainServer.serverPort()))));
+    reply.reset(manager.get(request));
+    QVERIFY(waitForFinish(reply) != Timeout);
+    QCOMPARE(reply->readAll(), "abc");
+    QVERIFY(!reply->attribute(QNetworkRequest::CompressedBytesAttribute).isValid());
+    QVERIFY(!reply->attribute(QNetworkRequest::DecompressionTimeAttribute).isValid());
+}
+
+void tst_QNetworkReply::connectionStatistics()
+{
+    MiniHttpServer server("HTTP/1.1 200 OK\r\nContent-Length: 3\r\n\r\nabc");
+    server.doClose = false;
+    server.multiple = true;
+
+    QNetworkAccessManager qnam;
+    QCOMPARE(qnam.connectionStatistics().requestCount(), 0);
+
+    const QUrl url(QLatin1String("http://localhost:%1").arg(QString::number(server.serverPort())));
+    for (int i = 0; i < 3; ++i) {
+        QNetworkReplyPtr reply(qnam.get(QNetworkRequest(url)));
+        QVERIFY(waitForFinish(reply) != Timeout);
+        QCOMPARE(reply->error(), QNetworkReply::NoError);
+        QCOMPARE(reply->readAll(), "abc");
+    }
+    QCOMPARE(server.totalConnections, 1);
+
+    // the HTTP thread releases its replies asynchronously
+    QTRY_COMPARE(qnam.connectionStatistics().requestsInFlight(), 0);
+    QNetworkConnectionStatistics statistics = qnam.connectionStatistics();
+    QCOMPARE(statistics.requestCount(), 3);
+    QCOMPARE(statistics.reusedConnectionRequestCount(), 2);
+    QCOMPARE(statistics.connectionReuseRatio(), 2. / 3);
+    QCOMPARE_GE(statistics.totalQueueWaitTime(), statistics.maximumQueueWaitTime());
+    QCOMPARE(statistics.connectionCount(), 1);
+    QCOMPARE_GT(statistics.totalConnectTime().count(), 0);
+    QCOMPARE(statistics.tlsHandshakeCount(), 0);
+    QCOMPARE(statistics.openConnections(), 1);
+    QCOMPARE(statistics.peakOpenConnections(), 1);
+    QCOMPARE(statistics.peakRequestsInFlight(), 1);
+    QCOMPARE(statistics.http2StreamsInFlight(), 0);
+    QCOMPARE(statistics.peakHttp2StreamsInFlight(), 0);
+
+    // The snapshot doesn't change with the manager's counters
+    qnam.resetConnectionStatistics();
+    QCOMPARE(statistics.requestCount(), 3);
+    statistics = qnam.connectionStatistics();
+    QCOMPARE(statistics.requestCount(), 0);
+    QCOMPARE(statistics.connectionReuseRatio(), 0.);
+    QCOMPARE(statistics.totalQueueWaitTime().count(), 0);
+    QCOMPARE(statistics.connectionCount(), 0);
+    QCOMPARE(statistics.openConnections(), 1);
+    QCOMPARE(statistics.peakOpenConnections(), 1);
+    QCOMPARE(statistics.peakRequestsInFlight(), 0);
+
+    QNetworkReplyPtr reply(qnam.get(QNetworkRequest(url)));
+    QVERIFY(waitForFinish(reply) != Timeout);
+    statistics = qnam.connectionStatistics();
+    QCOMPARE(statistics.requestCount(), 1);
+    QCOMPARE(statistics.reusedConnectionRequestCount(), 1);
+    QCOMPARE(statistics.connectionCount(), 0);
+}
+
 // When this test is failing it will appear flaky because it relies on the
 // timing of delivery from one socket to another in the OS.
 // + we have to send all the data at once, so the readyRead emissions are
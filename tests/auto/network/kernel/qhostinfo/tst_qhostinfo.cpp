@@ -19,6 +19,10 @@
 #include <QDebug>
 #include <QTcpSocket>
 #include <QTcpServer>
+#include <QUdpSocket>
+#include <QNetworkDatagram>
+#include <QScopeGuard>
+#include <QtEndian>
 
 #include <private/qthread_p.h>
 
@@ -78,6 +82,8 @@ private slots:
     void multipleDifferentLookups();
 
     void cache();
+    void asyncResolver();
+    void asyncResolverStalledLookups();
 
     void abortHostLookup();
 protected slots:
@@ -668,6 +674,174 @@ void tst_QHostInfo::cache()
     QCOMPARE(lookupsDoneCounter, 2);
 }
 
+#if defined(QT_BUILD_INTERNAL) && QT_CONFIG(async_dns)
+// A minimal DNS server for the zone "async.test": "hostN.async.test" has the
+// IPv4 address 10.0.0.0 + N and no IPv6 address; queries for
+// "silentN.async.test" are never answered; all other names don't exist.
+class StubDnsServer : public QObject
+{
+public:
+    StubDnsServer()
+    {
+        socket.bind(QHostAddress::LocalHost);
+        // like a real name server, keep up with many clients' queries at once
+        socket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 1024 * 1024);
+        connect(&socket, &QUdpSocket::readyRead, this, &StubDnsServer::answerQueries);
+    }
+
+    quint16 port() const { return socket.localPort(); }
+
+    int queryCount = 0;
+    quint32 ttl = 1;
+
+private:
+    void answerQueries()
+    {
+        while (socket.hasPendingDatagrams()) {
+            const QNetworkDatagram query = socket.receiveDatagram();
+            QByteArray reply = query.data();
+            if (reply.size() < 12)
+                continue;
+            ++queryCount;
+
+            QByteArrayList labels;
+            qsizetype pos = 12;
+            while (pos < reply.size() && reply.at(pos)) {
+                labels << reply.mid(pos + 1, uchar(reply.at(pos)));
+                pos += uchar(reply.at(pos)) + 1;
+            }
+            if (pos + 5 > reply.size())
+                continue;
+            const quint16 type = qFromBigEndian<quint16>(reply.constData() + pos + 1);
+            reply.truncate(pos + 5);        // drop the EDNS0 record
+
+            const bool inZone = labels.size() == 3 && labels.at(1) == "async"
+                    && labels.at(2) == "test";
+            if (inZone && labels.at(0).startsWith("silent"))
+                continue;
+            const bool exists = inZone && labels.at(0).startsWith("host");
+            reply[2] = char(0x81);                  // QR, RD
+            reply[3] = char(exists ? 0x80 : 0x83);  // RA, NOERROR or NXDOMAIN
+            reply[11] = 0;                          // no additional records
+            if (exists && type == 1) {
+                reply[7] = 1;                       // one answer
+                reply += QByteArray::fromHex("c00c00010001");   // A IN for the question
+                const quint32 address = 0x0a000000 + labels.at(0).sliced(4).toUInt();
+                char rdata[10];
+                qToBigEndian<quint32>(ttl, rdata);
+                qToBigEndian<quint16>(4, rdata + 4);
+                qToBigEndian<quint32>(address, rdata + 6);
+                reply.append(rdata, sizeof(rdata));
+            }
+            socket.writeDatagram(reply, query.senderAddress(), query.senderPort());
+        }
+    }
+
+    QUdpSocket socket;
+};
+#endif
+
+void tst_QHostInfo::asyncResolver()
+{
+#if !defined(QT_BUILD_INTERNAL) || !QT_CONFIG(async_dns)
+    QSKIP("This test requires the asynchronous resolver and a developer build");
+#else
+    QFETCH_GLOBAL(bool, cache);
+
+    StubDnsServer server;
+    qt_qhostinfo_set_async_nameserver(QHostAddress::LocalHost, server.port());
+    const auto restore = qScopeGuard([] {
+        qt_qhostinfo_set_async_nameserver(QHostAddress(), 0);
+    });
+
+    // many more lookups in flight than the thread pool has threads
+    constexpr int Count = 1000;
+    int finished = 0;
+    int mismatches = 0;
+    for (int i = 0; i < Count; ++i) {
+        QHostInfo::lookupHost(QString::fromLatin1("host%1.async.test").arg(i), this,
+                              [&, i](const QHostInfo &info) {
+            ++finished;
+            if (info.error() != QHostInfo::NoError
+                    || info.addresses() != QList<QHostAddress>{ QHostAddress(0x0a000000 + i) }) {
+                ++mismatches;
+            }
+        });
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(finished, Count, 30000);
+    QCOMPARE(mismatches, 0);
+
+    QHostInfo missing;
+    QHostInfo::lookupHost(QStringLiteral("missing.other.test"), this,
+                          [&](const QHostInfo &info) { missing = info; });
+    QTRY_COMPARE(missing.error(), QHostInfo::HostNotFound);
+    QVERIFY(missing.addresses().isEmpty());
+
+    if (!cache)
+        return;
+
+    // the result is cached for as long as the record's time to live
+    lookupsDoneCounter = 0;
+    bool valid = true;
+    int id = -1;
+    qt_qhostinfo_lookup("host4242.async.test", this, SLOT(resultsReady(QHostInfo)), &valid, &id);
+    QVERIFY(!valid);
+    QTRY_COMPARE(lookupsDoneCounter, 1);
+    QCOMPARE(lookupResults.addresses(), QList<QHostAddress>{ QHostAddress("10.0.16.146") });
+
+    const int queryCount = server.queryCount;
+    QHostInfo result = qt_qhostinfo_lookup("host4242.async.test", this,
+                                           SLOT(resultsReady(QHostInfo)), &valid, &id);
+    QVERIFY(valid);
+    QCOMPARE(result.addresses(), lookupResults.addresses());
+    QCOMPARE(server.queryCount, queryCount);
+
+    QTest::qWait(server.ttl * 1000 + 100);
+    qt_qhostinfo_lookup("host4242.async.test", this, SLOT(resultsReady(QHostInfo)), &valid, &id);
+    QVERIFY(!valid);
+    QTRY_COMPARE(lookupsDoneCounter, 2);
+    QVERIFY(server.queryCount > queryCount);
+#endif
+}
+
+void tst_QHostInfo::asyncResolverStalledLookups()
+{
+#if !defined(QT_BUILD_INTERNAL) || !QT_CONFIG(async_dns)
+    QSKIP("This test requires the asynchronous resolver and a developer build");
+#else
+    StubDnsServer server;
+    qt_qhostinfo_set_async_nameserver(QHostAddress::LocalHost, server.port());
+    const auto restore = qScopeGuard([] {
+        qt_qhostinfo_set_async_nameserver(QHostAddress(), 0);
+    });
+
+    // More unanswered lookups than the resolver lets wait for a reply at once,
+    // which depends on the receive buffer size the system grants it.
+    QUdpSocket probe;
+    probe.bind();
+    probe.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, 1024 * 1024);
+    const int silentCount =
+            qMax(64, probe.socketOption(QAbstractSocket::ReceiveBufferSizeSocketOption).toInt()
+                             / 4096) + 100;
+    int silentFinished = 0;
+    for (int i = 0; i < silentCount; ++i) {
+        QHostInfo::lookupHost(QString::fromLatin1("silent%1.async.test").arg(i), this,
+                              [&](const QHostInfo &) { ++silentFinished; });
+    }
+
+    // once their first attempt timed out, they no longer hold up the lookups
+    // queued after them, which get answered before any of them gave up
+    QHostInfo info;
+    QHostInfo::lookupHost(QStringLiteral("host1.async.test"), this,
+                          [&](const QHostInfo &result) { info = result; });
+    QTRY_COMPARE_WITH_TIMEOUT(info.addresses(), QList<QHostAddress>{ QHostAddress("10.0.0.1") },
+                              30000);
+    QCOMPARE(silentFinished, 0);
+
+    QTRY_COMPARE_WITH_TIMEOUT(silentFinished, silentCount, 30000);
+#endif
+}
+
 void tst_QHostInfo::resultsReady(const QHostInfo &hi)
 {
     QVERIFY(QThread::currentThread() == thread());
@@ -13,6 +13,7 @@
 #include <QLoggingCategory>
 #include <QMutex>
 #include <QList>
+#include <QTemporaryFile>
 
 #include <qtextstream.h>
 #include <qdatastream.h>
@@ -20,11 +21,17 @@
 #include <qproperty.h>
 #include <QtNetwork/qlocalsocket.h>
 #include <QtNetwork/qlocalserver.h>
+#ifdef Q_OS_UNIX
+#include <QtNetwork/private/qlocalsocketbulkchannel_p.h>
+#endif
 
 #ifdef Q_OS_UNIX
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/un.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h> // for unlink()
 #endif
 
@@ -117,6 +124,12 @@ private slots:
     void syncDisconnectNotify();
     void asyncDisconnectNotify();
 
+    void sendDescriptors();
+    void sendDescriptorsDropped();
+    void bulkChannel();
+    void bulkChannelBadSegment_data();
+    void bulkChannelBadSegment();
+
     void verifySocketOptions();
     void verifySocketOptions_data();
 
@@ -1661,6 +1674,211 @@ void tst_QLocalSocket::asyncDisconnectNotify()
     QCOMPARE(readChannelFinishedSpy.size(), 1);
 }
 
+void tst_QLocalSocket::sendDescriptors()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Descriptor passing is only supported on Unix");
+#else
+    CrashSafeLocalServer server;
+    QVERIFY2(server.listen("sendDescriptors"), qUtf8Printable(server.errorString()));
+    QLocalSocket client;
+    client.connectToServer("sendDescriptors");
+    QVERIFY(server.waitForNewConnection());
+    QLocalSocket *serverSocket = server.nextPendingConnection();
+    QVERIFY(serverSocket);
+
+    int first[2];
+    int second[2];
+    QCOMPARE(::pipe(first), 0);
+    QCOMPARE(::pipe(second), 0);
+
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QLocalSocket::sendDescriptors: Descriptors must be sent along with data");
+    QVERIFY(!client.sendDescriptors({ first[0] }, QByteArray()));
+    // the descriptors travel in order with the data, behind what was buffered
+    QCOMPARE(client.write("before"), 6);
+    QVERIFY(client.sendDescriptors({ first[0] }, "one"));
+    QCOMPARE(client.write("between"), 7);
+    QVERIFY(client.sendDescriptors({ second[0], second[1] }, "two"));
+    ::close(first[0]);
+    ::close(second[0]);
+    while (client.bytesToWrite())
+        QVERIFY(client.waitForBytesWritten());
+
+    QByteArray received;
+    QList<qintptr> descriptors;
+    while (received.size() < 19) {
+        QVERIFY(serverSocket->waitForReadyRead());
+        received += serverSocket->readAll();
+        descriptors += serverSocket->takeReceivedDescriptors();
+    }
+    QCOMPARE(received, "beforeonebetweentwo");
+    QCOMPARE(descriptors.size(), 3);
+
+    // they refer to the pipes the client sent
+    QCOMPARE(::write(first[1], "a", 1), 1);
+    QCOMPARE(::write(int(descriptors.at(2)), "b", 1), 1);
+    char c;
+    QCOMPARE(::read(int(descriptors.at(0)), &c, 1), 1);
+    QCOMPARE(c, 'a');
+    QCOMPARE(::read(int(descriptors.at(1)), &c, 1), 1);
+    QCOMPARE(c, 'b');
+
+    for (qintptr fd : std::as_const(descriptors))
+        ::close(int(fd));
+    ::close(first[1]);
+    ::close(second[1]);
+    QVERIFY(serverSocket->takeReceivedDescriptors().isEmpty());
+#endif
+}
+
+void tst_QLocalSocket::sendDescriptorsDropped()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("Descriptor passing is only supported on Unix");
+#else
+    CrashSafeLocalServer server;
+    QVERIFY2(server.listen("sendDescriptorsDropped"), qUtf8Printable(server.errorString()));
+    QLocalSocket client;
+    client.connectToServer("sendDescriptorsDropped");
+    QVERIFY(server.waitForNewConnection());
+    QLocalSocket *serverSocket = server.nextPendingConnection();
+    QVERIFY(serverSocket);
+    QSignalSpy errorSpy(serverSocket, &QLocalSocket::errorOccurred);
+
+    int fds[2];
+    QCOMPARE(::pipe(fds), 0);
+    QVERIFY(client.sendDescriptors({ fds[0] }, "one"));
+    ::close(fds[0]);
+    ::close(fds[1]);
+    while (client.bytesToWrite())
+        QVERIFY(client.waitForBytesWritten());
+
+    // leave no room for the descriptor, so that the kernel drops it
+    rlimit limit;
+    QCOMPARE(::getrlimit(RLIMIT_NOFILE, &limit), 0);
+    const int lowestFree = ::dup(0);
+    QVERIFY(lowestFree != -1);
+    ::close(lowestFree);
+    rlimit lowered = limit;
+    lowered.rlim_cur = lowestFree;
+    QCOMPARE(::setrlimit(RLIMIT_NOFILE, &lowered), 0);
+    const bool readyRead = serverSocket->waitForReadyRead();
+    QCOMPARE(::setrlimit(RLIMIT_NOFILE, &limit), 0);
+
+    QVERIFY(!readyRead);
+    QCOMPARE(errorSpy.size(), 1);
+    QCOMPARE(serverSocket->error(), QLocalSocket::SocketResourceError);
+    QVERIFY(serverSocket->takeReceivedDescriptors().isEmpty());
+#endif
+}
+
+void tst_QLocalSocket::bulkChannel()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("The bulk channel is only supported on Unix");
+#else
+    CrashSafeLocalServer server;
+    QVERIFY2(server.listen("bulkChannel"), qUtf8Printable(server.errorString()));
+    QLocalSocket client;
+    client.connectToServer("bulkChannel");
+    QVERIFY(server.waitForNewConnection());
+    QLocalSocket *serverSocket = server.nextPendingConnection();
+    QVERIFY(serverSocket);
+
+    constexpr qsizetype SegmentSize = 1024;
+    QLocalSocketBulkChannel sender(&client, SegmentSize);
+    QLocalSocketBulkChannel receiver(serverSocket, SegmentSize);
+    QSignalSpy readyReadSpy(&receiver, &QLocalSocketBulkChannel::readyRead);
+    QSignalSpy spaceSpy(&sender, &QLocalSocketBulkChannel::spaceAvailable);
+
+    QVERIFY(!sender.write(QByteArray(SegmentSize + 1, 'x')));
+    QVERIFY(sender.write(QByteArray(400, 'a')));
+    char *space = sender.reserve(400);
+    QVERIFY(space);
+    memset(space, 'b', 400);
+    QVERIFY(sender.commit());
+    QCOMPARE(sender.bytesInFlight(), 800);
+    // flow control: the segment is full until the receiver releases payloads
+    QVERIFY(!sender.write(QByteArray(400, 'c')));
+
+    QTRY_COMPARE(receiver.pendingPayloadCount(), 2);
+    QCOMPARE(receiver.peekPayload(), QByteArray(400, 'a'));
+    receiver.releasePayload();
+    QTRY_COMPARE(spaceSpy.size(), 1);
+    QCOMPARE(sender.bytesInFlight(), 400);
+
+    // wraps around to the start of the segment
+    QVERIFY(sender.write(QByteArray(400, 'c')));
+    QTRY_COMPARE(receiver.pendingPayloadCount(), 2);
+    QCOMPARE(receiver.readPayload(), QByteArray(400, 'b'));
+    QCOMPARE(receiver.readPayload(), QByteArray(400, 'c'));
+    QCOMPARE(receiver.pendingPayloadCount(), 0);
+    QVERIFY(receiver.peekPayload().isNull());
+    QTRY_COMPARE(sender.bytesInFlight(), 0);
+    QVERIFY(readyReadSpy.size() >= 2);
+#endif
+}
+
+void tst_QLocalSocket::bulkChannelBadSegment_data()
+{
+    QTest::addColumn<bool>("sealed");
+    QTest::addColumn<qsizetype>("size");
+
+#if defined(Q_OS_LINUX) && defined(MFD_ALLOW_SEALING)
+    QTest::newRow("unsealed") << false << qsizetype(1024);
+    QTest::newRow("too-small") << true << qsizetype(512);
+#else
+    QTest::newRow("too-small") << false << qsizetype(512);
+#endif
+}
+
+void tst_QLocalSocket::bulkChannelBadSegment()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("The bulk channel is only supported on Unix");
+#else
+    QFETCH(bool, sealed);
+    QFETCH(qsizetype, size);
+
+    CrashSafeLocalServer server;
+    QVERIFY2(server.listen("bulkChannelBadSegment"), qUtf8Printable(server.errorString()));
+    QLocalSocket client;
+    client.connectToServer("bulkChannelBadSegment");
+    QVERIFY(server.waitForNewConnection());
+    QLocalSocket *serverSocket = server.nextPendingConnection();
+    QVERIFY(serverSocket);
+
+    // A segment that could be truncated while mapped, or that is smaller
+    // than announced, would make the receiver crash when reading it
+#if defined(Q_OS_LINUX) && defined(MFD_ALLOW_SEALING)
+    const int fd = ::memfd_create("bulkChannelBadSegment", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    QVERIFY(fd != -1);
+    QCOMPARE(::ftruncate(fd, size), 0);
+    if (sealed)
+        QCOMPARE(::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW), 0);
+#else
+    Q_UNUSED(sealed);
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QVERIFY(file.resize(size));
+    const int fd = ::dup(file.handle());
+    QVERIFY(fd != -1);
+#endif
+    // the Segment frame of the channel, announcing 1024 bytes
+    const struct { quint32 type, reserved; quint64 offset, length; } frame = { 0, 0, 0, 1024 };
+    QVERIFY(client.sendDescriptors(
+            { fd }, QByteArray(reinterpret_cast<const char *>(&frame), sizeof(frame))));
+    ::close(fd);
+
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QLocalSocketBulkChannel: Cannot map the peer's shared memory segment");
+    QLocalSocketBulkChannel receiver(serverSocket, 1024);
+    QTRY_COMPARE(serverSocket->state(), QLocalSocket::UnconnectedState);
+    QCOMPARE(receiver.pendingPayloadCount(), 0);
+#endif
+}
+
 void tst_QLocalSocket::verifySocketOptions_data()
 {
 #ifdef Q_OS_LINUX
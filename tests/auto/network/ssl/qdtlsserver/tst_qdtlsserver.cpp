@@ -0,0 +1,293 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QSignalSpy>
+
+#include <QtNetwork/qsslpresharedkeyauthenticator.h>
+#include <QtNetwork/qsslconfiguration.h>
+#include <QtNetwork/qnetworkdatagram.h>
+#include <QtNetwork/qdtlsserver.h>
+#include <QtNetwork/qudpsocket.h>
+#include <QtNetwork/qdtls.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qlist.h>
+
+#include "../shared/tlshelpers.h"
+
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+QT_BEGIN_NAMESPACE
+
+namespace
+{
+
+const QByteArray presharedKey = "DEADBEEFDEADBEEF";
+
+// One peer of a client swarm: a QDtls client on its own socket.
+class DtlsClient : public QObject
+{
+    Q_OBJECT
+public:
+    DtlsClient()
+    {
+        auto configuration = QSslConfiguration::defaultDtlsConfiguration();
+        configuration.setPeerVerifyMode(QSslSocket::VerifyNone);
+        dtls.setDtlsConfiguration(configuration);
+
+        connect(&dtls, &QDtls::pskRequired, this, [](QSslPreSharedKeyAuthenticator *auth) {
+            auth->setIdentity("client");
+            auth->setPreSharedKey(presharedKey);
+        });
+        connect(&dtls, &QDtls::handshakeTimeout, this, [this]() {
+            dtls.handleTimeout(&socket);
+        });
+        connect(&socket, &QUdpSocket::readyRead, this, &DtlsClient::readDatagrams);
+    }
+
+    bool connectToServer(const QHostAddress &address, quint16 port)
+    {
+        return socket.bind(QHostAddress::LocalHost) && dtls.setPeer(address, port)
+                && dtls.doHandshake(&socket);
+    }
+
+    void readDatagrams()
+    {
+        while (socket.hasPendingDatagrams()) {
+            const QNetworkDatagram datagram = socket.receiveDatagram();
+            if (!dtls.isConnectionEncrypted()) {
+                dtls.doHandshake(&socket, datagram.data());
+                continue;
+            }
+            const QByteArray plainText = dtls.decryptDatagram(&socket, datagram.data());
+            if (!plainText.isEmpty())
+                received << plainText;
+            else if (dtls.dtlsError() == QDtlsError::RemoteClosedConnectionError)
+                closedByServer = true;
+        }
+    }
+
+    QUdpSocket socket;
+    QDtls dtls{QSslSocket::SslClientMode};
+    QByteArrayList received;
+    bool closedByServer = false;
+};
+
+} // unnamed namespace
+
+class tst_QDtlsServer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+
+    void handshakeAndEcho();
+    void clientSwarm_data();
+    void clientSwarm();
+    void closeSession();
+    void peerClosesSession();
+    void idleTimeout();
+    void maximumSessionCount();
+
+private:
+    void echo(const QList<QNetworkDatagram> &datagrams);
+
+    std::unique_ptr<QDtlsServer> server;
+};
+
+void qt_ForceTlsSecurityLevel();
+
+void tst_QDtlsServer::initTestCase()
+{
+    if (!TlsAux::classImplemented(QSsl::ImplementedClass::Dtls))
+        QSKIP("The active TLS backend does not support DTLS");
+
+    qt_ForceTlsSecurityLevel();
+}
+
+void tst_QDtlsServer::init()
+{
+    server.reset(new QDtlsServer);
+    auto configuration = QSslConfiguration::defaultDtlsConfiguration();
+    configuration.setPeerVerifyMode(QSslSocket::VerifyNone);
+    server->setDtlsConfiguration(configuration);
+    connect(server.get(), &QDtlsServer::pskRequired, this,
+            [](const QHostAddress &, quint16, QSslPreSharedKeyAuthenticator *auth) {
+        auth->setPreSharedKey(presharedKey);
+    });
+    QVERIFY(server->listen(QHostAddress::LocalHost));
+    QVERIFY(server->isListening());
+}
+
+void tst_QDtlsServer::echo(const QList<QNetworkDatagram> &datagrams)
+{
+    for (const QNetworkDatagram &datagram : datagrams)
+        server->writeDatagram(datagram.makeReply(datagram.data()));
+}
+
+void tst_QDtlsServer::handshakeAndEcho()
+{
+    connect(server.get(), &QDtlsServer::datagramsReceived, this, &tst_QDtlsServer::echo);
+    QSignalSpy newSessionSpy(server.get(), &QDtlsServer::newSession);
+
+    DtlsClient client;
+    QVERIFY(client.connectToServer(server->serverAddress(), server->serverPort()));
+    QTRY_VERIFY(client.dtls.isConnectionEncrypted());
+    QTRY_COMPARE(newSessionSpy.size(), 1);
+    QCOMPARE(newSessionSpy.first().at(0).value<QHostAddress>(), client.socket.localAddress());
+    QCOMPARE(newSessionSpy.first().at(1).value<quint16>(), client.socket.localPort());
+
+    QCOMPARE(server->sessionCount(), 1);
+    QDtls *session = server->session(client.socket.localAddress(), client.socket.localPort());
+    QVERIFY(session);
+    QVERIFY(session->isConnectionEncrypted());
+
+    QVERIFY(client.dtls.writeDatagramEncrypted(&client.socket, "hello") > 0);
+    QTRY_COMPARE(client.received, QByteArrayList{"hello"});
+
+    // no session, no encryption
+    QCOMPARE(server->writeDatagram("nobody", QHostAddress::LocalHost, 1), -1);
+}
+
+void tst_QDtlsServer::clientSwarm_data()
+{
+    QTest::addColumn<int>("clientCount");
+    QTest::addColumn<int>("batchSize");
+
+    QTest::addRow("16 peers") << 16 << 64;
+    QTest::addRow("16 peers, batches of 1") << 16 << 1;
+    QTest::addRow("256 peers") << 256 << 64;
+}
+
+void tst_QDtlsServer::clientSwarm()
+{
+    QFETCH(const int, clientCount);
+    QFETCH(const int, batchSize);
+
+    server->setReadBatchSize(batchSize);
+    QCOMPARE(server->readBatchSize(), batchSize);
+
+    int batches = 0;
+    qsizetype largestBatch = 0;
+    connect(server.get(), &QDtlsServer::datagramsReceived, this,
+            [&](const QList<QNetworkDatagram> &datagrams) {
+        ++batches;
+        largestBatch = qMax(largestBatch, datagrams.size());
+        echo(datagrams);
+    });
+
+    std::vector<std::unique_ptr<DtlsClient>> clients;
+    for (int i = 0; i < clientCount; ++i) {
+        clients.push_back(std::make_unique<DtlsClient>());
+        QVERIFY(clients.back()->connectToServer(server->serverAddress(), server->serverPort()));
+    }
+    QTRY_COMPARE_WITH_TIMEOUT(server->sessionCount(), clientCount, 60000);
+    for (const auto &client : clients)
+        QTRY_VERIFY_WITH_TIMEOUT(client->dtls.isConnectionEncrypted(), 30000);
+
+    // every peer sends a few messages at once, and gets them back
+    for (int i = 0; i < clientCount; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            const QByteArray message = QByteArray::number(i) + '/' + QByteArray::number(j);
+            QVERIFY(clients[i]->dtls.writeDatagramEncrypted(&clients[i]->socket, message) > 0);
+        }
+    }
+    for (int i = 0; i < clientCount; ++i) {
+        QTRY_COMPARE_WITH_TIMEOUT(clients[i]->received.size(), 3, 30000);
+        for (int j = 0; j < 3; ++j) {
+            QVERIFY(clients[i]->received.contains(QByteArray::number(i) + '/'
+                                                  + QByteArray::number(j)));
+        }
+    }
+    QVERIFY(largestBatch <= batchSize);
+    QVERIFY(batches <= 3 * clientCount);
+    QCOMPARE(server->sessionCount(), clientCount);
+}
+
+void tst_QDtlsServer::closeSession()
+{
+    DtlsClient client;
+    QVERIFY(client.connectToServer(server->serverAddress(), server->serverPort()));
+    QTRY_VERIFY(client.dtls.isConnectionEncrypted());
+    QTRY_COMPARE(server->sessionCount(), 1);
+
+    QSignalSpy closedSpy(server.get(), &QDtlsServer::sessionClosed);
+    QVERIFY(server->closeSession(client.socket.localAddress(), client.socket.localPort()));
+    QVERIFY(!server->closeSession(client.socket.localAddress(), client.socket.localPort()));
+    QCOMPARE(server->sessionCount(), 0);
+    QTRY_VERIFY(client.closedByServer);
+    QCOMPARE(closedSpy.size(), 0);
+}
+
+void tst_QDtlsServer::peerClosesSession()
+{
+    DtlsClient client;
+    QVERIFY(client.connectToServer(server->serverAddress(), server->serverPort()));
+    QTRY_VERIFY(client.dtls.isConnectionEncrypted());
+    QTRY_COMPARE(server->sessionCount(), 1);
+
+    QSignalSpy closedSpy(server.get(), &QDtlsServer::sessionClosed);
+    QVERIFY(client.dtls.shutdown(&client.socket));
+    QTRY_COMPARE(closedSpy.size(), 1);
+    QCOMPARE(closedSpy.first().at(1).value<quint16>(), client.socket.localPort());
+    QCOMPARE(server->sessionCount(), 0);
+}
+
+void tst_QDtlsServer::idleTimeout()
+{
+    server->setIdleTimeout(200);
+    QCOMPARE(server->idleTimeout(), 200);
+
+    DtlsClient idle;
+    DtlsClient active;
+    QVERIFY(idle.connectToServer(server->serverAddress(), server->serverPort()));
+    QVERIFY(active.connectToServer(server->serverAddress(), server->serverPort()));
+    QTRY_COMPARE(server->sessionCount(), 2);
+    QTRY_VERIFY(idle.dtls.isConnectionEncrypted());
+    QTRY_VERIFY(active.dtls.isConnectionEncrypted());
+
+    QSignalSpy closedSpy(server.get(), &QDtlsServer::sessionClosed);
+    for (int i = 0; i < 10; ++i) {
+        active.dtls.writeDatagramEncrypted(&active.socket, "ping");
+        QTest::qWait(50ms);
+    }
+    QTRY_COMPARE(closedSpy.size(), 1);
+    QCOMPARE(closedSpy.first().at(1).value<quint16>(), idle.socket.localPort());
+    QVERIFY(server->hasSession(active.socket.localAddress(), active.socket.localPort()));
+    QTRY_VERIFY(idle.closedByServer);
+}
+
+void tst_QDtlsServer::maximumSessionCount()
+{
+    server->setMaximumSessionCount(2);
+    QCOMPARE(server->maximumSessionCount(), 2);
+
+    std::vector<std::unique_ptr<DtlsClient>> clients;
+    for (int i = 0; i < 3; ++i) {
+        clients.push_back(std::make_unique<DtlsClient>());
+        QVERIFY(clients.back()->connectToServer(server->serverAddress(), server->serverPort()));
+    }
+    QTRY_COMPARE(server->sessionCount(), 2);
+    QTest::qWait(200ms);
+    QCOMPARE(server->sessionCount(), 2);
+
+    // once there is room, the third peer's retransmitted hello gets through
+    QVERIFY(clients[0]->dtls.shutdown(&clients[0]->socket));
+    QTRY_VERIFY(!server->hasSession(clients[0]->socket.localAddress(),
+                                    clients[0]->socket.localPort()));
+    QTRY_VERIFY_WITH_TIMEOUT(clients[2]->dtls.isConnectionEncrypted(), 10000);
+    QCOMPARE(server->sessionCount(), 2);
+}
+
+QT_END_NAMESPACE
+
+QTEST_MAIN(tst_QDtlsServer)
+
+#include "tst_qdtlsserver.moc"
@@ -0,0 +1,147 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+
+#include <QtSql/qsqlcolumnbuffer.h>
+
+#include <QtCore/qdatetime.h>
+
+using namespace Qt::StringLiterals;
+
+class tst_QSqlColumnBuffer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void construction();
+    void integers();
+    void doubles();
+    void strings();
+    void variants();
+    void clear();
+    void copy();
+};
+
+void tst_QSqlColumnBuffer::construction()
+{
+    QSqlColumnBuffer buffer;
+    QCOMPARE(buffer.type(), QSqlColumnBuffer::Type::Variant);
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.size(), 0);
+    QVERIFY(buffer.nulls().isEmpty());
+    QVERIFY(!buffer.value(0).isValid());
+
+    QSqlColumnBuffer integers(QSqlColumnBuffer::Type::Integer);
+    QCOMPARE(integers.type(), QSqlColumnBuffer::Type::Integer);
+    QVERIFY(integers.isEmpty());
+}
+
+void tst_QSqlColumnBuffer::integers()
+{
+    QSqlColumnBuffer buffer(QSqlColumnBuffer::Type::Integer);
+    buffer.reserve(4);
+    buffer.appendInteger(1);
+    buffer.appendNull();
+    buffer.appendVariant(QVariant(u"42"_s));
+    buffer.appendInteger(-7);
+
+    QCOMPARE(buffer.size(), 4);
+    QCOMPARE(buffer.integers(), (QList<qint64>{1, 0, 42, -7}));
+    QVERIFY(!buffer.isNull(0));
+    QVERIFY(buffer.isNull(1));
+    QVERIFY(!buffer.isNull(3));
+    QVERIFY(!buffer.isNull(4));
+
+    const QBitArray nulls = buffer.nulls();
+    QCOMPARE(nulls.size(), 4);
+    QCOMPARE(nulls.count(true), 1);
+    QVERIFY(nulls.testBit(1));
+
+    QCOMPARE(buffer.value(0), QVariant(qint64(1)));
+    QVERIFY(buffer.value(1).isNull());
+    QCOMPARE(buffer.value(1).metaType(), QMetaType::fromType<qint64>());
+    QVERIFY(!buffer.value(4).isValid());
+}
+
+void tst_QSqlColumnBuffer::doubles()
+{
+    QSqlColumnBuffer buffer(QSqlColumnBuffer::Type::Double);
+    buffer.appendDouble(1.5);
+    buffer.appendVariant(QVariant(QMetaType::fromType<double>()));
+    buffer.appendVariant(QVariant(u"2.25"_s));
+
+    QCOMPARE(buffer.doubles(), (QList<double>{1.5, 0.0, 2.25}));
+    QVERIFY(buffer.isNull(1));
+    QCOMPARE(buffer.value(2), QVariant(2.25));
+}
+
+void tst_QSqlColumnBuffer::strings()
+{
+    QSqlColumnBuffer buffer(QSqlColumnBuffer::Type::String);
+    QString moved = u"moved"_s;
+    buffer.appendString(u"copied"_s);
+    buffer.appendString(std::move(moved));
+    buffer.appendNull();
+    buffer.appendVariant(QVariant(17));
+
+    QCOMPARE(buffer.strings(), (QStringList{u"copied"_s, u"moved"_s, QString(), u"17"_s}));
+    QVERIFY(buffer.isNull(2));
+    QVERIFY(!buffer.isNull(3));
+    QVERIFY(buffer.value(2).isNull());
+    QCOMPARE(buffer.value(3), QVariant(u"17"_s));
+}
+
+void tst_QSqlColumnBuffer::variants()
+{
+    const QDate date(2024, 2, 29);
+    QSqlColumnBuffer buffer;
+    buffer.appendVariant(QVariant(date));
+    buffer.appendVariant(QVariant(QMetaType::fromType<QDate>()));
+    buffer.appendNull();
+
+    QCOMPARE(buffer.size(), 3);
+    QCOMPARE(buffer.variants().first(), QVariant(date));
+    QVERIFY(!buffer.isNull(0));
+    QVERIFY(buffer.isNull(1));
+    QVERIFY(buffer.isNull(2));
+    // the null variant keeps its type
+    QCOMPARE(buffer.value(1).metaType(), QMetaType::fromType<QDate>());
+}
+
+void tst_QSqlColumnBuffer::clear()
+{
+    QSqlColumnBuffer buffer(QSqlColumnBuffer::Type::String);
+    buffer.appendNull();
+    buffer.appendString(u"value"_s);
+    buffer.clear();
+
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.type(), QSqlColumnBuffer::Type::String);
+    QVERIFY(buffer.nulls().isEmpty());
+    buffer.appendString(u"again"_s);
+    QVERIFY(!buffer.isNull(0));
+}
+
+void tst_QSqlColumnBuffer::copy()
+{
+    QSqlColumnBuffer buffer(QSqlColumnBuffer::Type::Integer);
+    buffer.appendInteger(1);
+    buffer.appendNull();
+
+    QSqlColumnBuffer copy = buffer;
+    buffer.appendInteger(3);
+    buffer.clear();
+    QCOMPARE(copy.type(), QSqlColumnBuffer::Type::Integer);
+    QCOMPARE(copy.integers(), (QList<qint64>{1, 0}));
+    QVERIFY(copy.isNull(1));
+    QVERIFY(buffer.isEmpty());
+
+    QSqlColumnBuffer moved = std::move(copy);
+    QCOMPARE(moved.size(), 2);
+    copy = moved;
+    QCOMPARE(copy.size(), 2);
+}
+
+QTEST_MAIN(tst_QSqlColumnBuffer)
+#include "tst_qsqlcolumnbuffer.moc"
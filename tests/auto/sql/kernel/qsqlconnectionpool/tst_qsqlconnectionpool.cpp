@@ -0,0 +1,340 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+
+#include <QtSql/qsqlconnectionpool.h>
+#include <QtSql/qsqldatabase.h>
+#include <QtSql/qsqldriver.h>
+#include <QtSql/qsqlerror.h>
+#include <QtSql/qsqlquery.h>
+#include <QtSql/qsqlrecord.h>
+#include <QtSql/qsqlresult.h>
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+namespace {
+
+QAtomicInt openedConnections;
+
+// Executes every statement except "FAIL", without producing any rows.
+class PoolTestResult : public QSqlResult
+{
+public:
+    explicit PoolTestResult(const QSqlDriver *driver) : QSqlResult(driver) {}
+
+protected:
+    QVariant data(int) override { return QVariant(); }
+    bool isNull(int) override { return true; }
+    bool reset(const QString &query) override
+    {
+        if (query == "FAIL"_L1) {
+            setLastError(QSqlError("failed"_L1, QString(), QSqlError::StatementError));
+            return false;
+        }
+        setActive(true);
+        return true;
+    }
+    bool fetch(int) override { return false; }
+    bool fetchFirst() override { return false; }
+    bool fetchLast() override { return false; }
+    int size() override { return -1; }
+    int numRowsAffected() override { return 0; }
+};
+
+// Opens any database except "unreachable".
+class PoolTestDriver : public QSqlDriver
+{
+public:
+    bool hasFeature(DriverFeature) const override { return false; }
+    bool open(const QString &db, const QString &, const QString &, const QString &, int,
+              const QString &) override
+    {
+        if (db == "unreachable"_L1) {
+            setLastError(QSqlError("unreachable"_L1, QString(), QSqlError::ConnectionError));
+            setOpenError(true);
+            return false;
+        }
+        openedConnections.ref();
+        setOpen(true);
+        setOpenError(false);
+        return true;
+    }
+    void close() override { setOpen(false); }
+    QSqlResult *createResult() const override { return new PoolTestResult(this); }
+};
+
+} // unnamed namespace
+
+class tst_QSqlConnectionPool : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void acquireAndRelease();
+    void openError();
+    void maximumSize();
+    void threads();
+    void validationQuery();
+    void resetQuery();
+    void idleTimeout();
+    void clear();
+
+private:
+    QSqlDatabase prototype;
+};
+
+void tst_QSqlConnectionPool::initTestCase()
+{
+    QSqlDatabase::registerSqlDriver("QPOOLTEST"_L1, new QSqlDriverCreator<PoolTestDriver>);
+    prototype = QSqlDatabase::addDatabase("QPOOLTEST"_L1, "prototype"_L1);
+    prototype.setDatabaseName("pooled"_L1);
+}
+
+void tst_QSqlConnectionPool::init()
+{
+    openedConnections.storeRelaxed(0);
+}
+
+void tst_QSqlConnectionPool::cleanup()
+{
+    QCOMPARE(QSqlDatabase::connectionNames(), QStringList{"prototype"_L1});
+}
+
+void tst_QSqlConnectionPool::acquireAndRelease()
+{
+    QSqlConnectionPool pool(prototype, "pool"_L1);
+    QCOMPARE(pool.name(), "pool"_L1);
+    QCOMPARE(pool.maximumSize(), QThread::idealThreadCount());
+    QVERIFY(pool.resetQuery().isEmpty());
+
+    QSqlDatabase db = pool.acquire();
+    QVERIFY(db.isValid());
+    QVERIFY(db.isOpen());
+    QCOMPARE(db.driverName(), "QPOOLTEST"_L1);
+    QCOMPARE(db.databaseName(), "pooled"_L1);
+    QVERIFY(db.connectionName().startsWith("pool/"_L1));
+    QCOMPARE(QSqlDatabase::database(db.connectionName()).driver(), db.driver());
+    const QString connectionName = db.connectionName();
+
+    QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.size, 1);
+    QCOMPARE(stats.inUseCount, 1);
+    QCOMPARE(stats.idleCount, 0);
+
+    pool.release(db);
+    QVERIFY(!db.isValid());
+    stats = pool.statistics();
+    QCOMPARE(stats.inUseCount, 0);
+    QCOMPARE(stats.idleCount, 1);
+
+    // the idle connection is reused
+    db = pool.acquire();
+    QCOMPARE(db.connectionName(), connectionName);
+    QCOMPARE(db.driver()->thread(), QThread::currentThread());
+    pool.release(db);
+
+    stats = pool.statistics();
+    QCOMPARE(stats.acquireCount, 2);
+    QCOMPARE(stats.openCount, 1);
+    QCOMPARE(stats.peakInUseCount, 1);
+    QCOMPARE(stats.waitCount, 0);
+    QCOMPARE(openedConnections.loadRelaxed(), 1);
+
+    // not ours
+    QTest::ignoreMessage(QtWarningMsg,
+                         "QSqlConnectionPool::release: connection 'prototype' is not in use "
+                         "from pool 'pool'");
+    pool.release(prototype);
+    QVERIFY(prototype.isValid());
+}
+
+void tst_QSqlConnectionPool::openError()
+{
+    QSqlDatabase unreachable = QSqlDatabase::addDatabase("QPOOLTEST"_L1, "unreachable"_L1);
+    unreachable.setDatabaseName("unreachable"_L1);
+    {
+        QSqlConnectionPool pool(unreachable);
+        QSqlDatabase db = pool.acquire();
+        QVERIFY(!db.isValid());
+        QCOMPARE(pool.lastError().type(), QSqlError::ConnectionError);
+        QCOMPARE(pool.lastError().driverText(), "unreachable"_L1);
+        const QSqlConnectionPool::Statistics stats = pool.statistics();
+        QCOMPARE(stats.size, 0);
+        QCOMPARE(stats.openCount, 0);
+        QCOMPARE(stats.acquireCount, 0);
+    }
+    unreachable = QSqlDatabase();
+    QSqlDatabase::removeDatabase("unreachable"_L1);
+}
+
+void tst_QSqlConnectionPool::maximumSize()
+{
+    QSqlConnectionPool pool(prototype);
+    pool.setMaximumSize(1);
+    QCOMPARE(pool.maximumSize(), 1);
+
+    QSqlDatabase db = pool.acquire();
+    QVERIFY(db.isValid());
+    QVERIFY(!pool.acquire(QDeadlineTimer(50ms)).isValid());
+    QCOMPARE(pool.lastError().type(), QSqlError::ConnectionError);
+
+    QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.timeoutCount, 1);
+    QCOMPARE(stats.waitCount, 1);
+    QVERIFY(stats.totalWaitTime >= 50ms);
+
+    // a waiting thread gets the connection once it is released
+    QString acquiredName;
+    std::unique_ptr<QThread> thread(QThread::create([&] {
+        QSqlDatabase waited = pool.acquire(QDeadlineTimer(10s));
+        if (!waited.isValid() || waited.driver()->thread() != QThread::currentThread())
+            return;
+        acquiredName = waited.connectionName();
+        pool.release(waited);
+    }));
+    thread->start();
+    QTRY_COMPARE(pool.statistics().waitCount, 2);
+    const QString connectionName = db.connectionName();
+    pool.release(db);
+    QVERIFY(thread->wait(10s));
+    QCOMPARE(acquiredName, connectionName);
+
+    stats = pool.statistics();
+    QCOMPARE(stats.openCount, 1);
+    QCOMPARE(stats.acquireCount, 2);
+    QCOMPARE(stats.timeoutCount, 1);
+    QVERIFY(stats.maximumWaitTime > 0ns);
+}
+
+void tst_QSqlConnectionPool::threads()
+{
+    QSqlConnectionPool pool(prototype);
+    pool.setMaximumSize(2);
+    pool.setValidationQuery("SELECT 1"_L1);
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(8);
+    QAtomicInt failures;
+    for (int i = 0; i < 200; ++i) {
+        threadPool.start([&pool, &failures] {
+            QSqlDatabase db = pool.acquire();
+            if (!db.isValid() || db.driver()->thread() != QThread::currentThread()) {
+                failures.ref();
+                return;
+            }
+            {
+                QSqlQuery query(db);
+                if (!query.exec("UPDATE t SET x = 1"_L1))
+                    failures.ref();
+            }
+            pool.release(db);
+        });
+    }
+    QVERIFY(threadPool.waitForDone(60000));
+    QCOMPARE(failures.loadRelaxed(), 0);
+
+    const QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.acquireCount, 200);
+    QCOMPARE(stats.inUseCount, 0);
+    QVERIFY(stats.peakInUseCount <= 2);
+    QVERIFY(stats.openCount <= 2);
+    QCOMPARE(stats.size, stats.openCount);
+    QCOMPARE(stats.discardCount, 0);
+}
+
+void tst_QSqlConnectionPool::validationQuery()
+{
+    QSqlConnectionPool pool(prototype);
+    QSqlDatabase db = pool.acquire();
+    pool.release(db);
+
+    pool.setValidationQuery("FAIL"_L1);
+    QCOMPARE(pool.validationQuery(), "FAIL"_L1);
+    // new connections are not validated, idle ones are
+    db = pool.acquire();
+    QVERIFY(db.isValid());
+    QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.openCount, 2);
+    QCOMPARE(stats.discardCount, 1);
+    QCOMPARE(stats.size, 1);
+    pool.release(db);
+
+    // the pool is not fooled by a connection that was closed behind its back
+    pool.setValidationQuery(QString());
+    db = pool.acquire();
+    db.close();
+    pool.release(db);
+    stats = pool.statistics();
+    QCOMPARE(stats.discardCount, 2);
+    QCOMPARE(stats.size, 0);
+}
+
+void tst_QSqlConnectionPool::resetQuery()
+{
+    QSqlConnectionPool pool(prototype);
+    pool.setResetQuery("SET SESSION AUTHORIZATION DEFAULT"_L1);
+    QSqlDatabase db = pool.acquire();
+    pool.release(db);
+    QCOMPARE(pool.statistics().idleCount, 1);
+
+    pool.setResetQuery("FAIL"_L1);
+    QCOMPARE(pool.resetQuery(), "FAIL"_L1);
+    db = pool.acquire();
+    const QString connectionName = db.connectionName();
+    pool.release(db);
+    const QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.idleCount, 0);
+    QCOMPARE(stats.discardCount, 1);
+    QVERIFY(!QSqlDatabase::contains(connectionName));
+}
+
+void tst_QSqlConnectionPool::idleTimeout()
+{
+    QSqlConnectionPool pool(prototype);
+    QCOMPARE(pool.idleTimeout(), 5min);
+    pool.setIdleTimeout(20ms);
+    QCOMPARE(pool.idleTimeout(), 20ms);
+
+    QSqlDatabase db = pool.acquire();
+    const QString connectionName = db.connectionName();
+    pool.release(db);
+    QTest::qSleep(50ms);
+
+    db = pool.acquire();
+    QVERIFY(db.isValid());
+    QVERIFY(db.connectionName() != connectionName);
+    QVERIFY(!QSqlDatabase::contains(connectionName));
+    const QSqlConnectionPool::Statistics stats = pool.statistics();
+    QCOMPARE(stats.openCount, 2);
+    QCOMPARE(stats.discardCount, 1);
+    pool.release(db);
+}
+
+void tst_QSqlConnectionPool::clear()
+{
+    QSqlConnectionPool pool(prototype);
+    pool.setMaximumSize(2);
+    QSqlDatabase first = pool.acquire();
+    QSqlDatabase second = pool.acquire();
+    const QString firstName = first.connectionName();
+    pool.release(first);
+
+    pool.clear();
+    QVERIFY(!QSqlDatabase::contains(firstName));
+    QVERIFY(QSqlDatabase::contains(second.connectionName()));
+    QCOMPARE(pool.statistics().size, 1);
+    pool.release(second);
+}
+
+QTEST_MAIN(tst_QSqlConnectionPool)
+#include "tst_qsqlconnectionpool.moc"
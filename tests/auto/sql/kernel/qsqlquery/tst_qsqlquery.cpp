@@ -72,6 +72,8 @@ private slots:
     // forwardOnly mode need special treatment
     void forwardOnly_data() { generic_data(); }
     void forwardOnly();
+    void fetchColumns_data() { generic_data(); }
+    void fetchColumns();
     void forwardOnlyMultipleResultSet_data() { generic_data(); }
     void forwardOnlyMultipleResultSet();
     void psql_forwardOnlyQueryResultsLost_data() { generic_data("QPSQL"); }
@@ -145,6 +147,14 @@ private slots:
     void psql_bindWithDoubleColonCastOperator();
     void psql_specialFloatValues_data() { generic_data("QPSQL"); }
     void psql_specialFloatValues();
+    void psql_binaryResults_data() { generic_data("QPSQL"); }
+    void psql_binaryResults();
+    void psql_copyFromStdin_data() { generic_data("QPSQL"); }
+    void psql_copyFromStdin();
+    void psql_copyDateTimes_data() { generic_data("QPSQL"); }
+    void psql_copyDateTimes();
+    void psql_batchTransaction_data() { generic_data("QPSQL"); }
+    void psql_batchTransaction();
     void queryOnInvalidDatabase_data() { generic_data(); }
     void queryOnInvalidDatabase();
     void createQueryOnClosedDatabase_data() { generic_data(); }
@@ -1473,6 +1483,69 @@ void tst_QSqlQuery::forwardOnly()
     QCOMPARE(q.at(), QSql::AfterLastRow);
 }
 
+void tst_QSqlQuery::fetchColumns()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    TableScope ts(db, "qtest_fetchcolumns", __FILE__);
+    const auto &tableName = ts.tableName();
+
+    QSqlQuery q(db);
+    QVERIFY_SQL(q, exec("create table " + tableName
+                        + " (id int not null, val int, name varchar(20))"));
+    QVERIFY_SQL(q, prepare("insert into " + tableName + " values (?, ?, ?)"));
+    for (int i = 0; i < 10; ++i) {
+        q.bindValue(0, i);
+        q.bindValue(1, i % 3 ? QVariant(i * 10) : QVariant(QMetaType::fromType<int>()));
+        q.bindValue(2, i % 4 ? QVariant(QString("name %1").arg(i))
+                             : QVariant(QMetaType::fromType<QString>()));
+        QVERIFY_SQL(q, exec());
+    }
+
+    for (const bool forwardOnly : {false, true}) {
+        q.setForwardOnly(forwardOnly);
+        QVERIFY_SQL(q, exec("select id, val, name from " + tableName + " order by id"));
+        QList<QSqlColumnBuffer> columns = q.fetchColumns(4);
+        QCOMPARE(columns.size(), 3);
+        QCOMPARE(columns.at(0).type(), QSqlColumnBuffer::Type::Integer);
+        QCOMPARE(columns.at(1).type(), QSqlColumnBuffer::Type::Integer);
+        QCOMPARE(columns.at(2).type(), QSqlColumnBuffer::Type::String);
+        QCOMPARE(columns.at(0).integers(), (QList<qint64>{0, 1, 2, 3}));
+        QVERIFY(columns.at(1).isNull(0));
+        QVERIFY(!columns.at(1).isNull(1));
+        QCOMPARE(columns.at(1).integers().at(1), 10);
+        QVERIFY(columns.at(1).isNull(3));
+        QVERIFY(columns.at(2).isNull(0));
+        QCOMPARE(columns.at(2).strings().at(1), u"name 1");
+        QCOMPARE(columns.at(2).value(3), QVariant(u"name 3"_s));
+
+        // positioned on the last row fetched, next() takes it from there
+        QCOMPARE(q.at(), 3);
+        QCOMPARE(q.value(0).toInt(), 3);
+        QVERIFY(q.next());
+        QCOMPARE(q.value(0).toInt(), 4);
+
+        columns = q.fetchColumns(100);
+        QCOMPARE(columns.at(0).integers(), (QList<qint64>{5, 6, 7, 8, 9}));
+        const QBitArray nulls = columns.at(1).nulls();
+        QCOMPARE(nulls.size(), 5);
+        QCOMPARE(nulls.count(true), 2);
+        QCOMPARE(q.at(), QSql::AfterLastRow);
+        QVERIFY(!q.next());
+        QVERIFY(q.fetchColumns(100).isEmpty());
+    }
+
+    // Unsigned 64-bit values need not fit into the integer buffer
+    if (tst_Databases::getDatabaseType(db) == QSqlDriver::MySqlServer) {
+        QVERIFY_SQL(q, exec("select cast(18446744073709551615 as unsigned)"));
+        const QList<QSqlColumnBuffer> columns = q.fetchColumns(1);
+        QCOMPARE(columns.size(), 1);
+        QCOMPARE(columns.at(0).type(), QSqlColumnBuffer::Type::Variant);
+        QCOMPARE(columns.at(0).value(0).toULongLong(), Q_UINT64_C(18446744073709551615));
+    }
+}
+
 void tst_QSqlQuery::forwardOnlyMultipleResultSet()
 {
     QFETCH(QString, dbName);
@@ -2888,6 +2961,229 @@ void tst_QSqlQuery::psql_specialFloatValues()
     }
 }
 
+// Prepared statements whose columns all have a binary decoder get their
+// results in binary; they must read back the same as text results do.
+void tst_QSqlQuery::psql_binaryResults()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery query(db);
+    TableScope ts(db, "binaryresults", __FILE__);
+    QVERIFY_SQL(query, exec(QLatin1String(
+            "create table %1 (id int4, small int2, big int8, flag bool, dbl float8, "
+            "num numeric(20, 6), day date, tod time, stamp timestamp, stamptz timestamptz, "
+            "blob bytea, txt text, vc varchar(20), ch char(5))").arg(ts.tableName())));
+    QVERIFY_SQL(query, exec(QLatin1String(
+            "insert into %1 values (1, -2, -9000000000, true, 0.1, -12345.000678, "
+            "'1999-12-31', '23:59:58.123', '1970-01-01 00:00:01.5', "
+            "'2024-02-29 12:34:56.789+00', '\\x00ff10', 'hello', 'world', 'ab'), "
+            "(2, null, 42, false, 'NaN', 0.5, 'infinity', '00:00', '1969-12-31 23:59:59', "
+            "'-infinity', '', '', null, null), "
+            "(3, null, null, null, null, null, null, '12:00:00.0006', "
+            "'1999-12-31 23:59:59.9996', '2024-02-29 12:34:56.0006+00', null, null, null, null), "
+            "(4, null, null, null, null, null, null, '23:59:59.9996', "
+            "'1969-12-31 23:59:59.0004', null, null, null, null, null)").arg(ts.tableName())));
+
+    const QString select = QLatin1String("select * from %1 order by id").arg(ts.tableName());
+    QSqlQuery text(db);
+    QVERIFY_SQL(query, prepare(select));
+    for (const bool forwardOnly : { false, true }) {
+        QVERIFY_SQL(text, exec(select));
+        query.setForwardOnly(forwardOnly);
+        QVERIFY_SQL(query, exec());
+        while (text.next()) {
+            QVERIFY(query.next());
+            for (int i = 0; i < text.record().count(); ++i) {
+                const QVariant expected = text.value(i);
+                const QVariant actual = query.value(i);
+                QCOMPARE(actual.metaType().id(), expected.metaType().id());
+                QCOMPARE(actual.isNull(), expected.isNull());
+                if (expected.metaType() == QMetaType::fromType<double>() && qIsNaN(expected.toDouble()))
+                    QVERIFY(qIsNaN(actual.toDouble()));
+                else
+                    QCOMPARE(actual, expected);
+            }
+        }
+        QVERIFY(!query.next());
+    }
+
+    // Microseconds round to the nearest millisecond; a time stops short of
+    // the end of the day, a timestamp carries into the next one.
+    QVERIFY_SQL(query, prepare(QLatin1String("select tod, stamp from %1 where id > 2 order by id")
+                                       .arg(ts.tableName())));
+    QVERIFY_SQL(query, exec());
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toTime(), QTime(12, 0, 0, 1));
+    QCOMPARE(query.value(1).toDateTime(), QDateTime(QDate(2000, 1, 1), QTime(0, 0)));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toTime(), QTime(23, 59, 59, 999));
+    QCOMPARE(query.value(1).toDateTime(), QDateTime(QDate(1969, 12, 31), QTime(23, 59, 59)));
+
+    // High precision numerics come as strings, exactly as the server prints them
+    query.setNumericalPrecisionPolicy(QSql::HighPrecision);
+    QVERIFY_SQL(query, prepare(QLatin1String("select num from %1 order by id").arg(ts.tableName())));
+    QVERIFY_SQL(query, exec());
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toString(), QString("-12345.000678"));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toString(), QString("0.500000"));
+}
+
+void tst_QSqlQuery::psql_copyFromStdin()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery query(db);
+    TableScope ts(db, "copytest", __FILE__);
+    QVERIFY_SQL(query, exec(QLatin1String("create table %1 (id int, txt text, blob bytea)")
+                                    .arg(ts.tableName())));
+
+    const QVariantList ids = { 1, 2, 3 };
+    const QVariantList texts = { QString("tab\there"), QString("back\\slash\nnewline"),
+                                 QVariant(QMetaType::fromType<QString>()) };
+    const QVariantList blobs = { QByteArray("\x00\x01\\", 3), QByteArray(""),
+                                 QVariant(QMetaType::fromType<QByteArray>()) };
+    QVERIFY_SQL(query, prepare(QLatin1String("copy %1 (id, txt, blob) from stdin")
+                                       .arg(ts.tableName())));
+    query.addBindValue(ids);
+    query.addBindValue(texts);
+    query.addBindValue(blobs);
+    QVERIFY_SQL(query, execBatch());
+    QCOMPARE(query.numRowsAffected(), 3);
+
+    // exec() copies a single row
+    query.addBindValue(4);
+    query.addBindValue(QString("four"));
+    query.addBindValue(QByteArray("4"));
+    QVERIFY_SQL(query, exec());
+
+    QVERIFY_SQL(query, exec(QLatin1String("select id, txt, blob from %1 order by id")
+                                    .arg(ts.tableName())));
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY(query.next());
+        QCOMPARE(query.value(0), ids.at(i));
+        QCOMPARE(query.value(1).isNull(), texts.at(i).isNull());
+        QCOMPARE(query.value(1).toString(), texts.at(i).toString());
+        QCOMPARE(query.value(2).isNull(), blobs.at(i).isNull());
+        QCOMPARE(query.value(2).toByteArray(), blobs.at(i).toByteArray());
+    }
+    QVERIFY(query.next());
+    QCOMPARE(query.value(1).toString(), QString("four"));
+    QVERIFY(!query.next());
+
+    // Errors in the data abort the whole COPY
+    QVERIFY_SQL(query, prepare(QLatin1String("copy %1 (id) from stdin").arg(ts.tableName())));
+    query.addBindValue(QVariantList{ 5, QString("not a number") });
+    QVERIFY(!query.execBatch());
+    QVERIFY(query.lastError().isValid());
+    QVERIFY_SQL(query, exec(QLatin1String("select count(*) from %1").arg(ts.tableName())));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 4);
+}
+
+void tst_QSqlQuery::psql_copyDateTimes()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery query(db);
+    TableScope ts(db, "copydatetimes", __FILE__);
+    QVERIFY_SQL(query, exec(QLatin1String("create table %1 (id int, ts timestamp(3), "
+                                          "tstz timestamp(3) with time zone)")
+                                    .arg(ts.tableName())));
+
+    // A session time zone that is not the one of the client, with an offset
+    // that is not a whole number of hours
+    QVERIFY_SQL(query, exec("set time zone 'Asia/Kolkata'"));
+    const auto tidier = qScopeGuard([db]() {
+        QSqlQuery(db).exec("set time zone default");
+    });
+
+    const QDateTime dateTime(QDate(2024, 3, 31), QTime(1, 30, 15, 250), QTimeZone::UTC);
+    const QVariantList ids = { 1, 2 };
+    const QVariantList dateTimes = { dateTime, dateTime.toLocalTime() };
+
+    // COPY stores the same values as an INSERT does
+    QVERIFY_SQL(query, prepare(QLatin1String("copy %1 (id, ts, tstz) from stdin")
+                                       .arg(ts.tableName())));
+    query.addBindValue(ids);
+    query.addBindValue(dateTimes);
+    query.addBindValue(dateTimes);
+    QVERIFY_SQL(query, execBatch());
+    QVERIFY_SQL(query, prepare(QLatin1String("insert into %1 (id, ts, tstz) values (?, ?, ?)")
+                                       .arg(ts.tableName())));
+    for (int i = 0; i < ids.size(); ++i) {
+        query.addBindValue(ids.at(i).toInt() + 10);
+        query.addBindValue(dateTimes.at(i));
+        query.addBindValue(dateTimes.at(i));
+        QVERIFY_SQL(query, exec());
+    }
+
+    QVERIFY_SQL(query, exec(QLatin1String("select c.ts = i.ts, c.tstz = i.tstz, c.ts "
+                                          "from %1 c join %1 i on i.id = c.id + 10 order by c.id")
+                                    .arg(ts.tableName())));
+    for (int i = 0; i < ids.size(); ++i) {
+        QVERIFY(query.next());
+        QVERIFY(query.value(0).toBool());
+        QVERIFY(query.value(1).toBool());
+        // The session's wall-clock time, at +05:30
+        QCOMPARE(query.value(2).toDateTime().time(), QTime(7, 0, 15, 250));
+    }
+    QVERIFY(!query.next());
+}
+
+// A batch is executed in a transaction of its own, unless there already is
+// one: a failing row must not leave the rows before it stored.
+void tst_QSqlQuery::psql_batchTransaction()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery query(db);
+    TableScope ts(db, "batchtransaction", __FILE__);
+    QVERIFY_SQL(query, exec(QLatin1String("create table %1 (id int primary key)")
+                                    .arg(ts.tableName())));
+    const QString insert = QLatin1String("insert into %1 (id) values (?)").arg(ts.tableName());
+    const QString count = QLatin1String("select count(*) from %1").arg(ts.tableName());
+
+    // More rows than are sent before the first sync point
+    QVariantList ids;
+    for (int i = 0; i < 600; ++i)
+        ids.append(i);
+    QVERIFY_SQL(query, prepare(insert));
+    query.addBindValue(ids);
+    QVERIFY_SQL(query, execBatch());
+    QVERIFY_SQL(query, exec(count));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 600);
+
+    // The duplicate is in the second chunk; the first one isn't kept either
+    for (QVariant &id : ids)
+        id = id.toInt() + 1000;
+    ids[500] = 1000;
+    QVERIFY_SQL(query, prepare(insert));
+    query.addBindValue(ids);
+    QVERIFY(!query.execBatch());
+    QVERIFY(query.lastError().isValid());
+    QVERIFY_SQL(query, exec(count));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 600);
+
+    // The connection is usable afterwards, and a transaction of the user's
+    // is left to the user
+    QVERIFY_SQL(db, transaction());
+    ids[500] = 1500;
+    QVERIFY_SQL(query, prepare(insert));
+    query.addBindValue(ids);
+    QVERIFY_SQL(query, execBatch());
+    QVERIFY_SQL(db, rollback());
+    QVERIFY_SQL(query, exec(count));
+    QVERIFY(query.next());
+    QCOMPARE(query.value(0).toInt(), 600);
+}
+
 /* For task 157397: Using QSqlQuery with an invalid QSqlDatabase
    does not set the last error of the query.
    This test function will output some warnings, that's ok.
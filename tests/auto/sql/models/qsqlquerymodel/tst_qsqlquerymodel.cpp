@@ -46,6 +46,8 @@ private slots:
     void setHeaderData();
     void fetchMore_data() { generic_data(); }
     void fetchMore();
+    void backgroundFetch_data() { generic_data(); }
+    void backgroundFetch();
 
     //problem specific tests
     void withSortFilterProxyModel_data() { generic_data(); }
@@ -466,6 +468,66 @@ void tst_QSqlQueryModel::fetchMore()
     }
 }
 
+void tst_QSqlQueryModel::backgroundFetch()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+
+    QSqlQueryModel model;
+    model.setBackgroundFetch(true);
+    model.setFetchBatchSize(100);
+    QVERIFY(model.backgroundFetch());
+    QCOMPARE(model.fetchBatchSize(), 100);
+
+    QSignalSpy rowsInsertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy progressSpy(&model, SIGNAL(fetchProgress(int)));
+    QSignalSpy finishedSpy(&model, SIGNAL(fetchFinished()));
+
+    // fetch everything, the way a view scrolling down would
+    connect(&model, &QSqlQueryModel::fetchProgress, this, [&model]() {
+        if (model.canFetchMore())
+            model.fetchMore();
+    });
+    model.setQuery("select id, name from " + qTableName("many", __FILE__, db) + " order by id", db);
+    QVERIFY(model.isFetching());
+    QVERIFY(!model.query().isActive());
+
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.size(), 1, 30000);
+    QVERIFY(!model.isFetching());
+    QVERIFY(!model.canFetchMore());
+    QVERIFY2(!model.lastError().isValid(), qPrintable(model.lastError().text()));
+    QCOMPARE(model.rowCount(), 2048);
+    QCOMPARE(model.columnCount(), 2);
+    QCOMPARE(model.data(model.index(0, 0)).toInt(), 0);
+    QCOMPARE(model.data(model.index(2047, 0)).toInt(), 2047);
+    QCOMPARE(model.record(1000).value("name").toString(), QString("harry"));
+
+    // rows arrive in batches, and the insertions cover them without gaps
+    QVERIFY(!rowsInsertedSpy.isEmpty());
+    int next = 0;
+    for (const auto &arguments : std::as_const(rowsInsertedSpy)) {
+        QCOMPARE(arguments.at(1).toInt(), next);
+        next = arguments.at(2).toInt() + 1;
+    }
+    QCOMPARE(next, 2048);
+    QCOMPARE(progressSpy.last().at(0).toInt(), 2048);
+
+    // errors are reported once the worker is done
+    model.setQuery("select * from " + qTableName("nonexistent", __FILE__, db), db);
+    QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.size(), 2, 30000);
+    QVERIFY(model.lastError().isValid());
+    QCOMPARE(model.rowCount(), 0);
+
+    // a new query, or clear(), stops a fetch in progress
+    model.setQuery("select id, name from " + qTableName("many", __FILE__, db), db);
+    model.clear();
+    QVERIFY(!model.isFetching());
+    QCOMPARE(model.rowCount(), 0);
+    QTest::qWait(100);
+    QCOMPARE(model.rowCount(), 0);
+}
+
 // For task 149491: When used with QSortFilterProxyModel, a view and a
 // database that doesn't support the QuerySize feature, blank rows was
 // appended if the query returned more than 256 rows and setQuery()
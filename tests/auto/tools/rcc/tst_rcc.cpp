@@ -14,7 +14,9 @@
 #include <QtCore/QMap>
 #include <QtCore/QList>
 #include <QtCore/QResource>
+#include <QtCore/QScopeGuard>
 #include <QtCore/QLocale>
+#include <QtCore/QTemporaryDir>
 #include <QtCore/QtGlobal>
 
 #include <algorithm>
@@ -61,6 +63,8 @@ private slots:
 
     void binary_data();
     void binary();
+    void payloadAlignment();
+    void zstdDictionary();
 
     void readback_data();
     void readback();
@@ -244,56 +248,58 @@ void tst_rcc::binary_data()
 
     QString dataPath = m_dataPath + QLatin1String("/binary/");
 
-    QDirIterator iter(dataPath, QStringList() << QLatin1String("*.qrc"));
-    while (iter.hasNext())
-    {
-        QFileInfo qrcFileInfo = iter.nextFileInfo();
-        QString absoluteBaseName = QFileInfo(qrcFileInfo.absolutePath(), qrcFileInfo.baseName()).absoluteFilePath();
-        QString rccFileName = absoluteBaseName + QLatin1String(".rcc");
-
-        // same as above: force no compression
-        QProcess rccProcess;
-        rccProcess.setWorkingDirectory(dataPath);
-        rccProcess.start(m_rcc, { "-binary", "-no-compress", "-o", rccFileName, qrcFileInfo.absoluteFilePath() });
-        QVERIFY2(rccProcess.waitForStarted(), msgProcessStartFailed(rccProcess).constData());
-        if (!rccProcess.waitForFinished()) {
-            rccProcess.kill();
-            QFAIL(msgProcessTimeout(rccProcess).constData());
-        }
-        QVERIFY2(rccProcess.exitStatus() == QProcess::NormalExit,
-                 msgProcessCrashed(rccProcess).constData());
-        QVERIFY2(rccProcess.exitCode() == 0,
-                 msgProcessFailed(rccProcess).constData());
-
-        QByteArray output = rccProcess.readAllStandardOutput();
-        if (!output.isEmpty())
-            qWarning("rcc stdout: %s", output.constData());
-
-        output = rccProcess.readAllStandardError();
-        if (!output.isEmpty())
-            qWarning("rcc stderr: %s", output.constData());
-
-        QString localeFileName = absoluteBaseName + QLatin1String(".locale");
-        QFile localeFile(localeFileName);
-        if (localeFile.exists()) {
-            const QStringList locales = readLinesFromFile(localeFileName, Qt::SkipEmptyParts);
-            for (const QString &locale : locales) {
-                QString expectedFileName = QString::fromLatin1("%1.%2.%3").arg(absoluteBaseName, locale, QLatin1String("expected"));
-                QStringMap expectedFiles = readExpectedFiles(expectedFileName);
-                QTest::newRow(qPrintable(qrcFileInfo.baseName() + QLatin1Char('_') + locale)) << rccFileName
-                                                                                              << QLocale(locale)
-                                                                                              << dataPath
-                                                                                              << expectedFiles;
+    // format version 4 has a lookup index
+    for (int formatVersion : { 3, 4 }) {
+        QDirIterator iter(dataPath, QStringList() << QLatin1String("*.qrc"));
+        while (iter.hasNext())
+        {
+            QFileInfo qrcFileInfo = iter.nextFileInfo();
+            QString absoluteBaseName = QFileInfo(qrcFileInfo.absolutePath(), qrcFileInfo.baseName()).absoluteFilePath();
+            const QString suffix = formatVersion == 3 ? QString() : QLatin1String("_v4");
+            QString rccFileName = absoluteBaseName + suffix + QLatin1String(".rcc");
+
+            // same as above: force no compression
+            QProcess rccProcess;
+            rccProcess.setWorkingDirectory(dataPath);
+            rccProcess.start(m_rcc, { "-binary", "-no-compress", "--format-version",
+                                      QString::number(formatVersion), "-o", rccFileName,
+                                      qrcFileInfo.absoluteFilePath() });
+            QVERIFY2(rccProcess.waitForStarted(), msgProcessStartFailed(rccProcess).constData());
+            if (!rccProcess.waitForFinished()) {
+                rccProcess.kill();
+                QFAIL(msgProcessTimeout(rccProcess).constData());
+            }
+            QVERIFY2(rccProcess.exitStatus() == QProcess::NormalExit,
+                     msgProcessCrashed(rccProcess).constData());
+            QVERIFY2(rccProcess.exitCode() == 0,
+                     msgProcessFailed(rccProcess).constData());
+
+            QByteArray output = rccProcess.readAllStandardOutput();
+            if (!output.isEmpty())
+                qWarning("rcc stdout: %s", output.constData());
+
+            output = rccProcess.readAllStandardError();
+            if (!output.isEmpty())
+                qWarning("rcc stderr: %s", output.constData());
+
+            QString localeFileName = absoluteBaseName + QLatin1String(".locale");
+            QFile localeFile(localeFileName);
+            if (localeFile.exists()) {
+                const QStringList locales = readLinesFromFile(localeFileName, Qt::SkipEmptyParts);
+                for (const QString &locale : locales) {
+                    QString expectedFileName = QString::fromLatin1("%1.%2.%3").arg(absoluteBaseName, locale, QLatin1String("expected"));
+                    QStringMap expectedFiles = readExpectedFiles(expectedFileName);
+                    QTest::newRow(qPrintable(qrcFileInfo.baseName() + QLatin1Char('_') + locale + suffix))
+                            << rccFileName << QLocale(locale) << dataPath << expectedFiles;
+                }
             }
-        }
 
-        // always test for the C locale as well
-        QString expectedFileName = absoluteBaseName + QLatin1String(".expected");
-        QStringMap expectedFiles = readExpectedFiles(expectedFileName);
-        QTest::newRow(qPrintable(qrcFileInfo.baseName() + QLatin1String("_C"))) << rccFileName
-                                                                                << QLocale::c()
-                                                                                << dataPath
-                                                                                << expectedFiles;
+            // always test for the C locale as well
+            QString expectedFileName = absoluteBaseName + QLatin1String(".expected");
+            QStringMap expectedFiles = readExpectedFiles(expectedFileName);
+            QTest::newRow(qPrintable(qrcFileInfo.baseName() + QLatin1String("_C") + suffix))
+                    << rccFileName << QLocale::c() << dataPath << expectedFiles;
+        }
     }
 }
 
@@ -352,12 +358,153 @@ void tst_rcc::binary()
         QCOMPARE(resourceData, actualData);
     }
 
+    QVERIFY(!QFile::exists(resourceRootPrefix + QLatin1String("nonexistent.txt")));
+    QVERIFY(!QFile::exists(resourceRootPrefix + QLatin1String("nonexistent/")));
     }
 
     QVERIFY(QResource::unregisterResource(resourceFile, rootPrefix));
     QLocale::setDefault(oldDefaultLocale);
 }
 
+void tst_rcc::payloadAlignment()
+{
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+    const auto writeFile = [&dir](const QString &name, const QByteArray &contents) {
+        QFile file(dir.filePath(name));
+        return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+    };
+    const QByteArray small("small");
+    const QByteArray large(10000, 'x');
+    QVERIFY(writeFile("small.txt", small));
+    QVERIFY(writeFile("large.txt", large));
+    QVERIFY(writeFile("align.qrc", "<RCC><qresource prefix=\"/align\">"
+                                   "<file>small.txt</file><file>large.txt</file>"
+                                   "</qresource></RCC>"));
+
+    const QString rccFileName = dir.filePath("align.rcc");
+    QProcess rccProcess;
+    rccProcess.setWorkingDirectory(dir.path());
+    rccProcess.start(m_rcc, { "-binary", "-no-compress", "--format-version", "4",
+                              "-o", rccFileName, "align.qrc" });
+    QVERIFY2(rccProcess.waitForStarted(), msgProcessStartFailed(rccProcess).constData());
+    if (!rccProcess.waitForFinished()) {
+        rccProcess.kill();
+        QFAIL(msgProcessTimeout(rccProcess).constData());
+    }
+    QVERIFY2(rccProcess.exitStatus() == QProcess::NormalExit,
+             msgProcessCrashed(rccProcess).constData());
+    QVERIFY2(rccProcess.exitCode() == 0,
+             msgProcessFailed(rccProcess).constData());
+
+    QFile rccFile(rccFileName);
+    QVERIFY(rccFile.open(QIODevice::ReadOnly));
+    const QByteArray rccData = rccFile.readAll();
+    const uchar *base = reinterpret_cast<const uchar *>(rccData.constData());
+    QVERIFY(QResource::registerResource(base));
+    const auto unregister = qScopeGuard([base] { QResource::unregisterResource(base); });
+
+    // the large payload starts at a page boundary of the file, the small
+    // one is not padded
+    QResource largeResource(":/align/large.txt");
+    QVERIFY(largeResource.isValid());
+    QCOMPARE((largeResource.data() - base) % 4096, 0);
+    QCOMPARE(largeResource.uncompressedData(), large);
+    QResource smallResource(":/align/small.txt");
+    QVERIFY(smallResource.isValid());
+    QCOMPARE(smallResource.uncompressedData(), small);
+    QVERIFY(rccData.size() < large.size() + 2 * 4096);
+}
+
+void tst_rcc::zstdDictionary()
+{
+#if !QT_CONFIG(zstd)
+    QSKIP("This test requires zstd support");
+#else
+    QTemporaryDir dir;
+    QVERIFY2(dir.isValid(), qPrintable(dir.errorString()));
+
+    // many small files of the same kind, which barely compress on their own
+    QByteArray qrc("<RCC><qresource prefix=\"/dict\">");
+    QList<QByteArray> contents;
+    for (int i = 0; i < 200; ++i) {
+        const QByteArray name = "item" + QByteArray::number(i) + ".json";
+        const QByteArray content = "{\n    \"name\": \"item" + QByteArray::number(i)
+                + "\",\n    \"enabled\": " + (i % 2 ? "true" : "false")
+                + ",\n    \"size\": { \"width\": " + QByteArray::number(i * 7 % 640)
+                + ", \"height\": " + QByteArray::number(i * 13 % 480)
+                + " },\n    \"tags\": [ \"resource\", \"generated\", \"test\" ]\n}\n";
+        QFile file(dir.filePath(QString::fromLatin1(name)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(content), content.size());
+        qrc += "<file>" + name + "</file>";
+        contents.append(content);
+    }
+    qrc += "</qresource></RCC>";
+    {
+        QFile file(dir.filePath("dict.qrc"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(qrc), qrc.size());
+    }
+
+    const auto runRcc = [&](const QStringList &arguments) {
+        QProcess rccProcess;
+        rccProcess.setWorkingDirectory(dir.path());
+        rccProcess.start(m_rcc, arguments);
+        QVERIFY2(rccProcess.waitForStarted(), msgProcessStartFailed(rccProcess).constData());
+        if (!rccProcess.waitForFinished()) {
+            rccProcess.kill();
+            QFAIL(msgProcessTimeout(rccProcess).constData());
+        }
+        QVERIFY2(rccProcess.exitStatus() == QProcess::NormalExit,
+                 msgProcessCrashed(rccProcess).constData());
+        QVERIFY2(rccProcess.exitCode() == 0,
+                 msgProcessFailed(rccProcess).constData());
+    };
+    const QString plainFileName = dir.filePath("plain.rcc");
+    runRcc({ "-binary", "--compress-algo", "zstd", "--format-version", "4",
+             "-o", plainFileName, "dict.qrc" });
+    if (QTest::currentTestFailed())
+        return;
+    const QString dictionaryFileName = dir.filePath("dictionary.rcc");
+    runRcc({ "-binary", "--compress-algo", "zstd", "--format-version", "4", "--zstd-dictionary",
+             "-o", dictionaryFileName, "dict.qrc" });
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(QFileInfo(dictionaryFileName).size() < QFileInfo(plainFileName).size());
+
+    // the dictionary is built anew after the file was registered again
+    for (int round = 0; round < 2; ++round) {
+        QVERIFY(QResource::registerResource(dictionaryFileName));
+        const auto unregister = qScopeGuard([&dictionaryFileName] {
+            QResource::unregisterResource(dictionaryFileName);
+        });
+        int compressed = 0;
+        for (int i = 0; i < contents.size(); ++i) {
+            QResource resource(":/dict/item" + QString::number(i) + ".json");
+            QVERIFY(resource.isValid());
+            if (resource.compressionAlgorithm() == QResource::ZstdCompression)
+                ++compressed;
+            QCOMPARE(resource.uncompressedData(), contents.at(i));
+            QFile file(resource.fileName());
+            QVERIFY(file.open(QIODevice::ReadOnly));
+            QCOMPARE(file.readAll(), contents.at(i));
+        }
+        QVERIFY2(compressed > contents.size() / 2, QByteArray::number(compressed).constData());
+    }
+
+    // the dictionary offset is part of the format version 4 header
+    QProcess rccProcess;
+    rccProcess.setWorkingDirectory(dir.path());
+    rccProcess.start(m_rcc, { "-binary", "--format-version", "3", "--zstd-dictionary",
+                              "-o", dir.filePath("old.rcc"), "dict.qrc" });
+    QVERIFY2(rccProcess.waitForStarted(), msgProcessStartFailed(rccProcess).constData());
+    QVERIFY(rccProcess.waitForFinished());
+    QCOMPARE(rccProcess.exitStatus(), QProcess::NormalExit);
+    QVERIFY(rccProcess.exitCode() != 0);
+#endif
+}
+
 void tst_rcc::readback_data()
 {
     QTest::addColumn<QString>("resourceName");
@@ -471,6 +618,8 @@ void tst_rcc::cleanupTestCase()
 {
     QDir dataDir(m_dataPath + QLatin1String("/binary"));
     QFileInfoList entries = dataDir.entryInfoList(QStringList() << QLatin1String("*.rcc"));
+    QDir dataSizesDir(m_dataPath + QLatin1String("/sizes"));
+    entries += dataSizesDir.entryInfoList(QStringList() << QLatin1String("*.rcc"));
     QDir dataDepDir(m_dataPath + QLatin1String("/depfile"));
     entries += dataDepDir.entryInfoList({QLatin1String("*.d"), QLatin1String("*.qrc.cpp")});
     for (const QFileInfo &entry : std::as_const(entries))
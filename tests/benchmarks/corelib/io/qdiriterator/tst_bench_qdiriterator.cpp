@@ -33,6 +33,10 @@ private slots:
     void posix_data() { data(); }
     void diriterator();
     void diriterator_data() { data(); }
+    void diriteratorParallel();
+    void diriteratorParallel_data() { data(); }
+    void diriteratorParallelUnordered();
+    void diriteratorParallelUnordered_data() { data(); }
     void fsiterator();
     void fsiterator_data() { data(); }
     void stdRecursiveDirectoryIterator();
@@ -178,6 +182,40 @@ void tst_QDirIterator::diriterator()
     qDebug() << count;
 }
 
+static int countFilesInParallel(const QByteArray &dirpath, QDirIterator::IteratorFlags flags)
+{
+    int count = 0;
+    QDirIterator dir(dirpath, QDir::Files,
+                     QDirIterator::Subdirectories | QDirIterator::ParallelTraversal | flags);
+    while (dir.hasNext()) {
+        dir.nextFileInfo();
+        ++count;
+    }
+    return count;
+}
+
+void tst_QDirIterator::diriteratorParallel()
+{
+    QFETCH(QByteArray, dirpath);
+
+    int count = 0;
+    QBENCHMARK {
+        count = countFilesInParallel(dirpath, {});
+    }
+    qDebug() << count;
+}
+
+void tst_QDirIterator::diriteratorParallelUnordered()
+{
+    QFETCH(QByteArray, dirpath);
+
+    int count = 0;
+    QBENCHMARK {
+        count = countFilesInParallel(dirpath, QDirIterator::UnorderedResults);
+    }
+    qDebug() << count;
+}
+
 void tst_QDirIterator::fsiterator()
 {
     QFETCH(QByteArray, dirpath);
@@ -6,6 +6,19 @@
 #include <QtCore/QProcess>
 #include <QtCore/QElapsedTimer>
 
+#include <cstring>
+#include <memory>
+
+// The size of the heap that spawn() allocates and touches, in megabytes,
+// because fork() has to copy the page tables of the parent process. Set
+// QT_BENCH_PROCESS_HEAP_MB=4096 to measure a parent with a 4 GB heap.
+static qsizetype heapSize()
+{
+    bool ok;
+    const int megabytes = qEnvironmentVariableIntValue("QT_BENCH_PROCESS_HEAP_MB", &ok);
+    return qsizetype(ok ? megabytes : 1024) * 1024 * 1024;
+}
+
 class tst_QProcess : public QObject
 {
     Q_OBJECT
@@ -13,6 +26,8 @@ class tst_QProcess : public QObject
 private slots:
 
     void echoTest_performance();
+    void spawn_data();
+    void spawn();
 };
 
 #ifdef Q_OS_WIN
@@ -66,5 +81,57 @@ void tst_QProcess::echoTest_performance()
     QVERIFY(process.waitForFinished());
 }
 
+void tst_QProcess::spawn_data()
+{
+    QTest::addColumn<bool>("modifier");
+    QTest::addColumn<bool>("useVFork");
+    QTest::addColumn<bool>("largeHeap");
+
+    for (bool largeHeap : { false, true }) {
+        const char *heap = largeHeap ? "large-heap" : "small-heap";
+        QTest::addRow("default:%s", heap) << false << false << largeHeap;
+#ifdef Q_OS_UNIX
+        // a modifier makes QProcess use fork(), unless it is declared vfork-safe
+        QTest::addRow("modifier:%s", heap) << true << false << largeHeap;
+        QTest::addRow("modifier-vfork:%s", heap) << true << true << largeHeap;
+#endif
+    }
+}
+
+// starts a child process that exits at once and waits for it to finish
+void tst_QProcess::spawn()
+{
+    QFETCH(bool, modifier);
+    QFETCH(bool, useVFork);
+    QFETCH(bool, largeHeap);
+
+    std::unique_ptr<char[]> heap;
+    if (largeHeap) {
+        const qsizetype size = heapSize();
+        heap.reset(new char[size]);
+        memset(heap.get(), 1, size);
+    }
+
+    QProcess process;
+    process.setProgram(QFINDTESTDATA("../testProcessLoopback/testProcessLoopback" EXE));
+    process.setStandardInputFile(QProcess::nullDevice());
+#ifdef Q_OS_UNIX
+    if (modifier)
+        process.setChildProcessModifier([] {});
+    if (useVFork)
+        process.setUnixProcessParameters(QProcess::UnixProcessFlag::UseVFork);
+#else
+    Q_UNUSED(modifier);
+    Q_UNUSED(useVFork);
+#endif
+
+    QBENCHMARK {
+        process.start();
+        QVERIFY2(process.waitForFinished(), qPrintable(process.errorString()));
+        QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+        QCOMPARE(process.exitCode(), 0);
+    }
+}
+
 QTEST_MAIN(tst_QProcess)
 #include "tst_bench_qprocess.moc"
@@ -0,0 +1,191 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qlibraryinfo.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qresource.h>
+#include <QtCore/qtemporarydir.h>
+
+using namespace Qt::StringLiterals;
+
+// a bundle of many small files of the same kinds, like the QML files, icons
+// and configuration of an application
+static constexpr int FilesPerKind = 500;
+
+class tst_QResourceEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void load_data();
+    void load();
+
+private:
+    bool runRcc(const QStringList &arguments, const QString &output);
+
+    QTemporaryDir dir;
+    QStringList resourcePaths;
+};
+
+static QByteArray qmlFile(int i)
+{
+    const int width = 100 + i % 300;
+    const int height = 50 + i % 200;
+    const int spacing = i % 16;
+    return QString::asprintf(
+            "import QtQuick\n"
+            "import QtQuick.Controls\n"
+            "import QtQuick.Layouts\n"
+            "\n"
+            "Item {\n"
+            "    id: page%d\n"
+            "    width: %d\n"
+            "    height: %d\n"
+            "    property string title: qsTr(\"Page %d\")\n"
+            "    property bool active: %s\n"
+            "\n"
+            "    ColumnLayout {\n"
+            "        anchors.fill: parent\n"
+            "        spacing: %d\n"
+            "        Label {\n"
+            "            text: page%d.title\n"
+            "            font.pixelSize: %d\n"
+            "            Layout.alignment: Qt.AlignHCenter\n"
+            "        }\n"
+            "        Rectangle {\n"
+            "            Layout.fillWidth: true\n"
+            "            Layout.preferredHeight: %d\n"
+            "            color: page%d.active ? \"#%06x\" : \"transparent\"\n"
+            "            radius: %d\n"
+            "        }\n"
+            "        Button {\n"
+            "            text: qsTr(\"Continue\")\n"
+            "            onClicked: page%d.active = !page%d.active\n"
+            "        }\n"
+            "    }\n"
+            "}\n",
+            i, width, height, i, i % 2 ? "true" : "false", spacing, i, 12 + i % 10,
+            height / 2, i, i * 2654435761u % 0xffffff, spacing, i, i)
+            .toUtf8();
+}
+
+static QByteArray svgFile(int i)
+{
+    const int x = i % 24;
+    const int y = i * 7 % 24;
+    const int r = i * 3 % 12;
+    return QString::asprintf(
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"24\" height=\"24\" "
+            "viewBox=\"0 0 24 24\">\n"
+            "  <path fill=\"none\" d=\"M0 0h24v24H0z\"/>\n"
+            "  <path fill=\"#%06x\" d=\"M%d %dl%d %d-%d %dz\"/>\n"
+            "  <circle cx=\"%d\" cy=\"%d\" r=\"%d\" stroke=\"#%06x\" stroke-width=\"2\"/>\n"
+            "</svg>\n",
+            i * 40503u % 0xffffff, x, y, r, i * 5 % 12, i * 11 % 12, x,
+            y, x, r, i * 40503u % 0xffffff)
+            .toUtf8();
+}
+
+static QByteArray jsonFile(int i)
+{
+    const int category = i % 7;
+    return QString::asprintf(
+            "{\n"
+            "    \"id\": %d,\n"
+            "    \"name\": \"setting-%d\",\n"
+            "    \"enabled\": %s,\n"
+            "    \"category\": \"category-%d\",\n"
+            "    \"values\": [%d, %d, %d],\n"
+            "    \"description\": \"The value of setting %d, in the units of category %d.\"\n"
+            "}\n",
+            i, i, i % 3 ? "true" : "false", category, i * 13 % 1000, i * 17 % 1000,
+            i * 19 % 1000, i, category)
+            .toUtf8();
+}
+
+bool tst_QResourceEngine::runRcc(const QStringList &arguments, const QString &output)
+{
+    QProcess rcc;
+    rcc.setWorkingDirectory(dir.path());
+    rcc.start(QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + "/rcc"_L1,
+              QStringList{ "-binary"_L1, "--format-version"_L1, "4"_L1, "-o"_L1, output }
+                      + arguments + QStringList{ "bundle.qrc"_L1 });
+    if (!rcc.waitForFinished() || rcc.exitStatus() != QProcess::NormalExit
+        || rcc.exitCode() != 0) {
+        qWarning("rcc failed: %ls %s", qUtf16Printable(rcc.errorString()),
+                 rcc.readAllStandardError().constData());
+        return false;
+    }
+    return true;
+}
+
+void tst_QResourceEngine::initTestCase()
+{
+#if !QT_CONFIG(zstd)
+    QSKIP("This benchmark compares zstd compression modes");
+#endif
+    QVERIFY(dir.isValid());
+    QByteArray qrc = "<RCC><qresource>\n";
+    const auto addFile = [&](const QString &name, const QByteArray &contents) {
+        QFile file(dir.filePath(name));
+        if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size())
+            return false;
+        qrc += "<file>" + name.toUtf8() + "</file>\n";
+        resourcePaths.append(":/"_L1 + name);
+        return true;
+    };
+    for (int i = 0; i < FilesPerKind; ++i) {
+        QVERIFY(addFile(QString::asprintf("page%d.qml", i), qmlFile(i)));
+        QVERIFY(addFile(QString::asprintf("icon%d.svg", i), svgFile(i)));
+        QVERIFY(addFile(QString::asprintf("setting%d.json", i), jsonFile(i)));
+    }
+    qrc += "</qresource></RCC>\n";
+    QFile qrcFile(dir.filePath("bundle.qrc"_L1));
+    QVERIFY(qrcFile.open(QIODevice::WriteOnly));
+    QCOMPARE(qrcFile.write(qrc), qrc.size());
+    qrcFile.close();
+
+    QVERIFY(runRcc({ "-no-compress"_L1 }, "none.rcc"_L1));
+    QVERIFY(runRcc({ "--compress-algo"_L1, "zstd"_L1 }, "zstd.rcc"_L1));
+    QVERIFY(runRcc({ "--compress-algo"_L1, "zstd"_L1, "--zstd-dictionary"_L1 },
+                   "dictionary.rcc"_L1));
+    for (const char *name : { "none.rcc", "zstd.rcc", "dictionary.rcc" }) {
+        qDebug("%s: %lld bytes for %lld files", name,
+               QFileInfo(dir.filePath(QLatin1StringView(name))).size(),
+               qlonglong(resourcePaths.size()));
+    }
+}
+
+void tst_QResourceEngine::load_data()
+{
+    QTest::addColumn<QString>("rccFile");
+    QTest::newRow("uncompressed") << "none.rcc";
+    QTest::newRow("zstd") << "zstd.rcc";
+    QTest::newRow("zstd-dictionary") << "dictionary.rcc";
+}
+
+// registers the bundle and reads all of its files
+void tst_QResourceEngine::load()
+{
+    QFETCH(QString, rccFile);
+    const QString fileName = dir.filePath(rccFile);
+
+    qsizetype total = 0;
+    QBENCHMARK {
+        // unregistering drops the decompressed data cached for the bundle
+        QVERIFY(QResource::registerResource(fileName));
+        for (const QString &path : std::as_const(resourcePaths))
+            total += QResource(path).uncompressedData().size();
+        QVERIFY(QResource::unregisterResource(fileName));
+    }
+    QVERIFY(total > 0);
+}
+
+QTEST_MAIN(tst_QResourceEngine)
+
+#include "tst_bench_qresourceengine.moc"
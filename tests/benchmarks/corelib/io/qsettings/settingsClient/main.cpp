@@ -0,0 +1,41 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qsettings.h>
+
+// Usage: settingsClient read|write <INI file> <count>
+//
+// "read" opens the file and looks <count> of its keys up, like an
+// application starting; "write" changes a key and syncs, <count> times.
+// The file has the keys section<i>/key<j>, for i and j below 100.
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments = app.arguments();
+    if (arguments.size() != 4)
+        return 2;
+    const QString fileName = arguments.at(2);
+    const int count = arguments.at(3).toInt();
+
+    if (arguments.at(1) == QLatin1StringView("read")) {
+        QSettings settings(fileName, QSettings::IniFormat);
+        for (int i = 0; i < count; ++i) {
+            const QString key = QString::asprintf("section%d/key%d", i * 37 % 100, i * 53 % 100);
+            if (!settings.value(key).isValid())
+                return 1;
+        }
+    } else if (arguments.at(1) == QLatin1StringView("write")) {
+        for (int i = 0; i < count; ++i) {
+            QSettings settings(fileName, QSettings::IniFormat);
+            settings.setValue(QString::asprintf("section%d/key%d", i * 41 % 100, i * 59 % 100),
+                              QCoreApplication::applicationPid() + i);
+            settings.sync();
+            if (settings.status() != QSettings::NoError)
+                return 1;
+        }
+    } else {
+        return 2;
+    }
+    return 0;
+}
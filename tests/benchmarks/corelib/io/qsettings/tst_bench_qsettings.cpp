@@ -0,0 +1,147 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QtCore/qfile.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qscopeguard.h>
+#include <QtCore/qsettings.h>
+#include <QtCore/qtemporarydir.h>
+#include <private/qsettings_p.h>
+
+#include <memory>
+#include <vector>
+
+using namespace Qt::StringLiterals;
+
+#ifdef Q_OS_WIN
+#  define EXE ".exe"
+#else
+#  define EXE ""
+#endif
+
+// a large INI file shared by the applications of a system
+static constexpr int Sections = 100;
+static constexpr int KeysPerSection = 100;
+static constexpr int LookupsPerOpen = 100;
+static constexpr int Readers = 8;
+static constexpr int Syncs = 10;
+
+class tst_QSettings : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void open_data();
+    void open();
+    void processes_data() { open_data(); }
+    void processes();
+
+private:
+    void prepareIndex(bool index);
+
+    QString client;
+    QTemporaryDir dir;
+    QString fileName;
+};
+
+// the same keys as settingsClient looks up
+static QString lookedUpKey(int i)
+{
+    return QString::asprintf("section%d/key%d", i * 37 % Sections, i * 53 % KeysPerSection);
+}
+
+void tst_QSettings::initTestCase()
+{
+    client = QFINDTESTDATA("../settingsClient/settingsClient" EXE);
+    QVERIFY(!client.isEmpty());
+    QVERIFY(dir.isValid());
+    fileName = dir.filePath("settings.ini"_L1);
+
+    QByteArray contents;
+    for (int i = 0; i < Sections; ++i) {
+        contents += "[section" + QByteArray::number(i) + "]\n";
+        for (int j = 0; j < KeysPerSection; ++j) {
+            contents += "key" + QByteArray::number(j) + "=value " + QByteArray::number(i * j)
+                    + ", \"with a list\", of, items\n";
+        }
+        contents += '\n';
+    }
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(contents), contents.size());
+}
+
+void tst_QSettings::prepareIndex(bool index)
+{
+    QFile::remove(fileName + ".index"_L1);
+    if (!index) {
+        qunsetenv("QT_SETTINGS_INDEX");
+        return;
+    }
+
+    // the first process to open the file builds the index
+    qputenv("QT_SETTINGS_INDEX", "1");
+    QProcess process;
+    process.start(client, { "read"_L1, fileName, "1"_L1 });
+    QVERIFY(process.waitForFinished());
+    QCOMPARE(process.exitCode(), 0);
+    QVERIFY(QFile::exists(fileName + ".index"_L1));
+}
+
+void tst_QSettings::open_data()
+{
+    QTest::addColumn<bool>("index");
+    QTest::newRow("parse") << false;
+    QTest::newRow("index") << true;
+}
+
+// opens the file and looks keys up, like an application starting
+void tst_QSettings::open()
+{
+#ifndef QT_BUILD_INTERNAL
+    QSKIP("This benchmark needs QConfFile::clearCache()");
+#else
+    QFETCH(bool, index);
+    auto restoreEnvironment = qScopeGuard([] { qunsetenv("QT_SETTINGS_INDEX"); });
+    prepareIndex(index);
+
+    QBENCHMARK {
+        // another process shares nothing parsed with this one
+        QConfFile::clearCache();
+        QSettings settings(fileName, QSettings::IniFormat);
+        for (int i = 0; i < LookupsPerOpen; ++i)
+            QVERIFY(settings.value(lookedUpKey(i)).isValid());
+    }
+#endif
+}
+
+// starts the reading processes while another process writes
+void tst_QSettings::processes()
+{
+    QFETCH(bool, index);
+    auto restoreEnvironment = qScopeGuard([] { qunsetenv("QT_SETTINGS_INDEX"); });
+    prepareIndex(index);
+
+    QBENCHMARK {
+        std::vector<std::unique_ptr<QProcess>> processes;
+        const auto start = [&](const QString &mode, int count) {
+            auto process = std::make_unique<QProcess>();
+            process->start(client, { mode, fileName, QString::number(count) });
+            processes.push_back(std::move(process));
+        };
+        start("write"_L1, Syncs);
+        for (int i = 0; i < Readers; ++i)
+            start("read"_L1, LookupsPerOpen);
+        for (const auto &process : processes) {
+            QVERIFY(process->waitForFinished());
+            QCOMPARE(process->exitStatus(), QProcess::NormalExit);
+            QCOMPARE(process->exitCode(), 0);
+        }
+    }
+}
+
+QTEST_MAIN(tst_QSettings)
+
+#include "tst_bench_qsettings.moc"
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QTest>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qlibrary.h>
+#include <QtCore/qtemporarydir.h>
+#include <private/qfactoryloader_p.h>
+
+using namespace Qt::StringLiterals;
+
+static constexpr char Iid[] = "org.qt-project.Qt.benchmarks.qfactoryloader";
+// a plugin directory of a typical size, plus files that are not plugins
+static constexpr int PluginCount = 40;
+static constexpr int OtherFileCount = 10;
+
+class tst_QFactoryLoader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void startup_data();
+    void startup();
+
+private:
+    QTemporaryDir root;
+    QTemporaryDir cacheDir;
+};
+
+void tst_QFactoryLoader::initTestCase()
+{
+    const QString binFolder = QFINDTESTDATA("bin");
+    QVERIFY2(!binFolder.isEmpty(), "Unable to locate 'bin' folder");
+    QString plugin;
+    QDirIterator it(binFolder, QDir::Files);
+    while (plugin.isEmpty() && it.hasNext()) {
+        const QString fileName = it.next();
+        if (QLibrary::isLibrary(fileName))
+            plugin = fileName;
+    }
+    QVERIFY(!plugin.isEmpty());
+
+    QVERIFY(root.isValid());
+    QVERIFY(cacheDir.isValid());
+    QVERIFY(QDir(root.path()).mkdir("benchmark"_L1));
+    const QString pluginDir = root.filePath("benchmark"_L1);
+    const QString suffix = QFileInfo(plugin).suffix();
+    for (int i = 0; i < PluginCount; ++i)
+        QVERIFY(QFile::copy(plugin, "%1/plugin%2.%3"_L1.arg(pluginDir).arg(i).arg(suffix)));
+    for (int i = 0; i < OtherFileCount; ++i) {
+        QFile file("%1/other%2.%3"_L1.arg(pluginDir).arg(i).arg(suffix));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray(4096, 'x'));
+    }
+    QCoreApplication::setLibraryPaths({ root.path() });
+}
+
+void tst_QFactoryLoader::cleanupTestCase()
+{
+    qunsetenv("QT_NO_PLUGIN_METADATA_CACHE");
+    qunsetenv("QT_PLUGIN_METADATA_CACHE_DIR");
+}
+
+void tst_QFactoryLoader::startup_data()
+{
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("uncached") << false;
+    QTest::newRow("cached") << true;
+}
+
+void tst_QFactoryLoader::startup()
+{
+    QFETCH(bool, cached);
+    if (cached) {
+        qunsetenv("QT_NO_PLUGIN_METADATA_CACHE");
+        qputenv("QT_PLUGIN_METADATA_CACHE_DIR", QFile::encodeName(cacheDir.path()));
+        // fill the cache
+        QFactoryLoader loader(Iid, "/benchmark"_L1);
+        QCOMPARE(loader.metaData().size(), PluginCount);
+    } else {
+        qputenv("QT_NO_PLUGIN_METADATA_CACHE", "1");
+    }
+
+    QBENCHMARK {
+        QFactoryLoader loader(Iid, "/benchmark"_L1);
+        QCOMPARE(loader.metaData().size(), PluginCount);
+    }
+}
+
+QTEST_MAIN(tst_QFactoryLoader)
+
+#include "tst_bench_qfactoryloader.moc"
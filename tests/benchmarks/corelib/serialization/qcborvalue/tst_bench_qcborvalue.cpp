@@ -1,8 +1,10 @@
 // Copyright (C) 2023 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
+#include <QCborArray>
 #include <QCborMap>
 #include <QCborValue>
+#include <QDateTime>
 
 #include <QTest>
 
@@ -51,6 +53,9 @@ private slots:
     void constructString() { doConstruct<QString>(); }
     void constructStringView() { doConstruct<QStringView>(); }
     void constructConstCharPtr() { doConstruct<char>(); }
+
+    void dateTimeFromCbor();
+    void dateTimeToCbor();
 };
 
 template <typename Type>
@@ -90,6 +95,40 @@ void tst_QCborValue::doConstruct()
     }
 }
 
+// A thousand RFC 3339 timestamps, a minute and a millisecond apart
+static QList<QDateTime> sampleDateTimes()
+{
+    QList<QDateTime> result;
+    const QDateTime start(QDate(2024, 2, 29), QTime(23, 30, 15, 125), QTimeZone::UTC);
+    for (int i = 0; i < 1000; ++i)
+        result.append(start.addMSecs(i * 60001));
+    return result;
+}
+
+void tst_QCborValue::dateTimeFromCbor()
+{
+    QCborArray array;
+    for (const QDateTime &dt : sampleDateTimes())
+        array.append(QCborValue(QCborKnownTags::DateTimeString, dt.toString(Qt::ISODateWithMs)));
+    const QByteArray cbor = QCborValue(array).toCbor();
+    QBENCHMARK {
+        const QCborArray decoded = QCborValue::fromCbor(cbor).toArray();
+        for (const QCborValue &value : decoded)
+            QVERIFY(value.toDateTime().isValid());
+    }
+}
+
+void tst_QCborValue::dateTimeToCbor()
+{
+    const QList<QDateTime> dateTimes = sampleDateTimes();
+    QBENCHMARK {
+        QCborArray array;
+        for (const QDateTime &dt : dateTimes)
+            array.append(QCborValue(dt));
+        [[maybe_unused]] const QByteArray cbor = QCborValue(array).toCbor();
+    }
+}
+
 QTEST_MAIN(tst_QCborValue)
 
 #include "tst_bench_qcborvalue.moc"
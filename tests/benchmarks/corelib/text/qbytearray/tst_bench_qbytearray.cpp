@@ -4,9 +4,13 @@
 #include <QDebug>
 #include <QIODevice>
 #include <QFile>
+#include <QList>
+#include <QLocale>
+#include <QRandomGenerator>
 #include <QString>
 
 #include <qtest.h>
+#include <cstring>
 #include <limits>
 
 class tst_QByteArray : public QObject
@@ -23,6 +27,11 @@ private slots:
     void toULongLong_data();
     void toULongLong();
 
+    void number_double_data();
+    void number_double();
+    void toDouble_data() { number_double_data(); }
+    void toDouble();
+
     void latin1Uppercasing_qt54();
     void latin1Uppercasing_xlate();
     void latin1Uppercasing_xlate_checked();
@@ -152,6 +161,80 @@ void tst_QByteArray::toULongLong()
     QCOMPARE(ok, good);
 }
 
+// a column of a CSV file, as written by data logging or exported from a spreadsheet
+static QList<double> doubleColumn(const QByteArray &kind)
+{
+    QRandomGenerator rng(1234);
+    QList<double> values;
+    values.reserve(1000);
+    while (values.size() < 1000) {
+        double d;
+        if (kind == "measurements") {
+            // readings with a few significant digits, like 12.345
+            d = (int(rng.bounded(2000000)) - 1000000) / 1000.0;
+        } else if (kind == "fractions") {
+            // results of computations, which need all 17 digits
+            d = rng.generateDouble() * 1000 - 500;
+        } else {
+            // any finite value, large and small
+            const quint64 bits = rng.generate64();
+            std::memcpy(&d, &bits, sizeof(d));
+            if (!qIsFinite(d))
+                continue;
+        }
+        values.append(d);
+    }
+    return values;
+}
+
+void tst_QByteArray::number_double_data()
+{
+    QTest::addColumn<QList<double>>("values");
+    for (const char *kind : { "measurements", "fractions", "bit-patterns" })
+        QTest::newRow(kind) << doubleColumn(kind);
+}
+
+void tst_QByteArray::number_double()
+{
+    QFETCH(QList<double>, values);
+
+    QByteArray csv;
+    QBENCHMARK {
+        csv.clear();
+        for (double d : std::as_const(values)) {
+            csv += QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
+            csv += '\n';
+        }
+    }
+
+    // the shortest representation reads back as the same value
+    QList<double> parsed;
+    const QByteArrayList lines = csv.chopped(1).split('\n');
+    for (const QByteArray &line : lines)
+        parsed.append(line.toDouble());
+    QCOMPARE(parsed, values);
+}
+
+void tst_QByteArray::toDouble()
+{
+    QFETCH(QList<double>, values);
+    QByteArrayList texts;
+    for (double d : std::as_const(values))
+        texts.append(QByteArray::number(d, 'g', QLocale::FloatingPointShortest));
+
+    QList<double> parsed(values.size());
+    bool ok = true;
+    QBENCHMARK {
+        for (qsizetype i = 0; i < texts.size(); ++i) {
+            bool good;
+            parsed[i] = texts.at(i).toDouble(&good);
+            ok = ok && good;
+        }
+    }
+    QVERIFY(ok);
+    QCOMPARE(parsed, values);
+}
+
 void tst_QByteArray::latin1Uppercasing_qt54()
 {
     QByteArray s = sourcecode;
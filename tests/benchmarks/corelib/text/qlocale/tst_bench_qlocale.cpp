@@ -4,6 +4,8 @@
 #include <QLocale>
 #include <QTest>
 
+#include <limits>
+
 using namespace Qt::StringLiterals;
 
 class tst_QLocale : public QObject
@@ -31,6 +33,8 @@ private Q_SLOTS:
     void toUpper_QLocale_2();
     void toUpper_QString();
     void number_QString();
+    void toString_double_data();
+    void toString_double();
     void toLongLong_data();
     void toLongLong();
     void toULongLong_data();
@@ -375,6 +379,45 @@ void tst_QLocale::number_QString()
     }
 }
 
+void tst_QLocale::toString_double_data()
+{
+    QTest::addColumn<double>("number");
+    QTest::addColumn<QString>("locale");
+    QTest::addColumn<int>("precision");
+    QTest::addColumn<QString>("expected");
+
+    const double third = 1.0 / 3;
+    QTest::newRow("C: 1/3") << third << u"C"_s << 6 << u"0.333333"_s;
+    QTest::newRow("C: 1/3 shortest")
+            << third << u"C"_s << int(QLocale::FloatingPointShortest) << u"0.3333333333333333"_s;
+    QTest::newRow("C: 1e-300/3 shortest")
+            << 1e-300 / 3 << u"C"_s << int(QLocale::FloatingPointShortest)
+            << u"3.3333333333333334e-301"_s;
+    QTest::newRow("en: 1/3 shortest")
+            << third << u"en"_s << int(QLocale::FloatingPointShortest) << u"0.3333333333333333"_s;
+    QTest::newRow("de: 1/3 shortest")
+            << third << u"de"_s << int(QLocale::FloatingPointShortest) << u"0,3333333333333333"_s;
+    QTest::newRow("ar_EG: 1/3 shortest")
+            << third << u"ar_EG"_s << int(QLocale::FloatingPointShortest)
+            << u"\u0660\u066b\u0663\u0663\u0663\u0663\u0663\u0663\u0663\u0663"
+               "\u0663\u0663\u0663\u0663\u0663\u0663\u0663\u0663"_s;
+}
+
+void tst_QLocale::toString_double()
+{
+    QFETCH(double, number);
+    QFETCH(QString, locale);
+    QFETCH(int, precision);
+    QFETCH(QString, expected);
+
+    const QLocale loc(locale);
+    QString actual;
+    QBENCHMARK {
+        actual = loc.toString(number, 'g', precision);
+    }
+    QCOMPARE(actual, expected);
+}
+
 template <typename Integer>
 void toWholeCommon_data()
 {
@@ -530,6 +573,10 @@ void tst_QLocale::toDouble_data()
             << (QString(961, u'0') + u'1' + QString(64, u'0') + u".0e-64"_s)
             << u"C"_s << true << 1.0;
     QTest::newRow("C: 12345678.9") << u"12345678.9"_s << u"C"_s << true << 12345678.9;
+    QTest::newRow("C: 1/3") << u"0.3333333333333333"_s << u"C"_s << true << 1.0 / 3;
+    QTest::newRow("C: -max")
+            << u"-1.7976931348623157e+308"_s << u"C"_s << true
+            << -std::numeric_limits<double>::max();
 
     // With and without grouping, en vs de for flipped separators:
     QTest::newRow("en: 12345678.9") << u"12345678.9"_s << u"en"_s << true << 12345678.9;
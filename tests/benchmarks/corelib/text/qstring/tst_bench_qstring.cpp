@@ -3,6 +3,7 @@
 #include <QStringList>
 #include <QByteArray>
 #include <QLatin1StringView>
+#include <QLocale>
 #include <QFile>
 #include <QTest>
 #include <limits>
@@ -292,6 +293,14 @@ void tst_QString::number_double_data()
         { 0.0001, 'E', 1, QStringLiteral("1.0E-04") },
         { 1e8, 'E', 1, QStringLiteral("1.0E+08") },
         { -1e8, 'E', 1, QStringLiteral("-1.0E+08") },
+        { 0.1, 'g', QLocale::FloatingPointShortest, QStringLiteral("0.1") },
+        { 1.0 / 3, 'g', QLocale::FloatingPointShortest, QStringLiteral("0.3333333333333333") },
+        { 0.5 + qSqrt(1.25), 'g', QLocale::FloatingPointShortest,
+          QStringLiteral("1.618033988749895") },
+        { std::numeric_limits<double>::epsilon(), 'g', QLocale::FloatingPointShortest,
+          QStringLiteral("2.220446049250313e-16") },
+        { -std::numeric_limits<double>::max(), 'e', QLocale::FloatingPointShortest,
+          QStringLiteral("-1.7976931348623157e+308") },
     };
 
     for (auto &datum : data) {
@@ -437,6 +446,10 @@ void tst_QString::toDouble_data()
     QTest::newRow("1e4") << u"1e4"_s << true << 1.0e+4;
     QTest::newRow("1.0e-8") << u"1.0e-8"_s << true << 1.0e-8;
     QTest::newRow("1.0e+8") << u"1.0e+8"_s << true << 1.0e+8;
+    QTest::newRow("1/3") << u"0.3333333333333333"_s << true << 1.0 / 3;
+    QTest::newRow("golden ratio") << u"1.618033988749895"_s << true << 0.5 + qSqrt(1.25);
+    QTest::newRow("-max")
+        << u"-1.7976931348623157e+308"_s << true << -std::numeric_limits<double>::max();
 
     // NaN and infinity:
     QTest::newRow("nan") << u"nan"_s << true << qQNaN();
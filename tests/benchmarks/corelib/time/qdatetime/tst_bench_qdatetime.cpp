@@ -8,6 +8,8 @@
 #include <qdebug.h>
 #include <QtCore/private/qdatetime_p.h>
 
+using namespace Qt::StringLiterals;
+
 class tst_QDateTime : public QObject
 {
     Q_OBJECT
@@ -47,6 +49,8 @@ private Q_SLOTS:
     void toString();
     void toStringTextFormat();
     void toStringIsoFormat();
+    void toStringIsoFormatWithMs();
+    void toStringRfc2822();
     void addDays();
 #if QT_CONFIG(timezone)
     void addDaysTz();
@@ -71,6 +75,8 @@ private Q_SLOTS:
     void fromString();
     void fromStringText();
     void fromStringIso();
+    void fromStringIsoWithMs_data();
+    void fromStringIsoWithMs();
     void fromMSecsSinceEpoch();
     void fromMSecsSinceEpochUtc();
 #if QT_CONFIG(timezone)
@@ -312,6 +318,24 @@ void tst_QDateTime::toStringIsoFormat()
     }
 }
 
+void tst_QDateTime::toStringIsoFormatWithMs()
+{
+    const auto list = daily(JULIAN_DAY_2010, JULIAN_DAY_2011);
+    QBENCHMARK {
+        for (const QDateTime &test : list)
+            test.toString(Qt::ISODateWithMs);
+    }
+}
+
+void tst_QDateTime::toStringRfc2822()
+{
+    const auto list = daily(JULIAN_DAY_2010, JULIAN_DAY_2011);
+    QBENCHMARK {
+        for (const QDateTime &test : list)
+            test.toString(Qt::RFC2822Date);
+    }
+}
+
 void tst_QDateTime::addDays()
 {
     const auto list = daily(JULIAN_DAY_2010, JULIAN_DAY_2020);
@@ -518,6 +542,26 @@ void tst_QDateTime::fromStringIso()
     }
 }
 
+void tst_QDateTime::fromStringIsoWithMs_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::newRow("utc") << u"2010-01-01T13:28:34.999Z"_s;
+    QTest::newRow("offset") << u"2010-01-01T13:28:34.999+05:30"_s;
+    QTest::newRow("local") << u"2010-01-01T13:28:34"_s;
+    QTest::newRow("microseconds") << u"2010-01-01T13:28:34.999999Z"_s;
+    QTest::newRow("minutes") << u"2010-01-01T13:28Z"_s;
+}
+
+void tst_QDateTime::fromStringIsoWithMs()
+{
+    QFETCH(QString, input);
+    QVERIFY(QDateTime::fromString(input, Qt::ISODateWithMs).isValid());
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i)
+            QDateTime::fromString(input, Qt::ISODateWithMs);
+    }
+}
+
 void tst_QDateTime::fromMSecsSinceEpoch()
 {
     const int start = JULIAN_DAY_2010 - JULIAN_DAY_1970;
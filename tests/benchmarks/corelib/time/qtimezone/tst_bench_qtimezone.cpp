@@ -26,6 +26,10 @@ private Q_SLOTS:
     void transitionsForward();
     void transitionsReverse_data() { transitionList_data(); }
     void transitionsReverse();
+    void fromMSecsSinceEpoch_data();
+    void fromMSecsSinceEpoch();
+    void toTimeZone_data() { fromMSecsSinceEpoch_data(); }
+    void toTimeZone();
 #endif
 };
 
@@ -140,6 +144,63 @@ void tst_QTimeZone::transitionsReverse()
             tran = zone.previousTransition(tran.atUtc);
     }
 }
+
+void tst_QTimeZone::fromMSecsSinceEpoch_data()
+{
+    QTest::addColumn<QByteArray>("name");
+    QTest::addColumn<int>("firstYear");
+    QTest::addColumn<int>("lastYear");
+
+    // Zone files describe transitions up to 2037 at most, and a rule after it:
+    const QByteArray names[] = {
+        "America/New_York", "Asia/Tokyo", "Australia/Sydney", "Europe/Oslo"
+    };
+    for (const QByteArray &name : names) {
+        QTest::addRow("%s:2000-2030", name.constData()) << name << 2000 << 2030;
+        QTest::addRow("%s:2040-2070", name.constData()) << name << 2040 << 2070;
+    }
+}
+
+// Hourly instants over the range, a week apart:
+static QList<qint64> sampleMSecs(int firstYear, int lastYear)
+{
+    QList<qint64> result;
+    const qint64 start = QDate(firstYear, 1, 1).startOfDay(QTimeZone::UTC).toMSecsSinceEpoch();
+    const qint64 end = QDate(lastYear, 12, 31).endOfDay(QTimeZone::UTC).toMSecsSinceEpoch();
+    for (qint64 ms = start; ms < end; ms += (7 * 24 + 1) * 3600 * 1000)
+        result.append(ms);
+    return result;
+}
+
+void tst_QTimeZone::fromMSecsSinceEpoch()
+{
+    QFETCH(QByteArray, name);
+    QFETCH(int, firstYear);
+    QFETCH(int, lastYear);
+    const QTimeZone zone(name);
+    QVERIFY(zone.isValid());
+    const QList<qint64> samples = sampleMSecs(firstYear, lastYear);
+    QBENCHMARK {
+        for (qint64 ms : samples)
+            QDateTime::fromMSecsSinceEpoch(ms, zone);
+    }
+}
+
+void tst_QTimeZone::toTimeZone()
+{
+    QFETCH(QByteArray, name);
+    QFETCH(int, firstYear);
+    QFETCH(int, lastYear);
+    const QTimeZone zone(name);
+    QVERIFY(zone.isValid());
+    QList<QDateTime> utc;
+    for (qint64 ms : sampleMSecs(firstYear, lastYear))
+        utc.append(QDateTime::fromMSecsSinceEpoch(ms, QTimeZone::UTC));
+    QBENCHMARK {
+        for (const QDateTime &when : std::as_const(utc))
+            when.toTimeZone(zone);
+    }
+}
 #endif
 
 QTEST_MAIN(tst_QTimeZone)
@@ -29,7 +29,7 @@ class tst_qnetworkdiskcache : public QObject
 {
     Q_OBJECT
 private:
-    void injectFakeData();
+    void injectFakeData(quint32 count = NumFakeCacheObjects);
     void insertOneItem();
     bool isUrlCached(quint32 id);
     void cleanRecursive(QString &path);
@@ -53,6 +53,9 @@ private slots:
 
     void timeExpiration_data();
     void timeExpiration();
+
+    void timeLargeCacheExpiration_data();
+    void timeLargeCacheExpiration();
 };
 
 
@@ -299,11 +302,70 @@ void tst_qnetworkdiskcache::timeExpiration()
     cleanRecursive(cacheDir);
 
 }
+void tst_qnetworkdiskcache::timeLargeCacheExpiration_data()
+{
+    QTest::addColumn<QString>("cacheRootDirectory");
+    QTest::addColumn<quint32>("entries");
+
+    QString cacheLoc = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QTest::newRow("100000 entries") << cacheLoc << quint32(100000);
+    QTest::newRow("1000000 entries") << cacheLoc << quint32(1000000);
+}
+
+//Times opening a cache with many entries and inserting into it
+//once it is full, so that every insertion has to evict something.
+void tst_qnetworkdiskcache::timeLargeCacheExpiration()
+{
+    QFETCH(QString, cacheRootDirectory);
+    QFETCH(quint32, entries);
+
+    if (entries > 100000 && qEnvironmentVariableIsEmpty("QNETWORKDISKCACHE_BENCH_HUGE"))
+        QSKIP("Set QNETWORKDISKCACHE_BENCH_HUGE to populate a cache of this size");
+
+    cacheDir = QString( cacheRootDirectory + QDir::separator() + "man_qndc");
+    QDir d;
+    qDebug() << "Setting cache directory to = " << d.absoluteFilePath(cacheDir);
+
+    //Housekeeping
+    initCacheObject();
+    cleanRecursive(cacheDir); // slow op.
+    cache->setCacheDirectory(cacheDir);
+    cache->setMaximumCacheSize(Q_INT64_C(1) << 40);
+    cache->clear();
+
+    injectFakeData(entries); // VERY SLOW
+    const qint64 cacheSize = cache->cacheSize();
+    cleanupCacheObject();
+
+    QBENCHMARK_ONCE {
+        initCacheObject();
+        cache->setCacheDirectory(cacheDir);
+        cache->setMaximumCacheSize(cacheSize);
+        for (quint32 i = entries; i < (entries + NumInsertions); i++) {
+            QNetworkCacheMetaData meta;
+            QString fakeURL;
+            QTextStream stream(&fakeURL);
+            stream << fakeURLbase << i;
+            QUrl url(fakeURL);
+            meta.setUrl(url);
+            meta.setSaveToDisk(true);
+
+            QIODevice *device = cache->prepare(meta);
+            device->write(payload);
+            cache->insert(device);
+        }
+    }
+
+    //Cleanup (VERY SLOW)
+    cleanupCacheObject();
+    cleanRecursive(cacheDir);
+}
+
 // This function simulates a partially or fully occupied disk cache
 // like a normal user of a cache might encounter is real-life browsing.
 // The point of this is to trigger degradation in file-system and media performance
 // that occur due to the quantity and layout of data.
-void tst_qnetworkdiskcache::injectFakeData()
+void tst_qnetworkdiskcache::injectFakeData(quint32 count)
 {
 
     QNetworkCacheMetaData::RawHeaderList headers;
@@ -311,7 +373,7 @@ void tst_qnetworkdiskcache::injectFakeData()
 
 
     //Prep cache dir with fake data using QNetworkDiskCache APIs
-    for (quint32 i = 0; i < NumFakeCacheObjects; i++) {
+    for (quint32 i = 0; i < count; i++) {
 
         //prepare metata for url
         QNetworkCacheMetaData meta;
@@ -348,7 +410,7 @@ bool tst_qnetworkdiskcache::isUrlCached(quint32 id)
 // Utility function for recursive directory cleanup.
 void tst_qnetworkdiskcache::cleanRecursive(QString &path)
 {
-    QDirIterator it(path, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    QDirIterator it(path, QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
     while (it.hasNext()) {
         QFile f(it.next());
         bool err = f.remove();
@@ -387,6 +387,34 @@ public slots:
     }
 };
 
+// Serves the same compressed body to every request, all at once
+class CompressedContentServer : QObject {
+    Q_OBJECT
+    QTcpServer server;
+    QByteArray response;
+
+public:
+    CompressedContentServer(const QByteArray &encoding, const QByteArray &body)
+    {
+        response = "HTTP/1.0 200 OK\r\nContent-Encoding: " + encoding
+                + "\r\nContent-Length: " + QByteArray::number(body.size())
+                + "\r\nConnection: close\r\n\r\n" + body;
+        server.listen();
+        connect(&server, &QTcpServer::newConnection, this, [this]() {
+            QTcpSocket *client = server.nextPendingConnection();
+            client->setParent(this);
+            connect(client, &QTcpSocket::readyRead, client, [this, client]() {
+                client->readAll();
+                client->write(response);
+                client->disconnectFromHost();
+            });
+            connect(client, &QTcpSocket::disconnected, client, &QObject::deleteLater);
+        });
+    }
+
+    int serverPort() { return server.serverPort(); }
+};
+
 class HttpDownloadPerformanceClient : QObject {
     Q_OBJECT;
     QIODevice *device;
@@ -434,6 +462,8 @@ private slots:
     void httpDownloadPerformance();
     void httpDownloadPerformanceDownloadBuffer_data();
     void httpDownloadPerformanceDownloadBuffer();
+    void httpDownloadCompressed_data();
+    void httpDownloadCompressed();
     void httpsRequestChain();
     void httpsUpload();
     void preConnect_data();
@@ -701,6 +731,61 @@ void tst_qnetworkreply::httpDownloadPerformance()
             << ((UploadSize/1024.0)/(elapsed/1000.0)) << " kB/sec";
 };
 
+void tst_qnetworkreply::httpDownloadCompressed_data()
+{
+    QTest::addColumn<bool>("backgroundDecompression");
+
+    QTest::newRow("decompress-in-user-thread") << false;
+    QTest::newRow("decompress-in-http-thread") << true;
+}
+
+void tst_qnetworkreply::httpDownloadCompressed()
+{
+    QFETCH(bool, backgroundDecompression);
+
+    constexpr qint64 DownloadSize = 64 * MiB;
+    QByteArray content;
+    content.reserve(DownloadSize);
+    for (int i = 0; content.size() < DownloadSize; ++i)
+        content += "line " + QByteArray::number(i) + ": " + QByteArray::number(i * 7919, 36) + '\n';
+    // Strip the length that qCompress() puts in front of the zlib stream
+    const QByteArray body = qCompress(content).sliced(4);
+    const qint64 contentSize = content.size();
+    content.clear();
+
+    CompressedContentServer server("deflate", body);
+
+    QNetworkRequest request(QUrl("http://127.0.0.1:" + QString::number(server.serverPort())));
+    request.setAttribute(QNetworkRequest::BackgroundDecompressionAttribute,
+                         backgroundDecompression);
+    request.setDecompressedSafetyCheckThreshold(-1);
+
+    // How long the user thread spends reading, which includes decompressing
+    // unless that happens in the HTTP thread
+    qint64 received = 0;
+    qint64 readingNSecs = 0;
+    QElapsedTimer time;
+    time.start();
+    QNetworkReplyPtr reply(manager.get(request));
+    QObject::connect(reply.data(), &QNetworkReply::readyRead, reply.data(), [&]() {
+        QElapsedTimer reading;
+        reading.start();
+        received += reply->readAll().size();
+        readingNSecs += reading.nsecsElapsed();
+    });
+    connect(reply, SIGNAL(finished()), &QTestEventLoop::instance(), SLOT(exitLoop()), Qt::QueuedConnection);
+    QTestEventLoop::instance().enterLoop(40);
+    QVERIFY(!QTestEventLoop::instance().timeout());
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    received += reply->readAll().size();
+    QCOMPARE(received, contentSize);
+
+    const qint64 elapsed = time.elapsed();
+    qDebug() << "tst_QNetworkReply::httpDownloadCompressed" << elapsed << "msec, "
+             << ((contentSize / 1024.0) / (elapsed / 1000.0)) << "kB/sec, "
+             << readingNSecs / 1000000 << "msec reading in the user thread";
+}
+
 enum HttpDownloadPerformanceDownloadBufferTestType {
     JustDownloadBuffer,
     DownloadBufferButUseRead,
@@ -11,10 +11,18 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qvector.h>
 #include <QtCore/qelapsedtimer.h>
+#if QT_CONFIG(sharedmemory)
+#include <QtCore/private/qsharedmemoryringbuffer_p.h>
+#endif
 #include <QtNetwork/qlocalsocket.h>
 #include <QtNetwork/qlocalserver.h>
+#ifdef Q_OS_UNIX
+#include <QtNetwork/private/qlocalsocketbulkchannel_p.h>
+#include <optional>
+#endif
 
 using namespace std::chrono_literals;
+using namespace Qt::StringLiterals;
 
 class tst_QLocalSocket : public QObject
 {
@@ -25,6 +33,10 @@ private slots:
     void pingPong();
     void dataExchange_data();
     void dataExchange();
+    void bulkTransfer_data();
+    void bulkTransfer();
+    void roundTrip_data();
+    void roundTrip();
 };
 
 class ServerThread : public QThread
@@ -209,6 +221,184 @@ void tst_QLocalSocket::dataExchange()
     serverThread.wait();
 }
 
+void tst_QLocalSocket::bulkTransfer_data()
+{
+    QTest::addColumn<bool>("bulkChannel");
+    QTest::addColumn<int>("chunkSize");
+    for (int chunkSize : {64 * 1024, 1024 * 1024, 4 * 1024 * 1024}) {
+        QTest::addRow("write, chunk size: %d", chunkSize) << false << chunkSize;
+        QTest::addRow("bulk channel, chunk size: %d", chunkSize) << true << chunkSize;
+    }
+}
+
+// One-way transfer of large chunks from one socket to the other, through
+// the socket itself or through QLocalSocketBulkChannel's shared memory.
+void tst_QLocalSocket::bulkTransfer()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("QLocalSocketBulkChannel is only supported on Unix");
+#else
+    QFETCH(bool, bulkChannel);
+    QFETCH(int, chunkSize);
+    const auto timeToTest = 3000ms;
+    // as much in flight either way
+    const qsizetype window = 4 * qsizetype(chunkSize);
+
+    QLocalServer server;
+    QVERIFY2(server.listen("bulkTransfer"), qPrintable(server.errorString()));
+    QLocalSocket sender;
+    sender.connectToServer("bulkTransfer");
+    QVERIFY(server.waitForNewConnection(3000));
+    QLocalSocket *receiver = server.nextPendingConnection();
+    QVERIFY(receiver);
+
+    const QByteArray chunk(chunkSize, 'q');
+    QByteArray buffer(chunkSize, Qt::Uninitialized);
+    // the channels take over the sockets' data streams
+    std::optional<QLocalSocketBulkChannel> bulkSender;
+    std::optional<QLocalSocketBulkChannel> bulkReceiver;
+    if (bulkChannel) {
+        bulkSender.emplace(&sender, window);
+        bulkReceiver.emplace(receiver, window);
+    }
+    QTestEventLoop eventLoop;
+    qint64 totalReceived = 0;
+    bool stopped = false;
+    QElapsedTimer timer;
+
+    const auto checkTime = [&]() {
+        if (!stopped && timer.elapsed() >= timeToTest.count()) {
+            stopped = true;
+            eventLoop.exitLoop();
+        }
+    };
+    const auto send = [&]() {
+        if (bulkChannel) {
+            while (!stopped && bulkSender->write(chunk)) {
+            }
+        } else {
+            while (!stopped && sender.bytesToWrite() < window)
+                sender.write(chunk);
+        }
+    };
+    if (bulkChannel) {
+        connect(&*bulkSender, &QLocalSocketBulkChannel::spaceAvailable, send);
+        connect(&*bulkReceiver, &QLocalSocketBulkChannel::readyRead, [&]() {
+            while (bulkReceiver->pendingPayloadCount()) {
+                totalReceived += bulkReceiver->peekPayload().size();
+                bulkReceiver->releasePayload();
+            }
+            checkTime();
+        });
+    } else {
+        connect(&sender, &QLocalSocket::bytesWritten, send);
+        connect(receiver, &QLocalSocket::readyRead, [&]() {
+            while (receiver->bytesAvailable())
+                totalReceived += receiver->read(buffer.data(), buffer.size());
+            checkTime();
+        });
+    }
+
+    timer.start();
+    send();
+    eventLoop.enterLoop(timeToTest * 2);
+
+    if (!QTest::currentTestFailed())
+        qDebug("Transfer rate: %.1f MB/s", totalReceived / 1048.576 / timer.elapsed());
+#endif
+}
+
+void tst_QLocalSocket::roundTrip_data()
+{
+    QTest::addColumn<bool>("ringBuffer");
+    QTest::newRow("local socket") << false;
+#if QT_CONFIG(sharedmemory)
+    QTest::newRow("shared memory ring buffer") << true;
+#endif
+}
+
+// Latency of a small message sent to another thread and back, with
+// blocking calls on both sides.
+void tst_QLocalSocket::roundTrip()
+{
+    QFETCH(bool, ringBuffer);
+    const int iterations = 100000;
+    const QByteArray message(16, 'q');
+    char buffer[16];
+    QElapsedTimer timer;
+
+    if (!ringBuffer) {
+        QLocalServer server;
+        QVERIFY2(server.listen("roundTrip"), qPrintable(server.errorString()));
+        QLocalSocket socket;
+        socket.connectToServer("roundTrip");
+        QVERIFY(server.waitForNewConnection(3000));
+        QLocalSocket *peer = server.nextPendingConnection();
+        QVERIFY(peer);
+        // the peer is moved to a thread of its own
+        peer->setParent(nullptr);
+        QScopedPointer<QThread> echo(QThread::create([peer]() {
+            char data[16];
+            for (int i = 0; i < iterations; ++i) {
+                while (peer->bytesAvailable() < qint64(sizeof(data)))
+                    peer->waitForReadyRead();
+                peer->read(data, sizeof(data));
+                peer->write(data, sizeof(data));
+                peer->flush();
+            }
+            delete peer;
+        }));
+        peer->moveToThread(echo.get());
+        echo->start();
+
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            socket.write(message);
+            socket.flush();
+            while (socket.bytesAvailable() < qint64(sizeof(buffer)))
+                QVERIFY(socket.waitForReadyRead());
+            socket.read(buffer, sizeof(buffer));
+        }
+        QVERIFY(echo->wait(3000));
+    } else {
+#if QT_CONFIG(sharedmemory)
+        const QString key = u"tst_bench_qlocalsocket_%1_"_s.arg(QCoreApplication::applicationPid());
+        QSharedMemoryRingBuffer requests;
+        QSharedMemoryRingBuffer replies;
+        QVERIFY(requests.create(QSharedMemory::platformSafeKey(key + u"requests"_s), 64, 16));
+        QVERIFY(replies.create(QSharedMemory::platformSafeKey(key + u"replies"_s), 64, 16));
+        QScopedPointer<QThread> echo(QThread::create([&key]() {
+            // stands in for the other process
+            QSharedMemoryRingBuffer requests;
+            QSharedMemoryRingBuffer replies;
+            if (!requests.attach(QSharedMemory::platformSafeKey(key + u"requests"_s))
+                    || !replies.attach(QSharedMemory::platformSafeKey(key + u"replies"_s))) {
+                return;
+            }
+            char data[16];
+            for (int i = 0; i < iterations; ++i) {
+                qsizetype size;
+                while ((size = requests.tryRead(data, sizeof(data))) < 0)
+                    requests.waitForReadyRead();
+                replies.write(QByteArrayView(data, size));
+            }
+        }));
+        echo->start();
+
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            QVERIFY(requests.write(message));
+            while (replies.tryRead(buffer, sizeof(buffer)) < 0)
+                QVERIFY(replies.waitForReadyRead(QDeadlineTimer(3000)));
+        }
+        QVERIFY(echo->wait(3000));
+#endif
+    }
+
+    if (!QTest::currentTestFailed())
+        qDebug("Round trip: %.2f us", timer.nsecsElapsed() / 1000.0 / iterations);
+}
+
 QTEST_MAIN(tst_QLocalSocket)
 
 #include "tst_qlocalsocket.moc"
@@ -24,6 +24,16 @@ private slots:
     void benchmark();
     void benchmarkSelectPrepared_data() { generic_data(); }
     void benchmarkSelectPrepared();
+    void benchmarkInsertPrepared_data() { generic_data(); }
+    void benchmarkInsertPrepared();
+    void benchmarkInsertBatch_data() { generic_data(); }
+    void benchmarkInsertBatch();
+    void benchmarkSelectTyped_data() { generic_data(); }
+    void benchmarkSelectTyped();
+    void benchmarkFetchColumns_data() { generic_data(); }
+    void benchmarkFetchColumns();
+    void psqlBenchmarkCopy_data() { generic_data("QPSQL"); }
+    void psqlBenchmarkCopy();
 
 private:
     // returns all database connections
@@ -115,4 +125,151 @@ void tst_QSqlQuery::benchmarkSelectPrepared()
     }
 }
 
+// The benchmarks below insert or read the same rows, to compare inserting
+// them one prepared statement at a time with execBatch() (which the QPSQL
+// driver pipelines) and COPY, and reading typed columns.
+static constexpr int BatchRows = 1000;
+
+static bool createTypedTable(QSqlQuery &q, const QString &tableName)
+{
+    return q.exec("CREATE TABLE " + tableName + "(id INT NOT NULL, amount NUMERIC(12, 2), "
+                  "stamp TIMESTAMP, payload VARCHAR(40))");
+}
+
+static QVariantList typedColumn(int column)
+{
+    QVariantList values;
+    values.reserve(BatchRows);
+    const QDateTime start(QDate(2024, 1, 1), QTime(0, 0));
+    for (int i = 0; i < BatchRows; ++i) {
+        switch (column) {
+        case 0:
+            values.append(i);
+            break;
+        case 1:
+            values.append(i * 1.25);
+            break;
+        case 2:
+            values.append(start.addSecs(i));
+            break;
+        default:
+            values.append(QString("payload %1").arg(i));
+            break;
+        }
+    }
+    return values;
+}
+
+void tst_QSqlQuery::benchmarkInsertPrepared()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery q(db);
+    TableScope ts(db, "benchmark", __FILE__);
+    QVERIFY2(createTypedTable(q, ts.tableName()), tst_Databases::printError(q.lastError(), db));
+
+    QList<QVariantList> columns;
+    for (int column = 0; column < 4; ++column)
+        columns.append(typedColumn(column));
+    QVERIFY_SQL(q, prepare("INSERT INTO " + ts.tableName() + " VALUES (?, ?, ?, ?)"));
+    QBENCHMARK {
+        for (int i = 0; i < BatchRows; ++i) {
+            for (int column = 0; column < 4; ++column)
+                q.bindValue(column, columns.at(column).at(i));
+            QVERIFY_SQL(q, exec());
+        }
+    }
+}
+
+void tst_QSqlQuery::benchmarkInsertBatch()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery q(db);
+    TableScope ts(db, "benchmark", __FILE__);
+    QVERIFY2(createTypedTable(q, ts.tableName()), tst_Databases::printError(q.lastError(), db));
+
+    QVERIFY_SQL(q, prepare("INSERT INTO " + ts.tableName() + " VALUES (?, ?, ?, ?)"));
+    for (int column = 0; column < 4; ++column)
+        q.addBindValue(typedColumn(column));
+    QBENCHMARK {
+        QVERIFY_SQL(q, execBatch());
+    }
+}
+
+void tst_QSqlQuery::benchmarkSelectTyped()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery q(db);
+    TableScope ts(db, "benchmark", __FILE__);
+    QVERIFY2(createTypedTable(q, ts.tableName()), tst_Databases::printError(q.lastError(), db));
+
+    QVERIFY_SQL(q, prepare("INSERT INTO " + ts.tableName() + " VALUES (?, ?, ?, ?)"));
+    for (int column = 0; column < 4; ++column)
+        q.addBindValue(typedColumn(column));
+    QVERIFY_SQL(q, execBatch());
+
+    QVERIFY_SQL(q, prepare("SELECT id, amount, stamp, payload FROM " + ts.tableName()));
+    QBENCHMARK {
+        QVERIFY_SQL(q, exec());
+        int rows = 0;
+        while (q.next()) {
+            for (int column = 0; column < 4; ++column)
+                q.value(column);
+            ++rows;
+        }
+        QCOMPARE(rows, BatchRows);
+    }
+}
+
+void tst_QSqlQuery::benchmarkFetchColumns()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery q(db);
+    TableScope ts(db, "benchmark", __FILE__);
+    QVERIFY2(createTypedTable(q, ts.tableName()), tst_Databases::printError(q.lastError(), db));
+
+    QVERIFY_SQL(q, prepare("INSERT INTO " + ts.tableName() + " VALUES (?, ?, ?, ?)"));
+    for (int column = 0; column < 4; ++column)
+        q.addBindValue(typedColumn(column));
+    QVERIFY_SQL(q, execBatch());
+
+    q.setForwardOnly(true);
+    QVERIFY_SQL(q, prepare("SELECT id, amount, stamp, payload FROM " + ts.tableName()));
+    QBENCHMARK {
+        QVERIFY_SQL(q, exec());
+        qsizetype rows = 0;
+        for (;;) {
+            const QList<QSqlColumnBuffer> columns = q.fetchColumns(4096);
+            if (columns.isEmpty() || columns.first().isEmpty())
+                break;
+            rows += columns.first().size();
+        }
+        QCOMPARE(rows, BatchRows);
+    }
+}
+
+void tst_QSqlQuery::psqlBenchmarkCopy()
+{
+    QFETCH(QString, dbName);
+    QSqlDatabase db = QSqlDatabase::database(dbName);
+    CHECK_DATABASE(db);
+    QSqlQuery q(db);
+    TableScope ts(db, "benchmark", __FILE__);
+    QVERIFY2(createTypedTable(q, ts.tableName()), tst_Databases::printError(q.lastError(), db));
+
+    QVERIFY_SQL(q, prepare("COPY " + ts.tableName() + " (id, amount, stamp, payload) FROM STDIN"));
+    for (int column = 0; column < 4; ++column)
+        q.addBindValue(typedColumn(column));
+    QBENCHMARK {
+        QVERIFY_SQL(q, execBatch());
+    }
+}
+
 #include "main.moc"